@@ -17,6 +17,7 @@
 #include "TIOMXPlugin.h"
 
 #include <dlfcn.h>
+#include <string.h>
 
 #include <HardwareAPI.h>
 
@@ -27,38 +28,131 @@ OMXPluginBase *createOMXPlugin() {
 }
 
 TIOMXPlugin::TIOMXPlugin()
-    : mLibHandle(dlopen("libOMX_Core.so", RTLD_NOW)),
+    : mLibHandle(NULL),
+      mCoreInitialized(false),
+      mTableBuilt(false),
+      mTableErr(OMX_ErrorNone),
       mInit(NULL),
       mDeinit(NULL),
       mComponentNameEnum(NULL),
       mGetHandle(NULL),
       mFreeHandle(NULL),
       mGetRolesOfComponentHandle(NULL) {
+}
+
+TIOMXPlugin::~TIOMXPlugin() {
+    if (mLibHandle != NULL) {
+        if (mCoreInitialized) {
+            (*mDeinit)();
+        }
+
+        dlclose(mLibHandle);
+        mLibHandle = NULL;
+    }
+}
+
+status_t TIOMXPlugin::loadLibrary_l() {
     if (mLibHandle != NULL) {
-        mInit = (InitFunc)dlsym(mLibHandle, "TIOMX_Init");
-        mDeinit = (DeinitFunc)dlsym(mLibHandle, "TIOMX_Deinit");
+        return OK;
+    }
+
+    mLibHandle = dlopen("libOMX_Core.so", RTLD_NOW);
+    if (mLibHandle == NULL) {
+        return UNKNOWN_ERROR;
+    }
 
-        mComponentNameEnum =
-            (ComponentNameEnumFunc)dlsym(mLibHandle, "TIOMX_ComponentNameEnum");
+    mInit = (InitFunc)dlsym(mLibHandle, "TIOMX_Init");
+    mDeinit = (DeinitFunc)dlsym(mLibHandle, "TIOMX_Deinit");
 
-        mGetHandle = (GetHandleFunc)dlsym(mLibHandle, "TIOMX_GetHandle");
-        mFreeHandle = (FreeHandleFunc)dlsym(mLibHandle, "TIOMX_FreeHandle");
+    mComponentNameEnum =
+        (ComponentNameEnumFunc)dlsym(mLibHandle, "TIOMX_ComponentNameEnum");
 
-        mGetRolesOfComponentHandle =
-            (GetRolesOfComponentFunc)dlsym(
-                    mLibHandle, "TIOMX_GetRolesOfComponent");
+    mGetHandle = (GetHandleFunc)dlsym(mLibHandle, "TIOMX_GetHandle");
+    mFreeHandle = (FreeHandleFunc)dlsym(mLibHandle, "TIOMX_FreeHandle");
 
-        (*mInit)();
+    mGetRolesOfComponentHandle =
+        (GetRolesOfComponentFunc)dlsym(
+                mLibHandle, "TIOMX_GetRolesOfComponent");
+
+    return OK;
+}
+
+// Walks the core's component table once. The core only fills the table in
+// TIOMX_Init, and the core stays initialized afterwards so that the first
+// makeComponentInstance does not build the table a second time.
+OMX_ERRORTYPE TIOMXPlugin::buildTable_l() {
+    OMX_ERRORTYPE err = initCore_l();
+    if (err != OMX_ErrorNone) {
+        return err;
     }
+
+    char name[OMX_MAX_STRINGNAME_SIZE];
+    for (OMX_U32 index = 0;
+            (*mComponentNameEnum)(name, sizeof(name), index) == OMX_ErrorNone;
+            ++index) {
+        Vector<String8> roles;
+
+        OMX_U32 numRoles;
+        err = (*mGetRolesOfComponentHandle)(name, &numRoles, NULL);
+        if (err == OMX_ErrorNone && numRoles > 0) {
+            OMX_U8 **array = new OMX_U8 *[numRoles];
+            for (OMX_U32 i = 0; i < numRoles; ++i) {
+                array[i] = new OMX_U8[OMX_MAX_STRINGNAME_SIZE];
+            }
+
+            OMX_U32 numRoles2 = numRoles;
+            err = (*mGetRolesOfComponentHandle)(name, &numRoles2, array);
+
+            if (err == OMX_ErrorNone && numRoles != numRoles2) {
+                err = OMX_ErrorUndefined;
+            }
+
+            for (OMX_U32 i = 0; i < numRoles; ++i) {
+                if (err == OMX_ErrorNone) {
+                    roles.push(String8((const char *)array[i]));
+                }
+
+                delete[] array[i];
+                array[i] = NULL;
+            }
+
+            delete[] array;
+            array = NULL;
+        }
+
+        if (err != OMX_ErrorNone) {
+            break;
+        }
+
+        mComponentNames.push(String8(name));
+        mComponentRoles.add(String8(name), roles);
+    }
+
+    return err;
 }
 
-TIOMXPlugin::~TIOMXPlugin() {
-    if (mLibHandle != NULL) {
-        (*mDeinit)();
+OMX_ERRORTYPE TIOMXPlugin::initCore_l() {
+    if (mCoreInitialized) {
+        return OMX_ErrorNone;
+    }
 
-        dlclose(mLibHandle);
-        mLibHandle = NULL;
+    OMX_ERRORTYPE err = (*mInit)();
+    if (err == OMX_ErrorNone) {
+        mCoreInitialized = true;
+    }
+
+    return err;
+}
+
+OMX_ERRORTYPE TIOMXPlugin::ensureTable() {
+    Mutex::Autolock autoLock(mLock);
+
+    if (!mTableBuilt) {
+        mTableBuilt = true;
+        mTableErr = (loadLibrary_l() == OK) ? buildTable_l() : OMX_ErrorUndefined;
     }
+
+    return mTableErr;
 }
 
 OMX_ERRORTYPE TIOMXPlugin::makeComponentInstance(
@@ -66,8 +160,17 @@ OMX_ERRORTYPE TIOMXPlugin::makeComponentInstance(
         const OMX_CALLBACKTYPE *callbacks,
         OMX_PTR appData,
         OMX_COMPONENTTYPE **component) {
-    if (mLibHandle == NULL) {
-        return OMX_ErrorUndefined;
+    {
+        Mutex::Autolock autoLock(mLock);
+
+        if (loadLibrary_l() != OK) {
+            return OMX_ErrorUndefined;
+        }
+
+        OMX_ERRORTYPE err = initCore_l();
+        if (err != OMX_ErrorNone) {
+            return err;
+        }
     }
 
     return (*mGetHandle)(
@@ -89,11 +192,21 @@ OMX_ERRORTYPE TIOMXPlugin::enumerateComponents(
         OMX_STRING name,
         size_t size,
         OMX_U32 index) {
-    if (mLibHandle == NULL) {
-        return OMX_ErrorUndefined;
+    OMX_ERRORTYPE err = ensureTable();
+    if (err != OMX_ErrorNone) {
+        return err;
     }
 
-    return (*mComponentNameEnum)(name, size, index);
+    if (index >= mComponentNames.size()) {
+        return OMX_ErrorNoMore;
+    }
+
+    strncpy(name, mComponentNames[index].string(), size);
+    if (size > 0) {
+        name[size - 1] = '\0';
+    }
+
+    return OMX_ErrorNone;
 }
 
 OMX_ERRORTYPE TIOMXPlugin::getRolesOfComponent(
@@ -101,47 +214,20 @@ OMX_ERRORTYPE TIOMXPlugin::getRolesOfComponent(
         Vector<String8> *roles) {
     roles->clear();
 
-    if (mLibHandle == NULL) {
-        return OMX_ErrorUndefined;
-    }
-
-    OMX_U32 numRoles;
-    OMX_ERRORTYPE err = (*mGetRolesOfComponentHandle)(
-            const_cast<OMX_STRING>(name), &numRoles, NULL);
-
+    OMX_ERRORTYPE err = ensureTable();
     if (err != OMX_ErrorNone) {
         return err;
     }
 
-    if (numRoles > 0) {
-        OMX_U8 **array = new OMX_U8 *[numRoles];
-        for (OMX_U32 i = 0; i < numRoles; ++i) {
-            array[i] = new OMX_U8[OMX_MAX_STRINGNAME_SIZE];
-        }
-
-        OMX_U32 numRoles2;
-        err = (*mGetRolesOfComponentHandle)(
-                const_cast<OMX_STRING>(name), &numRoles2, array);
-
-        if (err == OMX_ErrorNone && numRoles != numRoles2) {
-            err = OMX_ErrorUndefined;
-        }
-
-        for (OMX_U32 i = 0; i < numRoles; ++i) {
-            if (err == OMX_ErrorNone) {
-                String8 s((const char *)array[i]);
-                roles->push(s);
-            }
-
-            delete[] array[i];
-            array[i] = NULL;
-        }
-
-        delete[] array;
-        array = NULL;
+    ssize_t index = mComponentRoles.indexOfKey(String8(name));
+    if (index < 0) {
+        return OMX_ErrorInvalidComponentName;
     }
 
-    return err;
+    // String8 is reference counted, this copies no role strings
+    *roles = mComponentRoles.valueAt(index);
+
+    return OMX_ErrorNone;
 }
 
 }  // namespace android
@@ -20,6 +20,11 @@
 
 #include <OMXPluginBase.h>
 
+#include <utils/KeyedVector.h>
+#include <utils/Mutex.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
 namespace android {
 
 struct TIOMXPlugin : public OMXPluginBase {
@@ -45,8 +50,26 @@ struct TIOMXPlugin : public OMXPluginBase {
             Vector<String8> *roles);
 
 private:
+    Mutex mLock;
     void *mLibHandle;
 
+    // libOMX_Core is only loaded on the first query. TIOMX_Init runs once,
+    // for whichever of the role table or the first component instance
+    // needs it first, and the core stays up until the plugin goes away.
+    bool mCoreInitialized;
+
+    // Immutable once built: component names in core enumeration order and
+    // their roles.
+    bool mTableBuilt;
+    OMX_ERRORTYPE mTableErr;
+    Vector<String8> mComponentNames;
+    KeyedVector<String8, Vector<String8> > mComponentRoles;
+
+    status_t loadLibrary_l();
+    OMX_ERRORTYPE initCore_l();
+    OMX_ERRORTYPE buildTable_l();
+    OMX_ERRORTYPE ensureTable();
+
     typedef OMX_ERRORTYPE (*InitFunc)();
     typedef OMX_ERRORTYPE (*DeinitFunc)();
     typedef OMX_ERRORTYPE (*ComponentNameEnumFunc)(
@@ -80,6 +80,7 @@ endif
 #call to common omx & system components
 include $(TI_OMX_SYSTEM)/omx_core/src/Android.mk
 include $(TI_OMX_SYSTEM)/lcml/src/Android.mk
+include $(TI_OMX_SYSTEM)/common/src/Android.mk
 
 #call to audio
 include $(TI_OMX_AUDIO)/aac_dec/src/Android.mk
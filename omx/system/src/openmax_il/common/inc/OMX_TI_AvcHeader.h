@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_AvcHeader.h
+  *  H.264 sequence parameter set parser shared by the video decoder and
+  *  the config parser: the SPS fields up to the VUI, the timing and
+  *  bitstream restriction parts of the VUI, and the buffering figures
+  *  derived from them; and the recovery point lookup in SEI NAL units.
+  *  Linked statically from libOMX_TI_NalScan.
+ */
+
+#ifndef __OMX_TI_AVCHEADER_H__
+#define __OMX_TI_AVCHEADER_H__
+
+#include <OMX_Types.h>
+#include <OMX_Core.h>
+
+#include "OMX_TI_BitReader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* most frames a decoded picture buffer holds (A.3.1), also used when the
+   level is unknown */
+#define OMX_TI_AVC_MAX_DPB_FRAMES 16
+
+/* ======================================================================= */
+/**
+ * OMX_TI_AVCSPSTYPE  What OMX_TI_AvcParseSps() found, in a struct the
+ * caller provides. Sizes are in macroblocks / map units as coded; the
+ * frame cropping offsets are as coded too, nCropUnitX / nCropUnitY turn
+ * them into luma samples. Fields guarded by a flag that is not set are 0,
+ * except nChromaFormatIdc which is 1 (4:2:0) when the profile does not
+ * code it.
+ */
+/* ======================================================================= */
+typedef struct OMX_TI_AVCSPSTYPE {
+    OMX_U32 nProfileIdc;
+    OMX_U32 nConstraintFlags;               /* constraint_set0_flag in bit 7 */
+    OMX_U32 nLevelIdc;
+    OMX_U32 nSeqParameterSetId;
+    OMX_U32 nChromaFormatIdc;
+    OMX_BOOL bSeparateColourPlane;
+    OMX_U32 nBitDepthLumaMinus8;
+    OMX_U32 nBitDepthChromaMinus8;
+    OMX_BOOL bQpprimeYZeroTransformBypass;
+    OMX_BOOL bSeqScalingMatrix;
+    OMX_U32 nLog2MaxFrameNumMinus4;
+    OMX_U32 nPicOrderCntType;
+    OMX_U32 nNumRefFrames;
+    OMX_BOOL bGapsInFrameNumAllowed;
+    OMX_U32 nWidthMbs;
+    OMX_U32 nHeightMapUnits;
+    OMX_BOOL bFrameMbsOnly;
+    OMX_BOOL bMbAdaptiveFrameField;
+    OMX_BOOL bDirect8x8Inference;
+    OMX_BOOL bFrameCropping;
+    OMX_U32 nCropLeftOffset;
+    OMX_U32 nCropRightOffset;
+    OMX_U32 nCropTopOffset;
+    OMX_U32 nCropBottomOffset;
+    OMX_U32 nCropUnitX;
+    OMX_U32 nCropUnitY;
+    OMX_BOOL bVuiParametersPresent;         /* and parsed without error */
+    OMX_BOOL bTimingInfo;
+    OMX_U32 nNumUnitsInTick;
+    OMX_U32 nTimeScale;
+    OMX_BOOL bFixedFrameRate;
+    OMX_BOOL bBitstreamRestriction;
+    OMX_U32 nNumReorderFrames;
+    OMX_U32 nMaxDecFrameBuffering;
+    OMX_U32 nDpbFrames;                     /* frames the decoder has to hold */
+    OMX_U32 nReorderFrames;                 /* frames output can lag decoding */
+} OMX_TI_AVCSPSTYPE;
+
+/* Parses seq_parameter_set_data() from pBits, which is positioned on
+   profile_idc (right after the NAL header byte) and reads the RBSP, with
+   emulation prevention bytes already removed. A VUI that runs past the
+   end of the data or is not consistent is dropped, it only refines the
+   buffering figures. OMX_ErrorStreamCorrupt when the SPS itself is
+   truncated or out of range. */
+OMX_ERRORTYPE OMX_TI_AvcParseSps(OMX_TI_BITREADERTYPE *pBits,
+                                 OMX_TI_AVCSPSTYPE *pSps);
+
+/* Parses vui_parameters() (E.1.1) from pBits into the VUI fields of pSps.
+   OMX_FALSE if the VUI runs past the end of the data or is not
+   consistent; the fields read so far are left as they are. */
+OMX_BOOL OMX_TI_AvcParseVui(OMX_TI_BITREADERTYPE *pBits,
+                            OMX_TI_AVCSPSTYPE *pSps);
+
+/* OMX_TRUE if the SEI NAL unit pNal[0..nNalSize), NAL header byte
+   included and emulation prevention bytes not removed, carries a
+   recovery_point message (payloadType 6) in any of its sei_message()s.
+   A truncated unit is read as far as it goes. */
+OMX_BOOL OMX_TI_AvcSeiHasRecoveryPoint(const OMX_U8 *pNal, OMX_U32 nNalSize);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_AVCHEADER_H__ */
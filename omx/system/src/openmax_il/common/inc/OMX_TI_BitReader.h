@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_BitReader.h
+  *  MSB first bit cursor for the header parsers of the video components:
+  *  fixed length fields, ue(v)/se(v) Exp-Golomb codes and byte alignment,
+  *  bounded by the size of the buffer it was started on.
+  *  Header only, every call is inlined.
+ */
+
+#ifndef __OMX_TI_BITREADER_H__
+#define __OMX_TI_BITREADER_H__
+
+#include <OMX_Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* ======================================================================= */
+/**
+ * OMX_TI_BITREADERTYPE  Read position in a buffer of nSize bytes.
+ *
+ * Unread bits are kept left aligned in a 64 bit cache that is refilled a
+ * whole 8 byte word at a time (byte by byte only over the last 7 bytes),
+ * so a field of up to 32 bits is a shift and a mask. Bits past the end
+ * read as zero; a read that runs past the end returns 0 and sets the
+ * sticky bOverrun flag, so a parser can read a whole header and check the
+ * flag once. The fields are private to the OMX_TI_Bits* calls.
+ */
+/* ======================================================================= */
+typedef struct OMX_TI_BITREADERTYPE {
+    const OMX_U8 *pData;        /* first byte of the buffer */
+    const OMX_U8 *pNext;        /* next byte to be loaded into the cache */
+    const OMX_U8 *pEnd;         /* one past the last byte of the buffer */
+    OMX_U64 nCache;             /* unread bits, MSB first */
+    OMX_U32 nCacheBits;         /* valid bits in nCache */
+    OMX_BOOL bOverrun;
+} OMX_TI_BITREADERTYPE;
+
+#if defined(__GNUC__)
+#define OMX_TI_BITS_CLZ32(x) ((OMX_U32)__builtin_clz(x))
+#else
+static inline OMX_U32 OMX_TI_BITS_CLZ32(OMX_U32 x)
+{
+    OMX_U32 n = 0;
+    while (!(x & 0x80000000)) {
+        x <<= 1;
+        n++;
+    }
+    return n;
+}
+#endif
+
+static inline void OMX_TI_BitsRefill(OMX_TI_BITREADERTYPE *pBits)
+{
+    if (pBits->pEnd - pBits->pNext >= 8) {
+        const OMX_U8 *p = pBits->pNext;
+        OMX_U64 nWord = ((OMX_U64)p[0] << 56) | ((OMX_U64)p[1] << 48) |
+                        ((OMX_U64)p[2] << 40) | ((OMX_U64)p[3] << 32) |
+                        ((OMX_U64)p[4] << 24) | ((OMX_U64)p[5] << 16) |
+                        ((OMX_U64)p[6] << 8)  | (OMX_U64)p[7];
+        OMX_U32 nBytes = (64 - pBits->nCacheBits) >> 3;
+
+        /* the bits below the new nCacheBits belong to the next byte, the
+           following refill ORs the same values back in */
+        pBits->nCache |= nWord >> pBits->nCacheBits;
+        pBits->pNext += nBytes;
+        pBits->nCacheBits += nBytes << 3;
+    }
+    else {
+        while (pBits->nCacheBits <= 56 && pBits->pNext < pBits->pEnd) {
+            pBits->nCache |= (OMX_U64)(*pBits->pNext++) << (56 - pBits->nCacheBits);
+            pBits->nCacheBits += 8;
+        }
+    }
+}
+
+static inline void OMX_TI_BitsInit(OMX_TI_BITREADERTYPE *pBits, const OMX_U8 *pData,
+                                   OMX_U32 nSize)
+{
+    pBits->pData = pData;
+    pBits->pNext = pData;
+    pBits->pEnd = pData + nSize;
+    pBits->nCache = 0;
+    pBits->nCacheBits = 0;
+    pBits->bOverrun = OMX_FALSE;
+    OMX_TI_BitsRefill(pBits);
+}
+
+/* Bit offset of the next unread bit from the start of the buffer. */
+static inline OMX_U32 OMX_TI_BitsPos(const OMX_TI_BITREADERTYPE *pBits)
+{
+    return (OMX_U32)((pBits->pNext - pBits->pData) << 3) - pBits->nCacheBits;
+}
+
+static inline OMX_U32 OMX_TI_BitsLeft(const OMX_TI_BITREADERTYPE *pBits)
+{
+    return (OMX_U32)((pBits->pEnd - pBits->pNext) << 3) + pBits->nCacheBits;
+}
+
+static inline OMX_BOOL OMX_TI_BitsOverrun(const OMX_TI_BITREADERTYPE *pBits)
+{
+    return pBits->bOverrun;
+}
+
+/* Next nBits (0..32) bits, not consumed. */
+static inline OMX_U32 OMX_TI_BitsShow(OMX_TI_BITREADERTYPE *pBits, OMX_U32 nBits)
+{
+    if (pBits->nCacheBits < nBits) {
+        OMX_TI_BitsRefill(pBits);
+    }
+    /* two shifts keep nBits == 0 defined */
+    return (OMX_U32)((pBits->nCache >> 1) >> (63 - nBits));
+}
+
+/* Consumes nBits (0..32) bits. */
+static inline void OMX_TI_BitsSkip(OMX_TI_BITREADERTYPE *pBits, OMX_U32 nBits)
+{
+    if (pBits->nCacheBits < nBits) {
+        OMX_TI_BitsRefill(pBits);
+        if (pBits->nCacheBits < nBits) {
+            pBits->bOverrun = OMX_TRUE;
+            nBits = pBits->nCacheBits;
+        }
+    }
+    pBits->nCache <<= nBits;
+    pBits->nCacheBits -= nBits;
+}
+
+/* Reads nBits (0..32) bits, 0 if they are not all in the buffer. */
+static inline OMX_U32 OMX_TI_BitsRead(OMX_TI_BITREADERTYPE *pBits, OMX_U32 nBits)
+{
+    OMX_U32 nValue;
+
+    if (pBits->nCacheBits < nBits) {
+        OMX_TI_BitsRefill(pBits);
+        if (pBits->nCacheBits < nBits) {
+            pBits->bOverrun = OMX_TRUE;
+            pBits->nCache = 0;
+            pBits->nCacheBits = 0;
+            return 0;
+        }
+    }
+    nValue = (OMX_U32)((pBits->nCache >> 1) >> (63 - nBits));
+    pBits->nCache <<= nBits;
+    pBits->nCacheBits -= nBits;
+    return nValue;
+}
+
+/* Skips to the next byte boundary, nothing if already aligned. */
+static inline void OMX_TI_BitsByteAlign(OMX_TI_BITREADERTYPE *pBits)
+{
+    OMX_TI_BitsSkip(pBits, (8 - (OMX_TI_BitsPos(pBits) & 7)) & 7);
+}
+
+/* Moves to bit offset nPos, clamped to the end of the buffer, and clears
+   the overrun flag. */
+static inline void OMX_TI_BitsSeek(OMX_TI_BITREADERTYPE *pBits, OMX_U32 nPos)
+{
+    OMX_U32 nSize = (OMX_U32)(pBits->pEnd - pBits->pData);
+
+    if (nPos > (nSize << 3)) {
+        nPos = nSize << 3;
+    }
+    pBits->pNext = pBits->pData + (nPos >> 3);
+    pBits->nCache = 0;
+    pBits->nCacheBits = 0;
+    pBits->bOverrun = OMX_FALSE;
+    OMX_TI_BitsRefill(pBits);
+    OMX_TI_BitsSkip(pBits, nPos & 7);
+}
+
+/* ue(v). The leading zeros are counted with one CLZ; a code longer than
+   32 bits is not valid for any field the parsers read and is treated as
+   an overrun (returns 0). */
+static inline OMX_U32 OMX_TI_BitsUe(OMX_TI_BITREADERTYPE *pBits)
+{
+    OMX_U32 nShow = OMX_TI_BitsShow(pBits, 32);
+    OMX_U32 nLeadingZeros;
+
+    if (nShow == 0) {
+        pBits->bOverrun = OMX_TRUE;
+        return 0;
+    }
+    nLeadingZeros = OMX_TI_BITS_CLZ32(nShow);
+    if (nLeadingZeros < 16) {
+        /* the whole code is in the 32 bits shown */
+        OMX_U32 nLen = (nLeadingZeros << 1) + 1;
+        OMX_TI_BitsSkip(pBits, nLen);
+        return (nShow >> (32 - nLen)) - 1;
+    }
+    OMX_TI_BitsSkip(pBits, nLeadingZeros);
+    nShow = OMX_TI_BitsRead(pBits, nLeadingZeros + 1);
+    return nShow ? nShow - 1 : 0;
+}
+
+/* se(v): codeNum k maps to (-1)^(k+1) * ceil(k / 2). */
+static inline OMX_S32 OMX_TI_BitsSe(OMX_TI_BITREADERTYPE *pBits)
+{
+    OMX_U32 nCodeNum = OMX_TI_BitsUe(pBits);
+
+    if (nCodeNum & 1) {
+        return (OMX_S32)((nCodeNum >> 1) + 1);
+    }
+    return -(OMX_S32)(nCodeNum >> 1);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_BITREADER_H__ */
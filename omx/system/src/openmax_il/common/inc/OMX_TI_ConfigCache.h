@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_ConfigCache.h
+  *  Keys of the codec config parser result cache: the last few distinct
+  *  (role, component, config) triples, replaced least recently used first.
+  *  Only the keys are kept here; the caller stores a result per slot and
+  *  does the locking. Linked statically from libOMX_TI_NalScan.
+ */
+
+#ifndef __OMX_TI_CONFIGCACHE_H__
+#define __OMX_TI_CONFIGCACHE_H__
+
+#include <OMX_Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define OMX_TI_CONFIGCACHE_ENTRIES      8
+#define OMX_TI_CONFIGCACHE_MAX_BYTES    256
+#define OMX_TI_CONFIGCACHE_MAX_NAME     128
+
+typedef struct OMX_TI_CONFIGCACHEKEYTYPE {
+    OMX_U32 nHash;              /* 0 for an empty slot */
+    OMX_U32 nLastUse;
+    OMX_U32 nBytes;
+    OMX_U8 config[OMX_TI_CONFIGCACHE_MAX_BYTES];
+    char cRole[OMX_TI_CONFIGCACHE_MAX_NAME];
+    char cName[OMX_TI_CONFIGCACHE_MAX_NAME];
+} OMX_TI_CONFIGCACHEKEYTYPE;
+
+/* ======================================================================= */
+/**
+ * OMX_TI_CONFIGCACHETYPE  Cache keys and counters. A zero filled structure
+ * is an empty cache. Every OMX_TI_ConfigCacheFind is a lookup; the caller
+ * counts the configs it does not cache in nUncacheable (and nLookups).
+ */
+/* ======================================================================= */
+typedef struct OMX_TI_CONFIGCACHETYPE {
+    OMX_TI_CONFIGCACHEKEYTYPE aKeys[OMX_TI_CONFIGCACHE_ENTRIES];
+    OMX_U32 nClock;
+    OMX_U32 nLookups;
+    OMX_U32 nHits;
+    OMX_U32 nEvictions;
+    OMX_U32 nUncacheable;
+} OMX_TI_CONFIGCACHETYPE;
+
+/* OMX_TRUE when the key fits in a slot: at most OMX_TI_CONFIGCACHE_MAX_BYTES
+   of config and names shorter than OMX_TI_CONFIGCACHE_MAX_NAME. */
+OMX_BOOL OMX_TI_ConfigCacheFits(const char *cRole, const char *cName,
+                                const OMX_U8 *pConfig, OMX_U32 nBytes);
+
+/* FNV-1a hash of the role, the name (both with their terminator) and the
+   config, never 0. */
+OMX_U32 OMX_TI_ConfigCacheHash(const char *cRole, const char *cName,
+                               const OMX_U8 *pConfig, OMX_U32 nBytes);
+
+/* Slot holding the key, marked as the most recently used, or -1. The
+   stored key is compared on a hash match, so a collision is a miss. */
+OMX_S32 OMX_TI_ConfigCacheFind(OMX_TI_CONFIGCACHETYPE *pCache, OMX_U32 nHash,
+                               const char *cRole, const char *cName,
+                               const OMX_U8 *pConfig, OMX_U32 nBytes);
+
+/* Stores the key, in the slot already holding it or else in the least
+   recently used one (an eviction when that slot was in use), and returns
+   that slot, marked as the most recently used. */
+OMX_U32 OMX_TI_ConfigCacheInsert(OMX_TI_CONFIGCACHETYPE *pCache, OMX_U32 nHash,
+                                 const char *cRole, const char *cName,
+                                 const OMX_U8 *pConfig, OMX_U32 nBytes);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_CONFIGCACHE_H__ */
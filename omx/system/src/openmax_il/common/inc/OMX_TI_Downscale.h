@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_Downscale.h
+  *  In place box filter downscaling of a decoded frame by a power of two,
+  *  used by the video decoder's thumbnail mode. Linked statically from
+  *  libOMX_TI_NalScan.
+ */
+
+#ifndef __OMX_TI_DOWNSCALE_H__
+#define __OMX_TI_DOWNSCALE_H__
+
+#include <OMX_Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* ======================================================================= */
+/**
+ * OMX_TI_FRAMELAYOUTTYPE  Where the picture is in a decoded frame: rows of
+ * nStride pixels, planes of nSliceHeight rows, and the visible rectangle
+ * (the crop). For YUV 4:2:0 planar the chroma planes follow the luma one
+ * at half of each; nLeft and nTop must then be even.
+ */
+/* ======================================================================= */
+typedef struct OMX_TI_FRAMELAYOUTTYPE {
+    OMX_U32 nStride;
+    OMX_U32 nSliceHeight;
+    OMX_U32 nLeft;
+    OMX_U32 nTop;
+    OMX_U32 nWidth;
+    OMX_U32 nHeight;
+} OMX_TI_FRAMELAYOUTTYPE;
+
+/* Averages blocks of (1 << nShift) x (1 << nShift) pixels of the visible
+   part of the YUV 4:2:0 planar frame at pFrame, for nShift 1 to 7, and
+   writes the result packed (planar, stride = width) from pFrame. The
+   output size, each side shifted and rounded down to even, goes to
+   *pnWidth x *pnHeight. Returns the output bytes, 0 when a side would be
+   empty, and then the frame is left as it was. */
+OMX_U32 OMX_TI_DownscaleYuv420(OMX_U8 *pFrame, const OMX_TI_FRAMELAYOUTTYPE *pLayout,
+                               OMX_U32 nShift, OMX_U32 *pnWidth, OMX_U32 *pnHeight);
+
+/* The same for an interleaved Cb Y Cr Y (4:2:2) frame; nLeft must be even.
+   An output pair covers 2 << nShift source pixels: its first Y averages
+   the left half, the second the right half, Cb and Cr all of them. */
+OMX_U32 OMX_TI_DownscaleCbYCrY(OMX_U8 *pFrame, const OMX_TI_FRAMELAYOUTTYPE *pLayout,
+                               OMX_U32 nShift, OMX_U32 *pnWidth, OMX_U32 *pnHeight);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_DOWNSCALE_H__ */
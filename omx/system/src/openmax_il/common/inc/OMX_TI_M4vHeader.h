@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_M4vHeader.h
+  *  MPEG-4 Visual configuration header parser shared by the video decoder
+  *  and the config parser: the picture size and the few stream properties
+  *  they use, from a video object layer header or from the picture header
+  *  of an H.263 / short video header stream.
+  *  Linked statically from libOMX_TI_NalScan.
+ */
+
+#ifndef __OMX_TI_M4VHEADER_H__
+#define __OMX_TI_M4VHEADER_H__
+
+#include <OMX_Types.h>
+#include <OMX_Core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* profile_and_level_indication when the data has no visual object
+   sequence header */
+#define OMX_TI_M4V_PROFILELEVEL_NONE 0xFFFF
+
+/* ======================================================================= */
+/**
+ * OMX_TI_M4VHEADERTYPE  What OMX_TI_M4vParseHeader() found, in a struct
+ * the caller provides. nWidth x nHeight is the size coded in the header
+ * (video_object_layer_width/height, or the H.263 picture format), not
+ * rounded up to whole macroblocks. Fields the header does not carry are 0;
+ * an H.263 stream has no profile, aspect ratio or time base here.
+ */
+/* ======================================================================= */
+typedef struct OMX_TI_M4VHEADERTYPE {
+    OMX_BOOL bShortHeader;                  /* H.263 picture header */
+    OMX_U32 nProfileLevel;                  /* from the VOS header */
+    OMX_U32 nVideoObjectTypeIndication;
+    OMX_U32 nAspectRatioInfo;               /* 15: nParWidth:nParHeight */
+    OMX_U32 nParWidth;
+    OMX_U32 nParHeight;
+    OMX_U32 nTimeIncrementResolution;
+    OMX_U32 nWidth;
+    OMX_U32 nHeight;
+} OMX_TI_M4VHEADERTYPE;
+
+/* Parses the configuration data in pData[0..nSize): a short video header
+   when the data starts with one, otherwise the start codes are walked up
+   to the first VOL header, which is read as far as its size and no
+   further. OMX_ErrorStreamCorrupt when the data ends before the size is
+   known or a marker bit is broken, OMX_ErrorUnsupportedSetting for a VOL
+   that is not rectangular 4:2:0 or a VOP before any VOL. */
+OMX_ERRORTYPE OMX_TI_M4vParseHeader(const OMX_U8 *pData, OMX_U32 nSize,
+                                    OMX_TI_M4VHEADERTYPE *pHeader);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_M4VHEADER_H__ */
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_MBErrorMap.h
+  *  Summary of a macroblock error map as the video decoder reports it per
+  *  output frame: how many macroblocks had an error and the box around
+  *  them.
+  *  Linked statically from libOMX_TI_NalScan.
+ */
+
+#ifndef __OMX_TI_MBERRORMAP_H__
+#define __OMX_TI_MBERRORMAP_H__
+
+#include <OMX_Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* ======================================================================= */
+/**
+ * OMX_TI_MBERRORSUMMARYTYPE  In macroblocks: nLeft / nTop inclusive,
+ * nRight / nBottom exclusive. All 0 for a map without errors.
+ */
+/* ======================================================================= */
+typedef struct OMX_TI_MBERRORSUMMARYTYPE {
+    OMX_U32 nErroredMBs;
+    OMX_U32 nLeft;
+    OMX_U32 nTop;
+    OMX_U32 nRight;
+    OMX_U32 nBottom;
+} OMX_TI_MBERRORSUMMARYTYPE;
+
+/* Summarizes pErrMap, one byte per macroblock in raster order, nWidthMBs
+   x nHeightMBs, nonzero where the macroblock had an error. */
+void OMX_TI_MBErrorSummarize(const OMX_U8 *pErrMap, OMX_U32 nWidthMBs, OMX_U32 nHeightMBs,
+                             OMX_TI_MBERRORSUMMARYTYPE *pSummary);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_MBERRORMAP_H__ */
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_NalScan.h
+  *  H.264 NAL unit helpers shared by the video decoder and the config
+  *  parser: start code search, emulation prevention byte removal, a read
+  *  only iterator over Annex B or length prefixed NAL units, the packing of
+  *  length prefixed NAL units for the DSP, the assembly of config data
+  *  split over buffers, and the level limits needed to size a decoded
+  *  picture buffer.
+  *  Linked statically from libOMX_TI_NalScan.
+ */
+
+#ifndef __OMX_TI_NALSCAN_H__
+#define __OMX_TI_NALSCAN_H__
+
+#include <OMX_Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* ======================================================================= */
+/**
+ * OMX_TI_NALSCAN_IMPLTYPE  Implementation behind the OMX_TI_Nal* calls.
+ *
+ * The default (Auto) is chosen once per process: NEON when the library was
+ * built for it and the CPU reports it (HWCAP), SSE2 on x86 builds, the
+ * word at a time version otherwise. Scalar is the byte by byte reference
+ * the other implementations must match.
+ */
+/* ======================================================================= */
+typedef enum OMX_TI_NALSCAN_IMPLTYPE {
+    OMX_TI_NalScanAuto = 0,
+    OMX_TI_NalScanScalar,
+    OMX_TI_NalScanWord,
+    OMX_TI_NalScanSimd
+} OMX_TI_NALSCAN_IMPLTYPE;
+
+/* Forces an implementation, for verification. Returns the one in effect,
+   which is the automatic choice if the requested one is not available. */
+OMX_TI_NALSCAN_IMPLTYPE OMX_TI_NalScanSetImpl(OMX_TI_NALSCAN_IMPLTYPE eImpl);
+
+/* Offset of the first 00 00 01 in pData[0..nSize), nSize if there is none.
+   The leading zero of a four byte start code is not included. */
+OMX_U32 OMX_TI_NalFindStartCode(const OMX_U8 *pData, OMX_U32 nSize);
+
+/* Number of 00 00 01 start codes in pData[0..nSize). */
+OMX_U32 OMX_TI_NalCountStartCodes(const OMX_U8 *pData, OMX_U32 nSize);
+
+/* Offset of the first emulation prevention byte (a 0x03 following two or
+   more zero bytes) in pData[0..nSize), nSize if there is none. */
+OMX_U32 OMX_TI_NalFindEmulationPrevention(const OMX_U8 *pData, OMX_U32 nSize);
+
+/* Copies the NAL payload pSrc[0..nSize) to pDst dropping every 0x03 that
+   follows two or more zero bytes. pDst may be pSrc. Returns the RBSP
+   size. */
+OMX_U32 OMX_TI_NalRemoveEmulationPrevention(OMX_U8 *pDst, const OMX_U8 *pSrc,
+                                            OMX_U32 nSize);
+
+/* ======================================================================= */
+/**
+ * OMX_TI_NALITERTYPE  Read only walk over the NAL units of a buffer.
+ *
+ * Every step yields a view (pointer and size) into the caller's data, which
+ * is neither copied nor modified. nLengthSize selects the framing: 0 for an
+ * Annex B byte stream, 1, 2 or 4 for NAL units prefixed with a length of
+ * that many bytes. Empty NAL units are skipped; Annex B views exclude the
+ * zero bytes trailing a NAL unit. The fields are private to the iterator.
+ */
+/* ======================================================================= */
+typedef struct OMX_TI_NALITERTYPE {
+    const OMX_U8 *pData;
+    OMX_U32 nSize;
+    OMX_U32 nPos;           /* first payload byte of the next NAL unit */
+    OMX_U32 nLengthSize;
+    OMX_BOOL bBigEndian;
+} OMX_TI_NALITERTYPE;
+
+void OMX_TI_NalIterInit(OMX_TI_NALITERTYPE *pIter, const OMX_U8 *pData,
+                        OMX_U32 nSize, OMX_U32 nLengthSize, OMX_BOOL bBigEndian);
+
+/* Next NAL unit: its payload (starting with the NAL header byte) in
+   *ppNal and *pnSize, its nal_unit_type in *pnType. Returns OMX_FALSE at the
+   end of the data, or when a length prefix runs past it. */
+OMX_BOOL OMX_TI_NalIterNext(OMX_TI_NALITERTYPE *pIter, const OMX_U8 **ppNal,
+                            OMX_U32 *pnSize, OMX_U32 *pnType);
+
+/* Strips the nLengthSize (1, 2 or 4) byte length prefixes from the NAL
+   units in pData[0..*pnSize) in place: the payloads are packed at the
+   start of pData and their sizes stored in pSizes[0..nMaxCount), the
+   layout the DSP decoder takes for frame mode input. *pnSize becomes the
+   packed size and *pnCount the NAL unit count; bytes after the last
+   complete length prefix are dropped. Returns OMX_FALSE, with *pnCount 0,
+   for any other nLengthSize, a length running past the data or more than
+   nMaxCount NAL units. */
+OMX_BOOL OMX_TI_NalPackLengthPrefixed(OMX_U8 *pData, OMX_U32 *pnSize,
+                                      OMX_U32 nLengthSize, OMX_BOOL bBigEndian,
+                                      OMX_U32 *pSizes, OMX_U32 nMaxCount,
+                                      OMX_U32 *pnCount);
+
+/* Puts the nConfigSize bytes of codec config data at pConfig, held back
+   from earlier buffers, in front of the *pnSize bytes at pData, in a
+   buffer of nCapacity bytes; *pnSize grows by nConfigSize. The data is
+   moved up over itself first. Returns OMX_FALSE, leaving the buffer as it
+   was, when both do not fit. */
+OMX_BOOL OMX_TI_NalPrependConfig(OMX_U8 *pData, OMX_U32 *pnSize, OMX_U32 nCapacity,
+                                 const OMX_U8 *pConfig, OMX_U32 nConfigSize);
+
+/* Frames a decoded picture buffer holds for a picture of nWidthMbs x
+   nHeightMbs macroblocks at level_idc nLevelIdc: MaxDpbMbs of H.264 table
+   A-1 divided by the frame size, at most 16. 0 for an unknown level. */
+OMX_U32 OMX_TI_AvcMaxDpbFrames(OMX_U32 nLevelIdc, OMX_U32 nWidthMbs,
+                               OMX_U32 nHeightMbs);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_NALSCAN_H__ */
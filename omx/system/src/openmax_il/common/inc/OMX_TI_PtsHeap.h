@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_PtsHeap.h
+  *  Binary min-heap of the presentation timestamps of queued input, used by
+  *  the video decoder to hand frames that come out in display order the
+  *  earliest pending timestamp. Not thread safe; the caller locks.
+  *  Linked statically from libOMX_TI_NalScan.
+ */
+
+#ifndef __OMX_TI_PTSHEAP_H__
+#define __OMX_TI_PTSHEAP_H__
+
+#include <OMX_Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* ======================================================================= */
+/**
+ * OMX_TI_PTSHEAPTYPE  Heap over caller provided storage of nSize entries.
+ * The fields are private to the OMX_TI_PtsHeap calls.
+ */
+/* ======================================================================= */
+typedef struct OMX_TI_PTSHEAPTYPE {
+    OMX_TICKS *pEntries;
+    OMX_U32 nCount;
+    OMX_U32 nSize;
+} OMX_TI_PTSHEAPTYPE;
+
+/* Empty heap over pEntries[0..nSize). */
+void OMX_TI_PtsHeapInit(OMX_TI_PTSHEAPTYPE *pHeap, OMX_TICKS *pEntries, OMX_U32 nSize);
+
+/* Drops every timestamp. */
+void OMX_TI_PtsHeapClear(OMX_TI_PTSHEAPTYPE *pHeap);
+
+/* Adds nPts, O(log n). OMX_FALSE when the heap is full. */
+OMX_BOOL OMX_TI_PtsHeapPush(OMX_TI_PTSHEAPTYPE *pHeap, OMX_TICKS nPts);
+
+/* Takes the earliest timestamp into *pnPts, O(log n). OMX_FALSE when the
+   heap is empty. */
+OMX_BOOL OMX_TI_PtsHeapPop(OMX_TI_PTSHEAPTYPE *pHeap, OMX_TICKS *pnPts);
+
+/* Takes out one timestamp equal to nPts, for input leaving in decoding
+   order: O(n) to find it, O(log n) to restore the heap. OMX_FALSE when
+   there is none. */
+OMX_BOOL OMX_TI_PtsHeapRemove(OMX_TI_PTSHEAPTYPE *pHeap, OMX_TICKS nPts);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_PTSHEAP_H__ */
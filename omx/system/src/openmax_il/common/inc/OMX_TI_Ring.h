@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_Ring.h
+  *  Bounded lock free queue of small entries with any number of producer
+  *  threads and one consumer thread, used by the components to pass buffer
+  *  headers and commands to their component thread without a system call.
+  *  Header only, every call is inlined.
+ */
+
+#ifndef __OMX_TI_RING_H__
+#define __OMX_TI_RING_H__
+
+#include <stdlib.h>
+#include <OMX_Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* One queued item: a buffer header in pData, or a command with its
+   parameters. */
+typedef struct OMX_TI_RINGENTRYTYPE {
+    OMX_PTR pData;
+    OMX_U32 nParam1;
+    OMX_U32 nParam2;
+} OMX_TI_RINGENTRYTYPE;
+
+typedef struct OMX_TI_RINGCELLTYPE {
+    volatile OMX_U32 nSeq;
+    OMX_TI_RINGENTRYTYPE sEntry;
+} OMX_TI_RINGCELLTYPE;
+
+/* ======================================================================= */
+/**
+ * OMX_TI_RINGTYPE  Ring of a power of two cells, each tagged with a
+ * sequence number (Vyukov's bounded queue). A producer claims the cell at
+ * nHead with a compare and swap and publishes it by advancing the cell's
+ * sequence; the consumer owns nTail and hands the cell back one lap ahead.
+ * Nothing blocks: a full ring fails the put, an empty ring fails the get.
+ * The fields are private to the OMX_TI_Ring* calls.
+ */
+/* ======================================================================= */
+typedef struct OMX_TI_RINGTYPE {
+    OMX_TI_RINGCELLTYPE *pCells;
+    OMX_U32 nMask;
+    volatile OMX_U32 nHead;     /* next cell to claim, shared by producers */
+    OMX_U32 nTail;              /* next cell to consume */
+} OMX_TI_RINGTYPE;
+
+/* Sets up a ring holding at least nEntries entries. OMX_FALSE when out of
+   memory. */
+static inline OMX_BOOL OMX_TI_RingInit(OMX_TI_RINGTYPE *pRing, OMX_U32 nEntries)
+{
+    OMX_U32 nCells = 2;
+    OMX_U32 i;
+
+    while (nCells < nEntries) {
+        nCells <<= 1;
+    }
+    pRing->pCells = (OMX_TI_RINGCELLTYPE *)malloc(nCells * sizeof(OMX_TI_RINGCELLTYPE));
+    if (pRing->pCells == NULL) {
+        return OMX_FALSE;
+    }
+    for (i = 0; i < nCells; i++) {
+        pRing->pCells[i].nSeq = i;
+    }
+    pRing->nMask = nCells - 1;
+    pRing->nHead = 0;
+    pRing->nTail = 0;
+    return OMX_TRUE;
+}
+
+static inline void OMX_TI_RingDeinit(OMX_TI_RINGTYPE *pRing)
+{
+    free(pRing->pCells);
+    pRing->pCells = NULL;
+}
+
+/* Queues *pEntry. Safe from any thread; OMX_FALSE if the ring is full. */
+static inline OMX_BOOL OMX_TI_RingPut(OMX_TI_RINGTYPE *pRing, const OMX_TI_RINGENTRYTYPE *pEntry)
+{
+    OMX_TI_RINGCELLTYPE *pCell;
+    OMX_U32 nPos = pRing->nHead;
+
+    for (;;) {
+        OMX_S32 nDiff;
+
+        pCell = &pRing->pCells[nPos & pRing->nMask];
+        nDiff = (OMX_S32)(pCell->nSeq - nPos);
+        if (nDiff == 0) {
+            if (__sync_bool_compare_and_swap(&pRing->nHead, nPos, nPos + 1)) {
+                break;
+            }
+        }
+        else if (nDiff < 0) {
+            /* the consumer has not freed this cell yet */
+            return OMX_FALSE;
+        }
+        nPos = pRing->nHead;
+    }
+    pCell->sEntry = *pEntry;
+    /* the entry must be visible before the cell is published */
+    __sync_synchronize();
+    pCell->nSeq = nPos + 1;
+    return OMX_TRUE;
+}
+
+/* Dequeues the oldest entry into *pEntry. Consumer thread only; OMX_FALSE
+   if the ring is empty. */
+static inline OMX_BOOL OMX_TI_RingGet(OMX_TI_RINGTYPE *pRing, OMX_TI_RINGENTRYTYPE *pEntry)
+{
+    OMX_TI_RINGCELLTYPE *pCell = &pRing->pCells[pRing->nTail & pRing->nMask];
+
+    if ((OMX_S32)(pCell->nSeq - (pRing->nTail + 1)) < 0) {
+        return OMX_FALSE;
+    }
+    __sync_synchronize();
+    *pEntry = pCell->sEntry;
+    /* done with the entry before the cell is handed back to producers */
+    __sync_synchronize();
+    pCell->nSeq = pRing->nTail + pRing->nMask + 1;
+    pRing->nTail++;
+    return OMX_TRUE;
+}
+
+/* OMX_TRUE if the consumer would get nothing. Consumer thread only. */
+static inline OMX_BOOL OMX_TI_RingEmpty(const OMX_TI_RINGTYPE *pRing)
+{
+    const OMX_TI_RINGCELLTYPE *pCell = &pRing->pCells[pRing->nTail & pRing->nMask];
+
+    return ((OMX_S32)(pCell->nSeq - (pRing->nTail + 1)) < 0) ? OMX_TRUE : OMX_FALSE;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_RING_H__ */
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/** OMX_TI_SeqHeader.h
+  *  MPEG-2 and VC-1 advanced profile sequence header parsers used by the
+  *  video decoder: only the picture size, which is all it reads from them.
+  *  Linked statically from libOMX_TI_NalScan.
+ */
+
+#ifndef __OMX_TI_SEQHEADER_H__
+#define __OMX_TI_SEQHEADER_H__
+
+#include <OMX_Types.h>
+#include <OMX_Core.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* horizontal_size_value and vertical_size_value of the first sequence
+   header (00 00 01 B3) in pData[0..nSize). OMX_ErrorStreamCorrupt when
+   there is none or it ends before the size. */
+OMX_ERRORTYPE OMX_TI_Mpeg2ParseSeqHeader(const OMX_U8 *pData, OMX_U32 nSize,
+                                         OMX_U32 *pnWidth, OMX_U32 *pnHeight);
+
+/* Maximum coded size, max_coded_width * 2 + 2 by max_coded_height * 2 + 2,
+   of the first VC-1 advanced profile sequence header (00 00 01 0F), or
+   entry point (00 00 01 0E), in pData[0..nSize). OMX_ErrorStreamCorrupt
+   when there is none or it ends before the size. */
+OMX_ERRORTYPE OMX_TI_Vc1ParseSeqHeader(const OMX_U8 *pData, OMX_U32 nSize,
+                                       OMX_U32 *pnWidth, OMX_U32 *pnHeight);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __OMX_TI_SEQHEADER_H__ */
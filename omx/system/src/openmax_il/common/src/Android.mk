@@ -0,0 +1,31 @@
+LOCAL_PATH:= $(call my-dir)
+
+include $(CLEAR_VARS)
+
+
+
+LOCAL_SRC_FILES:= \
+	OMX_TI_NalScan.c \
+	OMX_TI_M4vHeader.c \
+	OMX_TI_AvcHeader.c \
+	OMX_TI_SeqHeader.c \
+	OMX_TI_ConfigCache.c \
+	OMX_TI_PtsHeap.c \
+	OMX_TI_Downscale.c \
+	OMX_TI_MBErrorMap.c
+
+LOCAL_C_INCLUDES += \
+	$(TI_OMX_INCLUDES) \
+	$(TI_OMX_SYSTEM)/common/inc
+
+LOCAL_CFLAGS := $(TI_OMX_CFLAGS) -O2
+
+# NEON kernels are built in when the target has NEON and are only used
+# after the CPU reports it at runtime
+ifeq ($(ARCH_ARM_HAVE_NEON),true)
+LOCAL_CFLAGS += -mfpu=neon -DOMX_TI_NALSCAN_NEON
+endif
+
+LOCAL_MODULE:= libOMX_TI_NalScan
+
+include $(BUILD_STATIC_LIBRARY)
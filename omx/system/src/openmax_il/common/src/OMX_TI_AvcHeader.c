@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/**
+* @file OMX_TI_AvcHeader.c
+*
+* H.264 sequence parameter set parser, see OMX_TI_AvcHeader.h.
+*
+* The SPS is read in full, high profile fields and scaling lists included,
+* so that the VUI behind it is read from the right bit position. Of the
+* VUI only the timing and bitstream restriction parts are kept; the HRD
+* parameters are stepped over.
+*
+* SEI units are walked byte-wise on the escaped data, payload sizes being
+* counted in RBSP bytes.
+*/
+/* ------------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "OMX_TI_AvcHeader.h"
+#include "OMX_TI_NalScan.h"
+
+/* profile_idc values whose SPS codes chroma_format_idc, the bit depths and
+   the scaling matrix (7.3.2.1.1) */
+static OMX_BOOL AvcHasChromaInfo(OMX_U32 nProfileIdc)
+{
+    switch (nProfileIdc) {
+        case 44: case 83: case 86: case 100: case 110: case 118:
+        case 122: case 128: case 134: case 135: case 138: case 139:
+        case 244:
+            return OMX_TRUE;
+        default:
+            return OMX_FALSE;
+    }
+}
+
+/* Steps over scaling_list() (7.3.2.1.1.1). */
+static void AvcSkipScalingList(OMX_TI_BITREADERTYPE *pBits, OMX_U32 nSize)
+{
+    OMX_S32 nLastScale = 8;
+    OMX_S32 nNextScale = 8;
+    OMX_U32 i;
+
+    for (i = 0; i < nSize && !OMX_TI_BitsOverrun(pBits); i++) {
+        if (nNextScale != 0) {
+            nNextScale = (nLastScale + OMX_TI_BitsSe(pBits) + 256) & 0xFF;
+        }
+        nLastScale = (nNextScale == 0) ? nLastScale : nNextScale;
+    }
+}
+
+/* Steps over hrd_parameters() (E.1.2). */
+static OMX_BOOL AvcSkipHrd(OMX_TI_BITREADERTYPE *pBits)
+{
+    OMX_U32 nCpbCntMinus1;
+    OMX_U32 i;
+
+    nCpbCntMinus1 = OMX_TI_BitsUe(pBits);
+    if (nCpbCntMinus1 > 31) {
+        return OMX_FALSE;
+    }
+    OMX_TI_BitsSkip(pBits, 8);          /* bit_rate_scale, cpb_size_scale */
+    for (i = 0; i <= nCpbCntMinus1 && !OMX_TI_BitsOverrun(pBits); i++) {
+        OMX_TI_BitsUe(pBits);           /* bit_rate_value_minus1[i] */
+        OMX_TI_BitsUe(pBits);           /* cpb_size_value_minus1[i] */
+        OMX_TI_BitsSkip(pBits, 1);      /* cbr_flag[i] */
+    }
+    OMX_TI_BitsSkip(pBits, 20);         /* four delay/offset lengths, u(5) each */
+    return OMX_TI_BitsOverrun(pBits) ? OMX_FALSE : OMX_TRUE;
+}
+
+OMX_BOOL OMX_TI_AvcParseVui(OMX_TI_BITREADERTYPE *pBits, OMX_TI_AVCSPSTYPE *pSps)
+{
+    OMX_U32 nNalHrd;
+    OMX_U32 nVclHrd;
+
+    if (OMX_TI_BitsRead(pBits, 1)) {                /* aspect_ratio_info_present_flag */
+        if (OMX_TI_BitsRead(pBits, 8) == 255) {     /* aspect_ratio_idc, Extended_SAR */
+            OMX_TI_BitsSkip(pBits, 32);             /* sar_width, sar_height */
+        }
+    }
+    if (OMX_TI_BitsRead(pBits, 1)) {                /* overscan_info_present_flag */
+        OMX_TI_BitsSkip(pBits, 1);                  /* overscan_appropriate_flag */
+    }
+    if (OMX_TI_BitsRead(pBits, 1)) {                /* video_signal_type_present_flag */
+        OMX_TI_BitsSkip(pBits, 4);                  /* video_format, video_full_range_flag */
+        if (OMX_TI_BitsRead(pBits, 1)) {            /* colour_description_present_flag */
+            OMX_TI_BitsSkip(pBits, 24);             /* colour_primaries, transfer_characteristics,
+                                                       matrix_coefficients */
+        }
+    }
+    if (OMX_TI_BitsRead(pBits, 1)) {                /* chroma_loc_info_present_flag */
+        OMX_TI_BitsUe(pBits);                       /* chroma_sample_loc_type_top_field */
+        OMX_TI_BitsUe(pBits);                       /* chroma_sample_loc_type_bottom_field */
+    }
+    if (OMX_TI_BitsRead(pBits, 1)) {                /* timing_info_present_flag */
+        pSps->nNumUnitsInTick = OMX_TI_BitsRead(pBits, 32);
+        pSps->nTimeScale = OMX_TI_BitsRead(pBits, 32);
+        pSps->bFixedFrameRate = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+        pSps->bTimingInfo = OMX_TRUE;
+    }
+    nNalHrd = OMX_TI_BitsRead(pBits, 1);            /* nal_hrd_parameters_present_flag */
+    if (nNalHrd && !AvcSkipHrd(pBits)) {
+        return OMX_FALSE;
+    }
+    nVclHrd = OMX_TI_BitsRead(pBits, 1);            /* vcl_hrd_parameters_present_flag */
+    if (nVclHrd && !AvcSkipHrd(pBits)) {
+        return OMX_FALSE;
+    }
+    if (nNalHrd || nVclHrd) {
+        OMX_TI_BitsSkip(pBits, 1);                  /* low_delay_hrd_flag */
+    }
+    OMX_TI_BitsSkip(pBits, 1);                      /* pic_struct_present_flag */
+    if (OMX_TI_BitsRead(pBits, 1)) {                /* bitstream_restriction_flag */
+        OMX_TI_BitsSkip(pBits, 1);                  /* motion_vectors_over_pic_boundaries_flag */
+        OMX_TI_BitsUe(pBits);                       /* max_bytes_per_pic_denom */
+        OMX_TI_BitsUe(pBits);                       /* max_bits_per_mb_denom */
+        OMX_TI_BitsUe(pBits);                       /* log2_max_mv_length_horizontal */
+        OMX_TI_BitsUe(pBits);                       /* log2_max_mv_length_vertical */
+        pSps->nNumReorderFrames = OMX_TI_BitsUe(pBits);
+        pSps->nMaxDecFrameBuffering = OMX_TI_BitsUe(pBits);
+        /* num_reorder_frames <= max_dec_frame_buffering <= MaxDpbFrames (E.2.1) */
+        if (pSps->nNumReorderFrames > pSps->nMaxDecFrameBuffering ||
+            pSps->nMaxDecFrameBuffering > OMX_TI_AVC_MAX_DPB_FRAMES) {
+            return OMX_FALSE;
+        }
+        pSps->bBitstreamRestriction = OMX_TRUE;
+    }
+    return OMX_TI_BitsOverrun(pBits) ? OMX_FALSE : OMX_TRUE;
+}
+
+OMX_ERRORTYPE OMX_TI_AvcParseSps(OMX_TI_BITREADERTYPE *pBits, OMX_TI_AVCSPSTYPE *pSps)
+{
+    OMX_U32 nCycle;
+    OMX_U32 i;
+
+    memset(pSps, 0, sizeof(OMX_TI_AVCSPSTYPE));
+    pSps->nProfileIdc = OMX_TI_BitsRead(pBits, 8);
+    pSps->nConstraintFlags = OMX_TI_BitsRead(pBits, 8);
+    pSps->nLevelIdc = OMX_TI_BitsRead(pBits, 8);
+    pSps->nSeqParameterSetId = OMX_TI_BitsUe(pBits);
+    if (pSps->nSeqParameterSetId > 31) {
+        return OMX_ErrorStreamCorrupt;
+    }
+
+    pSps->nChromaFormatIdc = 1;
+    if (AvcHasChromaInfo(pSps->nProfileIdc)) {
+        pSps->nChromaFormatIdc = OMX_TI_BitsUe(pBits);
+        if (pSps->nChromaFormatIdc > 3) {
+            return OMX_ErrorStreamCorrupt;
+        }
+        if (pSps->nChromaFormatIdc == 3) {
+            pSps->bSeparateColourPlane = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+        }
+        pSps->nBitDepthLumaMinus8 = OMX_TI_BitsUe(pBits);
+        pSps->nBitDepthChromaMinus8 = OMX_TI_BitsUe(pBits);
+        pSps->bQpprimeYZeroTransformBypass = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+        pSps->bSeqScalingMatrix = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+        if (pSps->bSeqScalingMatrix) {
+            /* six 4x4 lists, then two 8x8 lists, six for 4:4:4 */
+            for (i = 0; i < ((pSps->nChromaFormatIdc != 3) ? 8 : 12); i++) {
+                if (OMX_TI_BitsRead(pBits, 1)) {    /* seq_scaling_list_present_flag[i] */
+                    AvcSkipScalingList(pBits, (i < 6) ? 16 : 64);
+                }
+            }
+        }
+    }
+
+    pSps->nLog2MaxFrameNumMinus4 = OMX_TI_BitsUe(pBits);
+    pSps->nPicOrderCntType = OMX_TI_BitsUe(pBits);
+    if (pSps->nPicOrderCntType == 0) {
+        OMX_TI_BitsUe(pBits);                       /* log2_max_pic_order_cnt_lsb_minus4 */
+    }
+    else if (pSps->nPicOrderCntType == 1) {
+        OMX_TI_BitsSkip(pBits, 1);                  /* delta_pic_order_always_zero_flag */
+        OMX_TI_BitsSe(pBits);                       /* offset_for_non_ref_pic */
+        OMX_TI_BitsSe(pBits);                       /* offset_for_top_to_bottom_field */
+        nCycle = OMX_TI_BitsUe(pBits);              /* num_ref_frames_in_pic_order_cnt_cycle */
+        if (nCycle > 255) {
+            return OMX_ErrorStreamCorrupt;
+        }
+        for (i = 0; i < nCycle && !OMX_TI_BitsOverrun(pBits); i++) {
+            OMX_TI_BitsSe(pBits);                   /* offset_for_ref_frame[i] */
+        }
+    }
+    else if (pSps->nPicOrderCntType != 2) {
+        return OMX_ErrorStreamCorrupt;
+    }
+
+    pSps->nNumRefFrames = OMX_TI_BitsUe(pBits);
+    pSps->bGapsInFrameNumAllowed = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+    pSps->nWidthMbs = OMX_TI_BitsUe(pBits) + 1;
+    pSps->nHeightMapUnits = OMX_TI_BitsUe(pBits) + 1;
+    pSps->bFrameMbsOnly = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+    if (!pSps->bFrameMbsOnly) {
+        pSps->bMbAdaptiveFrameField = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+    }
+    pSps->bDirect8x8Inference = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+
+    /* offsets count chroma samples, and field pairs vertically (7.4.2.1.1) */
+    if (pSps->nChromaFormatIdc == 0 || pSps->bSeparateColourPlane) {
+        pSps->nCropUnitX = 1;
+        pSps->nCropUnitY = 2 - pSps->bFrameMbsOnly;
+    }
+    else {
+        pSps->nCropUnitX = (pSps->nChromaFormatIdc == 3) ? 1 : 2;
+        pSps->nCropUnitY = ((pSps->nChromaFormatIdc == 1) ? 2 : 1) * (2 - pSps->bFrameMbsOnly);
+    }
+    pSps->bFrameCropping = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+    if (pSps->bFrameCropping) {
+        pSps->nCropLeftOffset = OMX_TI_BitsUe(pBits);
+        pSps->nCropRightOffset = OMX_TI_BitsUe(pBits);
+        pSps->nCropTopOffset = OMX_TI_BitsUe(pBits);
+        pSps->nCropBottomOffset = OMX_TI_BitsUe(pBits);
+    }
+    if (OMX_TI_BitsOverrun(pBits) || pSps->nNumRefFrames > OMX_TI_AVC_MAX_DPB_FRAMES) {
+        return OMX_ErrorStreamCorrupt;
+    }
+
+    pSps->bVuiParametersPresent = OMX_TI_BitsRead(pBits, 1) ? OMX_TRUE : OMX_FALSE;
+    if (pSps->bVuiParametersPresent && !OMX_TI_AvcParseVui(pBits, pSps)) {
+        pSps->bVuiParametersPresent = OMX_FALSE;
+        pSps->bTimingInfo = OMX_FALSE;
+        pSps->nNumUnitsInTick = 0;
+        pSps->nTimeScale = 0;
+        pSps->bFixedFrameRate = OMX_FALSE;
+        pSps->bBitstreamRestriction = OMX_FALSE;
+        pSps->nNumReorderFrames = 0;
+        pSps->nMaxDecFrameBuffering = 0;
+    }
+
+    /* Frames the decoder holds, references and pictures waiting for output:
+       what the VUI states; only the references when pic_order_cnt_type 2
+       makes output order decoding order; otherwise the level bound */
+    if (pSps->bBitstreamRestriction) {
+        pSps->nDpbFrames = pSps->nMaxDecFrameBuffering;
+    }
+    else if (pSps->nPicOrderCntType == 2) {
+        pSps->nDpbFrames = pSps->nNumRefFrames;
+    }
+    else {
+        pSps->nDpbFrames = OMX_TI_AvcMaxDpbFrames(pSps->nLevelIdc, pSps->nWidthMbs,
+                                                  pSps->nHeightMapUnits * (2 - pSps->bFrameMbsOnly));
+        if (pSps->nDpbFrames == 0) {
+            pSps->nDpbFrames = OMX_TI_AVC_MAX_DPB_FRAMES;
+        }
+    }
+    if (pSps->nDpbFrames < pSps->nNumRefFrames) {
+        pSps->nDpbFrames = pSps->nNumRefFrames;
+    }
+    /* and how far output can lag decoding */
+    if (pSps->bBitstreamRestriction) {
+        pSps->nReorderFrames = pSps->nNumReorderFrames;
+    }
+    else if (pSps->nPicOrderCntType == 2) {
+        pSps->nReorderFrames = 0;
+    }
+    else {
+        pSps->nReorderFrames = pSps->nDpbFrames;
+    }
+    return OMX_ErrorNone;
+}
+
+/* Returns the RBSP byte at *pPos of pNal[0..nNalSize), dropping emulation
+   prevention bytes, and advances *pPos; 0x100 once the unit is used up. */
+static OMX_U32 AvcSeiNextByte(const OMX_U8 *pNal, OMX_U32 nNalSize,
+                              OMX_U32 *pPos, OMX_U32 *pZeros)
+{
+    OMX_U32 nByte;
+
+    if (*pPos < nNalSize && *pZeros >= 2 && pNal[*pPos] == 0x03) {
+        (*pPos)++;
+        *pZeros = 0;
+    }
+    if (*pPos >= nNalSize) {
+        return 0x100;
+    }
+    nByte = pNal[(*pPos)++];
+    *pZeros = (nByte == 0) ? *pZeros + 1 : 0;
+    return nByte;
+}
+
+OMX_BOOL OMX_TI_AvcSeiHasRecoveryPoint(const OMX_U8 *pNal, OMX_U32 nNalSize)
+{
+    OMX_U32 nPos = 1;
+    OMX_U32 nZeros = 0;
+
+    /* walk every sei_message(); the last byte left is rbsp_trailing_bits() */
+    while (nPos + 1 < nNalSize) {
+        OMX_U32 nPayloadType = 0;
+        OMX_U32 nPayloadSize = 0;
+        OMX_U32 nByte;
+
+        while ((nByte = AvcSeiNextByte(pNal, nNalSize, &nPos, &nZeros)) == 0xFF) {
+            nPayloadType += 255;
+        }
+        if (nByte == 0x100) {
+            break;
+        }
+        nPayloadType += nByte;
+        while ((nByte = AvcSeiNextByte(pNal, nNalSize, &nPos, &nZeros)) == 0xFF) {
+            nPayloadSize += 255;
+        }
+        if (nByte == 0x100) {
+            break;
+        }
+        nPayloadSize += nByte;
+        if (nPayloadType == 6) {
+            return OMX_TRUE;
+        }
+        while (nPayloadSize-- != 0 &&
+               AvcSeiNextByte(pNal, nNalSize, &nPos, &nZeros) != 0x100) {
+        }
+    }
+    return OMX_FALSE;
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/**
+* @file OMX_TI_ConfigCache.c
+*
+* Config parser result cache keys, see OMX_TI_ConfigCache.h.
+*
+* The cache is small enough for a linear search; the hash only saves the
+* string and config compares on the slots that cannot match.
+*/
+/* ------------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "OMX_TI_ConfigCache.h"
+
+#define CONFIGCACHE_FNV_OFFSET  2166136261U
+#define CONFIGCACHE_FNV_PRIME   16777619U
+
+static OMX_U32 ConfigCacheFnv(OMX_U32 nHash, const OMX_U8 *pData, OMX_U32 nBytes)
+{
+    OMX_U32 i = 0;
+
+    for (i = 0; i < nBytes; i++) {
+        nHash = (nHash ^ pData[i]) * CONFIGCACHE_FNV_PRIME;
+    }
+    return nHash;
+}
+
+static OMX_BOOL ConfigCacheMatches(const OMX_TI_CONFIGCACHEKEYTYPE *pKey, OMX_U32 nHash,
+                                   const char *cRole, const char *cName,
+                                   const OMX_U8 *pConfig, OMX_U32 nBytes)
+{
+    return (OMX_BOOL)(pKey->nHash == nHash &&
+                      pKey->nBytes == nBytes &&
+                      0 == strcmp(pKey->cRole, cRole) &&
+                      0 == strcmp(pKey->cName, cName) &&
+                      0 == memcmp(pKey->config, pConfig, nBytes));
+}
+
+OMX_BOOL OMX_TI_ConfigCacheFits(const char *cRole, const char *cName,
+                                const OMX_U8 *pConfig, OMX_U32 nBytes)
+{
+    return (OMX_BOOL)(cRole != NULL && cName != NULL && pConfig != NULL &&
+                      nBytes <= OMX_TI_CONFIGCACHE_MAX_BYTES &&
+                      strlen(cRole) < OMX_TI_CONFIGCACHE_MAX_NAME &&
+                      strlen(cName) < OMX_TI_CONFIGCACHE_MAX_NAME);
+}
+
+OMX_U32 OMX_TI_ConfigCacheHash(const char *cRole, const char *cName,
+                               const OMX_U8 *pConfig, OMX_U32 nBytes)
+{
+    OMX_U32 nHash = CONFIGCACHE_FNV_OFFSET;
+
+    nHash = ConfigCacheFnv(nHash, (const OMX_U8 *)cRole, strlen(cRole) + 1);
+    nHash = ConfigCacheFnv(nHash, (const OMX_U8 *)cName, strlen(cName) + 1);
+    nHash = ConfigCacheFnv(nHash, pConfig, nBytes);
+    return nHash ? nHash : 1;
+}
+
+OMX_S32 OMX_TI_ConfigCacheFind(OMX_TI_CONFIGCACHETYPE *pCache, OMX_U32 nHash,
+                               const char *cRole, const char *cName,
+                               const OMX_U8 *pConfig, OMX_U32 nBytes)
+{
+    OMX_U32 i = 0;
+
+    pCache->nLookups++;
+    for (i = 0; i < OMX_TI_CONFIGCACHE_ENTRIES; i++) {
+        if (ConfigCacheMatches(&pCache->aKeys[i], nHash, cRole, cName, pConfig, nBytes)) {
+            pCache->aKeys[i].nLastUse = ++pCache->nClock;
+            pCache->nHits++;
+            return (OMX_S32)i;
+        }
+    }
+    return -1;
+}
+
+OMX_U32 OMX_TI_ConfigCacheInsert(OMX_TI_CONFIGCACHETYPE *pCache, OMX_U32 nHash,
+                                 const char *cRole, const char *cName,
+                                 const OMX_U8 *pConfig, OMX_U32 nBytes)
+{
+    OMX_TI_CONFIGCACHEKEYTYPE *pKey = &pCache->aKeys[0];
+    OMX_U32 i = 0;
+
+    for (i = 0; i < OMX_TI_CONFIGCACHE_ENTRIES; i++) {
+        if (ConfigCacheMatches(&pCache->aKeys[i], nHash, cRole, cName, pConfig, nBytes)) {
+            pKey = &pCache->aKeys[i];
+            break;
+        }
+        if (pCache->aKeys[i].nLastUse < pKey->nLastUse) {
+            pKey = &pCache->aKeys[i];
+        }
+    }
+    if (i == OMX_TI_CONFIGCACHE_ENTRIES && pKey->nHash != 0) {
+        pCache->nEvictions++;
+    }
+    pKey->nHash = nHash;
+    pKey->nLastUse = ++pCache->nClock;
+    pKey->nBytes = nBytes;
+    memcpy(pKey->config, pConfig, nBytes);
+    strncpy(pKey->cRole, cRole, OMX_TI_CONFIGCACHE_MAX_NAME);
+    strncpy(pKey->cName, cName, OMX_TI_CONFIGCACHE_MAX_NAME);
+    return (OMX_U32)(pKey - pCache->aKeys);
+}
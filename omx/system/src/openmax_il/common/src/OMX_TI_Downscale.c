@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/**
+* @file OMX_TI_Downscale.c
+*
+* Thumbnail downscaling, see OMX_TI_Downscale.h.
+*
+* The output is written over the input it is made of: an output sample
+* never lands past the first source sample of its block, and each plane is
+* done before the next one, whose output starts before its source.
+*/
+/* ------------------------------------------------------------------------- */
+
+#include "OMX_TI_Downscale.h"
+
+/* Box filter over one plane, the result written packed from pDst. */
+static void DownscalePlane(OMX_U8 *pDst, const OMX_U8 *pSrc, OMX_U32 nSrcStride,
+                           OMX_U32 nDstWidth, OMX_U32 nDstHeight, OMX_U32 nShift)
+{
+    OMX_U32 nStep = 1 << nShift;
+    OMX_U32 nRound = 1 << (2 * nShift - 1);
+    OMX_U32 x, y, i, j;
+
+    for (y = 0; y < nDstHeight; y++) {
+        const OMX_U8 *pRow = pSrc + (y << nShift) * nSrcStride;
+        for (x = 0; x < nDstWidth; x++) {
+            const OMX_U8 *pBlock = pRow + (x << nShift);
+            OMX_U32 nSum = 0;
+            for (j = 0; j < nStep; j++) {
+                for (i = 0; i < nStep; i++) {
+                    nSum += pBlock[i];
+                }
+                pBlock += nSrcStride;
+            }
+            *pDst++ = (OMX_U8)((nSum + nRound) >> (2 * nShift));
+        }
+    }
+}
+
+static OMX_BOOL DownscaleSize(const OMX_TI_FRAMELAYOUTTYPE *pLayout, OMX_U32 nShift,
+                              OMX_U32 *pnWidth, OMX_U32 *pnHeight)
+{
+    *pnWidth = (pLayout->nWidth >> nShift) & ~1;
+    *pnHeight = (pLayout->nHeight >> nShift) & ~1;
+    return (OMX_BOOL)(nShift >= 1 && nShift <= 7 && *pnWidth != 0 && *pnHeight != 0);
+}
+
+OMX_U32 OMX_TI_DownscaleYuv420(OMX_U8 *pFrame, const OMX_TI_FRAMELAYOUTTYPE *pLayout,
+                               OMX_U32 nShift, OMX_U32 *pnWidth, OMX_U32 *pnHeight)
+{
+    OMX_U32 nStride = pLayout->nStride;
+    OMX_U32 nLuma = nStride * pLayout->nSliceHeight;
+    OMX_U32 nChroma = (nStride / 2) * (pLayout->nSliceHeight / 2);
+    OMX_U32 nChromaOffset = (pLayout->nTop / 2) * (nStride / 2) + pLayout->nLeft / 2;
+    OMX_U32 nDstWidth = 0;
+    OMX_U32 nDstHeight = 0;
+    OMX_U32 nDstLuma = 0;
+
+    if (!DownscaleSize(pLayout, nShift, &nDstWidth, &nDstHeight)) {
+        return 0;
+    }
+    nDstLuma = nDstWidth * nDstHeight;
+    DownscalePlane(pFrame, pFrame + pLayout->nTop * nStride + pLayout->nLeft, nStride,
+                   nDstWidth, nDstHeight, nShift);
+    DownscalePlane(pFrame + nDstLuma, pFrame + nLuma + nChromaOffset, nStride / 2,
+                   nDstWidth / 2, nDstHeight / 2, nShift);
+    DownscalePlane(pFrame + nDstLuma + nDstLuma / 4, pFrame + nLuma + nChroma + nChromaOffset,
+                   nStride / 2, nDstWidth / 2, nDstHeight / 2, nShift);
+    *pnWidth = nDstWidth;
+    *pnHeight = nDstHeight;
+    return nDstLuma + nDstLuma / 2;
+}
+
+OMX_U32 OMX_TI_DownscaleCbYCrY(OMX_U8 *pFrame, const OMX_TI_FRAMELAYOUTTYPE *pLayout,
+                               OMX_U32 nShift, OMX_U32 *pnWidth, OMX_U32 *pnHeight)
+{
+    OMX_U32 nStride = pLayout->nStride * 2;
+    OMX_U32 nStep = 1 << nShift;
+    OMX_U32 nRound = 1 << (2 * nShift - 1);
+    const OMX_U8 *pSrc = pFrame + pLayout->nTop * nStride + pLayout->nLeft * 2;
+    OMX_U8 *pDst = pFrame;
+    OMX_U32 nDstWidth = 0;
+    OMX_U32 nDstHeight = 0;
+    OMX_U32 x, y, i, j;
+
+    if (!DownscaleSize(pLayout, nShift, &nDstWidth, &nDstHeight)) {
+        return 0;
+    }
+    for (y = 0; y < nDstHeight; y++) {
+        const OMX_U8 *pRow = pSrc + (y << nShift) * nStride;
+        for (x = 0; x < nDstWidth; x += 2) {
+            OMX_U32 nCb = 0;
+            OMX_U32 nCr = 0;
+            OMX_U32 nY0 = 0;
+            OMX_U32 nY1 = 0;
+            for (j = 0; j < nStep; j++) {
+                const OMX_U8 *p = pRow + j * nStride + ((x << nShift) * 2);
+                for (i = 0; i < nStep; i += 2, p += 4) {
+                    nCb += p[0];
+                    nY0 += p[1] + p[3];
+                    nCr += p[2];
+                }
+                for (i = 0; i < nStep; i += 2, p += 4) {
+                    nCb += p[0];
+                    nY1 += p[1] + p[3];
+                    nCr += p[2];
+                }
+            }
+            pDst[0] = (OMX_U8)((nCb + nRound) >> (2 * nShift));
+            pDst[1] = (OMX_U8)((nY0 + nRound) >> (2 * nShift));
+            pDst[2] = (OMX_U8)((nCr + nRound) >> (2 * nShift));
+            pDst[3] = (OMX_U8)((nY1 + nRound) >> (2 * nShift));
+            pDst += 4;
+        }
+    }
+    *pnWidth = nDstWidth;
+    *pnHeight = nDstHeight;
+    return nDstWidth * nDstHeight * 2;
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/**
+* @file OMX_TI_M4vHeader.c
+*
+* MPEG-4 Visual / H.263 configuration header parser, see OMX_TI_M4vHeader.h.
+*
+* The headers ahead of the VOL (visual object sequence, visual object, user
+* data, group of VOPs) only matter for the profile and level, so they are
+* stepped over with the start code search instead of being parsed. The
+* VOL is read up to video_object_layer_height; nothing after it is used.
+*/
+/* ------------------------------------------------------------------------- */
+
+#include <string.h>
+
+#include "OMX_TI_M4vHeader.h"
+#include "OMX_TI_NalScan.h"
+#include "OMX_TI_BitReader.h"
+
+#define M4V_VOS_START_CODE      0xB0
+#define M4V_VOS_END_CODE        0xB1
+#define M4V_VOP_START_CODE      0xB6
+#define M4V_VOL_START_CODE_MIN  0x20
+#define M4V_VOL_START_CODE_MAX  0x2F
+
+/* H.263 source format 6 is the custom picture format of PLUSPTYPE */
+#define M4V_H263_FORMAT_CUSTOM  6
+#define M4V_H263_FORMAT_EXTENDED 7
+
+/* sub-QCIF to 16CIF, by source format */
+static const OMX_U16 nH263Formats[][2] = {
+    { 0, 0 }, { 128, 96 }, { 176, 144 }, { 352, 288 }, { 704, 576 }, { 1408, 1152 }
+};
+
+/* Reads the VOL header following its start code. */
+static OMX_ERRORTYPE M4vParseVol(const OMX_U8 *pData, OMX_U32 nSize,
+                                 OMX_TI_M4VHEADERTYPE *pHeader)
+{
+    /* vbv_parameters: bit rate halves, buffer size, then the 3 bit
+       buffer size half and the 11 bit occupancy half together, occupancy;
+       each followed by a marker bit */
+    static const OMX_U8 nVbvFields[] = { 15, 15, 15, 14, 15 };
+    OMX_TI_BITREADERTYPE sBits;
+    OMX_U32 nMarkers = 1;
+    OMX_U32 i;
+
+    OMX_TI_BitsInit(&sBits, pData, nSize);
+    OMX_TI_BitsSkip(&sBits, 1);                         /* random_accessible_vol */
+    pHeader->nVideoObjectTypeIndication = OMX_TI_BitsRead(&sBits, 8);
+    if (OMX_TI_BitsRead(&sBits, 1)) {
+        /* video_object_layer_verid, video_object_layer_priority */
+        OMX_TI_BitsSkip(&sBits, 7);
+    }
+    pHeader->nAspectRatioInfo = OMX_TI_BitsRead(&sBits, 4);
+    if (pHeader->nAspectRatioInfo == 15) {
+        pHeader->nParWidth = OMX_TI_BitsRead(&sBits, 8);
+        pHeader->nParHeight = OMX_TI_BitsRead(&sBits, 8);
+    }
+    if (OMX_TI_BitsRead(&sBits, 1)) {                   /* vol_control_parameters */
+        if (OMX_TI_BitsRead(&sBits, 2) != 1) {          /* chroma_format 4:2:0 */
+            return OMX_TI_BitsOverrun(&sBits) ? OMX_ErrorStreamCorrupt : OMX_ErrorUnsupportedSetting;
+        }
+        OMX_TI_BitsSkip(&sBits, 1);                     /* low_delay */
+        if (OMX_TI_BitsRead(&sBits, 1)) {
+            for (i = 0; i < sizeof(nVbvFields); i++) {
+                OMX_TI_BitsSkip(&sBits, nVbvFields[i]);
+                nMarkers &= OMX_TI_BitsRead(&sBits, 1);
+            }
+        }
+    }
+    if (OMX_TI_BitsRead(&sBits, 2) != 0) {              /* rectangular shape */
+        return OMX_TI_BitsOverrun(&sBits) ? OMX_ErrorStreamCorrupt : OMX_ErrorUnsupportedSetting;
+    }
+    nMarkers &= OMX_TI_BitsRead(&sBits, 1);
+    pHeader->nTimeIncrementResolution = OMX_TI_BitsRead(&sBits, 16);
+    nMarkers &= OMX_TI_BitsRead(&sBits, 1);
+    if (OMX_TI_BitsRead(&sBits, 1)) {
+        /* fixed_vop_time_increment, in as many bits as it takes to count
+           up to vop_time_increment_resolution - 1, at least one */
+        OMX_U32 nRes = pHeader->nTimeIncrementResolution;
+        OMX_TI_BitsSkip(&sBits, (nRes > 1) ? 32 - OMX_TI_BITS_CLZ32(nRes - 1) : 1);
+    }
+    nMarkers &= OMX_TI_BitsRead(&sBits, 1);
+    pHeader->nWidth = OMX_TI_BitsRead(&sBits, 13);
+    nMarkers &= OMX_TI_BitsRead(&sBits, 1);
+    pHeader->nHeight = OMX_TI_BitsRead(&sBits, 13);
+    nMarkers &= OMX_TI_BitsRead(&sBits, 1);
+
+    if (OMX_TI_BitsOverrun(&sBits) || !nMarkers || pHeader->nTimeIncrementResolution == 0 ||
+        pHeader->nWidth == 0 || pHeader->nHeight == 0) {
+        return OMX_ErrorStreamCorrupt;
+    }
+    return OMX_ErrorNone;
+}
+
+/* Reads the size from an H.263 picture header: PTYPE, and for the
+   extended source format PLUSPTYPE and the custom picture format. */
+static OMX_ERRORTYPE M4vParseShortHeader(const OMX_U8 *pData, OMX_U32 nSize,
+                                         OMX_TI_M4VHEADERTYPE *pHeader)
+{
+    OMX_TI_BITREADERTYPE sBits;
+    OMX_U32 nFormat;
+
+    pHeader->bShortHeader = OMX_TRUE;
+    OMX_TI_BitsInit(&sBits, pData, nSize);
+    OMX_TI_BitsSkip(&sBits, 22 + 8);                    /* PSC, TR */
+    if (OMX_TI_BitsRead(&sBits, 2) != 2) {              /* PTYPE "10" */
+        return OMX_ErrorStreamCorrupt;
+    }
+    OMX_TI_BitsSkip(&sBits, 3);                         /* split screen, camera, freeze */
+    nFormat = OMX_TI_BitsRead(&sBits, 3);
+    if (nFormat == M4V_H263_FORMAT_EXTENDED) {
+        /* UFEP: the first picture has to carry OPPTYPE */
+        if (OMX_TI_BitsRead(&sBits, 3) != 1) {
+            return OMX_ErrorStreamCorrupt;
+        }
+        nFormat = OMX_TI_BitsRead(&sBits, 3);
+        /* the optional modes of OPPTYPE end in "1000", MPPTYPE in "001" */
+        OMX_TI_BitsSkip(&sBits, 11);
+        if (OMX_TI_BitsRead(&sBits, 4) != 8) {
+            return OMX_ErrorStreamCorrupt;
+        }
+        OMX_TI_BitsSkip(&sBits, 6);
+        if (OMX_TI_BitsRead(&sBits, 3) != 1) {
+            return OMX_ErrorStreamCorrupt;
+        }
+        if (nFormat == M4V_H263_FORMAT_CUSTOM) {
+            OMX_U32 nMarker;
+
+            if (OMX_TI_BitsRead(&sBits, 1)) {           /* CPM */
+                OMX_TI_BitsSkip(&sBits, 2);             /* PSBI */
+            }
+            /* CPFMT: pixel aspect ratio, PWI, marker, PHI */
+            OMX_TI_BitsSkip(&sBits, 4);
+            pHeader->nWidth = (OMX_TI_BitsRead(&sBits, 9) + 1) << 2;
+            nMarker = OMX_TI_BitsRead(&sBits, 1);
+            pHeader->nHeight = OMX_TI_BitsRead(&sBits, 9) << 2;
+            if (OMX_TI_BitsOverrun(&sBits) || !nMarker || pHeader->nHeight == 0) {
+                return OMX_ErrorStreamCorrupt;
+            }
+            return OMX_ErrorNone;
+        }
+    }
+    if (OMX_TI_BitsOverrun(&sBits)) {
+        return OMX_ErrorStreamCorrupt;
+    }
+    if (nFormat == 0 || nFormat >= sizeof(nH263Formats) / sizeof(nH263Formats[0])) {
+        return OMX_ErrorUnsupportedSetting;
+    }
+    pHeader->nWidth = nH263Formats[nFormat][0];
+    pHeader->nHeight = nH263Formats[nFormat][1];
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_TI_M4vParseHeader(const OMX_U8 *pData, OMX_U32 nSize,
+                                    OMX_TI_M4VHEADERTYPE *pHeader)
+{
+    OMX_U32 nPos = 0;
+
+    memset(pHeader, 0, sizeof(*pHeader));
+    pHeader->nProfileLevel = OMX_TI_M4V_PROFILELEVEL_NONE;
+
+    /* short video header: 22 bit picture start code 0000 0000 0000 0000 1000 00 */
+    if (nSize >= 3 && pData[0] == 0 && pData[1] == 0 && (pData[2] & 0xFC) == 0x80) {
+        return M4vParseShortHeader(pData, nSize, pHeader);
+    }
+    for (;;) {
+        OMX_U32 nCode;
+
+        nPos += OMX_TI_NalFindStartCode(pData + nPos, nSize - nPos);
+        if (nPos + 4 > nSize) {
+            return OMX_ErrorStreamCorrupt;
+        }
+        nCode = pData[nPos + 3];
+        if (nCode >= M4V_VOL_START_CODE_MIN && nCode <= M4V_VOL_START_CODE_MAX) {
+            return M4vParseVol(pData + nPos + 4, nSize - nPos - 4, pHeader);
+        }
+        if (nCode == M4V_VOS_START_CODE && nPos + 4 < nSize) {
+            pHeader->nProfileLevel = pData[nPos + 4];
+        }
+        else if (nCode == M4V_VOP_START_CODE || nCode == M4V_VOS_END_CODE) {
+            return OMX_ErrorUnsupportedSetting;
+        }
+        nPos += 3;
+    }
+}
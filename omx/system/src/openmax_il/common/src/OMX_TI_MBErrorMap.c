@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/**
+* @file OMX_TI_MBErrorMap.c
+*
+* Macroblock error map summary, see OMX_TI_MBErrorMap.h.
+*
+* One pass over the map: errored macroblocks are counted a row at a time
+* and the first and last of each row widen the box.
+*/
+/* ------------------------------------------------------------------------- */
+
+#include "OMX_TI_MBErrorMap.h"
+
+void OMX_TI_MBErrorSummarize(const OMX_U8 *pErrMap, OMX_U32 nWidthMBs, OMX_U32 nHeightMBs,
+                             OMX_TI_MBERRORSUMMARYTYPE *pSummary)
+{
+    OMX_U32 x;
+    OMX_U32 y;
+
+    pSummary->nErroredMBs = 0;
+    pSummary->nLeft = nWidthMBs;
+    pSummary->nTop = 0;
+    pSummary->nRight = 0;
+    pSummary->nBottom = 0;
+    for (y = 0; y < nHeightMBs; y++, pErrMap += nWidthMBs) {
+        OMX_U32 nCount = 0;
+        OMX_U32 nFirst = 0;
+        OMX_U32 nLast = 0;
+
+        for (x = 0; x < nWidthMBs; x++) {
+            if (pErrMap[x] != 0) {
+                if (nCount == 0) {
+                    nFirst = x;
+                }
+                nLast = x;
+                nCount++;
+            }
+        }
+        if (nCount != 0) {
+            if (pSummary->nErroredMBs == 0) {
+                pSummary->nTop = y;
+            }
+            pSummary->nBottom = y + 1;
+            if (nFirst < pSummary->nLeft) {
+                pSummary->nLeft = nFirst;
+            }
+            if (nLast + 1 > pSummary->nRight) {
+                pSummary->nRight = nLast + 1;
+            }
+            pSummary->nErroredMBs += nCount;
+        }
+    }
+    if (pSummary->nErroredMBs == 0) {
+        pSummary->nLeft = 0;
+    }
+}
@@ -0,0 +1,527 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/**
+* @file OMX_TI_NalScan.c
+*
+* H.264 NAL unit scanning kernels, see OMX_TI_NalScan.h.
+*
+* Start codes (00 00 01) and emulation prevention bytes (00 00 03) both
+* begin with a pair of zero bytes, so every accelerated kernel is built on
+* one primitive that finds the next zero pair: whole words (or 16 byte
+* vectors) without a zero byte are skipped and only the ones with a zero
+* are looked at byte by byte. Coded slice data rarely contains zero bytes,
+* which is where the time goes on long NAL units.
+*/
+/* ------------------------------------------------------------------------- */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "OMX_TI_NalScan.h"
+
+#if defined(OMX_TI_NALSCAN_NEON) && defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NALSCAN_HAVE_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define NALSCAN_HAVE_SSE2
+#endif
+
+#ifndef AT_NULL
+#define AT_NULL 0
+#endif
+#ifndef AT_HWCAP
+#define AT_HWCAP 16
+#endif
+#ifndef HWCAP_NEON
+#define HWCAP_NEON (1 << 12)
+#endif
+
+/* word at a time zero byte test */
+#define NALSCAN_ONES    (~0UL / 0xFF)
+#define NALSCAN_HIGHS   (NALSCAN_ONES * 0x80)
+#define NALSCAN_HAS_ZERO_BYTE(w) (((w) - NALSCAN_ONES) & ~(w) & NALSCAN_HIGHS)
+
+/* Offset of the first i with pData[i] == pData[i + 1] == 0, nSize if none */
+typedef OMX_U32 (*NALSCAN_FINDFN)(const OMX_U8 *pData, OMX_U32 nSize);
+
+static pthread_once_t nalScanOnce = PTHREAD_ONCE_INIT;
+static OMX_TI_NALSCAN_IMPLTYPE eNalScanImpl = OMX_TI_NalScanScalar;
+static OMX_TI_NALSCAN_IMPLTYPE eNalScanAutoImpl = OMX_TI_NalScanScalar;
+/* NULL selects the byte by byte reference */
+static NALSCAN_FINDFN pNalScanFindZeroPair = NULL;
+
+
+static OMX_U32 NalScan_FindZeroPairTail(const OMX_U8 *pData, OMX_U32 nSize,
+                                        OMX_U32 i)
+{
+    for (; i + 1 < nSize; i++) {
+        if (pData[i] == 0 && pData[i + 1] == 0) {
+            return i;
+        }
+    }
+    return nSize;
+}
+
+static OMX_U32 NalScan_FindZeroPairWord(const OMX_U8 *pData, OMX_U32 nSize)
+{
+    OMX_U32 i = 0;
+    OMX_U32 k = 0;
+    unsigned long nWord = 0;
+
+    /* byte steps up to the first aligned word */
+    for (; i + 1 < nSize && ((unsigned long)(pData + i) & (sizeof(unsigned long) - 1)); i++) {
+        if (pData[i] == 0 && pData[i + 1] == 0) {
+            return i;
+        }
+    }
+    /* a pair can only start in a word holding a zero byte; the last byte
+       of the word pairs with the first one of the next word, which is why
+       one byte past the word must be readable */
+    for (; i + sizeof(unsigned long) < nSize; i += sizeof(unsigned long)) {
+        memcpy(&nWord, pData + i, sizeof(unsigned long));
+        if (NALSCAN_HAS_ZERO_BYTE(nWord)) {
+            for (k = i; k < i + sizeof(unsigned long); k++) {
+                if (pData[k] == 0 && pData[k + 1] == 0) {
+                    return k;
+                }
+            }
+        }
+    }
+    return NalScan_FindZeroPairTail(pData, nSize, i);
+}
+
+#ifdef NALSCAN_HAVE_NEON
+static OMX_U32 NalScan_FindZeroPairSimd(const OMX_U8 *pData, OMX_U32 nSize)
+{
+    OMX_U32 i = 0;
+    OMX_U32 k = 0;
+    const uint8x16_t vZero = vdupq_n_u8(0);
+
+    for (; i + 16 < nSize; i += 16) {
+        uint8x16_t vEq = vceqq_u8(vld1q_u8(pData + i), vZero);
+        uint8x8_t vAny = vorr_u8(vget_low_u8(vEq), vget_high_u8(vEq));
+
+        vAny = vpmax_u8(vAny, vAny);
+        if (vget_lane_u32(vreinterpret_u32_u8(vAny), 0)) {
+            for (k = i; k < i + 16; k++) {
+                if (pData[k] == 0 && pData[k + 1] == 0) {
+                    return k;
+                }
+            }
+        }
+    }
+    return NalScan_FindZeroPairTail(pData, nSize, i);
+}
+#elif defined(NALSCAN_HAVE_SSE2)
+static OMX_U32 NalScan_FindZeroPairSimd(const OMX_U8 *pData, OMX_U32 nSize)
+{
+    OMX_U32 i = 0;
+    const __m128i vZero = _mm_setzero_si128();
+
+    for (; i + 16 < nSize; i += 16) {
+        __m128i vData = _mm_loadu_si128((const __m128i *)(pData + i));
+        unsigned int nZero = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(vData, vZero));
+        /* bit k set when bytes k and k + 1 are both zero */
+        unsigned int nPair = nZero & ((nZero >> 1) | (pData[i + 16] == 0 ? 0x8000 : 0));
+
+        if (nPair) {
+            return i + __builtin_ctz(nPair);
+        }
+    }
+    return NalScan_FindZeroPairTail(pData, nSize, i);
+}
+#endif
+
+#ifdef NALSCAN_HAVE_NEON
+/* the library may be built for NEON and still run on a core without it */
+static OMX_BOOL NalScan_CpuHasNeon(void)
+{
+    unsigned long aux[2];
+    OMX_BOOL bNeon = OMX_FALSE;
+    int fd = open("/proc/self/auxv", O_RDONLY);
+
+    if (fd < 0) {
+        return OMX_FALSE;
+    }
+    while (read(fd, aux, sizeof(aux)) == sizeof(aux)) {
+        if (aux[0] == AT_NULL) {
+            break;
+        }
+        if (aux[0] == AT_HWCAP) {
+            bNeon = (aux[1] & HWCAP_NEON) ? OMX_TRUE : OMX_FALSE;
+            break;
+        }
+    }
+    close(fd);
+    return bNeon;
+}
+#endif
+
+static void NalScan_Select(OMX_TI_NALSCAN_IMPLTYPE eImpl)
+{
+    if (eImpl == OMX_TI_NalScanAuto || eImpl > OMX_TI_NalScanSimd ||
+        (eImpl == OMX_TI_NalScanSimd && eNalScanAutoImpl != OMX_TI_NalScanSimd)) {
+        eImpl = eNalScanAutoImpl;
+    }
+    if (eImpl == OMX_TI_NalScanScalar) {
+        pNalScanFindZeroPair = NULL;
+    }
+#if defined(NALSCAN_HAVE_NEON) || defined(NALSCAN_HAVE_SSE2)
+    else if (eImpl == OMX_TI_NalScanSimd) {
+        pNalScanFindZeroPair = NalScan_FindZeroPairSimd;
+    }
+#endif
+    else {
+        pNalScanFindZeroPair = NalScan_FindZeroPairWord;
+    }
+    eNalScanImpl = eImpl;
+}
+
+static void NalScan_Init(void)
+{
+    eNalScanAutoImpl = OMX_TI_NalScanWord;
+#if defined(NALSCAN_HAVE_NEON)
+    if (NalScan_CpuHasNeon()) {
+        eNalScanAutoImpl = OMX_TI_NalScanSimd;
+    }
+#elif defined(NALSCAN_HAVE_SSE2)
+    eNalScanAutoImpl = OMX_TI_NalScanSimd;
+#endif
+    NalScan_Select(OMX_TI_NalScanAuto);
+}
+
+static NALSCAN_FINDFN NalScan_GetFind(void)
+{
+    pthread_once(&nalScanOnce, NalScan_Init);
+    return pNalScanFindZeroPair;
+}
+
+OMX_TI_NALSCAN_IMPLTYPE OMX_TI_NalScanSetImpl(OMX_TI_NALSCAN_IMPLTYPE eImpl)
+{
+    pthread_once(&nalScanOnce, NalScan_Init);
+    NalScan_Select(eImpl);
+    return eNalScanImpl;
+}
+
+/* ======================================================================= */
+/*  Byte by byte reference                                                 */
+/* ======================================================================= */
+static OMX_U32 NalScan_FindStartCodeScalar(const OMX_U8 *pData, OMX_U32 nSize)
+{
+    OMX_U32 i = 0;
+
+    for (i = 0; i + 2 < nSize; i++) {
+        if (pData[i] == 0 && pData[i + 1] == 0 && pData[i + 2] == 1) {
+            return i;
+        }
+    }
+    return nSize;
+}
+
+static OMX_U32 NalScan_FindEmulationPreventionScalar(const OMX_U8 *pData, OMX_U32 nSize)
+{
+    OMX_U32 i = 0;
+    OMX_U32 nZeros = 0;
+
+    for (i = 0; i < nSize; i++) {
+        if (nZeros >= 2 && pData[i] == 0x03) {
+            return i;
+        }
+        nZeros = pData[i] ? 0 : nZeros + 1;
+    }
+    return nSize;
+}
+
+static OMX_U32 NalScan_RemoveEmulationPreventionScalar(OMX_U8 *pDst, const OMX_U8 *pSrc,
+                                                       OMX_U32 nSize)
+{
+    OMX_U32 i = 0;
+    OMX_U32 j = 0;
+    OMX_U32 nZeros = 0;
+
+    for (i = 0; i < nSize; i++) {
+        if (nZeros >= 2 && pSrc[i] == 0x03) {
+            nZeros = 0;
+            continue;
+        }
+        nZeros = pSrc[i] ? 0 : nZeros + 1;
+        pDst[j++] = pSrc[i];
+    }
+    return j;
+}
+
+/* ======================================================================= */
+/*  Public kernels                                                         */
+/* ======================================================================= */
+OMX_U32 OMX_TI_NalFindStartCode(const OMX_U8 *pData, OMX_U32 nSize)
+{
+    NALSCAN_FINDFN pFind = NalScan_GetFind();
+    OMX_U32 i = 0;
+
+    if (pFind == NULL) {
+        return NalScan_FindStartCodeScalar(pData, nSize);
+    }
+    while (i + 2 < nSize) {
+        i += pFind(pData + i, nSize - i);
+        if (i + 2 >= nSize) {
+            break;
+        }
+        if (pData[i + 2] == 0x01) {
+            return i;
+        }
+        i++;
+    }
+    return nSize;
+}
+
+OMX_U32 OMX_TI_NalCountStartCodes(const OMX_U8 *pData, OMX_U32 nSize)
+{
+    OMX_U32 nCount = 0;
+    OMX_U32 i = 0;
+
+    while (i < nSize) {
+        i += OMX_TI_NalFindStartCode(pData + i, nSize - i);
+        if (i >= nSize) {
+            break;
+        }
+        nCount++;
+        i += 3;
+    }
+    return nCount;
+}
+
+OMX_U32 OMX_TI_NalFindEmulationPrevention(const OMX_U8 *pData, OMX_U32 nSize)
+{
+    NALSCAN_FINDFN pFind = NalScan_GetFind();
+    OMX_U32 i = 0;
+
+    if (pFind == NULL) {
+        return NalScan_FindEmulationPreventionScalar(pData, nSize);
+    }
+    while (i + 2 < nSize) {
+        i += pFind(pData + i, nSize - i);
+        if (i + 2 >= nSize) {
+            break;
+        }
+        if (pData[i + 2] == 0x03) {
+            return i + 2;
+        }
+        i++;
+    }
+    return nSize;
+}
+
+OMX_U32 OMX_TI_NalRemoveEmulationPrevention(OMX_U8 *pDst, const OMX_U8 *pSrc,
+                                            OMX_U32 nSize)
+{
+    NALSCAN_FINDFN pFind = NalScan_GetFind();
+    OMX_U32 i = 0;
+    OMX_U32 nOut = 0;
+    OMX_U32 nCopyFrom = 0;
+
+    if (pFind == NULL) {
+        return NalScan_RemoveEmulationPreventionScalar(pDst, pSrc, nSize);
+    }
+    while (i + 2 < nSize) {
+        i += pFind(pSrc + i, nSize - i);
+        if (i + 2 >= nSize) {
+            break;
+        }
+        if (pSrc[i + 2] == 0x03) {
+            /* copy up to the 0x03 and drop it; the zero run restarts after it */
+            memmove(pDst + nOut, pSrc + nCopyFrom, i + 2 - nCopyFrom);
+            nOut += i + 2 - nCopyFrom;
+            nCopyFrom = i + 3;
+            i += 3;
+        }
+        else {
+            i++;
+        }
+    }
+    memmove(pDst + nOut, pSrc + nCopyFrom, nSize - nCopyFrom);
+    return nOut + nSize - nCopyFrom;
+}
+
+static OMX_U32 NalScan_ReadLength(const OMX_U8 *pData, OMX_U32 nLengthSize,
+                                  OMX_BOOL bBigEndian)
+{
+    OMX_U32 nLength = 0;
+    OMX_U32 i = 0;
+
+    for (i = 0; i < nLengthSize; i++) {
+        if (bBigEndian) {
+            nLength = (nLength << 8) | pData[i];
+        }
+        else {
+            nLength |= (OMX_U32)pData[i] << (8 * i);
+        }
+    }
+    return nLength;
+}
+
+void OMX_TI_NalIterInit(OMX_TI_NALITERTYPE *pIter, const OMX_U8 *pData,
+                        OMX_U32 nSize, OMX_U32 nLengthSize, OMX_BOOL bBigEndian)
+{
+    pIter->pData = pData;
+    pIter->nSize = nSize;
+    pIter->nLengthSize = nLengthSize;
+    pIter->bBigEndian = bBigEndian;
+    pIter->nPos = 0;
+    if (nLengthSize == 0) {
+        /* data before the first start code is not a NAL unit */
+        pIter->nPos = OMX_TI_NalFindStartCode(pData, nSize);
+        if (pIter->nPos < nSize) {
+            pIter->nPos += 3;
+        }
+    }
+    else if (nLengthSize != 1 && nLengthSize != 2 && nLengthSize != 4) {
+        pIter->nPos = nSize;
+    }
+}
+
+OMX_BOOL OMX_TI_NalIterNext(OMX_TI_NALITERTYPE *pIter, const OMX_U8 **ppNal,
+                            OMX_U32 *pnSize, OMX_U32 *pnType)
+{
+    const OMX_U8 *pData = pIter->pData;
+    OMX_U32 nSize = pIter->nSize;
+    OMX_U32 nIn = 0;
+    OMX_U32 nEnd = 0;
+    OMX_U32 nLength = 0;
+
+    while (pIter->nPos < nSize) {
+        nIn = pIter->nPos;
+        if (pIter->nLengthSize == 0) {
+            nEnd = nIn + OMX_TI_NalFindStartCode(pData + nIn, nSize - nIn);
+            pIter->nPos = (nEnd < nSize) ? nEnd + 3 : nSize;
+            /* trailing_zero_8bits and the first zero of a 4 byte start code */
+            for (; nEnd > nIn && pData[nEnd - 1] == 0; nEnd--) {
+            }
+            nLength = nEnd - nIn;
+        }
+        else {
+            if (pIter->nLengthSize > nSize - nIn) {
+                break;
+            }
+            nLength = NalScan_ReadLength(pData + nIn, pIter->nLengthSize,
+                                         pIter->bBigEndian);
+            nIn += pIter->nLengthSize;
+            if (nLength > nSize - nIn) {
+                break;
+            }
+            pIter->nPos = nIn + nLength;
+        }
+        if (nLength == 0) {
+            continue;
+        }
+        *ppNal = pData + nIn;
+        *pnSize = nLength;
+        *pnType = pData[nIn] & 0x1F;
+        return OMX_TRUE;
+    }
+    pIter->nPos = nSize;
+    return OMX_FALSE;
+}
+
+OMX_BOOL OMX_TI_NalPackLengthPrefixed(OMX_U8 *pData, OMX_U32 *pnSize,
+                                      OMX_U32 nLengthSize, OMX_BOOL bBigEndian,
+                                      OMX_U32 *pSizes, OMX_U32 nMaxCount,
+                                      OMX_U32 *pnCount)
+{
+    OMX_U32 nSize = *pnSize;
+    OMX_U32 nReadPos = 0;
+    OMX_U32 nWritePos = 0;
+    OMX_U32 nCount = 0;
+    OMX_U32 nNalSize = 0;
+
+    *pnCount = 0;
+    if (nLengthSize != 1 && nLengthSize != 2 && nLengthSize != 4) {
+        return OMX_FALSE;
+    }
+    while (nSize - nReadPos > nLengthSize) {
+        if (nLengthSize == 4 && bBigEndian) {
+            /* the framing of MP4 and Matroska demuxers */
+            nNalSize = (OMX_U32)pData[nReadPos] << 24 | (OMX_U32)pData[nReadPos + 1] << 16 |
+                       (OMX_U32)pData[nReadPos + 2] << 8 | pData[nReadPos + 3];
+        }
+        else {
+            nNalSize = NalScan_ReadLength(pData + nReadPos, nLengthSize, bBigEndian);
+        }
+        nReadPos += nLengthSize;
+        if (nNalSize > nSize - nReadPos || nCount == nMaxCount) {
+            return OMX_FALSE;
+        }
+        memmove(pData + nWritePos, pData + nReadPos, nNalSize);
+        pSizes[nCount++] = nNalSize;
+        nWritePos += nNalSize;
+        nReadPos += nNalSize;
+    }
+    *pnCount = nCount;
+    *pnSize = nWritePos;
+    return OMX_TRUE;
+}
+
+OMX_BOOL OMX_TI_NalPrependConfig(OMX_U8 *pData, OMX_U32 *pnSize, OMX_U32 nCapacity,
+                                 const OMX_U8 *pConfig, OMX_U32 nConfigSize)
+{
+    if (nConfigSize > nCapacity || *pnSize > nCapacity - nConfigSize) {
+        return OMX_FALSE;
+    }
+    /* source and destination overlap whenever the config is shorter than
+       the data */
+    memmove(pData + nConfigSize, pData, *pnSize);
+    memcpy(pData, pConfig, nConfigSize);
+    *pnSize += nConfigSize;
+    return OMX_TRUE;
+}
+
+OMX_U32 OMX_TI_AvcMaxDpbFrames(OMX_U32 nLevelIdc, OMX_U32 nWidthMbs,
+                               OMX_U32 nHeightMbs)
+{
+    /* level_idc, MaxDpbMbs */
+    static const OMX_U32 nMaxDpbMbs[][2] = {
+        { 9, 396 }, { 10, 396 }, { 11, 900 }, { 12, 2376 }, { 13, 2376 },
+        { 20, 2376 }, { 21, 4752 }, { 22, 8100 }, { 30, 8100 },
+        { 31, 18000 }, { 32, 20480 }, { 40, 32768 }, { 41, 32768 },
+        { 42, 34816 }, { 50, 110400 }, { 51, 184320 }
+    };
+    OMX_U32 nFrames = 0;
+    OMX_U32 i = 0;
+
+    if (nWidthMbs == 0 || nHeightMbs == 0) {
+        return 0;
+    }
+    for (i = 0; i < sizeof(nMaxDpbMbs) / sizeof(nMaxDpbMbs[0]); i++) {
+        if (nMaxDpbMbs[i][0] == nLevelIdc) {
+            nFrames = nMaxDpbMbs[i][1] / (nWidthMbs * nHeightMbs);
+            return nFrames > 16 ? 16 : nFrames;
+        }
+    }
+    return 0;
+}
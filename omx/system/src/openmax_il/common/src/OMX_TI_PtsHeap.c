@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/**
+* @file OMX_TI_PtsHeap.c
+*
+* Presentation timestamp min-heap, see OMX_TI_PtsHeap.h.
+*
+* The usual array layout: the children of entry i are 2i + 1 and 2i + 2,
+* and no entry is earlier than its parent.
+*/
+/* ------------------------------------------------------------------------- */
+
+#include "OMX_TI_PtsHeap.h"
+
+/* Moves nPts from the hole at nPos towards the root to its place. */
+static void PtsHeapSiftUp(OMX_TICKS *pEntries, OMX_U32 nPos, OMX_TICKS nPts)
+{
+    while (nPos > 0 && pEntries[(nPos - 1) >> 1] > nPts) {
+        pEntries[nPos] = pEntries[(nPos - 1) >> 1];
+        nPos = (nPos - 1) >> 1;
+    }
+    pEntries[nPos] = nPts;
+}
+
+/* Moves nPts from the hole at nPos towards the leaves of the nCount
+   entries to its place. */
+static void PtsHeapSiftDown(OMX_TICKS *pEntries, OMX_U32 nCount, OMX_U32 nPos, OMX_TICKS nPts)
+{
+    OMX_U32 nChild = 0;
+
+    while ((nChild = (nPos << 1) + 1) < nCount) {
+        if (nChild + 1 < nCount && pEntries[nChild + 1] < pEntries[nChild]) {
+            nChild++;
+        }
+        if (pEntries[nChild] >= nPts) {
+            break;
+        }
+        pEntries[nPos] = pEntries[nChild];
+        nPos = nChild;
+    }
+    pEntries[nPos] = nPts;
+}
+
+void OMX_TI_PtsHeapInit(OMX_TI_PTSHEAPTYPE *pHeap, OMX_TICKS *pEntries, OMX_U32 nSize)
+{
+    pHeap->pEntries = pEntries;
+    pHeap->nSize = nSize;
+    pHeap->nCount = 0;
+}
+
+void OMX_TI_PtsHeapClear(OMX_TI_PTSHEAPTYPE *pHeap)
+{
+    pHeap->nCount = 0;
+}
+
+OMX_BOOL OMX_TI_PtsHeapPush(OMX_TI_PTSHEAPTYPE *pHeap, OMX_TICKS nPts)
+{
+    if (pHeap->nCount >= pHeap->nSize) {
+        return OMX_FALSE;
+    }
+    PtsHeapSiftUp(pHeap->pEntries, pHeap->nCount++, nPts);
+    return OMX_TRUE;
+}
+
+OMX_BOOL OMX_TI_PtsHeapPop(OMX_TI_PTSHEAPTYPE *pHeap, OMX_TICKS *pnPts)
+{
+    if (pHeap->nCount == 0) {
+        return OMX_FALSE;
+    }
+    *pnPts = pHeap->pEntries[0];
+    pHeap->nCount--;
+    PtsHeapSiftDown(pHeap->pEntries, pHeap->nCount, 0, pHeap->pEntries[pHeap->nCount]);
+    return OMX_TRUE;
+}
+
+OMX_BOOL OMX_TI_PtsHeapRemove(OMX_TI_PTSHEAPTYPE *pHeap, OMX_TICKS nPts)
+{
+    OMX_TICKS *pEntries = pHeap->pEntries;
+    OMX_TICKS nLast;
+    OMX_U32 nPos = 0;
+
+    while (nPos < pHeap->nCount && pEntries[nPos] != nPts) {
+        nPos++;
+    }
+    if (nPos == pHeap->nCount) {
+        return OMX_FALSE;
+    }
+    /* the last entry fills the hole, and goes up or down from there */
+    nLast = pEntries[--pHeap->nCount];
+    if (nPos < pHeap->nCount) {
+        if (nPos > 0 && pEntries[(nPos - 1) >> 1] > nLast) {
+            PtsHeapSiftUp(pEntries, nPos, nLast);
+        }
+        else {
+            PtsHeapSiftDown(pEntries, pHeap->nCount, nPos, nLast);
+        }
+    }
+    return OMX_TRUE;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/**
+* @file OMX_TI_SeqHeader.c
+*
+* MPEG-2 / VC-1 sequence header parsers, see OMX_TI_SeqHeader.h.
+*
+* Both walk the start codes to the sequence header and read the size right
+* after it; nothing else in the header is used.
+*/
+/* ------------------------------------------------------------------------- */
+
+#include "OMX_TI_SeqHeader.h"
+#include "OMX_TI_NalScan.h"
+#include "OMX_TI_BitReader.h"
+
+#define MPEG2_SEQUENCE_HEADER_CODE  0xB3
+#define VC1_SEQUENCE_HEADER_CODE    0x0F
+#define VC1_ENTRY_POINT_CODE        0x0E
+
+/* Finds the next 00 00 01 xx at or after byte *pnPos, returns the xx byte
+   in *pnCode and leaves *pnPos on the byte after it. OMX_FALSE when there
+   is no complete start code left. */
+static OMX_BOOL SeqHeaderNextStartCode(const OMX_U8 *pData, OMX_U32 nSize,
+                                       OMX_U32 *pnPos, OMX_U32 *pnCode)
+{
+    OMX_U32 nOffset = 0;
+
+    if (nSize < 4 || *pnPos >= nSize - 3) {
+        return OMX_FALSE;
+    }
+    nOffset = OMX_TI_NalFindStartCode(pData + *pnPos, nSize - 1 - *pnPos);
+    if (nOffset >= nSize - 1 - *pnPos) {
+        return OMX_FALSE;
+    }
+    *pnPos += nOffset + 3;
+    *pnCode = pData[(*pnPos)++];
+    return OMX_TRUE;
+}
+
+OMX_ERRORTYPE OMX_TI_Mpeg2ParseSeqHeader(const OMX_U8 *pData, OMX_U32 nSize,
+                                         OMX_U32 *pnWidth, OMX_U32 *pnHeight)
+{
+    OMX_TI_BITREADERTYPE sBits;
+    OMX_U32 nPos = 0;
+    OMX_U32 nCode = 0;
+
+    do {
+        if (!SeqHeaderNextStartCode(pData, nSize, &nPos, &nCode)) {
+            return OMX_ErrorStreamCorrupt;
+        }
+    } while (nCode != MPEG2_SEQUENCE_HEADER_CODE);
+
+    OMX_TI_BitsInit(&sBits, pData + nPos, nSize - nPos);
+    *pnWidth = OMX_TI_BitsRead(&sBits, 12);
+    *pnHeight = OMX_TI_BitsRead(&sBits, 12);
+    return OMX_TI_BitsOverrun(&sBits) ? OMX_ErrorStreamCorrupt : OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE OMX_TI_Vc1ParseSeqHeader(const OMX_U8 *pData, OMX_U32 nSize,
+                                       OMX_U32 *pnWidth, OMX_U32 *pnHeight)
+{
+    OMX_TI_BITREADERTYPE sBits;
+    OMX_U32 nPos = 0;
+    OMX_U32 nCode = 0;
+
+    do {
+        if (!SeqHeaderNextStartCode(pData, nSize, &nPos, &nCode)) {
+            return OMX_ErrorStreamCorrupt;
+        }
+    } while (nCode != VC1_SEQUENCE_HEADER_CODE && nCode != VC1_ENTRY_POINT_CODE);
+
+    OMX_TI_BitsInit(&sBits, pData + nPos, nSize - nPos);
+    /* profile u(2), level u(3), colordiff_format u(2), frmrtq_postproc u(3),
+       bitrtq_postproc u(5), postprocflag u(1) */
+    OMX_TI_BitsSkip(&sBits, 16);
+    *pnWidth = OMX_TI_BitsRead(&sBits, 12) * 2 + 2;
+    *pnHeight = OMX_TI_BitsRead(&sBits, 12) * 2 + 2;
+    return OMX_TI_BitsOverrun(&sBits) ? OMX_ErrorStreamCorrupt : OMX_ErrorNone;
+}
@@ -0,0 +1,1528 @@
+/*
+ * Copyright (C) Texas Instruments - http://www.ti.com/
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+/* =============================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+*  (c) Copyright Texas Instruments, Incorporated.  All Rights Reserved.
+*
+*  Use of this software is controlled by the terms and conditions found
+*  in the license agreement under which this software has been supplied.
+* =========================================================================== */
+/**
+* @file common_unittest.c
+*
+* Unit tests and microbenchmarks for the shared helpers in common/inc and
+* common/src: the bit reader and the NAL scan kernels, each
+* checked against a byte or bit at a time reference and then timed, the
+* packing of length prefixed NAL units for the DSP and the assembly of
+* config data split over buffers, the
+* MPEG-4 / H.263, MPEG-2 and VC-1 header parsers over generated header
+* corpora, the H.264 SPS / VUI parser over a set of SPS + PPS config
+* buffers and the recovery point lookup over generated SEI units, the config parser result cache keys, the decoder's timestamp
+* heap, thumbnail downscaling and error map summaries, and the component thread ring with
+* several producers.
+* Usage: COMMON_test [seed] [iterations]
+*
+* ============================================================================ */
+#ifdef __COMMON_UNIT_TEST__
+
+    #include "OMX_TI_BitReader.h"
+    #include "OMX_TI_NalScan.h"
+    #include "OMX_TI_M4vHeader.h"
+    #include "OMX_TI_AvcHeader.h"
+    #include "OMX_TI_SeqHeader.h"
+    #include "OMX_TI_Ring.h"
+    #include "OMX_TI_ConfigCache.h"
+    #include "OMX_TI_PtsHeap.h"
+    #include "OMX_TI_Downscale.h"
+    #include "OMX_TI_MBErrorMap.h"
+    #include <assert.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <string.h>
+    #include <time.h>
+
+#define TEST_BUFFER_SIZE (64 * 1024)
+#define TEST_FIELDS      (16 * 1024)
+#define TEST_NAL_SIZE    1024
+#define TEST_HEADERS     256
+#define TEST_HEADER_SIZE 64
+#define TEST_AVC_CONFIG_SIZE 128
+#define TEST_NAL_UNITS   32
+#define TEST_PTS_QUEUE   32
+#define TEST_FRAME_SIZE  160
+#define TEST_SEI_SIZE    2048
+#define TEST_MAP_MBS     48
+#define TEST_RING_CELLS  16
+#define TEST_PRODUCERS   4
+
+static const OMX_TI_NALSCAN_IMPLTYPE eNalScanImpls[] = {
+    OMX_TI_NalScanScalar, OMX_TI_NalScanWord, OMX_TI_NalScanSimd
+};
+static const char *cNalScanImplNames[] = { "auto", "scalar", "word", "simd" };
+
+static unsigned long nSeed = 1;
+static unsigned long nIterations = 200;
+
+/* xorshift32, reproducible from the seed on every platform */
+static OMX_U32 test_rand()
+{
+    static OMX_U32 x = 0;
+
+    if (!x) {
+        x = (OMX_U32)nSeed ? (OMX_U32)nSeed : 1;
+    }
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static double test_now_us()
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000.0 + t.tv_nsec / 1000.0;
+}
+
+/* bit at a time reference for the OMX_TI_Bits* calls */
+typedef struct REF_BITS {
+    const OMX_U8 *pData;
+    OMX_U32 nSizeBits;
+    OMX_U32 nPos;
+    OMX_BOOL bOverrun;
+} REF_BITS;
+
+static OMX_U32 ref_read(REF_BITS *pRef, OMX_U32 nBits)
+{
+    OMX_U32 nValue = 0;
+    OMX_U32 i;
+
+    if (pRef->nSizeBits - pRef->nPos < nBits) {
+        pRef->nPos = pRef->nSizeBits;
+        pRef->bOverrun = OMX_TRUE;
+        return 0;
+    }
+    for (i = 0; i < nBits; i++, pRef->nPos++) {
+        nValue = (nValue << 1) |
+                 ((pRef->pData[pRef->nPos >> 3] >> (7 - (pRef->nPos & 7))) & 1);
+    }
+    return nValue;
+}
+
+static OMX_U32 ref_ue(REF_BITS *pRef)
+{
+    OMX_U32 nZeros = 0;
+    OMX_U32 nStart = pRef->nPos;
+
+    while (pRef->nPos < pRef->nSizeBits && nZeros < 32 && ref_read(pRef, 1) == 0) {
+        nZeros++;
+    }
+    if (nZeros == 32 || pRef->nSizeBits - nStart < (nZeros << 1) + 1) {
+        /* no valid code: a 32 bit zero run is left unread, a truncated
+           code is consumed to the end */
+        pRef->nPos = nZeros == 32 ? nStart : pRef->nSizeBits;
+        pRef->bOverrun = OMX_TRUE;
+        return 0;
+    }
+    return ((1u << nZeros) | ref_read(pRef, nZeros)) - 1;
+}
+
+/* Field list: a width of 1..32 for a fixed length read, 0 for ue(v). */
+static void make_fields(OMX_U8 *pFields, OMX_U32 nCount)
+{
+    OMX_U32 i;
+
+    for (i = 0; i < nCount; i++) {
+        pFields[i] = (OMX_U8)(test_rand() % 33);
+    }
+}
+
+/* OMX_TI_Bits* against the reference, down to the end of a buffer whose
+   size and start are random. */
+void bitreader_unit_test(const OMX_U8 *pData, const OMX_U8 *pFields)
+{
+    OMX_TI_BITREADERTYPE sBits;
+    REF_BITS sRef;
+    OMX_U32 nSize, nValue, nRefValue, i, n;
+
+    for (n = 0; n < nIterations; n++) {
+        nSize = 1 + test_rand() % 256;
+        OMX_TI_BitsInit(&sBits, pData + (test_rand() % 64), nSize);
+        sRef.pData = sBits.pData;
+        sRef.nSizeBits = nSize << 3;
+        sRef.nPos = 0;
+        sRef.bOverrun = OMX_FALSE;
+
+        for (i = 0; !sRef.bOverrun; i = (i + 1) % TEST_FIELDS) {
+            if (pFields[i]) {
+                nValue = OMX_TI_BitsRead(&sBits, pFields[i]);
+                nRefValue = ref_read(&sRef, pFields[i]);
+            }
+            else {
+                nValue = OMX_TI_BitsUe(&sBits);
+                nRefValue = ref_ue(&sRef);
+            }
+            assert(OMX_TI_BitsOverrun(&sBits) == sRef.bOverrun);
+            if (!sRef.bOverrun) {
+                assert(nValue == nRefValue);
+                assert(OMX_TI_BitsPos(&sBits) == sRef.nPos);
+            }
+            if ((i & 7) == 7 && !sRef.bOverrun) {
+                OMX_TI_BitsByteAlign(&sBits);
+                sRef.nPos = (sRef.nPos + 7) & ~7u;
+                assert(OMX_TI_BitsPos(&sBits) == sRef.nPos);
+            }
+        }
+    }
+}
+
+/* Time to read the same field list with the cached reader and with the
+   reference. */
+void bitreader_perf_test(const OMX_U8 *pData, const OMX_U8 *pFields)
+{
+    OMX_TI_BITREADERTYPE sBits;
+    REF_BITS sRef;
+    OMX_U32 nSum = 0, nRefSum = 0, nReads = 0, i, n;
+    double t1, t2, t3;
+
+    t1 = test_now_us();
+    for (n = 0; n < nIterations; n++) {
+        OMX_TI_BitsInit(&sBits, pData, TEST_BUFFER_SIZE);
+        for (i = 0; !OMX_TI_BitsOverrun(&sBits); i = (i + 1) % TEST_FIELDS) {
+            nSum += pFields[i] ? OMX_TI_BitsRead(&sBits, pFields[i]) : OMX_TI_BitsUe(&sBits);
+            nReads++;
+        }
+    }
+    t2 = test_now_us();
+    for (n = 0; n < nIterations; n++) {
+        sRef.pData = pData;
+        sRef.nSizeBits = TEST_BUFFER_SIZE << 3;
+        sRef.nPos = 0;
+        sRef.bOverrun = OMX_FALSE;
+        for (i = 0; !sRef.bOverrun; i = (i + 1) % TEST_FIELDS) {
+            nRefSum += pFields[i] ? ref_read(&sRef, pFields[i]) : ref_ue(&sRef);
+        }
+    }
+    t3 = test_now_us();
+
+    assert(nSum == nRefSum);
+    printf("bit reader: %.2f ns/field cached, %.2f ns/field bit by bit\n",
+           (t2 - t1) * 1000.0 / nReads, (t3 - t2) * 1000.0 / nReads);
+}
+
+/* Random payload with few zero bytes, then start codes and 00 00 03
+   sequences written at offsets that straddle 4, 8 and 16 byte boundaries
+   of the buffer, and at random offsets. */
+static void make_nal_buffer(OMX_U8 *pData, OMX_U32 nSize)
+{
+    static const OMX_U8 aPattern[][4] = {
+        { 0, 0, 1, 0 }, { 0, 0, 0, 1 }, { 0, 0, 3, 0 }, { 0, 0, 3, 1 }, { 0, 0, 0, 0 }
+    };
+    OMX_U32 nInserts = test_rand() % 16;
+    OMX_U32 i, nPos;
+
+    for (i = 0; i < nSize; i++) {
+        pData[i] = (OMX_U8)(test_rand() % 8 ? test_rand() | 1 : test_rand() % 4);
+    }
+    for (i = 0; i < nInserts && nSize > 4; i++) {
+        nPos = test_rand() % (nSize - 3);
+        if (test_rand() & 1) {
+            /* one to three bytes before a 4, 8 or 16 byte boundary */
+            nPos = (nPos | ((4u << (test_rand() % 3)) - 1)) - test_rand() % 3;
+            if (nPos + 4 > nSize) {
+                continue;
+            }
+        }
+        memcpy(pData + nPos, aPattern[test_rand() % 5], 4);
+    }
+}
+
+/* Word and SIMD kernels against the scalar reference on random buffers,
+   at every alignment of the data. */
+void nalscan_unit_test()
+{
+    OMX_U8 aBuffer[TEST_NAL_SIZE + 16];
+    OMX_U8 aRbsp[TEST_NAL_SIZE];
+    OMX_U8 aRefRbsp[TEST_NAL_SIZE];
+    OMX_U8 *pData;
+    OMX_U32 nSize, nOffset, nFind, nCount, nEp, nRbsp;
+    OMX_U32 nRefFind, nRefCount, nRefEp, nRefRbsp, nPos, nNext, nRefNext, i, n;
+
+    for (i = 1; i < sizeof(eNalScanImpls) / sizeof(eNalScanImpls[0]); i++) {
+        printf("nal scan: %s checked against scalar\n",
+               cNalScanImplNames[OMX_TI_NalScanSetImpl(eNalScanImpls[i])]);
+    }
+
+    for (n = 0; n < nIterations * 50; n++) {
+        nOffset = n % 16;
+        nSize = test_rand() % (TEST_NAL_SIZE + 1);
+        pData = aBuffer + nOffset;
+        make_nal_buffer(pData, nSize);
+
+        OMX_TI_NalScanSetImpl(OMX_TI_NalScanScalar);
+        nRefFind = OMX_TI_NalFindStartCode(pData, nSize);
+        nRefCount = OMX_TI_NalCountStartCodes(pData, nSize);
+        nRefEp = OMX_TI_NalFindEmulationPrevention(pData, nSize);
+        nRefRbsp = OMX_TI_NalRemoveEmulationPrevention(aRefRbsp, pData, nSize);
+
+        for (i = 1; i < sizeof(eNalScanImpls) / sizeof(eNalScanImpls[0]); i++) {
+            OMX_TI_NalScanSetImpl(eNalScanImpls[i]);
+            nFind = OMX_TI_NalFindStartCode(pData, nSize);
+            nCount = OMX_TI_NalCountStartCodes(pData, nSize);
+            nEp = OMX_TI_NalFindEmulationPrevention(pData, nSize);
+            nRbsp = OMX_TI_NalRemoveEmulationPrevention(aRbsp, pData, nSize);
+            assert(nFind == nRefFind);
+            assert(nCount == nRefCount);
+            assert(nEp == nRefEp);
+            assert(nRbsp == nRefRbsp && !memcmp(aRbsp, aRefRbsp, nRbsp));
+
+            /* every start code, from every position the decoder resumes at */
+            for (nPos = 0; nPos < nSize; nPos += nNext + 3) {
+                OMX_TI_NalScanSetImpl(OMX_TI_NalScanScalar);
+                nRefNext = OMX_TI_NalFindStartCode(pData + nPos, nSize - nPos);
+                OMX_TI_NalScanSetImpl(eNalScanImpls[i]);
+                nNext = OMX_TI_NalFindStartCode(pData + nPos, nSize - nPos);
+                assert(nNext == nRefNext);
+            }
+        }
+    }
+    OMX_TI_NalScanSetImpl(OMX_TI_NalScanAuto);
+}
+
+/* Writes nSize as an nLengthSize byte length prefix at pData. */
+static void put_nal_length(OMX_U8 *pData, OMX_U32 nSize, OMX_U32 nLengthSize,
+                           OMX_BOOL bBigEndian)
+{
+    OMX_U32 i;
+
+    for (i = 0; i < nLengthSize; i++) {
+        pData[bBigEndian ? nLengthSize - 1 - i : i] = (OMX_U8)(nSize >> (8 * i));
+    }
+}
+
+/* Length prefixed frames of random NAL units, with every prefix size and
+   byte order and a few stray bytes after the last NAL unit, packed and
+   checked against the units they were made of; then the error cases:
+   a length past the end, one NAL unit more than the size table holds,
+   and an unsupported prefix size. */
+void nalpack_unit_test()
+{
+    static const OMX_U32 aLengthSizes[] = { 1, 2, 4 };
+    OMX_U8 aFrame[TEST_NAL_UNITS * (TEST_HEADER_SIZE + 4) + 4];
+    OMX_U8 aPacked[TEST_NAL_UNITS * TEST_HEADER_SIZE];
+    OMX_U32 aSizes[TEST_NAL_UNITS];
+    OMX_U32 aPackSizes[TEST_NAL_UNITS];
+    OMX_U32 nLengthSize, nUnits, nSize, nPacked, nCount, nTail, i, j, n;
+    OMX_BOOL bBigEndian;
+
+    for (n = 0; n < nIterations * 10; n++) {
+        nLengthSize = aLengthSizes[n % 3];
+        bBigEndian = (n / 3) & 1 ? OMX_TRUE : OMX_FALSE;
+        nUnits = test_rand() % (TEST_NAL_UNITS + 1);
+        nSize = 0;
+        nPacked = 0;
+        for (i = 0; i < nUnits; i++) {
+            /* at least the NAL header byte */
+            aSizes[i] = 1 + test_rand() % TEST_HEADER_SIZE;
+            put_nal_length(aFrame + nSize, aSizes[i], nLengthSize, bBigEndian);
+            nSize += nLengthSize;
+            for (j = 0; j < aSizes[i]; j++) {
+                aFrame[nSize++] = aPacked[nPacked++] = (OMX_U8)test_rand();
+            }
+        }
+        /* too short for another length prefix and a payload byte */
+        nTail = test_rand() % (nLengthSize + 1);
+        for (i = 0; i < nTail; i++) {
+            aFrame[nSize++] = (OMX_U8)test_rand();
+        }
+
+        assert(OMX_TI_NalPackLengthPrefixed(aFrame, &nSize, nLengthSize, bBigEndian,
+                                            aPackSizes, TEST_NAL_UNITS, &nCount));
+        assert(nCount == nUnits && nSize == nPacked);
+        assert(!memcmp(aPackSizes, aSizes, nUnits * sizeof(aSizes[0])));
+        assert(!memcmp(aFrame, aPacked, nPacked));
+    }
+
+    for (i = 0; i < sizeof(aLengthSizes) / sizeof(aLengthSizes[0]); i++) {
+        nLengthSize = aLengthSizes[i];
+
+        /* a length one byte past the end of the data */
+        put_nal_length(aFrame, 8, nLengthSize, OMX_TRUE);
+        nSize = nLengthSize + 7;
+        assert(!OMX_TI_NalPackLengthPrefixed(aFrame, &nSize, nLengthSize, OMX_TRUE,
+                                             aPackSizes, TEST_NAL_UNITS, &nCount));
+        assert(nCount == 0 && nSize == nLengthSize + 7);
+
+        /* the size table full, then one NAL unit over */
+        nSize = 0;
+        for (j = 0; j <= TEST_NAL_UNITS; j++) {
+            put_nal_length(aFrame + nSize, 1, nLengthSize, OMX_FALSE);
+            aFrame[nSize + nLengthSize] = (OMX_U8)j;
+            nSize += nLengthSize + 1;
+        }
+        nPacked = nSize - nLengthSize - 1;
+        assert(OMX_TI_NalPackLengthPrefixed(aFrame, &nPacked, nLengthSize, OMX_FALSE,
+                                            aPackSizes, TEST_NAL_UNITS, &nCount));
+        assert(nCount == TEST_NAL_UNITS && nPacked == TEST_NAL_UNITS);
+        assert(aFrame[TEST_NAL_UNITS - 1] == TEST_NAL_UNITS - 1);
+        nSize = 0;
+        for (j = 0; j <= TEST_NAL_UNITS; j++) {
+            put_nal_length(aFrame + nSize, 1, nLengthSize, OMX_FALSE);
+            aFrame[nSize + nLengthSize] = (OMX_U8)j;
+            nSize += nLengthSize + 1;
+        }
+        assert(!OMX_TI_NalPackLengthPrefixed(aFrame, &nSize, nLengthSize, OMX_FALSE,
+                                             aPackSizes, TEST_NAL_UNITS, &nCount));
+        assert(nCount == 0);
+    }
+    nSize = 16;
+    assert(!OMX_TI_NalPackLengthPrefixed(aFrame, &nSize, 3, OMX_TRUE,
+                                         aPackSizes, TEST_NAL_UNITS, &nCount));
+    assert(nCount == 0 && nSize == 16);
+}
+
+/* Config data put in front of a buffer's data, with every relation of the
+   two sizes (the data moving up over itself whenever the config is the
+   shorter one), up to an exact fit; one byte more is refused and leaves
+   the buffer as it was. */
+void nalprepend_unit_test()
+{
+    OMX_U8 aBuffer[TEST_NAL_SIZE];
+    OMX_U8 aExpect[TEST_NAL_SIZE];
+    OMX_U8 aConfig[TEST_NAL_SIZE];
+    OMX_U32 nCapacity, nConfig, nSize, nFilled, i, n;
+
+    for (n = 0; n < nIterations * 50; n++) {
+        nCapacity = test_rand() % (TEST_NAL_SIZE + 1);
+        nConfig = test_rand() % (nCapacity + 1);
+        nSize = n & 1 ? nCapacity - nConfig : test_rand() % (nCapacity - nConfig + 1);
+        for (i = 0; i < nCapacity; i++) {
+            aBuffer[i] = (OMX_U8)test_rand();
+        }
+        for (i = 0; i < nConfig; i++) {
+            aConfig[i] = (OMX_U8)test_rand();
+        }
+        memcpy(aExpect, aConfig, nConfig);
+        memcpy(aExpect + nConfig, aBuffer, nSize);
+
+        nFilled = nSize;
+        assert(OMX_TI_NalPrependConfig(aBuffer, &nFilled, nCapacity, aConfig, nConfig));
+        assert(nFilled == nConfig + nSize);
+        assert(!memcmp(aBuffer, aExpect, nFilled));
+
+        if (nCapacity > 0) {
+            /* one byte over, from the data or from the config */
+            memcpy(aExpect, aBuffer, nCapacity);
+            nFilled = nCapacity - nConfig + 1;
+            if (nConfig > 0 && (n & 2)) {
+                nFilled = nCapacity - nConfig;
+                nConfig++;
+            }
+            nSize = nFilled;
+            assert(!OMX_TI_NalPrependConfig(aBuffer, &nFilled, nCapacity, aConfig, nConfig));
+            assert(nFilled == nSize && !memcmp(aBuffer, aExpect, nCapacity));
+        }
+    }
+}
+
+/* Start code count over a 1 MB buffer with each kernel. */
+void nalscan_perf_test()
+{
+    OMX_U32 nSize = 1024 * 1024;
+    OMX_U8 *pData = malloc(nSize);
+    OMX_U32 nCount, nRefCount = 0, i, n;
+    double t1, t2;
+
+    assert(pData != NULL);
+    for (i = 0; i + TEST_NAL_SIZE <= nSize; i += TEST_NAL_SIZE) {
+        make_nal_buffer(pData + i, TEST_NAL_SIZE);
+    }
+    for (i = 0; i < sizeof(eNalScanImpls) / sizeof(eNalScanImpls[0]); i++) {
+        OMX_TI_NALSCAN_IMPLTYPE eImpl = OMX_TI_NalScanSetImpl(eNalScanImpls[i]);
+
+        nCount = 0;
+        t1 = test_now_us();
+        for (n = 0; n < nIterations / 10 + 1; n++) {
+            nCount += OMX_TI_NalCountStartCodes(pData, nSize);
+        }
+        t2 = test_now_us();
+        if (i == 0) {
+            nRefCount = nCount;
+        }
+        assert(nCount == nRefCount);
+        printf("nal scan: %s %.1f MB/s\n", cNalScanImplNames[eImpl],
+               (double)nSize * (nIterations / 10 + 1) / (t2 - t1));
+    }
+    OMX_TI_NalScanSetImpl(OMX_TI_NalScanAuto);
+    free(pData);
+}
+
+/* MSB first bit writer for the generated headers */
+typedef struct TEST_BITWRITER {
+    OMX_U8 *pData;
+    OMX_U32 nPos;
+} TEST_BITWRITER;
+
+static void put_bits(TEST_BITWRITER *pWriter, OMX_U32 nValue, OMX_U32 nBits)
+{
+    while (nBits--) {
+        if (!(pWriter->nPos & 7)) {
+            pWriter->pData[pWriter->nPos >> 3] = 0;
+        }
+        pWriter->pData[pWriter->nPos >> 3] |= ((nValue >> nBits) & 1) << (7 - (pWriter->nPos & 7));
+        pWriter->nPos++;
+    }
+}
+
+/* header corpus entry: the bytes and what OMX_TI_M4vParseHeader() has to
+   find in them */
+typedef struct TEST_M4VHEADER {
+    OMX_U8 aData[TEST_HEADER_SIZE];
+    OMX_U32 nSize;
+    OMX_TI_M4VHEADERTYPE sExpected;
+} TEST_M4VHEADER;
+
+/* An MPEG-4 VOL with random optional fields, behind a VOS, VO and user
+   data header some of the time, or an H.263 picture header in one of the
+   standard formats. */
+static void make_m4v_header(TEST_M4VHEADER *pHeader)
+{
+    static const OMX_U16 nH263Sizes[][2] = {
+        { 128, 96 }, { 176, 144 }, { 352, 288 }, { 704, 576 }, { 1408, 1152 }
+    };
+    OMX_TI_M4VHEADERTYPE *pExp = &pHeader->sExpected;
+    TEST_BITWRITER sWriter = { pHeader->aData, 0 };
+    OMX_U32 nRes, i;
+
+    memset(pExp, 0, sizeof(*pExp));
+    pExp->nProfileLevel = OMX_TI_M4V_PROFILELEVEL_NONE;
+
+    if (test_rand() % 4 == 0) {
+        i = test_rand() % 5;
+        pExp->bShortHeader = OMX_TRUE;
+        pExp->nWidth = nH263Sizes[i][0];
+        pExp->nHeight = nH263Sizes[i][1];
+        put_bits(&sWriter, 0x20, 22);                   /* PSC */
+        put_bits(&sWriter, test_rand() & 0xFF, 8);      /* TR */
+        put_bits(&sWriter, 2, 2);
+        put_bits(&sWriter, test_rand() & 7, 3);
+        put_bits(&sWriter, i + 1, 3);                   /* source format */
+        put_bits(&sWriter, test_rand(), 16);            /* rest of the picture */
+        pHeader->nSize = (sWriter.nPos + 7) >> 3;
+        return;
+    }
+
+    if (test_rand() & 1) {
+        pExp->nProfileLevel = test_rand() & 0xFF;
+        put_bits(&sWriter, 0x1B0, 32);
+        put_bits(&sWriter, pExp->nProfileLevel, 8);
+        put_bits(&sWriter, 0x1B5, 32);                  /* visual object */
+        put_bits(&sWriter, 0x09, 8);
+        put_bits(&sWriter, 0x100, 32);                  /* video object */
+        if (test_rand() & 1) {
+            put_bits(&sWriter, 0x1B2, 32);              /* user data */
+            for (i = test_rand() % 8; i > 0; i--) {
+                put_bits(&sWriter, 0x40 | (test_rand() & 0x3F), 8);
+            }
+        }
+    }
+    put_bits(&sWriter, 0x120 | (test_rand() & 0xF), 32);
+    put_bits(&sWriter, test_rand() & 1, 1);             /* random_accessible_vol */
+    pExp->nVideoObjectTypeIndication = test_rand() & 0xFF;
+    put_bits(&sWriter, pExp->nVideoObjectTypeIndication, 8);
+    if (test_rand() & 1) {
+        put_bits(&sWriter, 1, 1);
+        put_bits(&sWriter, test_rand() & 0x7F, 7);     /* verid, priority */
+    }
+    else {
+        put_bits(&sWriter, 0, 1);
+    }
+    pExp->nAspectRatioInfo = test_rand() % 3 ? 1 + test_rand() % 5 : 15;
+    put_bits(&sWriter, pExp->nAspectRatioInfo, 4);
+    if (pExp->nAspectRatioInfo == 15) {
+        pExp->nParWidth = 1 + test_rand() % 255;
+        pExp->nParHeight = 1 + test_rand() % 255;
+        put_bits(&sWriter, pExp->nParWidth, 8);
+        put_bits(&sWriter, pExp->nParHeight, 8);
+    }
+    if (test_rand() & 1) {                              /* vol_control_parameters */
+        put_bits(&sWriter, 1, 1);
+        put_bits(&sWriter, 1, 2);                       /* 4:2:0 */
+        put_bits(&sWriter, test_rand() & 1, 1);
+        if (test_rand() & 1) {                          /* vbv_parameters */
+            static const OMX_U8 nVbvFields[] = { 15, 15, 15, 14, 15 };
+
+            put_bits(&sWriter, 1, 1);
+            for (i = 0; i < sizeof(nVbvFields); i++) {
+                put_bits(&sWriter, test_rand(), nVbvFields[i]);
+                put_bits(&sWriter, 1, 1);
+            }
+        }
+        else {
+            put_bits(&sWriter, 0, 1);
+        }
+    }
+    else {
+        put_bits(&sWriter, 0, 1);
+    }
+    put_bits(&sWriter, 0, 2);                           /* rectangular */
+    put_bits(&sWriter, 1, 1);
+    nRes = 1 + test_rand() % 0xFFFF;
+    pExp->nTimeIncrementResolution = nRes;
+    put_bits(&sWriter, nRes, 16);
+    put_bits(&sWriter, 1, 1);
+    if (test_rand() & 1) {                              /* fixed_vop_rate */
+        OMX_U32 nBits = 1;
+
+        while (nBits < 16 && (1u << nBits) < nRes) {
+            nBits++;
+        }
+        put_bits(&sWriter, 1, 1);
+        put_bits(&sWriter, test_rand() % nRes, nBits);
+    }
+    else {
+        put_bits(&sWriter, 0, 1);
+    }
+    pExp->nWidth = 16 + test_rand() % 1905;
+    pExp->nHeight = 16 + test_rand() % 1073;
+    put_bits(&sWriter, 1, 1);
+    put_bits(&sWriter, pExp->nWidth, 13);
+    put_bits(&sWriter, 1, 1);
+    put_bits(&sWriter, pExp->nHeight, 13);
+    put_bits(&sWriter, 1, 1);
+    put_bits(&sWriter, test_rand(), 8);                 /* rest of the VOL */
+    pHeader->nSize = (sWriter.nPos + 7) >> 3;
+}
+
+/* Generated MPEG-4 and H.263 config headers: each one parsed as is, then
+   truncated and with flipped bits, which must fail cleanly or parse
+   without reading past the data. Then the time per header. */
+void m4vheader_perf_test()
+{
+    TEST_M4VHEADER *pCorpus = malloc(TEST_HEADERS * sizeof(TEST_M4VHEADER));
+    OMX_TI_M4VHEADERTYPE sHeader;
+    OMX_U8 *pCopy;
+    OMX_U32 nParsed = 0, nSize, i, n;
+    double t1, t2;
+
+    assert(pCorpus != NULL);
+    for (i = 0; i < TEST_HEADERS; i++) {
+        make_m4v_header(&pCorpus[i]);
+        assert(OMX_TI_M4vParseHeader(pCorpus[i].aData, pCorpus[i].nSize, &sHeader) == OMX_ErrorNone);
+        assert(!memcmp(&sHeader, &pCorpus[i].sExpected, sizeof(sHeader)));
+    }
+
+    for (n = 0; n < nIterations * 10; n++) {
+        i = n % TEST_HEADERS;
+        nSize = test_rand() % (pCorpus[i].nSize + 1);
+        /* exactly nSize bytes, so that a read past them is caught by the
+           heap checker the test is run under */
+        pCopy = malloc(nSize ? nSize : 1);
+        assert(pCopy != NULL);
+        memcpy(pCopy, pCorpus[i].aData, nSize);
+        if (nSize && (test_rand() & 1)) {
+            pCopy[test_rand() % nSize] ^= (OMX_U8)(1 << (test_rand() % 8));
+        }
+        if (OMX_TI_M4vParseHeader(pCopy, nSize, &sHeader) == OMX_ErrorNone) {
+            assert(sHeader.nWidth && sHeader.nHeight);
+        }
+        free(pCopy);
+    }
+
+    t1 = test_now_us();
+    for (n = 0; n < nIterations; n++) {
+        for (i = 0; i < TEST_HEADERS; i++) {
+            nParsed += OMX_TI_M4vParseHeader(pCorpus[i].aData, pCorpus[i].nSize, &sHeader) == OMX_ErrorNone;
+        }
+    }
+    t2 = test_now_us();
+    assert(nParsed == nIterations * TEST_HEADERS);
+    printf("m4v header: %.1f ns/header over %d headers\n",
+           (t2 - t1) * 1000.0 / nParsed, TEST_HEADERS);
+    free(pCorpus);
+}
+
+/* sequence header corpus entry: the bytes and the size they carry */
+typedef struct TEST_SEQHEADER {
+    OMX_U8 aData[TEST_HEADER_SIZE];
+    OMX_U32 nSize;
+    OMX_BOOL bVc1;
+    OMX_U32 nWidth;
+    OMX_U32 nHeight;
+} TEST_SEQHEADER;
+
+/* An MPEG-2 sequence header with its extension and a GOP header, or a
+   VC-1 advanced profile sequence header and entry point, some of the time
+   behind user data or a sequence end of the previous stream. */
+static void make_seq_header(TEST_SEQHEADER *pHeader)
+{
+    TEST_BITWRITER sWriter = { pHeader->aData, 0 };
+    OMX_U32 i;
+
+    pHeader->bVc1 = (test_rand() & 1) ? OMX_TRUE : OMX_FALSE;
+    if (test_rand() & 1) {
+        put_bits(&sWriter, pHeader->bVc1 ? 0x10A : 0x1B7, 32);     /* end of sequence */
+    }
+    if (test_rand() & 1) {
+        put_bits(&sWriter, pHeader->bVc1 ? 0x11F : 0x1B2, 32);     /* user data */
+        for (i = test_rand() % 8; i > 0; i--) {
+            put_bits(&sWriter, 0x40 | (test_rand() & 0x3F), 8);
+        }
+    }
+    if (pHeader->bVc1) {
+        /* max_coded_width and max_coded_height code half the size less 1 */
+        pHeader->nWidth = 2 + 2 * (test_rand() % 1024);
+        pHeader->nHeight = 2 + 2 * (test_rand() % 1024);
+        put_bits(&sWriter, 0x10F, 32);
+        put_bits(&sWriter, 3, 2);                                   /* advanced */
+        put_bits(&sWriter, test_rand() % 5, 3);                     /* level */
+        put_bits(&sWriter, 1, 2);                                   /* 4:2:0 */
+        put_bits(&sWriter, test_rand(), 8);                         /* frmrtq, bitrtq */
+        put_bits(&sWriter, test_rand() & 1, 1);                     /* postprocflag */
+        put_bits(&sWriter, (pHeader->nWidth - 2) / 2, 12);
+        put_bits(&sWriter, (pHeader->nHeight - 2) / 2, 12);
+        put_bits(&sWriter, test_rand(), 6);                         /* pulldown .. reserved */
+        put_bits(&sWriter, 0, 1);                                   /* display_ext */
+        put_bits(&sWriter, 0, 1);                                   /* hrd_param_flag */
+        put_bits(&sWriter, 1, 2);                                   /* trailing bits */
+        put_bits(&sWriter, 0x10E, 32);                              /* entry point */
+        put_bits(&sWriter, test_rand(), 16);
+    }
+    else {
+        pHeader->nWidth = 16 + test_rand() % 1905;
+        pHeader->nHeight = 16 + test_rand() % 1073;
+        put_bits(&sWriter, 0x1B3, 32);
+        put_bits(&sWriter, pHeader->nWidth, 12);
+        put_bits(&sWriter, pHeader->nHeight, 12);
+        put_bits(&sWriter, 1 + test_rand() % 4, 4);                 /* aspect_ratio_information */
+        put_bits(&sWriter, 1 + test_rand() % 8, 4);                 /* frame_rate_code */
+        put_bits(&sWriter, test_rand(), 18);                        /* bit_rate_value */
+        put_bits(&sWriter, 1, 1);
+        put_bits(&sWriter, test_rand(), 10);                        /* vbv_buffer_size_value */
+        put_bits(&sWriter, 0, 3);                                   /* no quantiser matrices */
+        put_bits(&sWriter, 0x1B5, 32);                              /* sequence extension */
+        put_bits(&sWriter, 1, 4);
+        put_bits(&sWriter, test_rand(), 28);
+        put_bits(&sWriter, 0x1B8, 32);                              /* group of pictures */
+        put_bits(&sWriter, test_rand(), 27);
+    }
+    pHeader->nSize = (sWriter.nPos + 7) >> 3;
+}
+
+static OMX_ERRORTYPE parse_seq_header(const OMX_U8 *pData, OMX_U32 nSize, OMX_BOOL bVc1,
+                                      OMX_U32 *pnWidth, OMX_U32 *pnHeight)
+{
+    return bVc1 ? OMX_TI_Vc1ParseSeqHeader(pData, nSize, pnWidth, pnHeight)
+                : OMX_TI_Mpeg2ParseSeqHeader(pData, nSize, pnWidth, pnHeight);
+}
+
+/* Generated MPEG-2 and VC-1 sequence headers, checked, then truncated and
+   with flipped bits, then timed like the MPEG-4 ones. */
+void seqheader_perf_test()
+{
+    TEST_SEQHEADER *pCorpus = malloc(TEST_HEADERS * sizeof(TEST_SEQHEADER));
+    OMX_U8 *pCopy;
+    OMX_U32 nParsed = 0, nWidth, nHeight, nSize, i, n;
+    double t1, t2;
+
+    assert(pCorpus != NULL);
+    for (i = 0; i < TEST_HEADERS; i++) {
+        make_seq_header(&pCorpus[i]);
+        assert(parse_seq_header(pCorpus[i].aData, pCorpus[i].nSize, pCorpus[i].bVc1,
+                                &nWidth, &nHeight) == OMX_ErrorNone);
+        assert(nWidth == pCorpus[i].nWidth && nHeight == pCorpus[i].nHeight);
+    }
+
+    for (n = 0; n < nIterations * 10; n++) {
+        i = n % TEST_HEADERS;
+        nSize = test_rand() % (pCorpus[i].nSize + 1);
+        pCopy = malloc(nSize ? nSize : 1);
+        assert(pCopy != NULL);
+        memcpy(pCopy, pCorpus[i].aData, nSize);
+        if (nSize && (test_rand() & 1)) {
+            pCopy[test_rand() % nSize] ^= (OMX_U8)(1 << (test_rand() % 8));
+        }
+        if (parse_seq_header(pCopy, nSize, pCorpus[i].bVc1, &nWidth, &nHeight) == OMX_ErrorNone) {
+            /* 12 bit fields, doubled for VC-1 */
+            assert(nWidth <= 8192 && nHeight <= 8192);
+        }
+        free(pCopy);
+    }
+
+    t1 = test_now_us();
+    for (n = 0; n < nIterations; n++) {
+        for (i = 0; i < TEST_HEADERS; i++) {
+            nParsed += parse_seq_header(pCorpus[i].aData, pCorpus[i].nSize, pCorpus[i].bVc1,
+                                        &nWidth, &nHeight) == OMX_ErrorNone;
+        }
+    }
+    t2 = test_now_us();
+    assert(nParsed == nIterations * TEST_HEADERS);
+    printf("mpeg2 / vc1 sequence header: %.1f ns/header over %d headers\n",
+           (t2 - t1) * 1000.0 / nParsed, TEST_HEADERS);
+    free(pCorpus);
+}
+
+typedef struct TEST_AVCCONFIG {
+    OMX_U8 aData[TEST_AVC_CONFIG_SIZE];     /* Annex B SPS then PPS */
+    OMX_U32 nSize;
+    OMX_U32 nProfileIdc;
+    OMX_U32 nLevelIdc;
+    OMX_U32 nWidth;                         /* coded luma size */
+    OMX_U32 nHeight;
+    OMX_U32 nCropWidth;                     /* luma samples cropped */
+    OMX_U32 nCropHeight;
+    OMX_U32 nDpbFrames;
+    OMX_U32 nReorderFrames;
+    OMX_BOOL bVuiParametersPresent;
+    OMX_BOOL bTimingInfo;
+    OMX_BOOL bBitstreamRestriction;
+} TEST_AVCCONFIG;
+
+/* Config buffers as the common encoder settings write them, one per
+   branch of seq_parameter_set_data() and vui_parameters() that changes
+   the fields read after it: high profile chroma and scaling matrices,
+   pic_order_cnt_type 0, 1 and 2, field coding, cropping, extended SAR,
+   NAL and VCL HRD, and emulation prevention bytes in timing_info. */
+static const TEST_AVCCONFIG aAvcConfigs[] = {
+    /* baseline 3.0 640x480, one reference, VUI with bitstream_restriction */
+    { { 0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xc0, 0x1e, 0xda, 0x02, 0x80, 0xf6,
+        0x84, 0x00, 0x00, 0x03, 0x00, 0x04, 0x00, 0x00, 0x03, 0x00, 0xc8, 0x3c,
+        0x22, 0x11, 0xa8, 0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c, 0x80 },
+      35, 66, 30, 640, 480, 0, 0, 1, 0, OMX_TRUE, OMX_TRUE, OMX_TRUE },
+    /* constrained baseline 3.1 1280x720, no VUI */
+    { { 0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xe0, 0x1f, 0x95, 0xa0, 0x14, 0x01,
+        0x6e, 0x40, 0x00, 0x00, 0x00, 0x01, 0x68, 0xce, 0x3c, 0x80 },
+      22, 66, 31, 1280, 720, 0, 0, 1, 0, OMX_FALSE, OMX_FALSE, OMX_FALSE },
+    /* main 4.0 1920x1080, 1088 coded and cropped, 59.94 fps */
+    { { 0x00, 0x00, 0x00, 0x01, 0x67, 0x4d, 0x40, 0x28, 0x9a, 0xca, 0x03, 0xc0,
+        0x11, 0x3f, 0x2e, 0x02, 0x20, 0x00, 0x00, 0x7d, 0x20, 0x00, 0x1d, 0x4c,
+        0x11, 0xe1, 0x10, 0x8b, 0x2c, 0x00, 0x00, 0x00, 0x01, 0x68, 0xe9, 0x23,
+        0xc8 },
+      37, 77, 40, 1920, 1088, 0, 8, 4, 2, OMX_TRUE, OMX_TRUE, OMX_TRUE },
+    /* high 4.1 1920x1080, colour description and NAL HRD, 23.976 fps */
+    { { 0x00, 0x00, 0x00, 0x01, 0x67, 0x64, 0x00, 0x29, 0xac, 0xd9, 0x40, 0x78,
+        0x02, 0x27, 0xe5, 0xc0, 0x5a, 0x80, 0x80, 0x80, 0xa0, 0x00, 0x00, 0x7d,
+        0x20, 0x00, 0x17, 0x70, 0x1d, 0x0c, 0x00, 0x4c, 0x48, 0x01, 0xd4, 0xd7,
+        0xbd, 0xf0, 0x7c, 0x22, 0x11, 0x65, 0x80, 0x00, 0x00, 0x00, 0x01, 0x68,
+        0xe9, 0x23, 0x2c, 0x8b },
+      52, 100, 41, 1920, 1088, 0, 8, 4, 2, OMX_TRUE, OMX_TRUE, OMX_TRUE },
+    /* main 3.0 720x576 MBAFF, extended SAR, NAL and VCL HRD, no bitstream_restriction */
+    { { 0x00, 0x00, 0x00, 0x01, 0x67, 0x4d, 0x00, 0x1e, 0xe4, 0x20, 0x16, 0x84,
+        0x9b, 0xff, 0x00, 0x40, 0x00, 0x2d, 0x6a, 0x0a, 0x0a, 0x0a, 0x80, 0x00,
+        0x00, 0x03, 0x00, 0x80, 0x00, 0x00, 0x19, 0x74, 0x30, 0x07, 0x54, 0x00,
+        0x75, 0x3d, 0xef, 0x7c, 0x68, 0x60, 0x0c, 0x38, 0x00, 0xc3, 0x7b, 0xde,
+        0xf8, 0x50, 0x00, 0x00, 0x00, 0x01, 0x68, 0xeb, 0x8f, 0x20 },
+      58, 77, 30, 720, 576, 0, 0, 5, 5, OMX_TRUE, OMX_TRUE, OMX_FALSE },
+    /* high 3.2 1280x720 field coded, pic_order_cnt_type 1, no VUI */
+    { { 0x00, 0x00, 0x00, 0x01, 0x67, 0x64, 0x00, 0x20, 0xac, 0x48, 0x56, 0xc8,
+        0x46, 0x02, 0x80, 0x5c, 0xf9, 0x50, 0x00, 0x00, 0x00, 0x01, 0x68, 0xea,
+        0x8c, 0xb2, 0x2c },
+      27, 100, 32, 1280, 736, 0, 16, 5, 5, OMX_FALSE, OMX_FALSE, OMX_FALSE },
+    /* high 4:2:2 intra 4.1 1920x1080, 10 bit, scaling matrices */
+    { { 0x00, 0x00, 0x00, 0x01, 0x67, 0x7a, 0x10, 0x29, 0xb6, 0xd9, 0x47, 0x0e,
+        0x08, 0x02, 0xd1, 0xc3, 0x82, 0x00, 0xb4, 0x70, 0xe0, 0x80, 0x2d, 0x1c,
+        0x38, 0x20, 0x48, 0x20, 0x60, 0x80, 0xe8, 0x81, 0x82, 0x03, 0xa2, 0x06,
+        0x08, 0x0e, 0x88, 0x18, 0x20, 0x94, 0x41, 0x8c, 0x41, 0x44, 0x20, 0x2b,
+        0x10, 0x63, 0x10, 0x51, 0x08, 0x0a, 0xc4, 0x18, 0xc4, 0x14, 0x42, 0x02,
+        0xb1, 0x06, 0x31, 0x05, 0x10, 0x80, 0xac, 0x41, 0x8c, 0x41, 0x44, 0x20,
+        0x2b, 0x10, 0x63, 0x10, 0x51, 0x08, 0x0a, 0xc4, 0x18, 0xc4, 0x14, 0x42,
+        0x02, 0xb1, 0x06, 0x31, 0x05, 0x10, 0x8f, 0x01, 0xe0, 0x08, 0x9f, 0x89,
+        0x84, 0x00, 0x00, 0x03, 0x00, 0x04, 0x00, 0x00, 0x03, 0x00, 0xca, 0x3c,
+        0x22, 0x11, 0xe0, 0x00, 0x00, 0x00, 0x01, 0x68, 0xee, 0x32, 0xc8, 0xb0 },
+      120, 122, 41, 1920, 1088, 0, 8, 0, 0, OMX_TRUE, OMX_TRUE, OMX_TRUE },
+    /* main 1.3 176x144, VUI without bitstream_restriction */
+    { { 0x00, 0x00, 0x00, 0x01, 0x67, 0x4d, 0x40, 0x0d, 0xed, 0x85, 0x89, 0xd0,
+        0x80, 0x00, 0x00, 0x03, 0x00, 0x80, 0x00, 0x00, 0x0f, 0x02, 0x00, 0x00,
+        0x00, 0x01, 0x68, 0xea, 0x8f, 0x20 },
+      30, 77, 13, 176, 144, 0, 0, 16, 16, OMX_TRUE, OMX_TRUE, OMX_FALSE },
+};
+
+#define TEST_AVC_CONFIGS (sizeof(aAvcConfigs) / sizeof(aAvcConfigs[0]))
+
+/* What VIDDEC_ParseVideo_H264 and the config parser do with a config
+   buffer: find the SPS among the NAL units, drop its emulation prevention
+   bytes and parse it. The PPS is only walked past, neither reads it. */
+static OMX_ERRORTYPE parse_avc_config(const OMX_U8 *pData, OMX_U32 nSize,
+                                      OMX_U8 *pRbsp, OMX_TI_AVCSPSTYPE *pSps)
+{
+    OMX_TI_NALITERTYPE sIter;
+    OMX_TI_BITREADERTYPE sBits;
+    const OMX_U8 *pNal;
+    OMX_U32 nNalSize, nType, nRbspSize;
+
+    OMX_TI_NalIterInit(&sIter, pData, nSize, 0, OMX_FALSE);
+    while (OMX_TI_NalIterNext(&sIter, &pNal, &nNalSize, &nType)) {
+        if (nType == 7 && nNalSize > 1) {
+            nRbspSize = OMX_TI_NalRemoveEmulationPrevention(pRbsp, pNal + 1, nNalSize - 1);
+            OMX_TI_BitsInit(&sBits, pRbsp, nRbspSize);
+            return OMX_TI_AvcParseSps(&sBits, pSps);
+        }
+    }
+    return OMX_ErrorStreamCorrupt;
+}
+
+/* Each config parsed and checked against the values it was written with,
+   then truncated and with flipped bits, which must fail cleanly or give
+   a picture size and a DPB the decoder can use. Then the time per
+   config. */
+void avcheader_perf_test()
+{
+    const TEST_AVCCONFIG *pConfig;
+    OMX_TI_AVCSPSTYPE sSps;
+    OMX_U8 aRbsp[TEST_AVC_CONFIG_SIZE];
+    OMX_U8 *pCopy;
+    OMX_U32 nParsed = 0, nSize, i, n;
+    double t1, t2;
+
+    for (i = 0; i < TEST_AVC_CONFIGS; i++) {
+        pConfig = &aAvcConfigs[i];
+        assert(parse_avc_config(pConfig->aData, pConfig->nSize, aRbsp, &sSps) == OMX_ErrorNone);
+        assert(sSps.nProfileIdc == pConfig->nProfileIdc);
+        assert(sSps.nLevelIdc == pConfig->nLevelIdc);
+        assert(sSps.nWidthMbs * 16 == pConfig->nWidth);
+        assert(sSps.nHeightMapUnits * (2 - sSps.bFrameMbsOnly) * 16 == pConfig->nHeight);
+        assert(sSps.nCropUnitX * (sSps.nCropLeftOffset + sSps.nCropRightOffset) == pConfig->nCropWidth);
+        assert(sSps.nCropUnitY * (sSps.nCropTopOffset + sSps.nCropBottomOffset) == pConfig->nCropHeight);
+        assert(sSps.nDpbFrames == pConfig->nDpbFrames);
+        assert(sSps.nReorderFrames == pConfig->nReorderFrames);
+        assert(sSps.bVuiParametersPresent == pConfig->bVuiParametersPresent);
+        assert(sSps.bTimingInfo == pConfig->bTimingInfo);
+        assert(sSps.bBitstreamRestriction == pConfig->bBitstreamRestriction);
+    }
+
+    for (n = 0; n < nIterations * 10; n++) {
+        pConfig = &aAvcConfigs[n % TEST_AVC_CONFIGS];
+        nSize = test_rand() % (pConfig->nSize + 1);
+        pCopy = malloc(nSize ? nSize : 1);
+        assert(pCopy != NULL);
+        memcpy(pCopy, pConfig->aData, nSize);
+        if (nSize && (test_rand() & 1)) {
+            pCopy[test_rand() % nSize] ^= (OMX_U8)(1 << (test_rand() % 8));
+        }
+        if (parse_avc_config(pCopy, nSize, aRbsp, &sSps) == OMX_ErrorNone) {
+            assert(sSps.nWidthMbs && sSps.nHeightMapUnits);
+            assert(sSps.nDpbFrames <= OMX_TI_AVC_MAX_DPB_FRAMES);
+            assert(sSps.nReorderFrames <= sSps.nDpbFrames);
+        }
+        free(pCopy);
+    }
+
+    t1 = test_now_us();
+    for (n = 0; n < nIterations * 10; n++) {
+        for (i = 0; i < TEST_AVC_CONFIGS; i++) {
+            nParsed += parse_avc_config(aAvcConfigs[i].aData, aAvcConfigs[i].nSize,
+                                        aRbsp, &sSps) == OMX_ErrorNone;
+        }
+    }
+    t2 = test_now_us();
+    assert(nParsed == nIterations * 10 * TEST_AVC_CONFIGS);
+    printf("avc sps: %.1f ns/config over %d configs\n",
+           (t2 - t1) * 1000.0 / nParsed, (int)TEST_AVC_CONFIGS);
+}
+
+/* Config number nId of TEST_CONFIGS distinct ones, of nId % 32 + 1 bytes. */
+#define TEST_CONFIGS 24
+/* Appends the ff_byte coded nValue of a payloadType / payloadSize. */
+static OMX_U32 put_sei_value(OMX_U8 *pData, OMX_U32 nValue)
+{
+    OMX_U32 n = 0;
+
+    for (; nValue >= 255; nValue -= 255) {
+        pData[n++] = 0xFF;
+    }
+    pData[n++] = (OMX_U8)nValue;
+    return n;
+}
+
+/* SEI units of a few sei_message()s of random types and sizes, payloads
+   heavy in zero bytes so that emulation prevention bytes are inserted,
+   then cut anywhere. The recovery point is to be found once the unit
+   holds the whole payloadType / payloadSize of the first payloadType 6
+   message, and never otherwise. */
+void seirecovery_unit_test()
+{
+    static OMX_U8 aRbsp[TEST_SEI_SIZE];
+    static OMX_U8 aNal[TEST_SEI_SIZE * 2];
+    static OMX_U32 aNalEnd[TEST_SEI_SIZE];
+    OMX_U32 nRbsp, nNal, nZeros, nCount, nType, nSize, nRecoveryEnd, nCut, i, n;
+
+    for (n = 0; n < nIterations * 20; n++) {
+        /* nRecoveryEnd: RBSP end of the first recovery point header */
+        nRecoveryEnd = 0;
+        aRbsp[0] = 0x06;
+        nRbsp = 1;
+        for (nCount = 1 + test_rand() % 4; nCount != 0; nCount--) {
+            switch (test_rand() % 4) {
+                case 0:  nType = 6; break;
+                case 1:  nType = test_rand() % 8; break;
+                default: nType = test_rand() % 600; break;
+            }
+            nSize = (test_rand() & 1) ? test_rand() % 8 : test_rand() % 300;
+            nRbsp += put_sei_value(aRbsp + nRbsp, nType);
+            nRbsp += put_sei_value(aRbsp + nRbsp, nSize);
+            if (nType == 6 && nRecoveryEnd == 0) {
+                nRecoveryEnd = nRbsp;
+            }
+            for (i = 0; i < nSize; i++) {
+                aRbsp[nRbsp++] = (test_rand() & 1) ? 0 : (OMX_U8)test_rand();
+            }
+        }
+        aRbsp[nRbsp++] = 0x80;
+
+        /* escape, keeping where each RBSP byte ends in the NAL unit */
+        nNal = 0;
+        nZeros = 0;
+        for (i = 0; i < nRbsp; i++) {
+            if (nZeros >= 2 && aRbsp[i] <= 3) {
+                aNal[nNal++] = 0x03;
+                nZeros = 0;
+            }
+            aNal[nNal++] = aRbsp[i];
+            nZeros = (aRbsp[i] == 0) ? nZeros + 1 : 0;
+            aNalEnd[i] = nNal;
+        }
+
+        assert(OMX_TI_AvcSeiHasRecoveryPoint(aNal, nNal) == (nRecoveryEnd ? OMX_TRUE : OMX_FALSE));
+        nCut = test_rand() % (nNal + 1);
+        assert(OMX_TI_AvcSeiHasRecoveryPoint(aNal, nCut) ==
+               ((nRecoveryEnd && aNalEnd[nRecoveryEnd - 1] <= nCut) ? OMX_TRUE : OMX_FALSE));
+    }
+}
+
+static OMX_U32 make_config(OMX_U8 *pConfig, OMX_U32 nId)
+{
+    OMX_U32 nBytes = nId % 32 + 1;
+    OMX_U32 i;
+
+    for (i = 0; i < nBytes; i++) {
+        pConfig[i] = (OMX_U8)(nId * 7 + i);
+    }
+    return nBytes;
+}
+
+static OMX_S32 config_find(OMX_TI_CONFIGCACHETYPE *pCache, const char *cName, OMX_U32 nId)
+{
+    OMX_U8 aConfig[32];
+    OMX_U32 nBytes = make_config(aConfig, nId);
+
+    return OMX_TI_ConfigCacheFind(pCache, OMX_TI_ConfigCacheHash("video_decoder.avc", cName, aConfig, nBytes),
+                                  "video_decoder.avc", cName, aConfig, nBytes);
+}
+
+static OMX_U32 config_insert(OMX_TI_CONFIGCACHETYPE *pCache, const char *cName, OMX_U32 nId)
+{
+    OMX_U8 aConfig[32];
+    OMX_U32 nBytes = make_config(aConfig, nId);
+
+    return OMX_TI_ConfigCacheInsert(pCache, OMX_TI_ConfigCacheHash("video_decoder.avc", cName, aConfig, nBytes),
+                                    "video_decoder.avc", cName, aConfig, nBytes);
+}
+
+/* Hits, misses on any change of the key or a hash collision, the least
+   recently used slot evicted first, and a random lookup sequence against
+   a list of the configs in order of use. */
+void configcache_unit_test()
+{
+    static OMX_TI_CONFIGCACHETYPE sCache;
+    OMX_U8 aConfig[OMX_TI_CONFIGCACHE_MAX_BYTES + 1];
+    char cLongName[OMX_TI_CONFIGCACHE_MAX_NAME + 1];
+    OMX_U32 aRecent[OMX_TI_CONFIGCACHE_ENTRIES];
+    OMX_U32 aSlot[TEST_CONFIGS];
+    OMX_U32 nRecent = 0, nHits = 0, nEvictions = 0, nHash, nSlot, nId, i, j, n;
+    OMX_S32 nFound;
+
+    memset(aConfig, 0, sizeof(aConfig));
+    memset(cLongName, 'x', OMX_TI_CONFIGCACHE_MAX_NAME);
+    cLongName[OMX_TI_CONFIGCACHE_MAX_NAME] = 0;
+    assert(OMX_TI_ConfigCacheFits("video_decoder.avc", "", aConfig, OMX_TI_CONFIGCACHE_MAX_BYTES));
+    assert(!OMX_TI_ConfigCacheFits("video_decoder.avc", "", aConfig, OMX_TI_CONFIGCACHE_MAX_BYTES + 1));
+    assert(!OMX_TI_ConfigCacheFits("video_decoder.avc", cLongName, aConfig, 4));
+    assert(!OMX_TI_ConfigCacheFits(cLongName, "", aConfig, 4));
+    assert(!OMX_TI_ConfigCacheFits(NULL, "", aConfig, 4));
+    assert(!OMX_TI_ConfigCacheFits("video_decoder.avc", "", NULL, 4));
+
+    /* the terminators keep the role / name boundary in the hash */
+    assert(OMX_TI_ConfigCacheHash("ab", "c", aConfig, 4) != OMX_TI_ConfigCacheHash("a", "bc", aConfig, 4));
+
+    memset(&sCache, 0, sizeof(sCache));
+    assert(config_find(&sCache, "OMX.TI.Video.Decoder", 0) < 0);
+    nSlot = config_insert(&sCache, "OMX.TI.Video.Decoder", 0);
+    assert(config_find(&sCache, "OMX.TI.Video.Decoder", 0) == (OMX_S32)nSlot);
+    assert(config_find(&sCache, "OMX.TI.720P.Decoder", 0) < 0);
+    assert(config_find(&sCache, "OMX.TI.Video.Decoder", 1) < 0);
+    /* inserting a key again reuses its slot */
+    assert(config_insert(&sCache, "OMX.TI.Video.Decoder", 0) == nSlot);
+    assert(sCache.nEvictions == 0);
+
+    /* same hash, another config */
+    nHash = OMX_TI_ConfigCacheHash("video_decoder.avc", "OMX.TI.Video.Decoder", aConfig, 4);
+    OMX_TI_ConfigCacheInsert(&sCache, nHash, "video_decoder.avc", "OMX.TI.Video.Decoder", aConfig, 4);
+    aConfig[3] = 1;
+    assert(OMX_TI_ConfigCacheFind(&sCache, nHash, "video_decoder.avc", "OMX.TI.Video.Decoder",
+                                  aConfig, 4) < 0);
+
+    /* fill up; config 0 is used again, so config 1 is the first to go */
+    memset(&sCache, 0, sizeof(sCache));
+    for (i = 0; i < OMX_TI_CONFIGCACHE_ENTRIES; i++) {
+        config_insert(&sCache, "", i);
+    }
+    assert(sCache.nEvictions == 0);
+    assert(config_find(&sCache, "", 0) >= 0);
+    config_insert(&sCache, "", OMX_TI_CONFIGCACHE_ENTRIES);
+    assert(sCache.nEvictions == 1);
+    assert(config_find(&sCache, "", 1) < 0);
+    assert(config_find(&sCache, "", 0) >= 0);
+    for (i = 2; i <= OMX_TI_CONFIGCACHE_ENTRIES; i++) {
+        assert(config_find(&sCache, "", i) >= 0);
+    }
+
+    memset(&sCache, 0, sizeof(sCache));
+    for (n = 0; n < nIterations * 50; n++) {
+        /* a few configs often, the rest now and then */
+        nId = test_rand() % (test_rand() & 1 ? OMX_TI_CONFIGCACHE_ENTRIES / 2 : TEST_CONFIGS);
+        for (i = 0; i < nRecent && aRecent[i] != nId; i++) {
+        }
+        nFound = config_find(&sCache, "", nId);
+        if (i < nRecent) {
+            assert(nFound == (OMX_S32)aSlot[nId]);
+            nHits++;
+        }
+        else {
+            assert(nFound < 0);
+            aSlot[nId] = config_insert(&sCache, "", nId);
+            if (nRecent == OMX_TI_CONFIGCACHE_ENTRIES) {
+                /* the least recently used one, at the end of the list, went */
+                assert(aSlot[aRecent[nRecent - 1]] == aSlot[nId]);
+                nEvictions++;
+                i = nRecent - 1;
+            }
+            else {
+                i = nRecent++;
+            }
+        }
+        for (j = i; j > 0; j--) {
+            aRecent[j] = aRecent[j - 1];
+        }
+        aRecent[0] = nId;
+    }
+    assert(sCache.nLookups == nIterations * 50);
+    assert(sCache.nHits == nHits && sCache.nEvictions == nEvictions);
+    printf("config cache: %lu lookups, %lu hits, %lu evictions\n",
+           (unsigned long)sCache.nLookups, (unsigned long)sCache.nHits,
+           (unsigned long)sCache.nEvictions);
+}
+
+/* Index of the earliest of the nCount timestamps at pPts. */
+static OMX_U32 pts_min(const OMX_TICKS *pPts, OMX_U32 nCount)
+{
+    OMX_U32 nMin = 0;
+    OMX_U32 i;
+
+    for (i = 1; i < nCount; i++) {
+        if (pPts[i] < pPts[nMin]) {
+            nMin = i;
+        }
+    }
+    return nMin;
+}
+
+/* The decoder's input timestamp queue: timestamps (repeats included) go in
+   in decoding order, and each output takes the earliest pending one while
+   the stream reorders, or at depth 0 the oldest input's own one if it is
+   still pending. The depth changes on the way; the heap must hold exactly
+   the pending timestamps throughout, checked against a plain array, so
+   that every timestamp goes out once. */
+void ptsheap_unit_test()
+{
+    OMX_TI_PTSHEAPTYPE sHeap;
+    OMX_TICKS aEntries[TEST_PTS_QUEUE];
+    OMX_TICKS aFifo[TEST_PTS_QUEUE];
+    OMX_TICKS aPending[TEST_PTS_QUEUE];
+    OMX_TICKS nPts, nLast;
+    OMX_U32 nHead = 0, nCount = 0, nDepth = 0, nReordered = 0, i, n;
+
+    OMX_TI_PtsHeapInit(&sHeap, aEntries, TEST_PTS_QUEUE);
+    assert(!OMX_TI_PtsHeapPop(&sHeap, &nPts));
+    assert(!OMX_TI_PtsHeapRemove(&sHeap, 0));
+
+    for (n = 0; n < nIterations * 500; n++) {
+        if (test_rand() % 64 == 0) {
+            nDepth = test_rand() % 3;
+        }
+        if (nCount < TEST_PTS_QUEUE && (nCount == 0 || test_rand() % 2)) {
+            /* display times of a stream with B frames, and some repeats */
+            nPts = (OMX_TICKS)((n & ~3u) + test_rand() % 8) * 33000;
+            assert(OMX_TI_PtsHeapPush(&sHeap, nPts));
+            aFifo[(nHead + nCount) % TEST_PTS_QUEUE] = nPts;
+            aPending[nCount++] = nPts;
+        }
+        else {
+            for (i = 0; i < nCount && aPending[i] != aFifo[nHead]; i++) {
+            }
+            if (nDepth == 0 && i < nCount) {
+                assert(OMX_TI_PtsHeapRemove(&sHeap, aFifo[nHead]));
+            }
+            else {
+                /* an earlier timestamp, or this one already went out */
+                assert(nDepth != 0 || !OMX_TI_PtsHeapRemove(&sHeap, aFifo[nHead]));
+                i = pts_min(aPending, nCount);
+                assert(OMX_TI_PtsHeapPop(&sHeap, &nPts));
+                assert(nPts == aPending[i]);
+                nReordered += nPts != aFifo[nHead];
+            }
+            aPending[i] = aPending[--nCount];
+            nHead = (nHead + 1) % TEST_PTS_QUEUE;
+        }
+        assert(sHeap.nCount == nCount);
+        if (nCount == TEST_PTS_QUEUE) {
+            assert(!OMX_TI_PtsHeapPush(&sHeap, 0));
+        }
+    }
+
+    /* what is left comes out sorted */
+    for (nLast = 0; nCount > 0; nCount--) {
+        i = pts_min(aPending, nCount);
+        assert(OMX_TI_PtsHeapPop(&sHeap, &nPts));
+        assert(nPts == aPending[i] && nPts >= nLast);
+        aPending[i] = aPending[nCount - 1];
+        nLast = nPts;
+    }
+    assert(!OMX_TI_PtsHeapPop(&sHeap, &nPts));
+    printf("pts heap: %lu timestamps reordered\n", (unsigned long)nReordered);
+}
+
+/* Rounded average of the (1 << nShift) x (1 << nShift) block at pSrc of a
+   plane of nStride bytes per row, every nStep-th byte of each row. */
+static OMX_U8 ref_box(const OMX_U8 *pSrc, OMX_U32 nStride, OMX_U32 nStep, OMX_U32 nShift)
+{
+    OMX_U32 nSum = 0;
+    OMX_U32 i, j;
+
+    for (j = 0; j < (1u << nShift); j++) {
+        for (i = 0; i < (1u << nShift); i++) {
+            nSum += pSrc[j * nStride + i * nStep];
+        }
+    }
+    return (OMX_U8)((nSum + (1u << (2 * nShift - 1))) >> (2 * nShift));
+}
+
+/* Thumbnail downscaling in place, of random frames with a stride and slice
+   height larger than the picture and a crop anywhere in it (the adaptive
+   playback layout), against box averages taken from a copy of the
+   frame. */
+void downscale_unit_test()
+{
+    static OMX_U8 aFrame[TEST_FRAME_SIZE * TEST_FRAME_SIZE * 2];
+    static OMX_U8 aSource[TEST_FRAME_SIZE * TEST_FRAME_SIZE * 2];
+    OMX_TI_FRAMELAYOUTTYPE sLayout;
+    OMX_U32 nShift, nSize, nBytes, nWidth, nHeight, nChroma, x, y, n;
+    const OMX_U8 *pSrc;
+    const OMX_U8 *pDst;
+
+    for (n = 0; n < nIterations * 5; n++) {
+        nShift = 1 + test_rand() % 3;
+        sLayout.nWidth = 1 + test_rand() % (TEST_FRAME_SIZE / 2);
+        sLayout.nHeight = 1 + test_rand() % (TEST_FRAME_SIZE / 2);
+        sLayout.nLeft = (test_rand() % (TEST_FRAME_SIZE / 4)) & ~1;
+        sLayout.nTop = (test_rand() % (TEST_FRAME_SIZE / 4)) & ~1;
+        sLayout.nStride = (sLayout.nLeft + sLayout.nWidth + test_rand() % 16 + 1) & ~1;
+        sLayout.nSliceHeight = (sLayout.nTop + sLayout.nHeight + test_rand() % 16 + 1) & ~1;
+        nSize = sLayout.nStride * sLayout.nSliceHeight * 2;
+        for (x = 0; x < nSize; x++) {
+            aFrame[x] = aSource[x] = (OMX_U8)test_rand();
+        }
+
+        if (n & 1) {
+            nBytes = OMX_TI_DownscaleYuv420(aFrame, &sLayout, nShift, &nWidth, &nHeight);
+        }
+        else {
+            nBytes = OMX_TI_DownscaleCbYCrY(aFrame, &sLayout, nShift, &nWidth, &nHeight);
+        }
+        if (nBytes == 0) {
+            /* a side under two output pixels */
+            assert((sLayout.nWidth >> nShift) < 2 || (sLayout.nHeight >> nShift) < 2);
+            assert(!memcmp(aFrame, aSource, nSize));
+            continue;
+        }
+        assert(nWidth == ((sLayout.nWidth >> nShift) & ~1));
+        assert(nHeight == ((sLayout.nHeight >> nShift) & ~1));
+
+        if (n & 1) {
+            assert(nBytes == nWidth * nHeight * 3 / 2);
+            pSrc = aSource + sLayout.nTop * sLayout.nStride + sLayout.nLeft;
+            for (y = 0; y < nHeight; y++) {
+                for (x = 0; x < nWidth; x++) {
+                    assert(aFrame[y * nWidth + x] ==
+                           ref_box(pSrc + ((y * sLayout.nStride + x) << nShift), sLayout.nStride, 1, nShift));
+                }
+            }
+            /* Cb then Cr, half size */
+            nChroma = (sLayout.nStride / 2) * (sLayout.nSliceHeight / 2);
+            for (nSize = 0; nSize < 2; nSize++) {
+                pSrc = aSource + sLayout.nStride * sLayout.nSliceHeight + nSize * nChroma +
+                       (sLayout.nTop / 2) * (sLayout.nStride / 2) + sLayout.nLeft / 2;
+                pDst = aFrame + nWidth * nHeight + nSize * (nWidth * nHeight / 4);
+                for (y = 0; y < nHeight / 2; y++) {
+                    for (x = 0; x < nWidth / 2; x++) {
+                        assert(pDst[y * (nWidth / 2) + x] ==
+                               ref_box(pSrc + ((y * (sLayout.nStride / 2) + x) << nShift),
+                                       sLayout.nStride / 2, 1, nShift));
+                    }
+                }
+            }
+        }
+        else {
+            assert(nBytes == nWidth * nHeight * 2);
+            pSrc = aSource + (sLayout.nTop * sLayout.nStride + sLayout.nLeft) * 2;
+            for (y = 0; y < nHeight; y++) {
+                for (x = 0; x < nWidth; x += 2) {
+                    const OMX_U8 *pBlock = pSrc + (y << nShift) * sLayout.nStride * 2 + (x << nShift) * 2;
+                    const OMX_U8 *pOut = aFrame + (y * nWidth + x) * 2;
+
+                    /* Cb / Cr over the whole pair, each Y over its half */
+                    assert(pOut[0] == ref_box(pBlock, sLayout.nStride * 2, 4, nShift));
+                    assert(pOut[2] == ref_box(pBlock + 2, sLayout.nStride * 2, 4, nShift));
+                    assert(pOut[1] == ref_box(pBlock + 1, sLayout.nStride * 2, 2, nShift));
+                    assert(pOut[3] == ref_box(pBlock + 1 + (2 << nShift), sLayout.nStride * 2, 2, nShift));
+                }
+            }
+        }
+    }
+}
+
+/* Error map summaries of random maps, from clean to dense, against a
+   count and box taken macroblock by macroblock. */
+void mberrormap_unit_test()
+{
+    static OMX_U8 aMap[TEST_MAP_MBS * TEST_MAP_MBS];
+    OMX_TI_MBERRORSUMMARYTYPE sSummary;
+    OMX_U32 nWidth, nHeight, nDensity, nCount, nLeft, nTop, nRight, nBottom, x, y, n;
+
+    for (n = 0; n < nIterations * 20; n++) {
+        nWidth = 1 + test_rand() % TEST_MAP_MBS;
+        nHeight = test_rand() % (TEST_MAP_MBS + 1);
+        /* 1 in 2^nDensity macroblocks errored, none at 16 or over */
+        nDensity = test_rand() % 20;
+        nCount = 0;
+        nLeft = nWidth;
+        nTop = nHeight;
+        nRight = 0;
+        nBottom = 0;
+        for (y = 0; y < nHeight; y++) {
+            for (x = 0; x < nWidth; x++) {
+                OMX_U8 nError = (nDensity < 16 && (test_rand() & ((1u << nDensity) - 1)) == 0) ?
+                                (OMX_U8)(1 + test_rand() % 255) : 0;
+
+                aMap[y * nWidth + x] = nError;
+                if (nError != 0) {
+                    nCount++;
+                    nLeft = (x < nLeft) ? x : nLeft;
+                    nTop = (y < nTop) ? y : nTop;
+                    nRight = (x + 1 > nRight) ? x + 1 : nRight;
+                    nBottom = y + 1;
+                }
+            }
+        }
+        if (nCount == 0) {
+            nLeft = nTop = 0;
+        }
+
+        OMX_TI_MBErrorSummarize(aMap, nWidth, nHeight, &sSummary);
+        assert(sSummary.nErroredMBs == nCount);
+        assert(sSummary.nLeft == nLeft && sSummary.nTop == nTop);
+        assert(sSummary.nRight == nRight && sSummary.nBottom == nBottom);
+    }
+}
+
+/* Fills the ring to capacity and empties it, lap after lap, checking
+   that a put fails exactly when it is full and a get exactly when it is
+   empty, and that entries come out in order. */
+static void ring_laps(OMX_TI_RINGTYPE *pRing, OMX_U32 nCapacity, OMX_U32 nLaps)
+{
+    OMX_TI_RINGENTRYTYPE sEntry;
+    OMX_U32 nNext = 0, nExpect = 0, nFill, i, n;
+
+    for (n = 0; n < nLaps; n++) {
+        /* a varying fill level moves the lap boundary around the cells */
+        nFill = (n % 3) ? nCapacity : 1 + test_rand() % nCapacity;
+        for (i = 0; i < nFill; i++) {
+            sEntry.pData = NULL;
+            sEntry.nParam1 = nNext++;
+            sEntry.nParam2 = ~sEntry.nParam1;
+            assert(OMX_TI_RingPut(pRing, &sEntry));
+        }
+        if (nFill == nCapacity) {
+            assert(!OMX_TI_RingPut(pRing, &sEntry));
+        }
+        assert(!OMX_TI_RingEmpty(pRing));
+        for (i = 0; i < nFill; i++) {
+            assert(OMX_TI_RingGet(pRing, &sEntry));
+            assert(sEntry.nParam1 == nExpect && sEntry.nParam2 == ~nExpect);
+            nExpect++;
+        }
+        assert(OMX_TI_RingEmpty(pRing));
+        assert(!OMX_TI_RingGet(pRing, &sEntry));
+    }
+}
+
+typedef struct TEST_RINGPRODUCER {
+    OMX_TI_RINGTYPE *pRing;
+    OMX_U32 nId;
+    OMX_U32 nCount;
+    OMX_U32 nFull;                          /* puts that found the ring full */
+} TEST_RINGPRODUCER;
+
+static void *ring_producer(void *pArg)
+{
+    TEST_RINGPRODUCER *pProducer = (TEST_RINGPRODUCER *)pArg;
+    OMX_TI_RINGENTRYTYPE sEntry;
+    OMX_U32 i;
+
+    for (i = 0; i < pProducer->nCount; i++) {
+        sEntry.pData = pProducer;
+        sEntry.nParam1 = pProducer->nId;
+        sEntry.nParam2 = i;
+        while (!OMX_TI_RingPut(pProducer->pRing, &sEntry)) {
+            pProducer->nFull++;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/* Capacity and ordering on one thread, across the 32 bit wrap of the
+   sequence numbers too, then TEST_PRODUCERS threads against this one as
+   the consumer: every entry arrives exactly once and each producer's
+   entries in the order it put them. */
+void ring_unit_test()
+{
+    OMX_TI_RINGTYPE sRing;
+    OMX_TI_RINGENTRYTYPE sEntry;
+    TEST_RINGPRODUCER aProducers[TEST_PRODUCERS];
+    pthread_t aThreads[TEST_PRODUCERS];
+    OMX_U32 aNext[TEST_PRODUCERS];
+    OMX_U32 nCells, nBase, nTotal = 0, nReceived = 0, nFull = 0, i;
+    double t1, t2;
+
+    /* the size is rounded up to a power of two */
+    assert(OMX_TI_RingInit(&sRing, TEST_RING_CELLS - 3));
+    nCells = sRing.nMask + 1;
+    assert(nCells == TEST_RING_CELLS);
+    assert(OMX_TI_RingEmpty(&sRing));
+    ring_laps(&sRing, nCells, nIterations);
+
+    /* the same from just below the wrap of nHead / nTail; the fields are
+       private, this rebuilds the state of an empty ring at that position */
+    nBase = 0u - nCells * 4;
+    for (i = 0; i < nCells; i++) {
+        sRing.pCells[i].nSeq = nBase + i;
+    }
+    sRing.nHead = nBase;
+    sRing.nTail = nBase;
+    ring_laps(&sRing, nCells, 16);
+    assert(sRing.nTail - nBase > nCells * 4);
+    OMX_TI_RingDeinit(&sRing);
+
+    assert(OMX_TI_RingInit(&sRing, TEST_RING_CELLS));
+    for (i = 0; i < TEST_PRODUCERS; i++) {
+        aProducers[i].pRing = &sRing;
+        aProducers[i].nId = i;
+        aProducers[i].nCount = nIterations * 1000;
+        aProducers[i].nFull = 0;
+        aNext[i] = 0;
+        nTotal += aProducers[i].nCount;
+    }
+    t1 = test_now_us();
+    for (i = 0; i < TEST_PRODUCERS; i++) {
+        assert(pthread_create(&aThreads[i], NULL, ring_producer, &aProducers[i]) == 0);
+    }
+    while (nReceived < nTotal) {
+        if (!OMX_TI_RingGet(&sRing, &sEntry)) {
+            sched_yield();
+            continue;
+        }
+        assert(sEntry.nParam1 < TEST_PRODUCERS);
+        assert(sEntry.pData == &aProducers[sEntry.nParam1]);
+        assert(sEntry.nParam2 == aNext[sEntry.nParam1]);
+        aNext[sEntry.nParam1]++;
+        nReceived++;
+    }
+    for (i = 0; i < TEST_PRODUCERS; i++) {
+        pthread_join(aThreads[i], NULL);
+        assert(aNext[i] == aProducers[i].nCount);
+        nFull += aProducers[i].nFull;
+    }
+    t2 = test_now_us();
+    assert(OMX_TI_RingEmpty(&sRing));
+    OMX_TI_RingDeinit(&sRing);
+    printf("ring: %d producers, %lu entries, %lu puts found it full, %.1f ns/entry\n",
+           TEST_PRODUCERS, (unsigned long)nTotal, (unsigned long)nFull,
+           (t2 - t1) * 1000.0 / nTotal);
+}
+
+int main (int argc, char **argv)
+{
+    OMX_U8 *pData;
+    OMX_U8 *pFields;
+    OMX_U32 i;
+
+    if (argc > 1) {
+        nSeed = strtoul(argv[1], NULL, 0);
+    }
+    if (argc > 2) {
+        nIterations = strtoul(argv[2], NULL, 0);
+    }
+    printf("seed %lu, %lu iterations\n", nSeed, nIterations);
+
+    pData = malloc(TEST_BUFFER_SIZE);
+    pFields = malloc(TEST_FIELDS);
+    assert(pData != NULL && pFields != NULL);
+    for (i = 0; i < TEST_BUFFER_SIZE; i++) {
+        /* sparse bits so that ue(v) codes of every length show up */
+        pData[i] = (OMX_U8)(test_rand() & test_rand());
+    }
+    make_fields(pFields, TEST_FIELDS);
+
+    bitreader_unit_test(pData, pFields);
+    bitreader_perf_test(pData, pFields);
+    nalscan_unit_test();
+    nalscan_perf_test();
+    nalpack_unit_test();
+    nalprepend_unit_test();
+    m4vheader_perf_test();
+    seqheader_perf_test();
+    avcheader_perf_test();
+    seirecovery_unit_test();
+    configcache_unit_test();
+    ptsheap_unit_test();
+    downscale_unit_test();
+    mberrormap_unit_test();
+    ring_unit_test();
+
+    free(pFields);
+    free(pData);
+    return(0);
+}
+
+#endif
@@ -89,6 +89,10 @@ typedef enum
     EMMCodecStream20
 }TMMCodecBufferType;
 
+/* ORed into an EMMCodecStreamN type: keep the DSP mapping of the buffer
+   for later queue calls, as the MapReuse types do for streams 0 and 1 */
+#define EMMCodecStreamMapReuse 0x10000
+
 
 /**
  * Generic interface provided to write and codec needs to implement all 
@@ -241,6 +241,7 @@ typedef struct DMM_BUFFER_OBJ {
     void* paramReserved;
 /*  void* structReserved;*/
     int nSize;
+    int bKeepMapped;    /* buffer mapping owned by the reuse table, not unmapped on return */
 } DMM_BUFFER_OBJ;
 
 /* ======================================================================= */
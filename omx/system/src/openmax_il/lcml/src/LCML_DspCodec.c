@@ -870,6 +870,7 @@ static OMX_ERRORTYPE QueueBuffer (OMX_HANDLETYPE hComponent,
     int commandId;
     struct DSP_MSG msg;
     OMX_U32 MapBufLen=0;
+    OMX_U32 ReUseMap=0;
     OMX_BOOL mappedBufferFound = false;
 
     OMX_PRINT1 (((LCML_CODEC_INTERFACE *)hComponent)->dbg, "%d :: QueueBuffer application\n",__LINE__);
@@ -921,6 +922,12 @@ static OMX_ERRORTYPE QueueBuffer (OMX_HANDLETYPE hComponent,
     phandle->iBufinputcount = phandle->iBufinputcount % QUEUE_SIZE;
     phandle->commStruct->Bufoutindex = phandle->iBufoutputcount;
     phandle->commStruct->BufInindex = phandle->iBufinputcount;
+    if (bufType & EMMCodecStreamMapReuse)
+    {
+        bufType = (TMMCodecBufferType)(bufType & ~EMMCodecStreamMapReuse);
+        ReUseMap = 1;
+        phandle->ReUseMap = 1;
+    }
     switch (bufType)
     {
         case EMMCodecInputBufferMapBufLen:
@@ -933,10 +940,12 @@ static OMX_ERRORTYPE QueueBuffer (OMX_HANDLETYPE hComponent,
             break;
         case EMMCodecInputBufferMapReuse:
             bufType = EMMCodecInputBuffer;
+            ReUseMap = 1;
             phandle->ReUseMap = 1;
             break;
         case EMMCodecOutputBufferMapReuse:
             bufType = EMMCodecOuputBuffer;
+            ReUseMap = 1;
             phandle->ReUseMap = 1;
             break;
         default:
@@ -995,11 +1004,24 @@ static OMX_ERRORTYPE QueueBuffer (OMX_HANDLETYPE hComponent,
         OMX_U32 i;
         DSP_STATUS status;
 
-        if (phandle->ReUseMap)
+        if (ReUseMap)
         {
             mappedBufferFound = false;
-            for(i = 0; i <= phandle->mapped_buffer_count; i++)
+            for(i = 0; i < phandle->mapped_buffer_count; i++)
             {
+                if(phandle->mapped_dmm_buffers[i].pAllocated == buffer &&
+                   phandle->mapped_dmm_buffers[i].nSize < bufferLen)
+                {
+                    /* freed and reallocated larger at the same address: the
+                       kept mapping is too small, drop it and map again */
+                    OMX_PRBUFFER2 (((LCML_CODEC_INTERFACE *)hComponent)->dbg, "Stale DMM mapping for %p (%d < %ld), remapping\n",
+                        buffer, phandle->mapped_dmm_buffers[i].nSize, bufferLen);
+                    DmmUnMap(phandle->dspCodec->hProc, (void*)phandle->mapped_dmm_buffers[i].pMapped,
+                             phandle->mapped_dmm_buffers[i].bufReserved, ((LCML_CODEC_INTERFACE *)hComponent)->dbg);
+                    phandle->mapped_dmm_buffers[i] = phandle->mapped_dmm_buffers[--phandle->mapped_buffer_count];
+                    memset(&phandle->mapped_dmm_buffers[phandle->mapped_buffer_count], 0, sizeof(DMM_BUFFER_OBJ));
+                    break;
+                }
                 if(phandle->mapped_dmm_buffers[i].pAllocated == buffer)
                 {
                     mappedBufferFound = true;
@@ -1060,10 +1082,17 @@ static OMX_ERRORTYPE QueueBuffer (OMX_HANDLETYPE hComponent,
                 phandle->commStruct->iBufferPtr = (OMX_U32) pDmmBuf->pMapped;
                 /* storing reserve address for buffer */
                 pDmmBuf->bufReserved = pDmmBuf->pReserved;
-                if(phandle->mapped_buffer_count <= MAX_DMM_BUFFERS)
+                if(phandle->mapped_buffer_count < MAX_DMM_BUFFERS)
                 {
+                    pDmmBuf->bKeepMapped = 1;
                     phandle->mapped_dmm_buffers[phandle->mapped_buffer_count++] = *pDmmBuf;
                 }
+                else
+                {
+                    /* not kept, unmapped when the DSP returns it like any other buffer */
+                    OMX_PRBUFFER2 (((LCML_CODEC_INTERFACE *)hComponent)->dbg, "DMM reuse table full, buffer %p mapped per call\n", buffer);
+                    pDmmBuf->bKeepMapped = 0;
+                }
             }
         phandle->commStruct->iBufferPtr = (OMX_U32) pDmmBuf->pMapped;
         }
@@ -1095,6 +1124,7 @@ static OMX_ERRORTYPE QueueBuffer (OMX_HANDLETYPE hComponent,
             }
             phandle->commStruct->iBufferPtr = (OMX_U32) pDmmBuf->pMapped;
             pDmmBuf->bufReserved = pDmmBuf->pReserved;
+            pDmmBuf->bKeepMapped = 0;
         }
 
     }
@@ -1243,7 +1273,7 @@ static OMX_ERRORTYPE ControlCodec(OMX_HANDLETYPE hComponent,
                 pthread_mutex_unlock(&phandle->m_isStopped_mutex);
             }
 
-            if (phandle->ReUseMap)
+            if (phandle->mapped_buffer_count != 0)
             {
                 OMX_U32 i;
 
@@ -1254,7 +1284,7 @@ static OMX_ERRORTYPE ControlCodec(OMX_HANDLETYPE hComponent,
                             phandle->mapped_dmm_buffers[i].bufReserved, ((LCML_CODEC_INTERFACE *)hComponent)->dbg);
                 }
 
-                for(i = 0; i <= phandle->mapped_buffer_count; i++)
+                for(i = 0; i < phandle->mapped_buffer_count; i++)
                 {
                     phandle->mapped_dmm_buffers[i].pAllocated = 0;
                     phandle->mapped_dmm_buffers[i].pReserved = 0;
@@ -1262,6 +1292,7 @@ static OMX_ERRORTYPE ControlCodec(OMX_HANDLETYPE hComponent,
                     phandle->mapped_dmm_buffers[i].bufReserved = 0;
                     phandle->mapped_dmm_buffers[i].paramReserved = 0;
                     phandle->mapped_dmm_buffers[i].nSize = 0;
+                    phandle->mapped_dmm_buffers[i].bKeepMapped = 0;
                 }
 
                 phandle->mapped_buffer_count = 0;
@@ -1895,7 +1926,7 @@ void* MessagingThread(void* arg)
                                         "GOT MESSAGE EMMCodecBufferProcessed and now unmapping buufer %lx\n size=%ld",
                                              tmpDspStructAddress ->iBufferPtr, tmpDspStructAddress ->iBufferSize);
                                 /* 720p implementation */
-                                if (!hDSPInterface->ReUseMap)
+                                if (!pDmmBuf->bKeepMapped)
                                 {
                                     DmmUnMap(hDSPInterface->dspCodec->hProc,
                                             (void*)tmpDspStructAddress->iBufferPtr,
@@ -1986,7 +2017,7 @@ void* MessagingThread(void* arg)
                                             (void *)msg.dwArg1);
                                     if (tmpDspStructAddress->iBufferPtr != (OMX_U32)NULL)
                                     {
-                                        if (!hDSPInterface->ReUseMap)
+                                        if (!pDmmBuf->bKeepMapped)
                                         {
                                             DmmUnMap(hDSPInterface->dspCodec->hProc,
                                                     (void*)tmpDspStructAddress->iBufferPtr,
@@ -2056,7 +2087,7 @@ void* MessagingThread(void* arg)
                                     {
                                         OMX_PRINT1 (((LCML_CODEC_INTERFACE *)((LCML_DSP_INTERFACE *)arg)->pCodecinterfacehandle)->dbg, 
                                                 "tmpDspStructAddress ->iBufferPtr is not NULL\n");
-                                        if (!hDSPInterface->ReUseMap)
+                                        if (!pDmmBuf->bKeepMapped)
                                         {
                                             DmmUnMap(hDSPInterface->dspCodec->hProc,
                                                     (void*)tmpDspStructAddress->iBufferPtr,
@@ -2204,7 +2235,7 @@ void* MessagingThread(void* arg)
                                     if (tmpDspStructAddress->iBufferPtr != (OMX_U32)NULL)
                                     {
                                         /* 720p implementation */
-                                        if (!hDSPInterface->ReUseMap)
+                                        if (!pDmmBuf->bKeepMapped)
                                         {
                                             DmmUnMap(hDSPInterface->dspCodec->hProc,
                                                     (void*)tmpDspStructAddress->iBufferPtr,
@@ -2306,7 +2337,7 @@ void* MessagingThread(void* arg)
                                         /* 720p implementation */
                                         OMX_PRINT1 (((LCML_CODEC_INTERFACE *)((LCML_DSP_INTERFACE *)arg)->pCodecinterfacehandle)->dbg, 
                                                 "tmpDspStructAddress ->iBufferPtr is not NULL\n");
-                                        if (!hDSPInterface->ReUseMap)
+                                        if (!pDmmBuf->bKeepMapped)
                                         {
                                             DmmUnMap(hDSPInterface->dspCodec->hProc,
                                                     (void*)tmpDspStructAddress->iBufferPtr,
@@ -2411,7 +2442,7 @@ void* MessagingThread(void* arg)
                                     if (tmpDspStructAddress->iBufferPtr != (OMX_U32)NULL)
                                     {
                                         /* 720p implementation */
-                                        if (!hDSPInterface->ReUseMap)
+                                        if (!pDmmBuf->bKeepMapped)
                                         {
                                             DmmUnMap(hDSPInterface->dspCodec->hProc,
                                                     (void*)tmpDspStructAddress->iBufferPtr,
@@ -2492,7 +2523,7 @@ void* MessagingThread(void* arg)
                                         /* 720p implementation */
                                         OMX_PRINT1 (((LCML_CODEC_INTERFACE *)((LCML_DSP_INTERFACE *)arg)->pCodecinterfacehandle)->dbg, 
                                                 "tmpDspStructAddress ->iBufferPtr is not NULL\n");
-                                        if (!hDSPInterface->ReUseMap)
+                                        if (!pDmmBuf->bKeepMapped)
                                         {
                                             DmmUnMap(hDSPInterface->dspCodec->hProc,
                                                     (void*)tmpDspStructAddress->iBufferPtr,
@@ -20,3 +20,9 @@ typedef struct _ComponentTable {
 /* function prototypes */
 OMX_ERRORTYPE TIOMX_BuildComponentTable();
 
+/* call metrics, OMX_CoreMetrics.c */
+void TIOMX_MetricsInit();
+OMX_HANDLETYPE TIOMX_MetricsAllocHandle();
+void TIOMX_MetricsWrapHandle(OMX_HANDLETYPE hComponent);
+void TIOMX_MetricsDumpHandle(OMX_HANDLETYPE hComponent, OMX_STRING cComponentName);
+
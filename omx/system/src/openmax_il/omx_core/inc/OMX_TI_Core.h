@@ -0,0 +1,95 @@
+/* ====================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+* (c) Copyright Texas Instruments, Incorporated. All Rights Reserved.
+*
+* Use of this software is controlled by the terms and conditions found
+* in the license agreement under which this software has been supplied.
+* ==================================================================== */
+
+/** OMX_TI_Core.h
+ *  TI specific extensions to the OMX core, shared by the core and the
+ *  TI components.
+ */
+
+#ifndef OMX_TI_Core_h
+#define OMX_TI_Core_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#include <OMX_Core.h>
+
+/** Vendor bit in OMX_TUNNELSETUPTYPE::nTunnelFlags.
+ *  TIOMX_SetupTunnel() sets it when both ends of the tunnel are TI
+ *  components. A port that keeps the flag passes buffer ownership straight
+ *  to the peer and keeps the DSP (DMM) mapping of the tunnel buffers alive
+ *  across hops instead of re-mapping them for every LCML submission.
+ *  The input port may clear it to fall back to a standard tunnel.
+ */
+#define OMX_TI_PORTTUNNELFLAG_PROPRIETARY 0x00010000
+
+/** Component entry points and client callbacks timed by the core when
+ *  call metrics are enabled (setprop debug.omx.ti.metrics 1, read at the
+ *  first TIOMX_Init). When disabled the handle returned by TIOMX_GetHandle
+ *  is not wrapped and no call pays for the instrumentation.
+ */
+typedef enum TIOMX_METRICS_APITYPE {
+    TIOMX_MetricsEmptyThisBuffer = 0,
+    TIOMX_MetricsFillThisBuffer,
+    TIOMX_MetricsSendCommand,
+    TIOMX_MetricsGetParameter,
+    TIOMX_MetricsSetParameter,
+    TIOMX_MetricsGetConfig,
+    TIOMX_MetricsSetConfig,
+    TIOMX_MetricsEventHandler,      /* client callback turnaround */
+    TIOMX_MetricsEmptyBufferDone,   /* client callback turnaround */
+    TIOMX_MetricsFillBufferDone,    /* client callback turnaround */
+    TIOMX_MetricsMax
+} TIOMX_METRICS_APITYPE;
+
+/** Bucket n of the histogram counts calls that took [2^n, 2^(n+1)) us,
+ *  bucket 0 also holds sub-microsecond calls and the last bucket is open. */
+#define TIOMX_METRICS_HISTOGRAM_BUCKETS 20
+
+typedef struct TIOMX_METRICS_ENTRYTYPE {
+    OMX_U32 nCount;
+    OMX_U32 nMaxUs;
+    OMX_U64 nTotalUs;
+    OMX_U32 nHistogram[TIOMX_METRICS_HISTOGRAM_BUCKETS];
+} TIOMX_METRICS_ENTRYTYPE;
+
+typedef struct TIOMX_METRICSTYPE {
+    TIOMX_METRICS_ENTRYTYPE sApi[TIOMX_MetricsMax];
+} TIOMX_METRICSTYPE;
+
+/** Snapshot of the call metrics of one handle. Returns
+ *  OMX_ErrorNotImplemented when metrics are disabled. */
+OMX_API OMX_ERRORTYPE TIOMX_GetHandleMetrics(
+    OMX_IN  OMX_HANDLETYPE hComponent,
+    OMX_OUT TIOMX_METRICSTYPE *pMetrics);
+
+/** Hints for TIOMX_PrewarmComponent(). nTimeoutMs is how long the
+ *  pre-warmed instance is kept for a TIOMX_GetHandle() before it is
+ *  released, 0 selects the core default. DSP resources are still
+ *  allocated on the Loaded to Idle transition, as the LCML node can not be
+ *  created before the ports are populated.
+ */
+typedef struct TIOMX_PREWARMHINTSTYPE {
+    OMX_U32 nSize;
+    OMX_U32 nTimeoutMs;
+} TIOMX_PREWARMHINTSTYPE;
+
+/** Loads cComponentName in the background and constructs it up to
+ *  OMX_StateLoaded, optionally setting cRole. A later TIOMX_GetHandle() for
+ *  the same name adopts the instance. */
+OMX_API OMX_ERRORTYPE TIOMX_PrewarmComponent(
+    OMX_IN OMX_STRING cComponentName,
+    OMX_IN OMX_STRING cRole,
+    OMX_IN TIOMX_PREWARMHINTSTYPE *pHints);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* OMX_TI_Core_h */
@@ -5,7 +5,8 @@ include $(CLEAR_VARS)
 
 
 LOCAL_SRC_FILES:= \
-	OMX_Core.c
+	OMX_Core.c \
+	OMX_CoreMetrics.c
 
 LOCAL_C_INCLUDES += \
 	$(TI_OMX_INCLUDES) \
@@ -13,6 +14,7 @@ LOCAL_C_INCLUDES += \
 
 LOCAL_SHARED_LIBRARIES := \
 	libdl \
+	libcutils \
 	liblog
 	
 LOCAL_CFLAGS := $(TI_OMX_CFLAGS)
@@ -11,6 +11,8 @@
 #include <string.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <errno.h>
+#include <time.h>
 #include <utils/Log.h>
 
 #undef LOG_TAG
@@ -19,6 +21,7 @@
 #include "OMX_Component.h"
 #include "OMX_Core.h"
 #include "OMX_ComponentRegistry.h"
+#include "OMX_TI_Core.h"
 
 #ifndef NO_OPENCORE
 /** determine capabilities of a component before acually using it */
@@ -29,6 +32,11 @@
  * number of components that can be allocated at once */
 #define MAXCOMP (50)
 #define MAXNAMESIZE (130)
+
+/** number of components that can be pre-warmed at once, and how long a
+ * pre-warmed instance waits for its TIOMX_GetHandle() by default */
+#define MAXPREWARM (4)
+#define PREWARM_TIMEOUT_MS (3000)
 #define EMPTY_STRING "\0"
 
 /** Determine the number of elements in an array */
@@ -130,6 +138,7 @@ OMX_ERRORTYPE TIOMX_Init()
 
     if (count == 1)
     {
+        TIOMX_MetricsInit();
         eError = TIOMX_BuildComponentTable();
     }
 
@@ -140,6 +149,395 @@ OMX_ERRORTYPE TIOMX_Init()
     }
     return eError;
 }
+/* Loads lib<cComponentName>.so and runs its OMX_ComponentInit(). On
+ * success the component is in OMX_StateLoaded, without callbacks. Called
+ * either with the core mutex held or from a pre-warm thread. */
+static OMX_ERRORTYPE TIOMX_LoadComponent(OMX_STRING cComponentName,
+    void** ppModule, OMX_HANDLETYPE* pHandle)
+{
+    static const char prefix[] = "lib";
+    static const char postfix[] = ".so";
+    OMX_ERRORTYPE (*pComponentInit)(OMX_HANDLETYPE*);
+    OMX_ERRORTYPE err = OMX_ErrorNone;
+    OMX_COMPONENTTYPE *componentType;
+    const char* pErr = dlerror();
+
+    /* load the component and check for an error.  If filename is not an
+     * absolute path (i.e., it does not  begin with a "/"), then the
+     * file is searched for in the following locations:
+     *
+     *     The LD_LIBRARY_PATH environment variable locations
+     *     The library cache, /etc/ld.so.cache.
+     *     /lib
+     *     /usr/lib
+     *
+     * If there is an error, we can't go on, so set the error code and exit */
+
+    /* the lengths are defined herein or have been
+     * checked already, so strcpy and strcat are
+     * are safe to use in this context. */
+    char buf[sizeof(prefix) + MAXNAMESIZE + sizeof(postfix)];
+    strcpy(buf, prefix);
+    strcat(buf, cComponentName);
+    strcat(buf, postfix);
+
+    *pHandle = NULL;
+    *ppModule = dlopen(buf, RTLD_LAZY | RTLD_GLOBAL);
+    if( *ppModule == NULL ) {
+        ALOGE("dlopen %s failed because %s\n", buf, dlerror());
+        return OMX_ErrorComponentNotFound;
+    }
+
+    /* Get a function pointer to the "OMX_ComponentInit" function.  If
+     * there is an error, we can't go on, so set the error code and exit */
+    pComponentInit = dlsym(*ppModule, "OMX_ComponentInit");
+    pErr = dlerror();
+    if( (pErr != NULL) || (pComponentInit == NULL) ) {
+        ALOGE("%d:: dlsym failed for module %p\n", __LINE__, *ppModule);
+        err = OMX_ErrorInvalidComponent;
+        goto CLEAN_UP;
+    }
+
+   /* We now can access the dll.  So, we need to call the "OMX_ComponentInit"
+    * method to load up the "handle" (which is just a list of functions to
+    * call) and we should be all set.*/
+    *pHandle = TIOMX_MetricsAllocHandle();
+    if(*pHandle == NULL) {
+        err = OMX_ErrorInsufficientResources;
+        ALOGE("%d:: malloc of pHandle* failed\n", __LINE__);
+        goto CLEAN_UP;
+    }
+
+    componentType = (OMX_COMPONENTTYPE*) *pHandle;
+    componentType->nSize = sizeof(OMX_COMPONENTTYPE);
+    err = (*pComponentInit)(*pHandle);
+    if (OMX_ErrorNone != err) {
+        ALOGE("%d :: Core: OMX_ComponentInit of %s failed %x\n",__LINE__, cComponentName, err);
+        goto CLEAN_UP;
+    }
+    TIOMX_MetricsWrapHandle(*pHandle);
+    return OMX_ErrorNone;
+
+CLEAN_UP:
+    if(*pHandle != NULL)
+    {
+        free(*pHandle);
+        *pHandle = NULL;
+    }
+    dlclose(*ppModule);
+    *ppModule = NULL;
+    return err;
+}
+
+/*************************************************************************
+* Component pre-warm
+*
+* TIOMX_PrewarmComponent() loads a component and runs its construction up
+* to OMX_StateLoaded in a background thread. The next TIOMX_GetHandle()
+* for the same name adopts that instance instead of loading it again. An
+* instance that is not adopted within its timeout is reclaimed by the
+* same thread. All slot state is protected by the core mutex.
+**************************************************************************/
+typedef enum TIOMX_PREWARM_STATE {
+    TIOMX_PrewarmFree = 0,
+    TIOMX_PrewarmLoading,
+    TIOMX_PrewarmReady,
+    TIOMX_PrewarmAdopted
+} TIOMX_PREWARM_STATE;
+
+typedef struct TIOMX_PREWARM {
+    TIOMX_PREWARM_STATE eState;
+    char cComponentName[MAXNAMESIZE];
+    char cRole[OMX_MAX_STRINGNAME_SIZE];
+    OMX_U32 nTimeoutMs;
+    OMX_BOOL bCancel;
+    void* pModule;
+    OMX_HANDLETYPE hComponent;
+} TIOMX_PREWARM;
+
+static TIOMX_PREWARM sPrewarm[MAXPREWARM];
+static pthread_cond_t prewarmCond = PTHREAD_COND_INITIALIZER;
+
+/* Callbacks of a pre-warmed instance until it is adopted: the component
+ * gets a valid callback table before any parameter call, and nothing it
+ * reports while nobody owns it reaches a client. */
+static OMX_ERRORTYPE TIOMX_PrewarmEventHandler(OMX_HANDLETYPE hComponent,
+    OMX_PTR pAppData, OMX_EVENTTYPE eEvent, OMX_U32 nData1, OMX_U32 nData2,
+    OMX_PTR pEventData)
+{
+    ALOGD("pre-warm: event %d (%lx, %lx) from %p dropped\n", eEvent,
+          (unsigned long)nData1, (unsigned long)nData2, hComponent);
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE TIOMX_PrewarmBufferDone(OMX_HANDLETYPE hComponent,
+    OMX_PTR pAppData, OMX_BUFFERHEADERTYPE* pBuffer)
+{
+    return OMX_ErrorNone;
+}
+
+static OMX_CALLBACKTYPE sPrewarmCallbacks = {
+    TIOMX_PrewarmEventHandler,
+    TIOMX_PrewarmBufferDone,
+    TIOMX_PrewarmBufferDone
+};
+
+/* Number of pre-warmed instances of cComponentName, loading or waiting
+ * to be adopted. They count against MAX_CONCURRENT_INSTANCES like live
+ * handles. Must be called with the core mutex held. */
+static int TIOMX_CountPrewarms(OMX_STRING cComponentName)
+{
+    int i;
+    int nCount = 0;
+
+    for (i = 0; i < MAXPREWARM; i++) {
+        if ((sPrewarm[i].eState == TIOMX_PrewarmLoading ||
+             sPrewarm[i].eState == TIOMX_PrewarmReady) &&
+            strcmp(sPrewarm[i].cComponentName, cComponentName) == 0) {
+            nCount++;
+        }
+    }
+    return nCount;
+}
+
+static void* TIOMX_PrewarmThread(void* pArg)
+{
+    TIOMX_PREWARM* pPrewarm = (TIOMX_PREWARM*)pArg;
+    OMX_COMPONENTTYPE* pComp = NULL;
+    void* pModule = NULL;
+    OMX_HANDLETYPE hComponent = NULL;
+    OMX_PARAM_COMPONENTROLETYPE sRole;
+    OMX_ERRORTYPE err = OMX_ErrorNone;
+    struct timespec sDeadline;
+
+    err = TIOMX_LoadComponent(pPrewarm->cComponentName, &pModule, &hComponent);
+    if (err == OMX_ErrorNone) {
+        /* TIOMX_GetHandle() replaces these with the client's on adoption */
+        pComp = (OMX_COMPONENTTYPE*)hComponent;
+        err = pComp->SetCallbacks(hComponent, &sPrewarmCallbacks, NULL);
+        if (err != OMX_ErrorNone) {
+            pComp->ComponentDeInit(hComponent);
+            free(hComponent);
+            dlclose(pModule);
+        }
+    }
+    if (err == OMX_ErrorNone && pPrewarm->cRole[0] != '\0') {
+        memset(&sRole, 0, sizeof(sRole));
+        sRole.nSize = sizeof(sRole);
+        sRole.nVersion.s.nVersionMajor = 1;
+        sRole.nVersion.s.nVersionMinor = 1;
+        strncpy((char*)sRole.cRole, pPrewarm->cRole, OMX_MAX_STRINGNAME_SIZE - 1);
+        if (pComp->SetParameter(hComponent, OMX_IndexParamStandardComponentRole, &sRole) != OMX_ErrorNone) {
+            ALOGW("pre-warm: %s rejected role %s\n", pPrewarm->cComponentName, pPrewarm->cRole);
+        }
+    }
+
+    pthread_mutex_lock(&mutex);
+    if (err != OMX_ErrorNone) {
+        ALOGE("pre-warm of %s failed %x\n", pPrewarm->cComponentName, err);
+        pPrewarm->eState = TIOMX_PrewarmFree;
+        pthread_cond_broadcast(&prewarmCond);
+        pthread_mutex_unlock(&mutex);
+        return NULL;
+    }
+
+    pPrewarm->pModule = pModule;
+    pPrewarm->hComponent = hComponent;
+    pPrewarm->eState = TIOMX_PrewarmReady;
+    pthread_cond_broadcast(&prewarmCond);
+
+    clock_gettime(CLOCK_REALTIME, &sDeadline);
+    sDeadline.tv_sec += pPrewarm->nTimeoutMs / 1000;
+    sDeadline.tv_nsec += (pPrewarm->nTimeoutMs % 1000) * 1000000;
+    if (sDeadline.tv_nsec >= 1000000000) {
+        sDeadline.tv_sec++;
+        sDeadline.tv_nsec -= 1000000000;
+    }
+    while (pPrewarm->eState == TIOMX_PrewarmReady && !pPrewarm->bCancel) {
+        if (pthread_cond_timedwait(&prewarmCond, &mutex, &sDeadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+
+    if (pPrewarm->eState == TIOMX_PrewarmReady) {
+        /* nobody asked for it, reclaim */
+        ALOGD("pre-warmed %s not used, releasing\n", pPrewarm->cComponentName);
+        pComp = (OMX_COMPONENTTYPE*)pPrewarm->hComponent;
+        pComp->ComponentDeInit(pPrewarm->hComponent);
+        free(pPrewarm->hComponent);
+        dlclose(pPrewarm->pModule);
+    }
+    pPrewarm->pModule = NULL;
+    pPrewarm->hComponent = NULL;
+    pPrewarm->eState = TIOMX_PrewarmFree;
+    pthread_cond_broadcast(&prewarmCond);
+    pthread_mutex_unlock(&mutex);
+
+    return NULL;
+}
+
+/* Waits until no pre-warm of cComponentName is still loading. Drops the
+ * core mutex while waiting, so the caller must look at the core tables only
+ * after this returns. Must be called with the core mutex held. */
+static void TIOMX_WaitPrewarm(OMX_STRING cComponentName)
+{
+    int i = 0;
+
+    while (i < MAXPREWARM) {
+        if (sPrewarm[i].eState == TIOMX_PrewarmLoading &&
+            strcmp(sPrewarm[i].cComponentName, cComponentName) == 0) {
+            pthread_cond_wait(&prewarmCond, &mutex);
+            /* another pre-warm may have started while unlocked, rescan */
+            i = 0;
+            continue;
+        }
+        i++;
+    }
+}
+
+/* Hands a ready pre-warmed instance of cComponentName over to the caller.
+ * Never drops the core mutex; call TIOMX_WaitPrewarm() first so that an
+ * instance still loading is not missed. Must be called with the core
+ * mutex held. */
+static OMX_BOOL TIOMX_AdoptPrewarm(OMX_STRING cComponentName,
+    void** ppModule, OMX_HANDLETYPE* pHandle)
+{
+    int i;
+
+    for (i = 0; i < MAXPREWARM; i++) {
+        if (sPrewarm[i].eState == TIOMX_PrewarmReady &&
+            strcmp(sPrewarm[i].cComponentName, cComponentName) == 0) {
+            ALOGD("adopting pre-warmed %s\n", cComponentName);
+            *ppModule = sPrewarm[i].pModule;
+            *pHandle = sPrewarm[i].hComponent;
+            sPrewarm[i].eState = TIOMX_PrewarmAdopted;
+            pthread_cond_broadcast(&prewarmCond);
+            return OMX_TRUE;
+        }
+    }
+    return OMX_FALSE;
+}
+
+/* Cancels every pending pre-warm and waits until the slots are released.
+ * Must be called with the core mutex held. */
+static void TIOMX_CancelPrewarms()
+{
+    int i;
+
+    for (i = 0; i < MAXPREWARM; i++) {
+        sPrewarm[i].bCancel = OMX_TRUE;
+    }
+    pthread_cond_broadcast(&prewarmCond);
+    for (i = 0; i < MAXPREWARM; i++) {
+        while (sPrewarm[i].eState != TIOMX_PrewarmFree) {
+            pthread_cond_wait(&prewarmCond, &mutex);
+        }
+    }
+}
+
+/*************************************************************************
+* TIOMX_PrewarmComponent()
+*
+* Description: Starts loading a component in the background so that a later
+* TIOMX_GetHandle() for the same name returns immediately.
+*
+* Parameters:
+* @param[in] cComponentName  Name of the component to load
+* @param[in] cRole           Standard role to set on the instance, may be NULL
+* @param[in] pHints          Optional hints, may be NULL
+*
+* Returns:    OMX_NOERROR                   Pre-warm started or already pending
+*             OMX_ErrorBadParameter         NULL or too long name/role
+*             OMX_ErrorComponentNotFound    Unknown component
+*             OMX_ErrorInsufficientResources  No free pre-warm slot, or the
+*                                           component is at its instance limit
+*             OMX_ErrorUndefined            Core not initialized
+*
+**************************************************************************/
+OMX_API OMX_ERRORTYPE TIOMX_PrewarmComponent(
+    OMX_IN OMX_STRING cComponentName,
+    OMX_IN OMX_STRING cRole,
+    OMX_IN TIOMX_PREWARMHINTSTYPE* pHints)
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    pthread_attr_t attr;
+    pthread_t thread;
+    int i = 0;
+    int nFree = -1;
+    int nInstances = 0;
+
+    if (cComponentName == NULL || strlen(cComponentName) >= MAXNAMESIZE ||
+        (cRole != NULL && strlen(cRole) >= OMX_MAX_STRINGNAME_SIZE)) {
+        return OMX_ErrorBadParameter;
+    }
+
+    if(pthread_mutex_lock(&mutex) != 0)
+    {
+        ALOGE("%d :: Core: Error in Mutex lock\n",__LINE__);
+        return OMX_ErrorUndefined;
+    }
+
+    if (!count) {
+        eError = OMX_ErrorUndefined;
+        goto EXIT;
+    }
+
+    for (i = 0; i < tableCount; i++) {
+        if (strcmp(componentTable[i].name, cComponentName) == 0) {
+            break;
+        }
+    }
+    if (i == tableCount) {
+        eError = OMX_ErrorComponentNotFound;
+        goto EXIT;
+    }
+    nInstances = componentTable[i].refCount;
+
+    for (i = 0; i < MAXPREWARM; i++) {
+        if (sPrewarm[i].eState == TIOMX_PrewarmFree) {
+            if (nFree < 0) {
+                nFree = i;
+            }
+        }
+        else if ((sPrewarm[i].eState == TIOMX_PrewarmLoading ||
+                  sPrewarm[i].eState == TIOMX_PrewarmReady) &&
+                 strcmp(sPrewarm[i].cComponentName, cComponentName) == 0) {
+            /* already on its way */
+            goto EXIT;
+        }
+    }
+    if (nFree < 0 ||
+        nInstances + TIOMX_CountPrewarms(cComponentName) >= MAX_CONCURRENT_INSTANCES) {
+        eError = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+
+    strcpy(sPrewarm[nFree].cComponentName, cComponentName);
+    strcpy(sPrewarm[nFree].cRole, cRole != NULL ? cRole : EMPTY_STRING);
+    sPrewarm[nFree].nTimeoutMs = (pHints != NULL && pHints->nTimeoutMs) ?
+                                  pHints->nTimeoutMs : PREWARM_TIMEOUT_MS;
+    sPrewarm[nFree].bCancel = OMX_FALSE;
+    sPrewarm[nFree].pModule = NULL;
+    sPrewarm[nFree].hComponent = NULL;
+    sPrewarm[nFree].eState = TIOMX_PrewarmLoading;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, TIOMX_PrewarmThread, &sPrewarm[nFree]) != 0) {
+        sPrewarm[nFree].eState = TIOMX_PrewarmFree;
+        eError = OMX_ErrorInsufficientResources;
+    }
+    pthread_attr_destroy(&attr);
+
+EXIT:
+    if(pthread_mutex_unlock(&mutex) != 0)
+    {
+        ALOGE("%d :: Core: Error in Mutex unlock\n",__LINE__);
+        return OMX_ErrorUndefined;
+    }
+    return eError;
+}
+
 /******************************Public*Routine******************************\
 * OMX_GetHandle
 *
@@ -167,12 +565,8 @@ OMX_ERRORTYPE TIOMX_Init()
 OMX_ERRORTYPE TIOMX_GetHandle( OMX_HANDLETYPE* pHandle, OMX_STRING cComponentName,
     OMX_PTR pAppData, OMX_CALLBACKTYPE* pCallBacks)
 {
-    static const char prefix[] = "lib";
-    static const char postfix[] = ".so";
-    OMX_ERRORTYPE (*pComponentInit)(OMX_HANDLETYPE*);
     OMX_ERRORTYPE err = OMX_ErrorNone;
     OMX_COMPONENTTYPE *componentType;
-    const char* pErr = dlerror();
 
     if(pthread_mutex_lock(&mutex) != 0)
     {
@@ -193,6 +587,12 @@ OMX_ERRORTYPE TIOMX_GetHandle( OMX_HANDLETYPE* pHandle, OMX_STRING cComponentNam
         err = OMX_ErrorInvalidComponentName;
         goto UNLOCK_MUTEX;
     }
+
+    /* A pre-warm of this component that is still loading drops the mutex
+     * while we wait for it, so do that before picking a slot and checking
+     * the instance limit. */
+    TIOMX_WaitPrewarm(cComponentName);
+
     /* Locate the first empty slot for a component.  If no slots
      * are available, error out */
     int i = 0;
@@ -211,7 +611,9 @@ OMX_ERRORTYPE TIOMX_GetHandle( OMX_HANDLETYPE* pHandle, OMX_STRING cComponentNam
             ALOGD("Found component %s with refCount %d\n",
                   cComponentName, componentTable[refIndex].refCount);
 
-            /* check if the component is already loaded */
+            /* check if the component is already loaded; a pre-warmed
+               instance was counted when it was started and is adopted
+               below, so refCount alone is the limit here */
             if (componentTable[refIndex].refCount >= MAX_CONCURRENT_INSTANCES) {
                 err = OMX_ErrorInsufficientResources;
                 ALOGE("Max instances of component %s already created.\n", cComponentName);
@@ -219,73 +621,28 @@ OMX_ERRORTYPE TIOMX_GetHandle( OMX_HANDLETYPE* pHandle, OMX_STRING cComponentNam
             } else {  // we have not reached the limit yet
                 /* do what was done before need to limit concurrent instances of each component */
 
-                /* load the component and check for an error.  If filename is not an
-                 * absolute path (i.e., it does not  begin with a "/"), then the
-                 * file is searched for in the following locations:
-                 *
-                 *     The LD_LIBRARY_PATH environment variable locations
-                 *     The library cache, /etc/ld.so.cache.
-                 *     /lib
-                 *     /usr/lib
-                 *
-                 * If there is an error, we can't go on, so set the error code and exit */
-
-                /* the lengths are defined herein or have been
-                 * checked already, so strcpy and strcat are
-                 * are safe to use in this context. */
-                char buf[sizeof(prefix) + MAXNAMESIZE + sizeof(postfix)];
-                strcpy(buf, prefix);
-                strcat(buf, cComponentName);
-                strcat(buf, postfix);
-
-                pModules[i] = dlopen(buf, RTLD_LAZY | RTLD_GLOBAL);
-                if( pModules[i] == NULL ) {
-                    ALOGE("dlopen %s failed because %s\n", buf, dlerror());
-                    err = OMX_ErrorComponentNotFound;
-                    goto UNLOCK_MUTEX;
-                }
-
-                /* Get a function pointer to the "OMX_ComponentInit" function.  If
-                 * there is an error, we can't go on, so set the error code and exit */
-                pComponentInit = dlsym(pModules[i], "OMX_ComponentInit");
-                pErr = dlerror();
-                if( (pErr != NULL) || (pComponentInit == NULL) ) {
-                    ALOGE("%d:: dlsym failed for module %p\n", __LINE__, pModules[i]);
-                    err = OMX_ErrorInvalidComponent;
-                    goto CLEAN_UP;
-                }
-
-               /* We now can access the dll.  So, we need to call the "OMX_ComponentInit"
-                * method to load up the "handle" (which is just a list of functions to
-                * call) and we should be all set.*/
-                *pHandle = malloc(sizeof(OMX_COMPONENTTYPE));
-                if(*pHandle == NULL) {
-                    err = OMX_ErrorInsufficientResources;
-                    ALOGE("%d:: malloc of pHandle* failed\n", __LINE__);
-                    goto CLEAN_UP;
+                /* adopt a pre-warmed instance if there is one, otherwise
+                   load the component now */
+                if (TIOMX_AdoptPrewarm(cComponentName, &pModules[i], pHandle) != OMX_TRUE) {
+                    err = TIOMX_LoadComponent(cComponentName, &pModules[i], pHandle);
+                    if (err != OMX_ErrorNone) {
+                        goto UNLOCK_MUTEX;
+                    }
                 }
 
                 pComponents[i] = *pHandle;
                 componentType = (OMX_COMPONENTTYPE*) *pHandle;
-                componentType->nSize = sizeof(OMX_COMPONENTTYPE);
-                err = (*pComponentInit)(*pHandle);
-                if (OMX_ErrorNone == err) {
-                    err = (componentType->SetCallbacks)(*pHandle, pCallBacks, pAppData);
-                    if (err != OMX_ErrorNone) {
-                        ALOGE("%d :: Core: SetCallBack failed %d\n",__LINE__, err);
-                        goto CLEAN_UP;
-                    }
-                    /* finally, OMX_ComponentInit() was successful and
-                       SetCallbacks was successful, we have a valid instance,
-                       so no we increment refCount */
-                    componentTable[refIndex].pHandle[componentTable[refIndex].refCount] = *pHandle;
-                    componentTable[refIndex].refCount += 1;
-                    goto UNLOCK_MUTEX;  // Component is found, and thus we are done
-                }
-                else if (err == OMX_ErrorInsufficientResources) {
-                        ALOGE("%d :: Core: Insufficient Resources for Component %d\n",__LINE__, err);
-                        goto CLEAN_UP;
+                err = (componentType->SetCallbacks)(*pHandle, pCallBacks, pAppData);
+                if (err != OMX_ErrorNone) {
+                    ALOGE("%d :: Core: SetCallBack failed %d\n",__LINE__, err);
+                    goto CLEAN_UP;
                 }
+                /* finally, OMX_ComponentInit() was successful and
+                   SetCallbacks was successful, we have a valid instance,
+                   so no we increment refCount */
+                componentTable[refIndex].pHandle[componentTable[refIndex].refCount] = *pHandle;
+                componentTable[refIndex].refCount += 1;
+                goto UNLOCK_MUTEX;  // Component is found, and thus we are done
             }
         }
     }
@@ -294,12 +651,9 @@ OMX_ERRORTYPE TIOMX_GetHandle( OMX_HANDLETYPE* pHandle, OMX_STRING cComponentNam
     err = OMX_ErrorComponentNotFound;
     goto UNLOCK_MUTEX;
 CLEAN_UP:
-    if(*pHandle != NULL)
-    /* cover the case where we error out before malloc'd */
-    {
-        free(*pHandle);
-        *pHandle = NULL;
-    }
+    componentType->ComponentDeInit(*pHandle);
+    free(*pHandle);
+    *pHandle = NULL;
     pComponents[i] = NULL;
     dlclose(pModules[i]);
     pModules[i] = NULL;
@@ -370,6 +724,7 @@ OMX_ERRORTYPE TIOMX_FreeHandle (OMX_HANDLETYPE hComponent)
                     componentTable[refIndex].refCount -= 1;
                 }
                 componentTable[refIndex].pHandle[handleIndex] = NULL;
+                TIOMX_MetricsDumpHandle(hComponent, componentTable[refIndex].name);
                 dlclose(pModules[i]);
                 pModules[i] = NULL;
                 free(pComponents[i]);
@@ -419,6 +774,10 @@ OMX_ERRORTYPE TIOMX_Deinit()
 
     ALOGD("deinit count = %d\n", count);
 
+    if (count == 0) {
+        TIOMX_CancelPrewarms();
+    }
+
     if(pthread_mutex_unlock(&mutex) != 0) {
         ALOGE("%d :: Core: Error in Mutex unlock\n",__LINE__);
         return OMX_ErrorUndefined;
@@ -427,6 +786,26 @@ OMX_ERRORTYPE TIOMX_Deinit()
     return OMX_ErrorNone;
 }
 
+/* Returns OMX_TRUE when hComp reports an "OMX.TI." component name */
+static OMX_BOOL TIOMX_IsTIComponent(OMX_HANDLETYPE hComp)
+{
+    OMX_COMPONENTTYPE *pComp = (OMX_COMPONENTTYPE*)hComp;
+    char cName[OMX_MAX_STRINGNAME_SIZE];
+    OMX_VERSIONTYPE sComponentVersion;
+    OMX_VERSIONTYPE sSpecVersion;
+    OMX_UUIDTYPE sComponentUUID;
+
+    if (pComp == NULL || pComp->GetComponentVersion == NULL)
+        return OMX_FALSE;
+
+    cName[0] = '\0';
+    if (pComp->GetComponentVersion(hComp, cName, &sComponentVersion,
+                                   &sSpecVersion, &sComponentUUID) != OMX_ErrorNone)
+        return OMX_FALSE;
+
+    return (strncmp(cName, "OMX.TI.", 7) == 0) ? OMX_TRUE : OMX_FALSE;
+}
+
 /*************************************************************************
 * OMX_SetupTunnel()
 *
@@ -453,6 +832,7 @@ OMX_API OMX_ERRORTYPE OMX_APIENTRY TIOMX_SetupTunnel(
     OMX_ERRORTYPE eError = OMX_ErrorNotImplemented;
     OMX_COMPONENTTYPE *pCompIn, *pCompOut;
     OMX_TUNNELSETUPTYPE oTunnelSetup;
+    OMX_BOOL bProprietary = OMX_FALSE;
 
     if (hOutput == NULL && hInput == NULL)
         return OMX_ErrorBadParameter;
@@ -460,6 +840,15 @@ OMX_API OMX_ERRORTYPE OMX_APIENTRY TIOMX_SetupTunnel(
     oTunnelSetup.nTunnelFlags = 0;
     oTunnelSetup.eSupplier = OMX_BufferSupplyUnspecified;
 
+    /* Between two TI components buffers are handed over directly and
+       the DSP mappings are kept alive across the hop */
+    if (hOutput && hInput &&
+        TIOMX_IsTIComponent(hOutput) && TIOMX_IsTIComponent(hInput))
+    {
+        bProprietary = OMX_TRUE;
+        oTunnelSetup.nTunnelFlags |= OMX_TI_PORTTUNNELFLAG_PROPRIETARY;
+    }
+
     pCompOut = (OMX_COMPONENTTYPE*)hOutput;
 
     if (hOutput)
@@ -477,6 +866,13 @@ OMX_API OMX_ERRORTYPE OMX_APIENTRY TIOMX_SetupTunnel(
             /* cancel tunnel request on output port since input port failed */
             pCompOut->ComponentTunnelRequest(hOutput, nPortOutput, NULL, 0, NULL);
         }
+        else if (eError == OMX_ErrorNone && bProprietary &&
+                 !(oTunnelSetup.nTunnelFlags & OMX_TI_PORTTUNNELFLAG_PROPRIETARY))
+        {
+            /* input port declined the proprietary tunnel, let the output
+               port fall back to a standard one */
+            eError = pCompOut->ComponentTunnelRequest(hOutput, nPortOutput, hInput, nPortInput, &oTunnelSetup);
+        }
     }
   
     return eError;
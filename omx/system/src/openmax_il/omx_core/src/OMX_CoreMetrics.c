@@ -0,0 +1,358 @@
+/* ====================================================================
+*             Texas Instruments OMAP(TM) Platform Software
+* (c) Copyright Texas Instruments, Incorporated. All Rights Reserved.
+*
+* Use of this software is controlled by the terms and conditions found
+* in the license agreement under which this software has been supplied.
+* ==================================================================== */
+
+/** OMX_CoreMetrics.c
+ *  Optional call interposition for handles created by TIOMX_GetHandle.
+ *  The handle memory is over-allocated so the core can keep the component's
+ *  own function table, the client callbacks and the counters right behind
+ *  the OMX_COMPONENTTYPE that is returned to the client. The shims find
+ *  their context from hComponent alone, and the counters are only touched
+ *  with atomic operations so concurrent client threads never serialize.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <utils/Log.h>
+#include <cutils/properties.h>
+
+#undef LOG_TAG
+#define LOG_TAG "TIOMX_CORE"
+
+#include "OMX_Component.h"
+#include "OMX_Core.h"
+#include "OMX_ComponentRegistry.h"
+#include "OMX_TI_Core.h"
+
+#define TIOMX_METRICS_MAGIC 0x4D455452  /* "METR" */
+
+typedef struct TIOMX_METRICS_HANDLE {
+    OMX_COMPONENTTYPE sComponent;       /* handle given to the client, must be first */
+    OMX_U32 nMagic;
+    OMX_COMPONENTTYPE sComponentOrig;   /* entry points filled in by the component */
+    OMX_CALLBACKTYPE sClientCallbacks;
+    TIOMX_METRICSTYPE sMetrics;
+} TIOMX_METRICS_HANDLE;
+
+/* read once per process: handles outlive TIOMX_Deinit() and must keep the
+   layout they were allocated with */
+static OMX_BOOL bMetricsEnabled = OMX_FALSE;
+static OMX_BOOL bMetricsRead = OMX_FALSE;
+
+static const char *sApiName[TIOMX_MetricsMax] = {
+    "EmptyThisBuffer",
+    "FillThisBuffer",
+    "SendCommand",
+    "GetParameter",
+    "SetParameter",
+    "GetConfig",
+    "SetConfig",
+    "EventHandler",
+    "EmptyBufferDone",
+    "FillBufferDone",
+};
+
+static inline OMX_U64 TIOMX_MetricsNowUs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (OMX_U64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void TIOMX_MetricsRecord(OMX_HANDLETYPE hComponent,
+                                TIOMX_METRICS_APITYPE eApi,
+                                OMX_U64 nStartUs)
+{
+    TIOMX_METRICS_ENTRYTYPE *pEntry =
+        &((TIOMX_METRICS_HANDLE *)hComponent)->sMetrics.sApi[eApi];
+    OMX_U32 nUs = (OMX_U32)(TIOMX_MetricsNowUs() - nStartUs);
+    OMX_U32 nMax = pEntry->nMaxUs;
+    int nBucket = 0;
+
+    if (nUs) {
+        nBucket = 31 - __builtin_clz(nUs);
+        if (nBucket >= TIOMX_METRICS_HISTOGRAM_BUCKETS) {
+            nBucket = TIOMX_METRICS_HISTOGRAM_BUCKETS - 1;
+        }
+    }
+
+    __sync_fetch_and_add(&pEntry->nCount, 1);
+    __sync_fetch_and_add(&pEntry->nTotalUs, (OMX_U64)nUs);
+    __sync_fetch_and_add(&pEntry->nHistogram[nBucket], 1);
+    while (nUs > nMax) {
+        OMX_U32 nPrev = __sync_val_compare_and_swap(&pEntry->nMaxUs, nMax, nUs);
+        if (nPrev == nMax) {
+            break;
+        }
+        nMax = nPrev;
+    }
+}
+
+#define TIOMX_METRICS_ORIG(_h_) (((TIOMX_METRICS_HANDLE *)(_h_))->sComponentOrig)
+#define TIOMX_METRICS_CLIENT(_h_) (((TIOMX_METRICS_HANDLE *)(_h_))->sClientCallbacks)
+
+/* component entry point shims */
+
+static OMX_ERRORTYPE TIOMX_Metrics_EmptyThisBuffer(OMX_HANDLETYPE hComponent,
+                                                   OMX_BUFFERHEADERTYPE *pBuffer)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_ORIG(hComponent).EmptyThisBuffer(hComponent, pBuffer);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsEmptyThisBuffer, nStart);
+    return eError;
+}
+
+static OMX_ERRORTYPE TIOMX_Metrics_FillThisBuffer(OMX_HANDLETYPE hComponent,
+                                                  OMX_BUFFERHEADERTYPE *pBuffer)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_ORIG(hComponent).FillThisBuffer(hComponent, pBuffer);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsFillThisBuffer, nStart);
+    return eError;
+}
+
+static OMX_ERRORTYPE TIOMX_Metrics_SendCommand(OMX_HANDLETYPE hComponent,
+                                               OMX_COMMANDTYPE Cmd,
+                                               OMX_U32 nParam1,
+                                               OMX_PTR pCmdData)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_ORIG(hComponent).SendCommand(hComponent, Cmd, nParam1, pCmdData);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsSendCommand, nStart);
+    return eError;
+}
+
+static OMX_ERRORTYPE TIOMX_Metrics_GetParameter(OMX_HANDLETYPE hComponent,
+                                                OMX_INDEXTYPE nIndex,
+                                                OMX_PTR pStructure)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_ORIG(hComponent).GetParameter(hComponent, nIndex, pStructure);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsGetParameter, nStart);
+    return eError;
+}
+
+static OMX_ERRORTYPE TIOMX_Metrics_SetParameter(OMX_HANDLETYPE hComponent,
+                                                OMX_INDEXTYPE nIndex,
+                                                OMX_PTR pStructure)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_ORIG(hComponent).SetParameter(hComponent, nIndex, pStructure);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsSetParameter, nStart);
+    return eError;
+}
+
+static OMX_ERRORTYPE TIOMX_Metrics_GetConfig(OMX_HANDLETYPE hComponent,
+                                             OMX_INDEXTYPE nIndex,
+                                             OMX_PTR pStructure)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_ORIG(hComponent).GetConfig(hComponent, nIndex, pStructure);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsGetConfig, nStart);
+    return eError;
+}
+
+static OMX_ERRORTYPE TIOMX_Metrics_SetConfig(OMX_HANDLETYPE hComponent,
+                                             OMX_INDEXTYPE nIndex,
+                                             OMX_PTR pStructure)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_ORIG(hComponent).SetConfig(hComponent, nIndex, pStructure);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsSetConfig, nStart);
+    return eError;
+}
+
+/* client callback shims */
+
+static OMX_ERRORTYPE TIOMX_Metrics_EventHandler(OMX_HANDLETYPE hComponent,
+                                                OMX_PTR pAppData,
+                                                OMX_EVENTTYPE eEvent,
+                                                OMX_U32 nData1,
+                                                OMX_U32 nData2,
+                                                OMX_PTR pEventData)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_CLIENT(hComponent).EventHandler(hComponent, pAppData,
+                                                                         eEvent, nData1, nData2, pEventData);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsEventHandler, nStart);
+    return eError;
+}
+
+static OMX_ERRORTYPE TIOMX_Metrics_EmptyBufferDone(OMX_HANDLETYPE hComponent,
+                                                   OMX_PTR pAppData,
+                                                   OMX_BUFFERHEADERTYPE *pBuffer)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_CLIENT(hComponent).EmptyBufferDone(hComponent, pAppData, pBuffer);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsEmptyBufferDone, nStart);
+    return eError;
+}
+
+static OMX_ERRORTYPE TIOMX_Metrics_FillBufferDone(OMX_HANDLETYPE hComponent,
+                                                  OMX_PTR pAppData,
+                                                  OMX_BUFFERHEADERTYPE *pBuffer)
+{
+    OMX_U64 nStart = TIOMX_MetricsNowUs();
+    OMX_ERRORTYPE eError = TIOMX_METRICS_CLIENT(hComponent).FillBufferDone(hComponent, pAppData, pBuffer);
+    TIOMX_MetricsRecord(hComponent, TIOMX_MetricsFillBufferDone, nStart);
+    return eError;
+}
+
+static OMX_CALLBACKTYPE sMetricsCallbacks = {
+    TIOMX_Metrics_EventHandler,
+    TIOMX_Metrics_EmptyBufferDone,
+    TIOMX_Metrics_FillBufferDone
+};
+
+static OMX_ERRORTYPE TIOMX_Metrics_SetCallbacks(OMX_HANDLETYPE hComponent,
+                                                OMX_CALLBACKTYPE *pCallbacks,
+                                                OMX_PTR pAppData)
+{
+    if (pCallbacks == NULL) {
+        return OMX_ErrorBadParameter;
+    }
+    /* the component only ever sees the shims, the client callbacks are
+       called from there */
+    TIOMX_METRICS_CLIENT(hComponent) = *pCallbacks;
+    return TIOMX_METRICS_ORIG(hComponent).SetCallbacks(hComponent, &sMetricsCallbacks, pAppData);
+}
+
+/*************************************************************************
+* TIOMX_MetricsInit()
+*
+* Description: Reads the debug.omx.ti.metrics property once, at the first
+* TIOMX_Init() of the process; later Deinit/Init cycles keep that choice.
+* Must be called with the core mutex held.
+*
+**************************************************************************/
+void TIOMX_MetricsInit()
+{
+    char value[PROPERTY_VALUE_MAX];
+
+    if (bMetricsRead) {
+        return;
+    }
+    bMetricsRead = OMX_TRUE;
+    property_get("debug.omx.ti.metrics", value, "0");
+    bMetricsEnabled = (atoi(value) != 0) ? OMX_TRUE : OMX_FALSE;
+    if (bMetricsEnabled) {
+        ALOGD("OMX call metrics enabled\n");
+    }
+}
+
+/*************************************************************************
+* TIOMX_MetricsAllocHandle()
+*
+* Description: Allocates the memory backing a component handle, with room
+* for the metrics context when metrics are enabled.
+*
+**************************************************************************/
+OMX_HANDLETYPE TIOMX_MetricsAllocHandle()
+{
+    TIOMX_METRICS_HANDLE *pMetricsHandle = NULL;
+
+    if (!bMetricsEnabled) {
+        return malloc(sizeof(OMX_COMPONENTTYPE));
+    }
+
+    pMetricsHandle = calloc(1, sizeof(TIOMX_METRICS_HANDLE));
+    if (pMetricsHandle != NULL) {
+        pMetricsHandle->nMagic = TIOMX_METRICS_MAGIC;
+    }
+    return (OMX_HANDLETYPE)pMetricsHandle;
+}
+
+/*************************************************************************
+* TIOMX_MetricsWrapHandle()
+*
+* Description: Called after OMX_ComponentInit() and before SetCallbacks().
+* Saves the component entry points and installs the timing shims. Does
+* nothing when metrics are disabled.
+*
+**************************************************************************/
+void TIOMX_MetricsWrapHandle(OMX_HANDLETYPE hComponent)
+{
+    TIOMX_METRICS_HANDLE *pMetricsHandle = (TIOMX_METRICS_HANDLE *)hComponent;
+    OMX_COMPONENTTYPE *pComp = &pMetricsHandle->sComponent;
+
+    if (!bMetricsEnabled) {
+        return;
+    }
+
+    pMetricsHandle->sComponentOrig = *pComp;
+
+    pComp->SetCallbacks    = TIOMX_Metrics_SetCallbacks;
+    pComp->EmptyThisBuffer = TIOMX_Metrics_EmptyThisBuffer;
+    pComp->FillThisBuffer  = TIOMX_Metrics_FillThisBuffer;
+    pComp->SendCommand     = TIOMX_Metrics_SendCommand;
+    pComp->GetParameter    = TIOMX_Metrics_GetParameter;
+    pComp->SetParameter    = TIOMX_Metrics_SetParameter;
+    pComp->GetConfig       = TIOMX_Metrics_GetConfig;
+    pComp->SetConfig       = TIOMX_Metrics_SetConfig;
+}
+
+/*************************************************************************
+* TIOMX_MetricsDumpHandle()
+*
+* Description: Logs the metrics of a handle, called from TIOMX_FreeHandle().
+*
+**************************************************************************/
+void TIOMX_MetricsDumpHandle(OMX_HANDLETYPE hComponent, OMX_STRING cComponentName)
+{
+    TIOMX_METRICSTYPE sMetrics;
+    int i;
+
+    if (TIOMX_GetHandleMetrics(hComponent, &sMetrics) != OMX_ErrorNone) {
+        return;
+    }
+
+    for (i = 0; i < TIOMX_MetricsMax; i++) {
+        TIOMX_METRICS_ENTRYTYPE *pEntry = &sMetrics.sApi[i];
+        if (pEntry->nCount == 0) {
+            continue;
+        }
+        ALOGD("%s (%p) %s: count %lu avg %llu us max %lu us\n",
+              cComponentName, hComponent, sApiName[i], (unsigned long)pEntry->nCount,
+              (unsigned long long)(pEntry->nTotalUs / pEntry->nCount), (unsigned long)pEntry->nMaxUs);
+    }
+}
+
+/*************************************************************************
+* TIOMX_GetHandleMetrics()
+*
+* Description: Copies the call counts and latency histograms of a handle.
+*
+* Parameters:
+* @param[in]  hComponent  handle returned by TIOMX_GetHandle
+* @param[out] pMetrics    snapshot of the counters
+*
+* Returns:    OMX_NOERROR               Successful
+*             OMX_ErrorBadParameter     Bad handle or NULL pMetrics
+*             OMX_ErrorNotImplemented   Metrics are disabled
+*
+**************************************************************************/
+OMX_API OMX_ERRORTYPE TIOMX_GetHandleMetrics(
+    OMX_IN  OMX_HANDLETYPE hComponent,
+    OMX_OUT TIOMX_METRICSTYPE *pMetrics)
+{
+    TIOMX_METRICS_HANDLE *pMetricsHandle = (TIOMX_METRICS_HANDLE *)hComponent;
+
+    if (!bMetricsEnabled) {
+        return OMX_ErrorNotImplemented;
+    }
+    if (pMetricsHandle == NULL || pMetrics == NULL ||
+        pMetricsHandle->nMagic != TIOMX_METRICS_MAGIC) {
+        return OMX_ErrorBadParameter;
+    }
+
+    /* counters keep moving while we copy, each field is individually
+       consistent which is all a sampling reader needs */
+    memcpy(pMetrics, &pMetricsHandle->sMetrics, sizeof(TIOMX_METRICSTYPE));
+    return OMX_ErrorNone;
+}
@@ -43,10 +43,12 @@ LOCAL_ARM_MODE := arm
 LOCAL_COPY_HEADERS := \
  	inc/ti_video_config_parser.h \
  	inc/ti_m4v_config_parser.h \
+ 	../system/src/openmax_il/common/inc/OMX_TI_BitReader.h \
  	inc/ti_omx_config_parser.h 
 
 LOCAL_C_INCLUDES := \
-    $(PV_INCLUDES)
+    $(PV_INCLUDES) \
+    $(TI_OMX_SYSTEM)/common/inc
 
 -include $(PV_TOP)/Android_platform_extras.mk
 
@@ -54,5 +56,7 @@ LOCAL_C_INCLUDES := \
 
 LOCAL_SHARED_LIBRARIES += libopencore_common
 
+LOCAL_STATIC_LIBRARIES := libOMX_TI_NalScan
+
 include $(BUILD_SHARED_LIBRARY)
 endif
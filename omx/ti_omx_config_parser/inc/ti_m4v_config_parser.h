@@ -20,6 +20,7 @@
 
 #include "oscl_base.h"
 #include "oscl_types.h"
+#include "OMX_TI_BitReader.h"
 
 #include <utils/Log.h>
 #define LOG_TAG "TI_Parser_Utils"
@@ -58,17 +59,46 @@
 #define H264_PROFILE_IDC_EXTENDED 88
 #define H264_PROFILE_IDC_HIGH 100
 
-typedef struct
-{
-    uint8 *data;
-    uint32 numBytes;
-    uint32 bytePos;
-    uint32 bitBuf;
-    uint32 dataBitPos;
-    uint32  bitPos;
-} mp4StreamType;
+#define AVC_NALTYPE_SPS 7
+#define AVC_NALTYPE_PPS 8
+/* SPS/PPS with emulation prevention bytes are unescaped into a stack buffer
+   of this size, larger ones into a heap buffer */
+#define AVC_PARAM_SET_SCRATCH_SIZE 256
 
+typedef OMX_TI_BITREADERTYPE mp4StreamType;
 
+/* Everything the first SPS (with its VUI) and PPS of an AVC config say
+   about the stream, as filled in by iGetAVCStreamInfo(). Flags not set
+   leave the fields they guard at 0. */
+typedef struct
+{
+    int32 width;                    /* coded size, whole macroblocks */
+    int32 height;
+    int32 display_width;            /* after frame cropping */
+    int32 display_height;
+    int32 profile_idc;
+    int32 level_idc;
+    uint32 num_ref_frames;
+    uint32 frame_mbs_only_flag;
+    uint32 frame_cropping_flag;
+    uint32 crop_left;               /* in luma samples */
+    uint32 crop_right;
+    uint32 crop_top;
+    uint32 crop_bottom;
+    uint32 vui_parameters_present_flag;
+    uint32 timing_info_present_flag;
+    uint32 num_units_in_tick;
+    uint32 time_scale;
+    uint32 fixed_frame_rate_flag;
+    uint32 bitstream_restriction_flag;
+    uint32 num_reorder_frames;
+    uint32 max_dec_frame_buffering;
+    uint32 dpb_frames;              /* frames a decoder must hold, see OMX_TI_AvcParseSps */
+    uint32 entropy_coding_mode_flag;
+} tiAVCStreamInfo;
+
+/* Out of line wrappers around the OMX_TI_BitReader.h functions, kept for
+   existing callers; the parsers below use the inline reader directly. */
 int16 ShowBits(
     mp4StreamType *pStream,
     uint8 ucNBits,
@@ -123,13 +153,12 @@ int16 DecodeUserData(mp4StreamType *pStream);
 		int32 *profile, 
 		int32 *level,
 		uint32 *entropy_coding_mode_flag);
+	OSCL_IMPORT_REF int16 iGetAVCStreamInfo(
+		uint8 *buffer,
+		int32 length,
+		tiAVCStreamInfo *info);
 
-int32 FindNAL(uint8** nal_pnt, uint8* buffer, int32 length);
-int16 DecodeSPS(mp4StreamType *psBits, int32 *width, int32 *height, int32 *display_width, int32 *display_height, int32 *profile_idc, int32 *level_idc);
-#if USE_LATER
-int32 DecodeHRD(mp4StreamType *psBits);
-int32 DecodeVUI(mp4StreamType *psBits);
-#endif
+int16 DecodeSPS(mp4StreamType *psBits, tiAVCStreamInfo *info);
 int32 DecodePPS(mp4StreamType *psBits, uint32 *entropy_coding_mode_flag);
 
 void ue_v(mp4StreamType *psBits, uint32 *codeNum);
@@ -18,6 +18,16 @@
 #ifndef TI_OMX_CONFIG_PARSER_H_INCLUDED
 #define TI_OMX_CONFIG_PARSER_H_INCLUDED
 
+/* Result cache counters of TIOMXConfigParser(). Every call is a lookup;
+   configs too large to be cached count as uncacheable and are parsed. */
+typedef struct
+{
+    OMX_U32 nLookups;
+    OMX_U32 nHits;
+    OMX_U32 nEvictions;
+    OMX_U32 nUncacheable;
+} TIOMXConfigParserCacheStats;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -25,6 +35,9 @@ extern "C"
         OMX_PTR aInputParameters,
         OMX_PTR aOutputParameters);
 
+    OSCL_IMPORT_REF void TIOMXConfigParserGetCacheStats(
+        TIOMXConfigParserCacheStats *pStats);
+
 }
 #endif
 
@@ -18,6 +18,7 @@
 
 #define __USE_MISC
 #include "oscl_stdstring.h"
+#include "oscl_mem.h"
 
 // Use default DLL entry point
 #ifndef OSCL_DLL_H_INCLUDED
@@ -54,8 +55,49 @@
 
 #include "ti_omx_config_parser.h"
 #include "ti_video_config_parser.h"
+#include "OMX_TI_ConfigCache.h"
 
-OSCL_EXPORT_REF OMX_BOOL TIOMXConfigParser(
+#include <pthread.h>
+
+/* The framework asks for the same codec configs over and over (every
+   track prepare, seek, re-open and thumbnail), so the results of the last
+   few distinct (role, component, config) triples are kept, one per slot of
+   the OMX_TI_ConfigCache keys. Configs larger than
+   OMX_TI_CONFIGCACHE_MAX_BYTES are always parsed. */
+typedef union
+{
+    pvAudioConfigParserOutputs audio;
+    pvVideoConfigParserOutputs video;
+    tiVideoConfigParserOutputs tiVideo;
+} TIOMXConfigParserCachedOutputs;
+
+typedef struct
+{
+    OMX_BOOL bResult;
+    OMX_U32 nOutputSize;
+    TIOMXConfigParserCachedOutputs sOutputs;
+} TIOMXConfigParserCacheResult;
+
+static pthread_mutex_t configCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static OMX_TI_CONFIGCACHETYPE configCache;
+static TIOMXConfigParserCacheResult configCacheResults[OMX_TI_CONFIGCACHE_ENTRIES];
+
+/* Size of the outputs the parser for cRole writes */
+static OMX_U32 ConfigCacheOutputSize(const char *cRole)
+{
+    if (0 == oscl_strncmp(cRole, "audio_decoder", oscl_strlen("audio_decoder")))
+    {
+        return sizeof(pvAudioConfigParserOutputs);
+    }
+    if (0 == oscl_strcmp(cRole, "video_decoder.mpeg4") ||
+        0 == oscl_strcmp(cRole, "video_decoder.avc"))
+    {
+        return sizeof(tiVideoConfigParserOutputs);
+    }
+    return sizeof(pvVideoConfigParserOutputs);
+}
+
+static OMX_BOOL TIOMXConfigParserUncached(
     OMX_PTR aInputParameters,
     OMX_PTR aOutputParameters)
 
@@ -175,3 +217,74 @@ OSCL_EXPORT_REF OMX_BOOL TIOMXConfigParser(
     return OMX_TRUE;
 }
 
+
+OSCL_EXPORT_REF OMX_BOOL TIOMXConfigParser(
+    OMX_PTR aInputParameters,
+    OMX_PTR aOutputParameters)
+
+{
+    OMXConfigParserInputs* pInputs = (OMXConfigParserInputs*) aInputParameters;
+    const char *cName = pInputs->cComponentName ? pInputs->cComponentName : "";
+    TIOMXConfigParserCacheResult *pResult = NULL;
+    OMX_S32 nSlot;
+    OMX_U32 nHash;
+    OMX_BOOL bResult;
+
+    if (!OMX_TI_ConfigCacheFits(pInputs->cComponentRole, cName,
+                                pInputs->inPtr, pInputs->inBytes))
+    {
+        pthread_mutex_lock(&configCacheMutex);
+        configCache.nLookups++;
+        configCache.nUncacheable++;
+        pthread_mutex_unlock(&configCacheMutex);
+        return TIOMXConfigParserUncached(aInputParameters, aOutputParameters);
+    }
+
+    nHash = OMX_TI_ConfigCacheHash(pInputs->cComponentRole, cName,
+                                   pInputs->inPtr, pInputs->inBytes);
+
+    pthread_mutex_lock(&configCacheMutex);
+    nSlot = OMX_TI_ConfigCacheFind(&configCache, nHash, pInputs->cComponentRole, cName,
+                                   pInputs->inPtr, pInputs->inBytes);
+    if (nSlot >= 0)
+    {
+        pResult = &configCacheResults[nSlot];
+        bResult = pResult->bResult;
+        if (bResult)
+        {
+            oscl_memcpy(aOutputParameters, &pResult->sOutputs, pResult->nOutputSize);
+        }
+        pthread_mutex_unlock(&configCacheMutex);
+        return bResult;
+    }
+    pthread_mutex_unlock(&configCacheMutex);
+
+    /* parsed without the lock, two threads missing on the same config both
+       parse it and the second insert wins */
+    bResult = TIOMXConfigParserUncached(aInputParameters, aOutputParameters);
+
+    pthread_mutex_lock(&configCacheMutex);
+    pResult = &configCacheResults[OMX_TI_ConfigCacheInsert(&configCache, nHash,
+                                                           pInputs->cComponentRole, cName,
+                                                           pInputs->inPtr, pInputs->inBytes)];
+    pResult->bResult = bResult;
+    pResult->nOutputSize = ConfigCacheOutputSize(pInputs->cComponentRole);
+    if (bResult)
+    {
+        oscl_memcpy(&pResult->sOutputs, aOutputParameters, pResult->nOutputSize);
+    }
+    pthread_mutex_unlock(&configCacheMutex);
+
+    return bResult;
+}
+
+OSCL_EXPORT_REF void TIOMXConfigParserGetCacheStats(
+    TIOMXConfigParserCacheStats *pStats)
+{
+    pthread_mutex_lock(&configCacheMutex);
+    pStats->nLookups = configCache.nLookups;
+    pStats->nHits = configCache.nHits;
+    pStats->nEvictions = configCache.nEvictions;
+    pStats->nUncacheable = configCache.nUncacheable;
+    pthread_mutex_unlock(&configCacheMutex);
+}
@@ -61,23 +61,16 @@
 
 OSCL_DLL_ENTRY_POINT_DEFAULT()
 
-int32 GetNAL_Config(uint8** bitstream, int32* size);
-
 OSCL_EXPORT_REF int16 ti_video_config_parser(tiVideoConfigParserInputs *aInputs, tiVideoConfigParserOutputs *aOutputs, char* pComponentName)
 {
     if (aInputs->iMimeType == PVMF_MIME_M4V) //m4v
     {
         mp4StreamType psBits;
-        psBits.data = aInputs->inPtr;
         if (aInputs->inBytes <= 0)
         {
             return -1;
         }
-        psBits.numBytes = aInputs->inBytes;
-        psBits.bytePos = 0;
-        psBits.bitBuf = 0;
-        psBits.dataBitPos = 0;
-        psBits.bitPos = 32;
+        OMX_TI_BitsInit(&psBits, aInputs->inPtr, aInputs->inBytes);
 
         int32 width, height, display_width, display_height = 0;
         int32 profile_level = 0;
@@ -109,35 +102,10 @@ OSCL_EXPORT_REF int16 ti_video_config_parser(tiVideoConfigParserInputs *aInputs,
         int32 profile_idc, level_idc = 0;
         uint32 entropy_coding_mode_flag = 0;
 
-        uint8 *tp = aInputs->inPtr;
-
-        if (aInputs->inBytes > 1)
-        {
-            if (tp[0] == 0 && tp[1] == 0)
-            {
-                // ByteStream Format
-                uint8* tmp_ptr = tp;
-                uint8* buffer_begin = tp;
-                int16 length = 0;
-                int initbufsize = aInputs->inBytes;
-                int tConfigSize = 0;
-                do
-                {
-                    tmp_ptr += length;
-                    length = GetNAL_Config(&tmp_ptr, &initbufsize);
-                    buffer_begin[0] = length & 0xFF;
-                    buffer_begin[1] = (length >> 8) & 0xFF;
-                    oscl_memcpy(buffer_begin + 2, tmp_ptr, length);
-                    buffer_begin += (length + 2);
-                    tConfigSize += (length + 2);
-                }
-                while (initbufsize > 0);
-            }
-        }
-
-        // check codec info and get settings
+        // check codec info and get settings, Annex B or 2 byte length
+        // prefixed; the input buffer is left untouched
         int16 retval;
-        retval = iGetAVCConfigInfo(tp,
+        retval = iGetAVCConfigInfo(aInputs->inPtr,
                                    aInputs->inBytes,
                                    (int*) & width,
                                    (int*) & height,
@@ -253,51 +221,3 @@ OSCL_EXPORT_REF int16 ti_video_config_parser(tiVideoConfigParserInputs *aInputs,
     }
     return 0;
 }
-
-
-/* This function finds a nal from the SC's, moves the bitstream pointer to the beginning of the NAL unit, returns the
-size of the NAL, and at the same time, updates the remaining size in the bitstream buffer that is passed in */
-int32 GetNAL_Config(uint8** bitstream, int32* size)
-{
-    int i = 0;
-    int j;
-    uint8* nal_unit = *bitstream;
-    int count = 0;
-
-    /* find SC at the beginning of the NAL */
-    while (nal_unit[i++] == 0 && i < *size)
-    {
-    }
-
-    if (nal_unit[i-1] == 1)
-    {
-        *bitstream = nal_unit + i;
-    }
-    else
-    {
-        j = *size;
-        *size = 0;
-        return j;  // no SC at the beginning, not supposed to happen
-    }
-
-    j = i;
-
-    /* found the SC at the beginning of the NAL, now find the SC at the beginning of the next NAL */
-    while (i < *size)
-    {
-        if (count == 2 && nal_unit[i] == 0x01)
-        {
-            i -= 2;
-            break;
-        }
-
-        if (nal_unit[i])
-            count = 0;
-        else
-            count++;
-        i++;
-    }
-
-    *size -= i;
-    return (i -j);
-}
@@ -27,6 +27,7 @@
 #include <ResourceManagerProxyAPI.h>
 #endif
 #include <OMX_TI_Common.h>
+#include <OMX_TI_Core.h>
 
 #ifdef __PERF_INSTRUMENTATION__
 #include "perf.h"
@@ -156,6 +157,12 @@ void LinkedList_Destroy(LinkedList *LinkedList);
     LinkedList_FreeAll(&AllocList);\
 }
 
+/* LCML buffer type of an output stream; a TI to TI tunnel keeps the DSP
+   mapping of its buffers */
+#define VPP_OUTPUT_STREAM(_pComponentPrivate_, _nPort_, _eStream_) \
+    ((TMMCodecBufferType)((_eStream_) | \
+        ((_pComponentPrivate_)->sCompPorts[_nPort_].bProprietaryTunnel ? EMMCodecStreamMapReuse : 0)))
+
 
 /**********************************************************************
  *    GPP Internal data type
@@ -336,6 +343,7 @@ typedef struct VPP_PORT_TYPE
     OMX_U32                      nTunnelPort;
     OMX_BUFFERSUPPLIERTYPE       eSupplierSetting;
     OMX_BUFFERSUPPLIERTYPE       eSupplierPreference;
+    OMX_BOOL                     bProprietaryTunnel;
     OMX_U32                      nPortIndex;            
     OMX_U32                      nBufferCount;          
     OMX_VPP_COMPONENT_BUFFER     pVPPBufHeader[NUM_OF_VPP_BUFFERS];
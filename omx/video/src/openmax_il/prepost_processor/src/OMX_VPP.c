@@ -2471,6 +2471,7 @@ static OMX_ERRORTYPE VPP_ComponentTunnelRequest (OMX_HANDLETYPE hComponent,
         pPort->hTunnelComponent = 0;
         pPort->nTunnelPort = 0;
         pPort->eSupplierSetting = OMX_BufferSupplyUnspecified;
+        pPort->bProprietaryTunnel = OMX_FALSE;
         eError = OMX_ErrorNone;
         goto EXIT;
     }
@@ -2490,6 +2491,8 @@ static OMX_ERRORTYPE VPP_ComponentTunnelRequest (OMX_HANDLETYPE hComponent,
 
     pPort->hTunnelComponent = hTunneledComp;
     pPort->nTunnelPort      = nTunneledPort;
+    /* TI to TI tunnel, keep the DSP mappings of the tunnel buffers */
+    pPort->bProprietaryTunnel = (pTunnelSetup->nTunnelFlags & OMX_TI_PORTTUNNELFLAG_PROPRIETARY) ? OMX_TRUE : OMX_FALSE;
     VPP_DPRINT("VPP comp = %x, tunneled comp = %x\n",(int)hComponent, (int)pPort->hTunnelComponent);
 
     if (pComponentPrivate->sCompPorts[nPort].pPortDef.eDir == OMX_DirOutput) {
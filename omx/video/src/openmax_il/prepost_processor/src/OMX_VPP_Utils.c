@@ -1593,7 +1593,7 @@ OMX_ERRORTYPE VPP_StateToExecuting(VPP_COMPONENT_PRIVATE *pComponentPrivate)
                     VPP_DPRINT("LCML_QueueBuffer YUV: %s::%s: %d: VPP\n", __FILE__, __FUNCTION__, __LINE__);
                     eError = LCML_QueueBuffer(
                                 ((LCML_DSP_INTERFACE*)pLcmlHandle)->pCodecinterfacehandle,
-                                EMMCodecStream3,
+                                VPP_OUTPUT_STREAM(pComponentPrivate, OMX_VPP_YUV_OUTPUT_PORT, EMMCodecStream3),
                                 pBufHdr->pBuffer,
                                 pBufHdr->nAllocLen,0,
                                 (OMX_U8 *)pComponentPrivate->pOpYUVFrameStatus,
@@ -1623,7 +1623,7 @@ OMX_ERRORTYPE VPP_StateToExecuting(VPP_COMPONENT_PRIVATE *pComponentPrivate)
                     VPP_DPRINT("LCML_QueueBuffer RGB: %s::%s: %d: VPP\n", __FILE__, __FUNCTION__, __LINE__);
                     eError = LCML_QueueBuffer(
                                 ((LCML_DSP_INTERFACE*)pLcmlHandle)->pCodecinterfacehandle,
-                                EMMCodecStream2,
+                                VPP_OUTPUT_STREAM(pComponentPrivate, OMX_VPP_RGB_OUTPUT_PORT, EMMCodecStream2),
                                 pBufHdr->pBuffer,
                                 pBufHdr->nAllocLen,0,
                                 (OMX_U8 *)pComponentPrivate->pOpRGBFrameStatus,
@@ -2209,7 +2209,8 @@ OMX_ERRORTYPE VPP_Process_FilledInBuf(VPP_COMPONENT_PRIVATE* pComponentPrivate)
                 pComponentPrivate->pIpFrameStatus->ulMirror);
             
             eError = LCML_QueueBuffer(pLcmlHandle->pCodecinterfacehandle,
-                        EMMCodecInputBuffer,
+                        (pComponentPrivate->sCompPorts[OMX_VPP_INPUT_PORT].bProprietaryTunnel ?
+                            EMMCodecInputBufferMapReuse : EMMCodecInputBuffer),
                         pBufHeader->pBuffer,
                         pBufHeader->nAllocLen,
                         pBufHeader->nFilledLen,
@@ -2391,7 +2392,7 @@ OMX_ERRORTYPE VPP_Process_FreeOutBuf(VPP_COMPONENT_PRIVATE* pComponentPrivate)
         if (portDef->nPortIndex == OMX_VPP_RGB_OUTPUT_PORT) {
             eError = LCML_QueueBuffer(
                     pLcmlHandle->pCodecinterfacehandle,
-                    EMMCodecStream2,
+                    VPP_OUTPUT_STREAM(pComponentPrivate, OMX_VPP_RGB_OUTPUT_PORT, EMMCodecStream2),
                     pBufHeader->pBuffer,
                     pBufHeader->nAllocLen,0,
                     (OMX_U8 *) pComponentPrivate->pOpRGBFrameStatus,
@@ -2401,7 +2402,7 @@ OMX_ERRORTYPE VPP_Process_FreeOutBuf(VPP_COMPONENT_PRIVATE* pComponentPrivate)
         } else { /* portDef->nPortIndex == OMX_VPP_YUV_OUTPUT_PORT) */
            eError = LCML_QueueBuffer(
                     pLcmlHandle->pCodecinterfacehandle,
-                    EMMCodecStream3,
+                    VPP_OUTPUT_STREAM(pComponentPrivate, OMX_VPP_YUV_OUTPUT_PORT, EMMCodecStream3),
                     pBufHeader->pBuffer,
                     pBufHeader->nAllocLen,0,
                     (OMX_U8 *) pComponentPrivate->pOpYUVFrameStatus,
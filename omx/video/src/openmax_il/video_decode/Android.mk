@@ -20,6 +20,8 @@ endif
 
 LOCAL_SHARED_LIBRARIES := $(TI_OMX_COMP_SHARED_LIBRARIES)
 
+LOCAL_STATIC_LIBRARIES := libOMX_TI_NalScan
+
 ifeq ($(PERF_INSTRUMENTATION),1)
 LOCAL_SHARED_LIBRARIES += \
 	libPERF
@@ -48,6 +48,14 @@
 #define VIDDEC_CUSTOMPARAM_PARSERENABLED "OMX.TI.VideoDecode.Param.ParserEnabled"
 #define VIDDEC_CUSTOMPARAM_ISNALBIGENDIAN "OMX.TI.VideoDecode.Param.IsNALBigEndian"
 #define VIDDEC_CUSTOMCONFIG_DEBUG "OMX.TI.VideoDecode.Debug"
+#define VIDDEC_CUSTOMPARAM_REORDERDEPTH "OMX.TI.VideoDecode.Param.ReorderDepth"
+#define VIDDEC_CUSTOMPARAM_ADAPTIVEPLAYBACK "OMX.TI.VideoDecode.Param.AdaptivePlayback"
+#define VIDDEC_CUSTOMCONFIG_DECODEDEADLINE "OMX.TI.VideoDecode.Config.DecodeDeadline"
+#define VIDDEC_CUSTOMPARAM_THUMBNAIL "OMX.TI.VideoDecode.Param.Thumbnail"
+#define VIDDEC_CUSTOMCONFIG_SEEKPENDING "OMX.TI.VideoDecode.Config.SeekPending"
+#define VIDDEC_CUSTOMCONFIG_MBERRORMAP "OMX.TI.VideoDecode.Config.MBErrorMap"
+#define VIDDEC_CUSTOMPARAM_NALCOALESCING "OMX.TI.VideoDecode.Param.NalCoalescing"
+#define VIDDEC_CUSTOMCONFIG_DECODETELEMETRY "OMX.TI.VideoDecode.Config.DecodeTelemetry"
 #ifdef VIDDEC_SPARK_CODE 
  #define VIDDEC_CUSTOMPARAM_ISSPARKINPUT "OMX.TI.VideoDecode.Param.IsSparkInput"
 #endif
@@ -55,6 +63,163 @@
 /*------- Program Header Files ----------------------------------------*/
 #include <OMX_Component.h>
 
+/* VIDDEC_CUSTOMPARAM_ADAPTIVEPLAYBACK, output port only, set in Loaded.
+ * With bEnable the DSP node and the output buffers are sized once for
+ * nMaxFrameWidth x nMaxFrameHeight; for AVC the output port also asks for
+ * enough buffers for the largest DPB, up to the buffer ceiling. A stream that changes resolution
+ * within those bounds keeps its buffers: the decoder updates nStride,
+ * nSliceHeight and the output crop and sends OMX_EventPortSettingsChanged
+ * with nData2 = OMX_IndexConfigCommonOutputCrop instead of asking for a
+ * port disable/enable. A larger stream falls back to the full
+ * reconfiguration. */
+typedef struct VIDDEC_PARAM_ADAPTIVEPLAYBACKTYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_BOOL bEnable;
+    OMX_U32 nMaxFrameWidth;
+    OMX_U32 nMaxFrameHeight;
+} VIDDEC_PARAM_ADAPTIVEPLAYBACKTYPE;
+
+/* VIDDEC_CUSTOMCONFIG_DECODEDEADLINE, input port, frame mode only.
+ * With bEnable the decoder compares the timestamp of every input frame
+ * with the renderer's clock: nMediaTime is the media time on screen when
+ * the config is set, nLateBy how far behind the renderer runs (0 if
+ * nMediaTime already accounts for it). The clock is advanced in real
+ * time at 1x between two SetConfig calls, so the client sets it again on
+ * pause, seek or a rate change. A frame that can no longer be shown in
+ * time is returned undecoded when nothing references it (AVC nal_ref_idc
+ * 0, MPEG-4 B-VOP) and decoded anyway otherwise.
+ * The counters are read only and restart when bEnable is turned on:
+ * nFramesSkipped were returned undecoded, nFramesLate were late but
+ * decoded, nFramesOnTime met their deadline. */
+typedef struct VIDDEC_CONFIG_DECODEDEADLINETYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_BOOL bEnable;
+    OMX_TICKS nMediaTime;
+    OMX_TICKS nLateBy;
+    OMX_U32 nFramesSkipped;
+    OMX_U32 nFramesLate;
+    OMX_U32 nFramesOnTime;
+} VIDDEC_CONFIG_DECODEDEADLINETYPE;
+
+/* VIDDEC_CUSTOMPARAM_THUMBNAIL, output port, set in Loaded, frame mode.
+ * With bEnable the output port asks for a single buffer and the decoder
+ * drops the input up to the first key frame (IDR, I-VOP, intra picture),
+ * decodes that frame alone and ends the stream right after it: the next
+ * input buffer is turned into the end of stream and everything after is
+ * returned undecoded until the input port is flushed.
+ * nScaleShift 1 to 3 emits the frame packed at 1/2, 1/4 or 1/8 of the
+ * decoded size, averaged, in the output color format; the size it comes
+ * out at is returned in nOutputWidth x nOutputHeight. */
+typedef struct VIDDEC_PARAM_THUMBNAILTYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_BOOL bEnable;
+    OMX_U32 nScaleShift;
+    OMX_U32 nOutputWidth;
+    OMX_U32 nOutputHeight;
+} VIDDEC_PARAM_THUMBNAILTYPE;
+
+/* VIDDEC_CUSTOMCONFIG_SEEKPENDING, OMX_CONFIG_BOOLEANTYPE. Set after the
+ * input flush of a seek: until the first random access point (AVC IDR or
+ * recovery point SEI, MPEG-4 I-VOP, H.263 or MPEG-2 intra picture) input
+ * buffers are returned without being decoded. The decoder clears the flag
+ * at that buffer, or at the end of stream; GetConfig reads it back. */
+
+/* VIDDEC_CUSTOMCONFIG_MBERRORMAP, output port, GetConfig only, with
+ * OMX_IndexConfigVideoMBErrorReporting enabled (MPEG-4, H.263, AVC).
+ * pBufferHeader is an output buffer the client holds, between its
+ * FillBufferDone and the next FillThisBuffer. The decoder returns a view
+ * of that frame's error map without copying it: pErrMap is one byte per
+ * macroblock in raster order, nWidthMBs x nHeightMBs, nonzero where the
+ * macroblock had an error, and stays valid until the buffer is given
+ * back. The summary is filled in as the frame comes from the DSP:
+ * nErroredMBs and the box around them in macroblocks, nLeft and nTop
+ * inclusive, nWidth x nHeight 0 x 0 for a clean frame. pErrMap is NULL
+ * when the buffer carries no map. */
+typedef struct VIDDEC_CONFIG_MBERRORMAPTYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_BUFFERHEADERTYPE* pBufferHeader;
+    const OMX_U8* pErrMap;
+    OMX_U32 nErrMapSize;
+    OMX_U32 nWidthMBs;
+    OMX_U32 nHeightMBs;
+    OMX_U32 nErroredMBs;
+    OMX_U32 nLeft;
+    OMX_U32 nTop;
+    OMX_U32 nWidth;
+    OMX_U32 nHeight;
+} VIDDEC_CONFIG_MBERRORMAPTYPE;
+
+/* VIDDEC_CUSTOMPARAM_NALCOALESCING, input port, set in Loaded. With
+ * bEnable an AVC byte stream (H264BitStreamFormat 0) in stream mode
+ * (ProcessMode 1) that comes one NAL unit or slice per buffer is sent to
+ * the DSP one access unit at a time: the first buffer of an access unit
+ * is held and the NAL units of the following buffers are copied behind
+ * its data, each of those buffers going back to the client as soon as it
+ * is copied. The access unit is sent when a buffer starts the next one
+ * (new timestamp, access unit delimiter, SEI, SPS or PPS after a slice,
+ * or a slice with first_mb_in_slice 0), when a buffer has
+ * OMX_BUFFERFLAG_ENDOFFRAME, does not fit in the space left, carries a
+ * mark or a flag other than OMX_BUFFERFLAG_ENDOFFRAME. The input port
+ * needs at least two buffers. nBuffersCoalesced is read only: buffers
+ * returned without a DSP submission of their own since the last
+ * SetParameter. */
+typedef struct VIDDEC_PARAM_NALCOALESCINGTYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_BOOL bEnable;
+    OMX_U32 nBuffersCoalesced;
+} VIDDEC_PARAM_NALCOALESCINGTYPE;
+
+/* Where a frame spends its time, for VIDDEC_CONFIG_DECODETELEMETRYTYPE */
+typedef enum VIDDEC_TELEMETRY_STAGE {
+    VIDDEC_TelemetryAppQueue = 0,   /* EmptyThisBuffer to the LCML submission */
+    VIDDEC_TelemetryLcmlQueue,      /* inside LCML_QueueBuffer */
+    VIDDEC_TelemetryDsp,            /* LCML submission until the DSP returns the input */
+    VIDDEC_TelemetryOutputWait,     /* input returned until FillBufferDone */
+    VIDDEC_TelemetryTotal,          /* EmptyThisBuffer to FillBufferDone */
+    VIDDEC_TelemetryStageMax
+} VIDDEC_TELEMETRY_STAGE;
+
+/* Percentiles of one stage over the last nSamples frames, in us */
+typedef struct VIDDEC_TELEMETRY_STAGETYPE {
+    OMX_U32 nSamples;
+    OMX_U32 nP50;
+    OMX_U32 nP90;
+    OMX_U32 nP99;
+    OMX_U32 nMax;
+} VIDDEC_TELEMETRY_STAGETYPE;
+
+/* VIDDEC_CUSTOMCONFIG_DECODETELEMETRY, input port. SetConfig with bEnable
+ * starts timing every frame and clears what was gathered; only bEnable
+ * is read. GetConfig returns the rolling percentiles of each stage over
+ * the frames last timed (up to 128 per stage), nFramesOut the frames
+ * timed end to end since the start, and nFramesPerSecondQ16 the output
+ * rate over those frames in 16.16 fixed point. A frame is followed by its
+ * timestamp from the DSP returning its input to FillBufferDone; a
+ * tunneled output port only gets the first three stages. With PERF
+ * instrumentation each sample is also logged as PERF_Log(tag | stage,
+ * us, timestamp), tag VIDDEC_TELEMETRY_PERF_TAG. */
+typedef struct VIDDEC_CONFIG_DECODETELEMETRYTYPE {
+    OMX_U32 nSize;
+    OMX_VERSIONTYPE nVersion;
+    OMX_U32 nPortIndex;
+    OMX_BOOL bEnable;
+    OMX_U32 nFramesOut;
+    OMX_U32 nFramesPerSecondQ16;
+    VIDDEC_TELEMETRY_STAGETYPE sStage[VIDDEC_TelemetryStageMax];
+} VIDDEC_CONFIG_DECODETELEMETRYTYPE;
+
+#define VIDDEC_TELEMETRY_PERF_TAG 0x0DEC7E0
+
 /*------- Structures ----------------------------------------*/
 
 #endif /* OMX_VIDDEC_CUSTOMCMD_H */
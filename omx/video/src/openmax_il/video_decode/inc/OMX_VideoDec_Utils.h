@@ -58,6 +58,8 @@
     #include <errno.h>
     #include <sys/ioctl.h>
     #include <sys/time.h>
+    #include <time.h>
+    #include <sys/eventfd.h>
     #include <stdlib.h>
     #include <semaphore.h>
 #endif
@@ -96,6 +98,11 @@
 #include "OMX_VideoDecoder.h"
 #include "OMX_VidDec_CustomCmd.h"
 #include "OMX_TI_Common.h"
+#include "OMX_TI_Ring.h"
+#include "OMX_TI_AvcHeader.h"
+#include "OMX_TI_PtsHeap.h"
+#include "OMX_TI_MBErrorMap.h"
+#include "OMX_TI_Core.h"
 
 
 #ifdef KHRONOS_1_1
@@ -163,14 +170,19 @@ typedef enum VIDDEC_ENUM_MEMLEVELS{
 #define __STD_COMPONENT__
 
 /*
- * MAX_PRIVATE_IN_BUFFERS and MAX_PRIVATE_OUT_BUFFERS must NOT be
- * greater than MAX_PRIVATE_BUFFERS. MAX_PRIVATE_BUFFERS is set
- * to 6 because 6 overlay buffers are currently being used for
- * playback
+ * MAX_PRIVATE_IN_BUFFERS and MAX_PRIVATE_OUT_BUFFERS are the default
+ * nBufferCountActual of the ports, 6 because 6 overlay buffers are
+ * currently being used for playback. A port takes any count up to
+ * the buffer ceiling: VIDDEC_MAX_BUFFER_COUNT unless the property
+ * VIDDEC_MAX_BUFFER_COUNT_PROPERTY says otherwise, never more than
+ * VIDDEC_MAX_BUFFER_COUNT_LIMIT (the circular buffer indexes are
+ * 8 bit). The per buffer state is sized when the port is populated.
  */
 #define MAX_PRIVATE_IN_BUFFERS              6
 #define MAX_PRIVATE_OUT_BUFFERS             6
-#define MAX_PRIVATE_BUFFERS                 6
+#define VIDDEC_MAX_BUFFER_COUNT             16
+#define VIDDEC_MAX_BUFFER_COUNT_LIMIT       32
+#define VIDDEC_MAX_BUFFER_COUNT_PROPERTY    "video.decoder.max.buffers"
 #define NUM_OF_PORTS                        2
 #define VIDDEC_MAX_NAMESIZE                 128
 #define VIDDEC_NOPORT                       0xfffffffe
@@ -197,6 +209,8 @@ typedef enum VIDDEC_ENUM_MEMLEVELS{
 #define VIDDEC_WMVHEADER                    20
 
 #define VIDDEC_BUFFERMINCOUNT                   VIDDEC_ONE
+/* AVC output buffers held by the display on top of the decoded picture buffer */
+#define VIDDEC_AVC_DISPLAY_BUFFERS              2
 #define VIDDEC_PORT_ENABLED                     OMX_TRUE
 #define VIDDEC_PORT_POPULATED                   OMX_FALSE
 #define VIDDEC_PORT_DOMAIN                      OMX_PortDomainVideo
@@ -381,6 +395,9 @@ typedef enum VIDDEC_ENUM_MEMLEVELS{
 
 #define VIDDEC_MAX_QUEUE_SIZE                           256
 #define VIDDEC_WMV_BUFFER_OFFSET                        (255 - 4)
+/* Bytes reserved in front of the input buffers the component allocates,
+   where VIDDEC_CopyBuffer places saved codec config data */
+#define VIDDEC_CONFIG_HEADROOM                          1024
 #define VIDDEC_WMV_ELEMSTREAM                           0
 #define VIDDEC_WMV_RCVSTREAM                            1
 
@@ -414,7 +431,15 @@ typedef enum VIDDEC_CUSTOM_PARAM_INDEX
 #ifdef VIDDEC_SPARK_CODE
     VideoDecodeCustomParamIsSparkInput,
 #endif
-    VideoDecodeCustomConfigDebug
+    VideoDecodeCustomConfigDebug,
+    VideoDecodeCustomParamReorderDepth,
+    VideoDecodeCustomParamAdaptivePlayback,
+    VideoDecodeCustomConfigDecodeDeadline,
+    VideoDecodeCustomParamThumbnail,
+    VideoDecodeCustomConfigSeekPending,
+    VideoDecodeCustomConfigMBErrorMap,
+    VideoDecodeCustomParamNalCoalescing,
+    VideoDecodeCustomConfigDecodeTelemetry
 
 #ifdef ANDROID /*To be use by opencore multimedia framework*/
     ,
@@ -433,6 +458,14 @@ typedef enum VIDDEC_LCML_STATES
     VidDec_LCML_State_Destroy
 } VIDDEC_LCML_STATES;
 
+/* Where a thumbnail mode session is */
+typedef enum VIDDEC_THUMBNAIL_STATES
+{
+    VIDDEC_Thumbnail_Seeking = 0,   /* dropping input up to a key frame */
+    VIDDEC_Thumbnail_EosPending,    /* key frame going to the DSP, end of stream follows it */
+    VIDDEC_Thumbnail_Done           /* end of stream sent, input is dropped */
+} VIDDEC_THUMBNAIL_STATES;
+
 typedef enum VIDDEC_RMPROXY_STATES
 {
     VidDec_RMPROXY_State_Unload = 0,
@@ -548,6 +581,20 @@ typedef enum VIDDEC_WMV_PROFILES
     VIDDEC_WMV_PROFILEMAX
 }VIDDEC_WMV_PROFILES;
 
+#ifdef KHRONOS_1_1
+/* Macroblock error map of the frame in an output buffer. pErrMap points
+   into the buffer's own UALG output params, so it holds while the buffer
+   is away from the DSP. sSummary covers the nWidthMBs x nHeightMBs
+   viewed. */
+typedef struct VIDDEC_MBERRORMAP
+{
+    const OMX_U8* pErrMap;
+    OMX_U32 nWidthMBs;
+    OMX_U32 nHeightMBs;
+    OMX_TI_MBERRORSUMMARYTYPE sSummary;
+} VIDDEC_MBERRORMAP;
+#endif
+
 typedef struct VIDDEC_BUFFER_PRIVATE
 {
     OMX_BUFFERHEADERTYPE* pBufferHdr;
@@ -559,13 +606,68 @@ typedef struct VIDDEC_BUFFER_PRIVATE
     OMX_U8* pOriginalBuffer;
 #ifdef VIDDEC_WMVPOINTERFIXED
      OMX_U8* pTempBuffer;
+#endif
+    /* free bytes in front of pBuffer, and how many of them hold config
+       data prepended by VIDDEC_CopyBuffer until the buffer is returned */
+    OMX_U32 nHeadroom;
+    OMX_U32 nPrepended;
+    /* input buffers, with the decode telemetry on: monotonic time of
+       EmptyThisBuffer and of the LCML submission, 0 when not stamped */
+    OMX_TICKS nEmptyTime;
+    OMX_TICKS nSubmitTime;
+#ifdef KHRONOS_1_1
+    VIDDEC_MBERRORMAP sMBErrorMap;      /* output buffers */
 #endif
 } VIDDEC_BUFFER_PRIVATE;
 
 /*structures and defines for Circular Buffer*/
 #define VIDDEC_CBUFFER_LOCK
 #define MAX_MULTIPLY                        4
-#define CBUFFER_SIZE                        MAX_PRIVATE_BUFFERS * MAX_MULTIPLY
+/* Entries of the timestamp circular buffer and of the buffer flags, for
+   a buffer ceiling of _nMax_ */
+#define CBUFFER_SIZE(_nMax_)                ((_nMax_) * MAX_MULTIPLY)
+
+/* Entries of the buffer and command rings of the component thread. A buffer
+   is in at most one ring at a time, the slack covers EOS and flush paths
+   that queue a buffer header again. */
+#define VIDDEC_BUFFER_RING_SIZE(_nMax_)     ((_nMax_) * MAX_MULTIPLY)
+#define VIDDEC_COMMAND_RING_SIZE            16
+
+/* Reorder depth that follows the stream headers; 0 keeps decoding order */
+#define VIDDEC_REORDER_DEPTH_AUTO           0xFFFFFFFF
+
+/* Largest VIDDEC_PARAM_THUMBNAILTYPE.nScaleShift, 1/8 of the decoded size */
+#define VIDDEC_THUMBNAIL_MAX_SCALE_SHIFT    3
+
+/* Time a frame needs between input and display, in us: a frame due
+   sooner than this after the renderer's clock misses its deadline */
+#define VIDDEC_DECODE_DEADLINE_MARGIN       20000
+
+/* Frames the decode telemetry keeps per stage for the percentiles, and
+   frames it follows between the DSP returning their input and
+   FillBufferDone */
+#define VIDDEC_TELEMETRY_WINDOW             128
+#define VIDDEC_TELEMETRY_PENDING            32
+
+/* A frame whose input the DSP has returned, matched to its output buffer
+   by nTimeStamp. Free when nDspDoneTime is 0. */
+typedef struct VIDDEC_TELEMETRY_FRAME {
+    OMX_TICKS nTimeStamp;
+    OMX_TICKS nEmptyTime;
+    OMX_TICKS nDspDoneTime;
+} VIDDEC_TELEMETRY_FRAME;
+
+/* Decode telemetry, under mutexTelemetry. aSamples[stage] is a ring of
+   the last samples in us, nSamples[stage] counts them all;
+   aOutputTime follows the VIDDEC_TelemetryTotal ring. */
+typedef struct VIDDEC_TELEMETRY {
+    volatile OMX_BOOL bEnable;
+    OMX_U32 aSamples[VIDDEC_TelemetryStageMax][VIDDEC_TELEMETRY_WINDOW];
+    OMX_U32 nSamples[VIDDEC_TelemetryStageMax];
+    OMX_TICKS aOutputTime[VIDDEC_TELEMETRY_WINDOW];
+    VIDDEC_TELEMETRY_FRAME aFrames[VIDDEC_TELEMETRY_PENDING];
+    OMX_U32 nNextFrame;
+} VIDDEC_TELEMETRY;
 
 typedef enum VIDDEC_QUEUE_TYPES {
     VIDDEC_QUEUE_OMX_U32,
@@ -589,7 +691,8 @@ typedef enum VIDDEC_CBUFFER_TYPE {
 } VIDDEC_CBUFFER_TYPE;
 
 typedef struct VIDDEC_CIRCULAR_BUFFER {
-    OMX_PTR pElement[CBUFFER_SIZE];
+    OMX_PTR* pElement;                  /* nSize entries */
+    OMX_U32 nSize;
     VIDDEC_CBUFFER_TYPE nType;
 #ifdef VIDDEC_CBUFFER_LOCK
     pthread_mutex_t* m_lock;
@@ -597,6 +700,11 @@ typedef struct VIDDEC_CIRCULAR_BUFFER {
     OMX_U8 nTail;
     OMX_U8 nHead;
     OMX_U8 nCount;
+    /* timestamps of the queued elements as a min-heap over aPtsHeap,
+       always nCount of them; a reordering stream takes its output
+       timestamps from here */
+    OMX_TI_PTSHEAPTYPE sPtsHeap;
+    OMX_TICKS* aPtsHeap;                /* nSize entries */
 } VIDDEC_CIRCULAR_BUFFER;
 
 typedef struct VIDDEC_CBUFFER_BUFFERFLAGS{
@@ -612,7 +720,9 @@ typedef struct VIDDEC_PORT_TYPE
     OMX_HANDLETYPE hTunnelComponent;
     OMX_U32 nTunnelPort;
     OMX_BUFFERSUPPLIERTYPE eSupplierSetting;
-    VIDDEC_BUFFER_PRIVATE* pBufferPrivate[MAX_PRIVATE_BUFFERS];
+    OMX_BOOL bProprietaryTunnel;
+    VIDDEC_BUFFER_PRIVATE** pBufferPrivate; /* nBufferPrivateCnt entries */
+    OMX_U32 nBufferPrivateCnt;
     OMX_U8 nBufferCnt;
     VIDDEC_CIRCULAR_BUFFER eTimeStamp;
 } VIDDEC_PORT_TYPE;
@@ -635,165 +745,24 @@ typedef struct VIDDEC_SEMAPHORE{
 } VIDDEC_SEMAPHORE;
 
 #ifdef VIDDEC_ACTIVATEPARSER
-typedef struct VIDDEC_Point{
-    OMX_S32 nX;
-    OMX_S32 nY;
-}VIDDEC_Point;
-
-typedef struct VIDDEC_Rect{
-    VIDDEC_Point sTl;
-    VIDDEC_Point sBr;
-}VIDDEC_Rect;
-
-typedef struct VIDDEC_Size{
-    OMX_S32 nWidth;
-    OMX_S32 nHeight;
-}VIDDEC_Size;
-
-typedef struct VIDDEC_VideoPictureHeader{
-    OMX_U32 nOptions;
-    OMX_S32 nProfile;
-    OMX_S32 nLevel;
-    OMX_S32 nVersion;
-    OMX_U8* cnOptional;
-    VIDDEC_Size sSizeInMemory;
-    VIDDEC_Rect sDisplayedRect;
-    OMX_TICKS nPresentationTimestamp;
-    OMX_TICKS nDecodingTimestamp;
-    OMX_U32 nPreDecoderBufferSize;
-    OMX_U32 nPostDecoderBufferSize;
-    OMX_U32 nPictureNumber;
-    OMX_U32 nPictureLayer;
-    OMX_U8* pcSupplementalData;
-    OMX_BOOL bIsRandomAccessible;
-    OMX_S32 nRandomAccessBufferingPeriod;
-    OMX_U32 nRandomAccessBufferOccupancy;
-}VIDDEC_VideoPictureHeader;
-
-typedef struct VIDDEC_MPEG4VisualVbvParams{
-    OMX_TICKS nBitRate;
-    OMX_U32 nVbvBufferSize;
-    OMX_U32 nVbvOccupancy;
-}VIDDEC_MPEG4VisualVbvParams;
-
-typedef struct VIDDEC_MPEG4VisualVOLHeader{
-    OMX_U32 nVideoObjectLayerId;
-    OMX_BOOL bShortVideoHeader;
-    OMX_BOOL bRandomAccessibleVOL;
-    OMX_U32 nVideoObjectTypeIndication;
-    OMX_U32 nVideoObjectLayerVerId;
-    OMX_U32 nVideoObjectLayerPriority;
-    OMX_U32 nAspectRatioNum;
-    OMX_U32 nAspectRatioDenom;
-    VIDDEC_MPEG4VisualVbvParams sVbvParams;
-    OMX_U16 nVOPTimeIncrementResolution;
-    OMX_BOOL bnFnXedVopRate;
-    OMX_U16 nFnXedVOPTimeIncrement;
-    OMX_BOOL bDataPartitioning;
-    OMX_BOOL bReversibleVLC;
-    OMX_U8* pcUserData;
-}VIDDEC_MPEG4VisualVOLHeader ;
-
-typedef struct VIDDEC_MPEG4YuvConversionMatrix{
-    OMX_S32 iPostOffset;
-    OMX_S32 iMatrix;
-    OMX_S32 iPreOffset;
-}VIDDEC_MPEG4YuvConversionMatrix;
-
-typedef struct VIDDEC_MPEG4YuvFormat{
-    OMX_U32 iCoefficients;
-    OMX_U32 iPattern;
-    OMX_U32 iDataLayout;
-    VIDDEC_MPEG4YuvConversionMatrix * iYuv2RgbMatrix;
-    VIDDEC_MPEG4YuvConversionMatrix * iRgb2YuvMatrix;
-    OMX_U32 iAspectRatioNum;
-    OMX_U32 iAspectRatioDenom;
-}VIDDEC_MPEG4YuvFormat;
-
-typedef struct VIDDEC_MPEG4UncompressedVideoFormat{
-    OMX_U32 iDataFormat;
-    VIDDEC_MPEG4YuvFormat iYuvFormat;
-    OMX_U32 iRgbFormat;
-}VIDDEC_MPEG4UncompressedVideoFormat;
-
 typedef struct VIDDEC_AVC_ParserParam {
     OMX_U32 nBitPosTemp;
     OMX_U32 nForbiddenZeroBit;
     OMX_U32 nNalRefIdc;
-    OMX_U32 nProfileIdc;
-    OMX_U32 nConstraintSet0Flag;
-    OMX_U32 nConstraintSet1Flag;
-    OMX_U32 nConstraintSet2Flag;
-    OMX_U32 nReservedZero5bits;
-    OMX_U32 nLevelIdc;
-    OMX_U32 nSeqParameterSetId;
-    OMX_U32 nLog2MaxFrameNumMinus4;
-    OMX_U32 nPicOrderCntType;
-    OMX_U32 nLog2MaxPicOrderCntLsbMinus4;
-    OMX_S32 nOffsetForNonRefPic;
-    OMX_S32 nOffsetForTopToBottomField;
-    OMX_U32 nNumRefFramesInPicOrderCntCycle;
-    OMX_U32 nNumRefFrames;
-    OMX_S32 nGapsInFrameNumValueAllowedFlag;
-    OMX_U32 nPicWidthInMbsMinus1;
-    OMX_U32 nPicHeightInMapUnitsMinus1;
-    OMX_U32 nFrameMbsOnlyFlag;
-    OMX_S32 nMBAdaptiveFrameFieldFlag ;
-    OMX_U32 nDirect8x8InferenceFlag;
-    OMX_U32 nFrameCroppingFlag;
-    OMX_U32 nFrameCropLeftOffset;
-    OMX_U32 nFrameCropRightOffset;
-    OMX_U32 nFrameCropTopOffset;
-    OMX_U32 nFrameCropBottomOffset;
 }VIDDEC_AVC_ParserParam;
 
-typedef struct VIDDEC_MPEG4_ParserParam {
-    OMX_U32 nIsVisualObjectIdentifier;
-    OMX_U32 nVisualObjectType;
-    OMX_U32 nVideoSignalType;
-    OMX_U32 nVideoFormat;
-    OMX_U32 nVideoRange;
-    OMX_U32 nColorDescription;
-    OMX_U32 NBitZero;
-    OMX_U32 nVideoObjectTypeIndication;
-    OMX_U32 nIsVisualObjectLayerIdentifier;
-    OMX_U32 nLayerVerId;
-    OMX_U32 nLayerPriority;
-    OMX_U32 nAspectRadio;
-    OMX_U32 nParWidth;
-    OMX_U32 nParHeight;
-    OMX_U32 nControlParameters;
-    OMX_U32 nChromaFormat;
-    OMX_U32 nLowDelay;
-    OMX_U32 nVbvParameters;
-    OMX_U32 nBitRate;
-    OMX_U32 nFirstHalfVbvBufferSize;
-    OMX_U32 nLatterHalfVbvBufferSize;
-    OMX_U32 nFirstHalfVbvOccupancy;
-    OMX_U32 nLatterHalfVbvOccupancy;
-    OMX_U32 nLayerShape;
-    OMX_U32 nTimeIncrementResolution;
-    OMX_U32 nFnXedVopRate;
-    OMX_U32 nNum_bits;
-    OMX_U32 nInterlaced;
-    OMX_U32 nObmc;
-    OMX_U32 nUFEP;
-    OMX_U32 NSpriteNotSupported;
-    OMX_U32 nNot8Bit;
-    OMX_U32 nQuantPrecision;
-    OMX_U32 nBitsPerPnXel;
-    OMX_U32 nIsInverseQuantMethodFirst;
-    OMX_U32 nComplexityEstimationDisable;
-    OMX_U32 nIsResyncMarkerDisabled;
-    OMX_U32 nIsDataPartitioned;
-    OMX_U32 nRvlc;
-    OMX_U32 nScalability;
-    OMX_S32 nSourceFormat;
-    OMX_BOOL nOutputFormat;
-    OMX_U32 nCPM;
-    OMX_U32 nPWI;
-    OMX_U32 nPHI;
-}VIDDEC_MPEG4_ParserParam;
+/* RBSP bytes of an SPS with emulation prevention bytes that are unescaped
+   for parsing; the fields read end well before that */
+#define VIDDEC_AVC_SCRATCH_SIZE 512
+
+/* Per instance state of the AVC header parser */
+typedef struct VIDDEC_AVC_PARSERCTX {
+    VIDDEC_AVC_ParserParam sParam;
+    /* start codes seen so far in the config data being assembled */
+    OMX_U32 nConfigStartCodes;
+    OMX_U8 aScratch[VIDDEC_AVC_SCRATCH_SIZE];
+} VIDDEC_AVC_PARSERCTX;
+
 #endif
 
 #define VIDDEC_RCV_EXTHEADER_SIZE 4
@@ -880,16 +849,34 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
     OMX_VERSIONTYPE pSpecVersion;
     OMX_STRING cComponentName;
     pthread_t ComponentThread;
-    int free_inpBuf_Q[2];
-    int free_outBuf_Q[2];
-    int filled_inpBuf_Q[2];
-    int filled_outBuf_Q[2];
-    int cmdPipe[2];
-    int cmdDataPipe[2];
+    /* Work for the component thread. Producers put an entry and ring
+       nWakeFd (an eventfd) unless a wake is already pending; the thread
+       drains every ring on each wake. */
+    OMX_TI_RINGTYPE free_inpBuf_Q;
+    OMX_TI_RINGTYPE free_outBuf_Q;
+    OMX_TI_RINGTYPE filled_inpBuf_Q;
+    OMX_TI_RINGTYPE filled_outBuf_Q;
+    OMX_TI_RINGTYPE cmdQ;
+    int nWakeFd;
+    volatile OMX_U32 bWakePending;
     OMX_U32 bIsStopping;
     OMX_U32 bIsPaused;
     OMX_U32 bTransPause;
     OMX_U32 ProcessMode;
+    OMX_U32 nReorderDepth;              /* VIDDEC_REORDER_DEPTH_AUTO: from the stream */
+    VIDDEC_PARAM_ADAPTIVEPLAYBACKTYPE sAdaptivePlayback;
+    OMX_CONFIG_RECTTYPE sOutputCrop;    /* visible part of the output frames */
+    VIDDEC_CONFIG_DECODEDEADLINETYPE sDecodeDeadline;
+    OMX_TICKS nDeadlineAnchor;          /* monotonic time of the last clock update, us */
+    VIDDEC_PARAM_THUMBNAILTYPE sThumbnail;
+    VIDDEC_THUMBNAIL_STATES eThumbnailState;
+    OMX_U32 nThumbnailSavedCountMin;    /* output counts before thumbnail mode */
+    OMX_U32 nThumbnailSavedCountActual;
+    volatile OMX_BOOL bSeekPending;     /* input dropped up to a random access point */
+    VIDDEC_PARAM_NALCOALESCINGTYPE sNalCoalescing;
+    VIDDEC_TELEMETRY sTelemetry;
+    OMX_BUFFERHEADERTYPE* pCoalesceBuffer;  /* input buffer gathering an access unit */
+    OMX_BOOL bCoalesceHasSlice;         /* pCoalesceBuffer holds a slice */
     OMX_U32 H264BitStreamFormat;
     OMX_BOOL MPEG4Codec_IsTI;
     OMX_BUFFERHEADERTYPE pTempBuffHead;  /*Used for EOS logic*/
@@ -911,9 +898,7 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
     OMX_PARAM_COMPONENTROLETYPE componentRole;
     /*MBError Reporting code*/
     OMX_CONFIG_MBERRORREPORTINGTYPE eMBErrorReport;
-    OMX_CONFIG_MACROBLOCKERRORMAPTYPE_TI eMBErrorMapType[MAX_PRIVATE_BUFFERS];
-    OMX_U8 cMBErrorIndexIn;
-    OMX_U8 cMBErrorIndexOut;
+    OMX_BUFFERHEADERTYPE* pMBErrorMapLast;  /* output buffer of the last map delivered */
 #endif
     OMX_U8 nInMarkBufIndex;                          /* for OMX_MARKTYPE */
     OMX_U8 nOutMarkBufIndex;                         /* for OMX_MARKTYPE */
@@ -936,7 +921,6 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
     OMX_STATETYPE eIdleToLoad;
     OMX_STATETYPE eExecuteToIdle;
     OMX_BOOL iEndofInputSent;
-    OMX_BOOL bPipeCleaned;
     OMX_BOOL bFirstBuffer;
 
     OMX_BOOL bParserEnabled;
@@ -961,7 +945,8 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
     OMX_U8 nCountInputBFromApp;
     OMX_U8 nCountOutputBFromApp;
 
-    VIDDEC_CBUFFER_BUFFERFLAGS aBufferFlags[CBUFFER_SIZE];
+    VIDDEC_CBUFFER_BUFFERFLAGS* aBufferFlags;   /* CBUFFER_SIZE(nMaxBufferCount) */
+    OMX_U32 nMaxBufferCount;                    /* ceiling of nBufferCountActual */
     VIDDEC_LCML_STATES eLCMLState;
     OMX_U32 nWMVFileType;
     OMX_BOOL bIsNALBigEndian;
@@ -973,6 +958,8 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
     pthread_mutex_t mutexOutputBFromApp;
     pthread_mutex_t mutexInputBFromDSP;
     pthread_mutex_t mutexOutputBFromDSP;
+    pthread_mutex_t mutexDecodeDeadline;
+    pthread_mutex_t mutexTelemetry;
     VIDDEC_MUTEX inputFlushCompletionMutex;
     VIDDEC_MUTEX outputFlushCompletionMutex;
     OMX_BOOL bIsInputFlushPending;
@@ -1004,6 +991,11 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
     OMX_BOOL bConfigBufferCompleteAVC;
     OMX_PTR pInternalConfigBufferAVC;
     OMX_U32 nInternalConfigBufferFilledAVC;
+    /* Filled by VIDDEC_ParseVideo_H264, sizes the output port */
+    OMX_TI_AVCSPSTYPE sAVCStreamInfo;
+    /* output buffer count the last parsed SPS asked for, 0 before the first */
+    OMX_U32 nAVCOutBufferCount;
+    VIDDEC_AVC_PARSERCTX sAVCParser;
     struct OMX_TI_Debug dbg;
     /* track number of codec config data (CCD) units and sizes */
     OMX_U32 aCCDsize[MAX_CCD_CNT];
@@ -1039,7 +1031,8 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
 /*----------------------------------------------------------------------------*/
 
 #define OMX_GET_DATABUFF_SIZE(_nSizeBytes_)                         \
-         (_nSizeBytes_ + VIDDEC_PADDING_FULL + VIDDEC_WMV_BUFFER_OFFSET + VIDDEC_ALIGNMENT)
+         (_nSizeBytes_ + VIDDEC_PADDING_FULL + VIDDEC_WMV_BUFFER_OFFSET + VIDDEC_ALIGNMENT + \
+          VIDDEC_CONFIG_HEADROOM)
 
 
 #define OMX_MALLOC_STRUCT(_pStruct_, _sName_, _memusage_)           \
@@ -1132,7 +1125,7 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
 	int _nBufferCount_ = 0;									    \
 	OMX_U8* _pTemp_ = NULL;									    \
 												    \
-	for(_nBufferCount_ = 0; _nBufferCount_ < MAX_PRIVATE_BUFFERS; _nBufferCount_++){	    \
+	for(_nBufferCount_ = 0; _nBufferCount_ < (int)_pCompPort_->nBufferPrivateCnt; _nBufferCount_++){ \
             if(_pCompPort_->pBufferPrivate[_nBufferCount_]->pBufferHdr != NULL){		    \
                 _pTemp_ = (OMX_U8*)_pCompPort_->pBufferPrivate[_nBufferCount_]->pBufferHdr->pBuffer;	\
                 if(_pBuffHead_->pBuffer == _pTemp_){						    \
@@ -1141,7 +1134,7 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
 	    }											    \
         }											    \
 												    \
-        if(_nBufferCount_ == MAX_PRIVATE_BUFFERS){						    \
+        if(_nBufferCount_ == (int)_pCompPort_->nBufferPrivateCnt){				    \
             OMX_ERROR4(pComponentPrivate->dbg, "Error: Buffer NOT found to free: %p \n", _pBuffHead_->pBuffer);	    \
             goto EXIT;										    \
         }											    \
@@ -1228,14 +1221,6 @@ typedef struct VIDDEC_COMPONENT_PRIVATE
     goto EXIT;                                  \
 }
 
-
-#define OMX_PARSER_CHECKLIMIT(_total, _actual, _step) /*  \
-    if(((_actual + _step) >> 3) >= _total){                \
-    printf("_total %d _actual %d\n",_total,((_actual + _step)>>3)); \
-        eError = OMX_ErrorStreamCorrupt;                \
-        goto EXIT;                                      \
-    }*/
-
 /*sMutex*/
 #define VIDDEC_PTHREAD_MUTEX_INIT(_mutex_)    \
     if(!((_mutex_).bInitialized)) {            \
@@ -1380,6 +1365,11 @@ typedef OMX_ERRORTYPE (*VIDDEC_fpo)(OMX_HANDLETYPE);
 OMX_ERRORTYPE OMX_ComponentInit (OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE VIDDEC_Start_ComponentThread (OMX_HANDLETYPE pHandle);
 OMX_ERRORTYPE VIDDEC_Stop_ComponentThread(OMX_HANDLETYPE pComponent);
+int VIDDEC_Ring_PutBuffer(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_TI_RINGTYPE* pRing, OMX_BUFFERHEADERTYPE* pBuffHead);
+int VIDDEC_Ring_GetBuffer(OMX_TI_RINGTYPE* pRing, OMX_BUFFERHEADERTYPE** ppBuffHead);
+int VIDDEC_Ring_PutCommand(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_COMMANDTYPE eCmd, OMX_U32 nParam1, OMX_PTR pCmdData);
+OMX_BOOL VIDDEC_Ring_GetCommand(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_COMMANDTYPE* peCmd, OMX_U32* pnParam1, OMX_PTR* ppCmdData);
+int VIDDEC_Ring_Wait(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_S32 nTimeoutUs);
 OMX_ERRORTYPE VIDDEC_HandleCommand (OMX_HANDLETYPE pHandle, OMX_U32 nParam1);
 OMX_ERRORTYPE VIDDEC_DisablePort (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_U32 nParam1);
 OMX_ERRORTYPE VIDDEC_EnablePort (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_U32 nParam1);
@@ -1399,7 +1389,20 @@ OMX_ERRORTYPE VIDDEC_ReturnBuffers (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
 OMX_ERRORTYPE VIDDEC_HandleCommandMarkBuffer(VIDDEC_COMPONENT_PRIVATE *pComponentPrivate, OMX_U32 nParam1, OMX_PTR pCmdData);
 OMX_ERRORTYPE VIDDEC_HandleCommandFlush(VIDDEC_COMPONENT_PRIVATE *pComponentPrivate, OMX_U32 nParam1, OMX_BOOL bPass);
 OMX_ERRORTYPE VIDDEC_Load_Defaults (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_S32 nPassing);
+OMX_ERRORTYPE VIDDEC_Port_ReserveBuffers(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, VIDDEC_PORT_INDEX nPortIndex, OMX_U32 nCount);
+void VIDDEC_SetDecodeDeadline(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, const VIDDEC_CONFIG_DECODEDEADLINETYPE* pDeadline);
+void VIDDEC_GetDecodeDeadline(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, VIDDEC_CONFIG_DECODEDEADLINETYPE* pDeadline);
+void VIDDEC_Coalesce_Release(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate);
+void VIDDEC_SetDecodeTelemetry(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, const VIDDEC_CONFIG_DECODETELEMETRYTYPE* pTelemetry);
+void VIDDEC_GetDecodeTelemetry(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, VIDDEC_CONFIG_DECODETELEMETRYTYPE* pTelemetry);
+void VIDDEC_Telemetry_Received(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_BUFFERHEADERTYPE* pBuffHead);
+void VIDDEC_Telemetry_Output(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_BUFFERHEADERTYPE* pBuffHead);
+void VIDDEC_Telemetry_Flush(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate);
+#ifdef KHRONOS_1_1
+const VIDDEC_MBERRORMAP* VIDDEC_FindMBErrorMap(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_BUFFERHEADERTYPE* pBuffHead);
+#endif
 OMX_U32 VIDDEC_GetRMFrecuency(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate);
+OMX_U32 VIDDEC_AVC_LevelIdc(OMX_VIDEO_AVCLEVELTYPE eLevel);
 OMX_ERRORTYPE VIDDEC_Handle_InvalidState (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate);
 
 OMX_ERRORTYPE VIDDEC_CircBuf_Init(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, VIDDEC_CBUFFER_TYPE nTypeIndex, VIDDEC_PORT_INDEX nPortIndex);
@@ -1438,8 +1441,6 @@ OMX_ERRORTYPE VIDDEC_ParseVideo_H264(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate
                                      OMX_BUFFERHEADERTYPE* pBuffHead,OMX_S32* nWidth,
                                      OMX_S32* nHeight, OMX_S32* nCropWidth, OMX_S32* nCropHeight, OMX_U32 nType);
 OMX_ERRORTYPE VIDDEC_ParseVideo_MPEG2( OMX_S32* nWidth, OMX_S32* nHeight, OMX_BUFFERHEADERTYPE *pBuffHead);
-OMX_U32 VIDDEC_GetBits(OMX_U32* nPosition, OMX_U8 nBits, OMX_U8* pBuffer, OMX_BOOL bIcreasePosition);
-OMX_S32 VIDDEC_UVLC_dec(OMX_U32 *nPosition, OMX_U8* pBuffer);
 OMX_ERRORTYPE AddStateTransition(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate);
 OMX_ERRORTYPE RemoveStateTransition(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_BOOL bEnableSignal);
 OMX_ERRORTYPE IncrementCount (OMX_U8 * pCounter, pthread_mutex_t *pMutex);
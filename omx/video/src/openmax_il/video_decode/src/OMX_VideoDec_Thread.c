@@ -92,10 +92,93 @@ extern OMX_ERRORTYPE VIDDEC_HandleCommandMarkBuffer(VIDDEC_COMPONENT_PRIVATE *pC
 extern OMX_ERRORTYPE VIDDEC_HandleCommandFlush(VIDDEC_COMPONENT_PRIVATE *pComponentPrivate, OMX_U32 nParam1, OMX_BOOL bPass);
 extern OMX_ERRORTYPE VIDDEC_Handle_InvalidState (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate);
 
+/*----------------------------------------------------------------------------*/
+/**
+  * OMX_VidDec_HandleCommands() runs the oldest command queued by SendCommand.
+  * One per round, as the command pipe was read, so that a MarkBuffer still
+  * lands between the same input buffers. Returns OMX_TRUE when the thread
+  * has to exit.
+  **/
+/*----------------------------------------------------------------------------*/
+static OMX_BOOL OMX_VidDec_HandleCommands (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                           OMX_BOOL* pbProgress)
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_COMMANDTYPE eCmd;
+    OMX_U32 nParam1;
+    OMX_PTR pCmdData;
+
+    if (VIDDEC_Ring_GetCommand(pComponentPrivate, &eCmd, &nParam1, &pCmdData)) {
+        *pbProgress = OMX_TRUE;
+#ifdef __PERF_INSTRUMENTATION__
+        PERF_ReceivedCommand(pComponentPrivate->pPERFcomp,
+                             eCmd, nParam1, PERF_ModuleLLMM);
+#endif
+        if (eCmd == OMX_CommandStateSet) {
+            if ((OMX_S32)nParam1 < -2) {
+                OMX_ERROR2(pComponentPrivate->dbg, "Incorrect variable value used\n");
+            }
+            if ((OMX_S32)nParam1 != -1 && (OMX_S32)nParam1 != -2) {
+                eError = VIDDEC_HandleCommand(pComponentPrivate, nParam1);
+                if (eError != OMX_ErrorNone) {
+                    /*pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                           pComponentPrivate->pHandle->pApplicationPrivate,
+                                                           OMX_EventError,
+                                                           eError, 
+                                                           0,
+                                                           "Error in HadleCommand function");*/
+                }
+            } 
+            else if ((OMX_S32)nParam1 == -1) {
+                return OMX_TRUE;
+            }
+            else if ((OMX_S32)nParam1 == -2) {
+                OMX_VidDec_Return(pComponentPrivate);
+                VIDDEC_Handle_InvalidState( pComponentPrivate);
+                return OMX_TRUE;
+            }
+        } 
+        else if (eCmd == OMX_CommandPortDisable) {
+            eError = VIDDEC_DisablePort(pComponentPrivate, nParam1);
+            if (eError != OMX_ErrorNone) {
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                       pComponentPrivate->pHandle->pApplicationPrivate,
+                                                       OMX_EventError,
+                                                       eError, 
+                                                       OMX_TI_ErrorSevere,
+                                                       "Error in DisablePort function");
+            }
+        }
+        else if (eCmd == OMX_CommandPortEnable) {
+            eError = VIDDEC_EnablePort(pComponentPrivate, nParam1);
+            if (eError != OMX_ErrorNone) {
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                       pComponentPrivate->pHandle->pApplicationPrivate,
+                                                       OMX_EventError,
+                                                       eError, 
+                                                       OMX_TI_ErrorSevere,
+                                                       "Error in EnablePort function");
+            }
+        } else if (eCmd == OMX_CommandFlush) {
+            VIDDEC_HandleCommandFlush (pComponentPrivate, nParam1, OMX_TRUE);
+        }
+        else if (eCmd == OMX_CommandMarkBuffer)    {
+            pComponentPrivate->arrCmdMarkBufIndex[pComponentPrivate->nInCmdMarkBufIndex].hMarkTargetComponent = ((OMX_MARKTYPE*)(pCmdData))->hMarkTargetComponent;
+            pComponentPrivate->arrCmdMarkBufIndex[pComponentPrivate->nInCmdMarkBufIndex].pMarkData = ((OMX_MARKTYPE*)(pCmdData))->pMarkData;
+            pComponentPrivate->nInCmdMarkBufIndex++;
+            pComponentPrivate->nInCmdMarkBufIndex %= VIDDEC_MAX_QUEUE_SIZE;
+        }
+    }
+    return OMX_FALSE;
+}
+
 /*----------------------------------------------------------------------------*/
 /**
   * OMX_VidDec_Thread() is the open max thread. This method is in charge of
-  * listening to the buffers coming from DSP, application or commands through the pipes
+  * listening to the buffers coming from DSP, application or commands through
+  * the rings. Each wake drains the rings: one command, then one buffer of each
+  * kind, over and over until nothing is left, so a burst of buffers costs one
+  * wake instead of one select per buffer.
   **/
 /*----------------------------------------------------------------------------*/
 
@@ -105,25 +188,13 @@ extern OMX_ERRORTYPE VIDDEC_Handle_InvalidState (VIDDEC_COMPONENT_PRIVATE* pComp
 void* OMX_VidDec_Thread (void* pThreadData)
 {
     int status;
-#ifdef UNDER_CE
-    struct timeval tv;
-#else
-    sigset_t set;
-    struct timespec tv;
-#endif
-    int fdmax;
-    fd_set rfds;
     OMX_ERRORTYPE eError = OMX_ErrorNone;
-    OMX_COMMANDTYPE eCmd;
-    OMX_U32 nParam1;
-    OMX_PTR pCmdData;
     VIDDEC_COMPONENT_PRIVATE* pComponentPrivate;
     LCML_DSP_INTERFACE *pLcmlHandle;
-    OMX_U32 aParam[4];
-#ifndef UNDER_CE
-    OMX_BOOL bFlag = OMX_FALSE;
-#endif
-    /*OMX_U32 timeout = 0;*/
+    OMX_BOOL bProgress;
+    /* a buffer was left in a ring because the component was not ready for
+       it, look again without waiting for a new wake */
+    OMX_BOOL bPending = OMX_FALSE;
 
     pComponentPrivate = (VIDDEC_COMPONENT_PRIVATE*)pThreadData;
 
@@ -134,321 +205,60 @@ void* OMX_VidDec_Thread (void* pThreadData)
 
     pLcmlHandle = (LCML_DSP_INTERFACE *)pComponentPrivate->pLCML;
 
-    /**Looking for highest number of file descriptor for pipes in order to put in select loop */
-    fdmax = pComponentPrivate->cmdPipe[VIDDEC_PIPE_READ];
-
-    if (pComponentPrivate->free_inpBuf_Q[VIDDEC_PIPE_READ] > fdmax) {
-        fdmax = pComponentPrivate->free_inpBuf_Q[VIDDEC_PIPE_READ];
-    }
-
-    if (pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_READ] > fdmax) {
-        fdmax = pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_READ];
-    }
-
-    if (pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_READ] > fdmax) {
-        fdmax = pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_READ];
-    }
-
-    if (pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_READ] > fdmax) {
-        fdmax = pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_READ];
-    }
-
     while (1) {
-        FD_ZERO (&rfds);
-        FD_SET(pComponentPrivate->cmdPipe[VIDDEC_PIPE_READ], &rfds);
-        FD_SET(pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_READ], &rfds);
-        FD_SET(pComponentPrivate->free_inpBuf_Q[VIDDEC_PIPE_READ], &rfds);
-        FD_SET(pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_READ], &rfds);
-        FD_SET(pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_READ], &rfds);
-
-#ifdef UNDER_CE
-        tv.tv_sec = 0;
-        tv.tv_usec = VIDD_TIMEOUT * 30; 
-#else
-        tv.tv_sec = 0;
-        tv.tv_nsec = 30000;
-#endif
-
-
-#ifdef UNDER_CE
-        status = select (fdmax+1, &rfds, NULL, NULL, NULL);
-#else
-        sigemptyset (&set);
-        sigaddset (&set, SIGALRM);
-        status = pselect (fdmax+1, &rfds, NULL, NULL, NULL, &set);
-        sigdelset (&set, SIGALRM);
-#endif
-        
-        if (0 == status) {
-            ;
-        } 
-        else if (-1 == status) {
-            OMX_TRACE4(pComponentPrivate->dbg, "Error in Select\n");
-            pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                   pComponentPrivate->pHandle->pApplicationPrivate,
-                                                   OMX_EventError,
-                                                   OMX_ErrorInsufficientResources, 
-                                                   OMX_TI_ErrorSevere,
-                                                   "Error from Component Thread in select");
-	     eError = OMX_ErrorInsufficientResources;
-            break;
-        }
-        else {
-            if (FD_ISSET(pComponentPrivate->cmdPipe[VIDDEC_PIPE_READ], &rfds)) {
-#ifndef UNDER_CE
-            if(!bFlag) {
-            
-                bFlag = OMX_TRUE;
-#endif
-                read(pComponentPrivate->cmdPipe[VIDDEC_PIPE_READ], &eCmd, sizeof(eCmd));
-                read(pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_READ], &nParam1, sizeof(nParam1));
-                
-#ifdef __PERF_INSTRUMENTATION__
-                PERF_ReceivedCommand(pComponentPrivate->pPERFcomp,
-                                     eCmd, nParam1, PERF_ModuleLLMM);
-#endif
-                if (eCmd == OMX_CommandStateSet) {
-                    if ((OMX_S32)nParam1 < -2) {
-                        OMX_ERROR2(pComponentPrivate->dbg, "Incorrect variable value used\n");
-                    }
-                    if ((OMX_S32)nParam1 != -1 && (OMX_S32)nParam1 != -2) {
-                        eError = VIDDEC_HandleCommand(pComponentPrivate, nParam1);
-                        if (eError != OMX_ErrorNone) {
-                            /*pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                                   pComponentPrivate->pHandle->pApplicationPrivate,
-                                                                   OMX_EventError,
-                                                                   eError, 
-                                                                   0,
-                                                                   "Error in HadleCommand function");*/
-                        }
-                    } 
-                    else if ((OMX_S32)nParam1 == -1) {
-                        break;
-                    }
-                    else if ((OMX_S32)nParam1 == -2) {
-                        OMX_VidDec_Return(pComponentPrivate);
-                        VIDDEC_Handle_InvalidState( pComponentPrivate);
-                        break;
-                    }
-                } 
-                else if (eCmd == OMX_CommandPortDisable) {
-                    eError = VIDDEC_DisablePort(pComponentPrivate, nParam1);
-                    if (eError != OMX_ErrorNone) {
-                        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                                               OMX_EventError,
-                                                               eError, 
-                                                               OMX_TI_ErrorSevere,
-                                                               "Error in DisablePort function");
-                    }
-                }
-                else if (eCmd == OMX_CommandPortEnable) {
-                    eError = VIDDEC_EnablePort(pComponentPrivate, nParam1);
-                    if (eError != OMX_ErrorNone) {
-                        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                                               OMX_EventError,
-                                                               eError, 
-                                                               OMX_TI_ErrorSevere,
-                                                               "Error in EnablePort function");
-                    }
-                } else if (eCmd == OMX_CommandFlush) {
-                    VIDDEC_HandleCommandFlush (pComponentPrivate, nParam1, OMX_TRUE);
-                }
-                else if (eCmd == OMX_CommandMarkBuffer)    {
-                    read(pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_READ], &pCmdData, sizeof(pCmdData));
-                    pComponentPrivate->arrCmdMarkBufIndex[pComponentPrivate->nInCmdMarkBufIndex].hMarkTargetComponent = ((OMX_MARKTYPE*)(pCmdData))->hMarkTargetComponent;
-                    pComponentPrivate->arrCmdMarkBufIndex[pComponentPrivate->nInCmdMarkBufIndex].pMarkData = ((OMX_MARKTYPE*)(pCmdData))->pMarkData;
-                    pComponentPrivate->nInCmdMarkBufIndex++;
-                    pComponentPrivate->nInCmdMarkBufIndex %= VIDDEC_MAX_QUEUE_SIZE;
-
-                }
-#ifndef UNDER_CE
-    bFlag = OMX_FALSE;
-#endif
-
-#ifndef UNDER_CE
+        if (!bPending) {
+            status = VIDDEC_Ring_Wait(pComponentPrivate, -1);
+            if (0 == status) {
+                continue;
             }
-#endif
-        }
-            if(pComponentPrivate->bPipeCleaned){
-                pComponentPrivate->bPipeCleaned =0;
-            }
-            else{
-                if (FD_ISSET(pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_READ], &rfds)) {
-                    if(pComponentPrivate->bDynamicConfigurationInProgress){
-                        VIDDEC_WAIT_CODE();
-                        continue;
-                    }
-                    eError = VIDDEC_HandleDataBuf_FromDsp(pComponentPrivate);
-                    if (eError != OMX_ErrorNone) {
-                        OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while handling filled DSP output buffer\n");
-                        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                                               OMX_EventError,
-                                                               eError,
-                                                               OMX_TI_ErrorSevere,
-                                                               "Error from Component Thread while processing dsp Responses");
-                    }
-                }
-                if ((FD_ISSET(pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_READ], &rfds))){
-                    OMX_PRSTATE2(pComponentPrivate->dbg, "eExecuteToIdle 0x%x\n",pComponentPrivate->eExecuteToIdle);
-                    /* When doing a reconfiguration, don't send input buffers to SN & wait for SN to be ready*/
-                    if(pComponentPrivate->bDynamicConfigurationInProgress == OMX_TRUE || 
-                            pComponentPrivate->eLCMLState != VidDec_LCML_State_Start){
-                        VIDDEC_WAIT_CODE();
-                         continue;
-                    }
-                    else{
-                   eError = VIDDEC_HandleDataBuf_FromApp (pComponentPrivate);     
-                    if (eError != OMX_ErrorNone) {
-                        OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while handling filled input buffer\n");
-                        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                                               OMX_EventError,
-                                                               eError, 
-                                                               OMX_TI_ErrorSevere,
-                                                               "Error from Component Thread while processing input buffer");
-                    }
-                }
-                }
-                if (FD_ISSET(pComponentPrivate->free_inpBuf_Q[VIDDEC_PIPE_READ], &rfds)) {
-                    if(pComponentPrivate->bDynamicConfigurationInProgress){
-                        VIDDEC_WAIT_CODE();
-                        continue;
-                    }
-                    eError = VIDDEC_HandleFreeDataBuf(pComponentPrivate);
-                    if (eError != OMX_ErrorNone) {
-                        OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while processing free input buffers\n");
-                        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                                               OMX_EventError,
-                                                               eError,  
-                                                               OMX_TI_ErrorSevere,
-                                                               "Error from Component Thread while processing free input buffer");
-                    }
-                }
-                if (FD_ISSET(pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_READ], &rfds)) {
-                     if(pComponentPrivate->bDynamicConfigurationInProgress){
-                        VIDDEC_WAIT_CODE();
-                          continue;
-                     }
-                    OMX_PRSTATE2(pComponentPrivate->dbg, "eExecuteToIdle 0x%x\n",pComponentPrivate->eExecuteToIdle);
-                    eError = VIDDEC_HandleFreeOutputBufferFromApp(pComponentPrivate);
-                    if (eError != OMX_ErrorNone) {
-                        OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while processing free output buffer\n");
-                        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                                               OMX_EventError,
-                                                               eError, 
-                                                               OMX_TI_ErrorSevere,
-                                                               "Error from Component Thread while processing free output buffer");
-                    }
-                }
+            else if (-1 == status) {
+                OMX_TRACE4(pComponentPrivate->dbg, "Error in Select\n");
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                       pComponentPrivate->pHandle->pApplicationPrivate,
+                                                       OMX_EventError,
+                                                       OMX_ErrorInsufficientResources, 
+                                                       OMX_TI_ErrorSevere,
+                                                       "Error from Component Thread in select");
+                eError = OMX_ErrorInsufficientResources;
+                break;
             }
         }
-    }
+        bPending = OMX_FALSE;
 
-#ifdef __PERF_INSTRUMENTATION__
-    PERF_Done(pComponentPrivate->pPERFcomp);
-#endif
-
-    return (void *)eError;
-}
-
-void* OMX_VidDec_Return (void* pThreadData)
-{
-    int status = 0;
-    struct timeval tv1;
-#ifdef UNDER_CE
-    struct timeval tv;
-#else
-    sigset_t set;
-    struct timespec tv;
-#endif
-    int fdmax = 0;
-    OMX_U32 iLock = 0;
-    fd_set rfds;
-    OMX_ERRORTYPE eError = OMX_ErrorNone;
-    VIDDEC_COMPONENT_PRIVATE* pComponentPrivate = NULL;
-
-    pComponentPrivate = (VIDDEC_COMPONENT_PRIVATE*)pThreadData;
-    gettimeofday(&tv1, NULL);
-    /**Looking for highest number of file descriptor for pipes in order to put in select loop */
-    fdmax = pComponentPrivate->free_inpBuf_Q[VIDDEC_PIPE_READ];
-
-    if (pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_READ] > fdmax) {
-        fdmax = pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_READ];
-    }
-
-    if (pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_READ] > fdmax) {
-        fdmax = pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_READ];
-    }
-
-    if (pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_READ] > fdmax) {
-        fdmax = pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_READ];
-    }
-    while ((pComponentPrivate->nCountInputBFromApp != 0 &&
-                (pComponentPrivate->eLCMLState == VidDec_LCML_State_Start && pComponentPrivate->bDynamicConfigurationInProgress == OMX_FALSE)) ||
-            pComponentPrivate->nCountOutputBFromApp != 0 ||
-            pComponentPrivate->nCountInputBFromDsp != 0 || pComponentPrivate->nCountOutputBFromDsp != 0) {
-        FD_ZERO (&rfds);
-        FD_SET(pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_READ], &rfds);
-        FD_SET(pComponentPrivate->free_inpBuf_Q[VIDDEC_PIPE_READ], &rfds);
-        FD_SET(pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_READ], &rfds);
-        FD_SET(pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_READ], &rfds);
-
-#ifdef UNDER_CE
-        tv.tv_sec = 0;
-        tv.tv_usec = VIDD_TIMEOUT * 30; 
-#else
-    tv.tv_sec = 0;
-    tv.tv_nsec = 10000;
-#endif
-
-        
-#ifdef UNDER_CE
-        status = select (fdmax+1, &rfds, NULL, NULL, &tv);
-#else
-        sigemptyset (&set);
-        sigaddset (&set, SIGALRM);
-        status = pselect (fdmax+1, &rfds, NULL, NULL, &tv, &set);
-        sigdelset (&set, SIGALRM);
-#endif
-        if (0 == status) {
-            iLock++;
-            if (iLock > 2){
-                pComponentPrivate->bPipeCleaned = 1;
-                break;
+        do {
+            bProgress = OMX_FALSE;
+            if (OMX_VidDec_HandleCommands(pComponentPrivate, &bProgress)) {
+                goto EXIT;
             }
-        } 
-        else if (-1 == status) {
-            OMX_PRINT2(pComponentPrivate->dbg, "Error in Select\n");
-            pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                   pComponentPrivate->pHandle->pApplicationPrivate,
-                                                   OMX_EventError,
-                                                   OMX_ErrorInsufficientResources, 
-                                                   OMX_TI_ErrorSevere,
-                                                   "Error from Component Thread in select");
-	     eError = OMX_ErrorInsufficientResources;
-	     break;
-        } 
-        else {
-            if (FD_ISSET(pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_READ], &rfds)) {
+
+            if (!OMX_TI_RingEmpty(&pComponentPrivate->filled_outBuf_Q)) {
+                if(pComponentPrivate->bDynamicConfigurationInProgress){
+                    VIDDEC_WAIT_CODE();
+                    bPending = OMX_TRUE;
+                    break;
+                }
+                bProgress = OMX_TRUE;
                 eError = VIDDEC_HandleDataBuf_FromDsp(pComponentPrivate);
                 if (eError != OMX_ErrorNone) {
                     OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while handling filled DSP output buffer\n");
                     pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
                                                            pComponentPrivate->pHandle->pApplicationPrivate,
                                                            OMX_EventError,
-                                                           eError, 
+                                                           eError,
                                                            OMX_TI_ErrorSevere,
                                                            "Error from Component Thread while processing dsp Responses");
                 }
             }
-            if ((FD_ISSET(pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_READ], &rfds))){
+            if (!OMX_TI_RingEmpty(&pComponentPrivate->filled_inpBuf_Q)) {
                 OMX_PRSTATE2(pComponentPrivate->dbg, "eExecuteToIdle 0x%x\n",pComponentPrivate->eExecuteToIdle);
-                if(!(pComponentPrivate->bDynamicConfigurationInProgress == OMX_TRUE && pComponentPrivate->bInPortSettingsChanged == OMX_FALSE)){
+                /* When doing a reconfiguration, don't send input buffers to SN & wait for SN to be ready*/
+                if(pComponentPrivate->bDynamicConfigurationInProgress == OMX_TRUE || 
+                        pComponentPrivate->eLCMLState != VidDec_LCML_State_Start){
+                    VIDDEC_WAIT_CODE();
+                    bPending = OMX_TRUE;
+                    break;
+                }
+                bProgress = OMX_TRUE;
                 eError = VIDDEC_HandleDataBuf_FromApp (pComponentPrivate);     
                 if (eError != OMX_ErrorNone) {
                     OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while handling filled input buffer\n");
@@ -459,9 +269,14 @@ void* OMX_VidDec_Return (void* pThreadData)
                                                            OMX_TI_ErrorSevere,
                                                            "Error from Component Thread while processing input buffer");
                 }
-                }
             }
-            if (FD_ISSET(pComponentPrivate->free_inpBuf_Q[VIDDEC_PIPE_READ], &rfds)) {
+            if (!OMX_TI_RingEmpty(&pComponentPrivate->free_inpBuf_Q)) {
+                if(pComponentPrivate->bDynamicConfigurationInProgress){
+                    VIDDEC_WAIT_CODE();
+                    bPending = OMX_TRUE;
+                    break;
+                }
+                bProgress = OMX_TRUE;
                 eError = VIDDEC_HandleFreeDataBuf(pComponentPrivate);
                 if (eError != OMX_ErrorNone) {
                     OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while processing free input buffers\n");
@@ -473,7 +288,13 @@ void* OMX_VidDec_Return (void* pThreadData)
                                                            "Error from Component Thread while processing free input buffer");
                 }
             }
-            if (FD_ISSET(pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_READ], &rfds)) {
+            if (!OMX_TI_RingEmpty(&pComponentPrivate->free_outBuf_Q)) {
+                if(pComponentPrivate->bDynamicConfigurationInProgress){
+                    VIDDEC_WAIT_CODE();
+                    bPending = OMX_TRUE;
+                    break;
+                }
+                bProgress = OMX_TRUE;
                 OMX_PRSTATE2(pComponentPrivate->dbg, "eExecuteToIdle 0x%x\n",pComponentPrivate->eExecuteToIdle);
                 eError = VIDDEC_HandleFreeOutputBufferFromApp(pComponentPrivate);
                 if (eError != OMX_ErrorNone) {
@@ -486,10 +307,113 @@ void* OMX_VidDec_Return (void* pThreadData)
                                                            "Error from Component Thread while processing free output buffer");
                 }
             }
+        } while (bProgress);
+    }
+
+EXIT:
+#ifdef __PERF_INSTRUMENTATION__
+    PERF_Done(pComponentPrivate->pPERFcomp);
+#endif
+
+    return (void *)eError;
+}
+
+void* OMX_VidDec_Return (void* pThreadData)
+{
+    int status = 0;
+    struct timeval tv1;
+    OMX_U32 iLock = 0;
+    OMX_BOOL bReady;
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    VIDDEC_COMPONENT_PRIVATE* pComponentPrivate = NULL;
+
+    pComponentPrivate = (VIDDEC_COMPONENT_PRIVATE*)pThreadData;
+    gettimeofday(&tv1, NULL);
+    while ((pComponentPrivate->nCountInputBFromApp != 0 &&
+                (pComponentPrivate->eLCMLState == VidDec_LCML_State_Start && pComponentPrivate->bDynamicConfigurationInProgress == OMX_FALSE)) ||
+            pComponentPrivate->nCountOutputBFromApp != 0 ||
+            pComponentPrivate->nCountInputBFromDsp != 0 || pComponentPrivate->nCountOutputBFromDsp != 0) {
+        bReady = (!OMX_TI_RingEmpty(&pComponentPrivate->filled_outBuf_Q) ||
+                  !OMX_TI_RingEmpty(&pComponentPrivate->filled_inpBuf_Q) ||
+                  !OMX_TI_RingEmpty(&pComponentPrivate->free_inpBuf_Q) ||
+                  !OMX_TI_RingEmpty(&pComponentPrivate->free_outBuf_Q)) ? OMX_TRUE : OMX_FALSE;
+        if (!bReady) {
+            /* the dsp still owns buffers, give it a moment to return them */
+            status = VIDDEC_Ring_Wait(pComponentPrivate, 10);
+            if (0 == status) {
+                iLock++;
+                if (iLock > 2){
+                    break;
+                }
+            } 
+            else if (-1 == status) {
+                OMX_PRINT2(pComponentPrivate->dbg, "Error in Select\n");
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                       pComponentPrivate->pHandle->pApplicationPrivate,
+                                                       OMX_EventError,
+                                                       OMX_ErrorInsufficientResources, 
+                                                       OMX_TI_ErrorSevere,
+                                                       "Error from Component Thread in select");
+                eError = OMX_ErrorInsufficientResources;
+                break;
+            }
+            continue;
+        }
+
+        if (!OMX_TI_RingEmpty(&pComponentPrivate->filled_outBuf_Q)) {
+            eError = VIDDEC_HandleDataBuf_FromDsp(pComponentPrivate);
+            if (eError != OMX_ErrorNone) {
+                OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while handling filled DSP output buffer\n");
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                       pComponentPrivate->pHandle->pApplicationPrivate,
+                                                       OMX_EventError,
+                                                       eError, 
+                                                       OMX_TI_ErrorSevere,
+                                                       "Error from Component Thread while processing dsp Responses");
+            }
+        }
+        if (!OMX_TI_RingEmpty(&pComponentPrivate->filled_inpBuf_Q)) {
+            OMX_PRSTATE2(pComponentPrivate->dbg, "eExecuteToIdle 0x%x\n",pComponentPrivate->eExecuteToIdle);
+            if(!(pComponentPrivate->bDynamicConfigurationInProgress == OMX_TRUE && pComponentPrivate->bInPortSettingsChanged == OMX_FALSE)){
+            eError = VIDDEC_HandleDataBuf_FromApp (pComponentPrivate);     
+            if (eError != OMX_ErrorNone) {
+                OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while handling filled input buffer\n");
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                       pComponentPrivate->pHandle->pApplicationPrivate,
+                                                       OMX_EventError,
+                                                       eError, 
+                                                       OMX_TI_ErrorSevere,
+                                                       "Error from Component Thread while processing input buffer");
+            }
+            }
+        }
+        if (!OMX_TI_RingEmpty(&pComponentPrivate->free_inpBuf_Q)) {
+            eError = VIDDEC_HandleFreeDataBuf(pComponentPrivate);
+            if (eError != OMX_ErrorNone) {
+                OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while processing free input buffers\n");
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                       pComponentPrivate->pHandle->pApplicationPrivate,
+                                                       OMX_EventError,
+                                                       eError,  
+                                                       OMX_TI_ErrorSevere,
+                                                       "Error from Component Thread while processing free input buffer");
+            }
+        }
+        if (!OMX_TI_RingEmpty(&pComponentPrivate->free_outBuf_Q)) {
+            OMX_PRSTATE2(pComponentPrivate->dbg, "eExecuteToIdle 0x%x\n",pComponentPrivate->eExecuteToIdle);
+            eError = VIDDEC_HandleFreeOutputBufferFromApp(pComponentPrivate);
+            if (eError != OMX_ErrorNone) {
+                OMX_PRBUFFER4(pComponentPrivate->dbg, "Error while processing free output buffer\n");
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                       pComponentPrivate->pHandle->pApplicationPrivate,
+                                                       OMX_EventError,
+                                                       eError, 
+                                                       OMX_TI_ErrorSevere,
+                                                       "Error from Component Thread while processing free output buffer");
+            }
         }
     }
     
-    pComponentPrivate->bPipeCleaned = OMX_TRUE;
     return (void *)eError;
 }
 
@@ -54,6 +54,11 @@
 #include "OMX_VideoDec_Utils.h"
 #include "OMX_VideoDec_DSP.h"
 #include "OMX_VideoDec_Thread.h"
+#include "OMX_TI_NalScan.h"
+#include "OMX_TI_BitReader.h"
+#include "OMX_TI_M4vHeader.h"
+#include "OMX_TI_SeqHeader.h"
+#include "OMX_TI_Downscale.h"
 #define LOG_TAG "TI_Video_Decoder"
 /*----------------------------------------------------------------------------*/
 /**
@@ -170,6 +175,35 @@ OMX_U32 VIDDEC_GetRMFrecuency(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate)
     return nReturnValue;
 
 }
+/*----------------------------------------------------------------------------*/
+/**
+  * VIDDEC_AVC_LevelIdc() Return the level_idc of an OMX AVC level, 0 when
+  * eLevel is not a single level (OMX_VIDEO_AVCLevelMax).
+  **/
+/*----------------------------------------------------------------------------*/
+OMX_U32 VIDDEC_AVC_LevelIdc(OMX_VIDEO_AVCLEVELTYPE eLevel)
+{
+    switch (eLevel) {
+        case OMX_VIDEO_AVCLevel1:  return 10;
+        case OMX_VIDEO_AVCLevel1b: return 9;
+        case OMX_VIDEO_AVCLevel11: return 11;
+        case OMX_VIDEO_AVCLevel12: return 12;
+        case OMX_VIDEO_AVCLevel13: return 13;
+        case OMX_VIDEO_AVCLevel2:  return 20;
+        case OMX_VIDEO_AVCLevel21: return 21;
+        case OMX_VIDEO_AVCLevel22: return 22;
+        case OMX_VIDEO_AVCLevel3:  return 30;
+        case OMX_VIDEO_AVCLevel31: return 31;
+        case OMX_VIDEO_AVCLevel32: return 32;
+        case OMX_VIDEO_AVCLevel4:  return 40;
+        case OMX_VIDEO_AVCLevel41: return 41;
+        case OMX_VIDEO_AVCLevel42: return 42;
+        case OMX_VIDEO_AVCLevel5:  return 50;
+        case OMX_VIDEO_AVCLevel51: return 51;
+        default:                   return 0;
+    }
+}
+
 
 OMX_ERRORTYPE VIDDEC_Queue_Init(VIDDEC_QUEUE_TYPE *queue, VIDDEC_QUEUE_TYPES type)
 {
@@ -521,6 +555,31 @@ EXIT:
     return eError;
 }
 
+/*----------------------------------------------------------------------------*/
+/**
+  * VIDDEC_ReorderDepth() number of frames the output of the current stream
+  * can lag its decoding. The client setting wins; otherwise AVC follows the
+  * SPS and the codecs with B pictures allow one frame. 0 means output order
+  * is decoding order and input timestamps are used as they come.
+  **/
+/*----------------------------------------------------------------------------*/
+static OMX_U32 VIDDEC_ReorderDepth(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate)
+{
+    if (pComponentPrivate->nReorderDepth != VIDDEC_REORDER_DEPTH_AUTO) {
+        return pComponentPrivate->nReorderDepth;
+    }
+    switch (pComponentPrivate->pInPortDef->format.video.eCompressionFormat) {
+        case OMX_VIDEO_CodingAVC:
+            return pComponentPrivate->sAVCStreamInfo.nReorderFrames;
+        case OMX_VIDEO_CodingMPEG4:
+        case OMX_VIDEO_CodingMPEG2:
+        case OMX_VIDEO_CodingWMV:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
 /*----------------------------------------------------------------------------*/
 /**
   * VIDDEC_CircBuf_Init()
@@ -548,13 +607,19 @@ OMX_ERRORTYPE VIDDEC_CircBuf_Init(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, V
     /*pTempCBuffer->m_lock = malloc(sizeof(pthread_mutex_t));*/
     pthread_mutex_init(pTempCBuffer->m_lock, NULL);
 #endif
-    for(nCount = 0; nCount >= CBUFFER_SIZE; nCount++) {
-        pTempCBuffer->pElement[nCount] = NULL;
-    }
+    OMX_FREE_VIDDEC(pTempCBuffer->pElement);
+    OMX_FREE_VIDDEC(pTempCBuffer->aPtsHeap);
+    pTempCBuffer->nSize = 0;
+    nCount = CBUFFER_SIZE(pComponentPrivate->nMaxBufferCount);
+    OMX_MALLOC_STRUCT_SIZED(pTempCBuffer->pElement, OMX_PTR, nCount * sizeof(OMX_PTR), pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel3]);
+    OMX_MALLOC_STRUCT_SIZED(pTempCBuffer->aPtsHeap, OMX_TICKS, nCount * sizeof(OMX_TICKS), pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel3]);
+    memset(pTempCBuffer->pElement, 0, nCount * sizeof(OMX_PTR));
+    pTempCBuffer->nSize = nCount;
 EXIT:
     pTempCBuffer->nCount = 0;
     pTempCBuffer->nHead = 0;
     pTempCBuffer->nTail = 0;
+    OMX_TI_PtsHeapInit(&pTempCBuffer->sPtsHeap, pTempCBuffer->aPtsHeap, pTempCBuffer->nSize);
 
     return eError;
 }
@@ -589,6 +654,7 @@ OMX_ERRORTYPE VIDDEC_CircBuf_Flush(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
     pTempCBuffer->nCount = 0;
     pTempCBuffer->nHead = 0;
     pTempCBuffer->nTail = 0;
+    OMX_TI_PtsHeapClear(&pTempCBuffer->sPtsHeap);
 
 #ifdef VIDDEC_CBUFFER_LOCK
     if(pthread_mutex_unlock(pTempCBuffer->m_lock) != 0) {
@@ -608,7 +674,6 @@ OMX_ERRORTYPE VIDDEC_CircBuf_DeInit(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
 {
     OMX_ERRORTYPE eError = OMX_ErrorNone;
     VIDDEC_CIRCULAR_BUFFER *pTempCBuffer = NULL;
-    OMX_U32 nCount = 0;
 
     if(nTypeIndex == VIDDEC_CBUFFER_TIMESTAMP){
         pTempCBuffer = &pComponentPrivate->pCompPort[nPortIndex]->eTimeStamp;
@@ -623,9 +688,10 @@ OMX_ERRORTYPE VIDDEC_CircBuf_DeInit(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
         pTempCBuffer->m_lock = NULL;
     }
 #endif
-    for(nCount = 0; nCount >= CBUFFER_SIZE; nCount++) {
-        pTempCBuffer->pElement[nCount] = NULL;
-    }
+    OMX_FREE_VIDDEC(pTempCBuffer->pElement);
+    OMX_FREE_VIDDEC(pTempCBuffer->aPtsHeap);
+    pTempCBuffer->nSize = 0;
+    OMX_TI_PtsHeapInit(&pTempCBuffer->sPtsHeap, NULL, 0);
     return eError;
 }
 
@@ -655,7 +721,8 @@ OMX_ERRORTYPE VIDDEC_CircBuf_Add(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, VI
 #endif
     pTempCBuffer->pElement[pTempCBuffer->nHead++] = pElement;
     pTempCBuffer->nCount++;
-    if(pTempCBuffer->nHead >= CBUFFER_SIZE){
+    OMX_TI_PtsHeapPush(&pTempCBuffer->sPtsHeap, ((VIDDEC_CBUFFER_BUFFERFLAGS*)pElement)->nTimeStamp);
+    if(pTempCBuffer->nHead >= pTempCBuffer->nSize){
         pTempCBuffer->nHead = 0;
     }
 #ifdef VIDDEC_CBUFFER_LOCK
@@ -696,7 +763,23 @@ OMX_ERRORTYPE VIDDEC_CircBuf_Remove(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
         *pElement = pTempCBuffer->pElement[pTempCBuffer->nTail];
         pTempCBuffer->pElement[pTempCBuffer->nTail++] = NULL;
         pTempCBuffer->nCount--;
-        if(pTempCBuffer->nTail >= CBUFFER_SIZE){
+        if (*pElement != NULL) {
+            VIDDEC_CBUFFER_BUFFERFLAGS* pFlags = (VIDDEC_CBUFFER_BUFFERFLAGS*)*pElement;
+            OMX_TICKS nPts;
+
+            /* frames come out in display order, hand them the earliest
+               pending timestamp instead of the one of the oldest input.
+               In decoding order the input keeps its own, unless a change
+               of depth already handed that one out: every timestamp goes
+               out once and the heap holds the pending ones */
+            if (VIDDEC_ReorderDepth(pComponentPrivate) != 0 ||
+                !OMX_TI_PtsHeapRemove(&pTempCBuffer->sPtsHeap, pFlags->nTimeStamp)) {
+                if (OMX_TI_PtsHeapPop(&pTempCBuffer->sPtsHeap, &nPts)) {
+                    pFlags->nTimeStamp = nPts;
+                }
+            }
+        }
+        if(pTempCBuffer->nTail >= pTempCBuffer->nSize){
             pTempCBuffer->nTail = 0;
         }
     }
@@ -785,6 +868,71 @@ OMX_U8 VIDDEC_CircBuf_GetHead(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, VIDDE
     return ucHead;
 }
 
+/* ========================================================================== */
+/**
+  *  VIDDEC_GetMaxBufferCount() buffer ceiling of the ports, from the
+  *  VIDDEC_MAX_BUFFER_COUNT_PROPERTY property when it is set. Never below
+  *  the default counts nor above VIDDEC_MAX_BUFFER_COUNT_LIMIT.
+ **/
+/* ========================================================================== */
+static OMX_U32 VIDDEC_GetMaxBufferCount(void)
+{
+    OMX_U32 nMax = VIDDEC_MAX_BUFFER_COUNT;
+#ifdef ANDROID
+    char value[PROPERTY_VALUE_MAX];
+
+    if (property_get(VIDDEC_MAX_BUFFER_COUNT_PROPERTY, value, NULL) > 0) {
+        nMax = (OMX_U32)atoi(value);
+    }
+#endif
+    if (nMax < MAX_PRIVATE_IN_BUFFERS) {
+        nMax = MAX_PRIVATE_IN_BUFFERS;
+    }
+    if (nMax < MAX_PRIVATE_OUT_BUFFERS) {
+        nMax = MAX_PRIVATE_OUT_BUFFERS;
+    }
+    if (nMax > VIDDEC_MAX_BUFFER_COUNT_LIMIT) {
+        nMax = VIDDEC_MAX_BUFFER_COUNT_LIMIT;
+    }
+    return nMax;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Port_ReserveBuffers() makes room for nCount buffers on a port.
+  *  Called wherever nBufferCountActual is set, before the port is
+  *  populated; the private of each buffer (and for the output port its
+  *  error map) is allocated the first time a count needs it and kept until
+  *  the component is deinitialized. The pointer arrays are sized for the
+  *  ceiling at init, so a buffer private never moves.
+  *
+  * @retval OMX_ErrorNone                   Success
+  *         OMX_ErrorBadParameter           nCount above nMaxBufferCount
+  *         OMX_ErrorInsufficientResources  Not enough memory
+ **/
+/* ========================================================================== */
+OMX_ERRORTYPE VIDDEC_Port_ReserveBuffers(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, VIDDEC_PORT_INDEX nPortIndex, OMX_U32 nCount)
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    VIDDEC_PORT_TYPE* pCompPort = pComponentPrivate->pCompPort[nPortIndex];
+
+    if (nCount > pComponentPrivate->nMaxBufferCount) {
+        OMX_ERROR4(pComponentPrivate->dbg, "Error: %lu buffers on port %d, ceiling is %lu\n",
+            nCount, nPortIndex, pComponentPrivate->nMaxBufferCount);
+        eError = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+    while (pCompPort->nBufferPrivateCnt < nCount) {
+        OMX_U32 iCount = pCompPort->nBufferPrivateCnt;
+
+        OMX_MALLOC_STRUCT(pCompPort->pBufferPrivate[iCount], VIDDEC_BUFFER_PRIVATE, pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel0]);
+        pCompPort->pBufferPrivate[iCount]->pBufferHdr = NULL;
+        pCompPort->nBufferPrivateCnt++;
+    }
+EXIT:
+    return eError;
+}
+
 /* ========================================================================== */
 /**
   *  VIDDEC_Load_Defaults() function will be called by the component to
@@ -814,6 +962,8 @@ OMX_ERRORTYPE VIDDEC_Load_Defaults (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
 
             pComponentPrivate->pCompPort[0]->hTunnelComponent = NULL;
             pComponentPrivate->pCompPort[1]->hTunnelComponent = NULL;
+            pComponentPrivate->pCompPort[0]->bProprietaryTunnel = OMX_FALSE;
+            pComponentPrivate->pCompPort[1]->bProprietaryTunnel = OMX_FALSE;
 
             /* Set component version */
             pComponentPrivate->pComponentVersion.s.nVersionMajor                = VERSION_MAJOR;
@@ -904,14 +1054,24 @@ OMX_ERRORTYPE VIDDEC_Load_Defaults (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
 #ifdef KHRONOS_1_1
             pComponentPrivate->pOutPortDef->format.video.pNativeWindow           = 0;
 #endif
-            for (iCount = 0; iCount < MAX_PRIVATE_BUFFERS; iCount++) {
-                OMX_MALLOC_STRUCT(pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate[iCount], VIDDEC_BUFFER_PRIVATE,pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel0]);
-                pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate[iCount]->pBufferHdr = NULL;
+            /* per buffer state, the arrays for the ceiling and the
+               privates for the default counts */
+            pComponentPrivate->nMaxBufferCount = VIDDEC_GetMaxBufferCount();
+            OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate, VIDDEC_BUFFER_PRIVATE*,
+                pComponentPrivate->nMaxBufferCount * sizeof(VIDDEC_BUFFER_PRIVATE*), pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel0]);
+            OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate, VIDDEC_BUFFER_PRIVATE*,
+                pComponentPrivate->nMaxBufferCount * sizeof(VIDDEC_BUFFER_PRIVATE*), pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel0]);
+            OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->aBufferFlags, VIDDEC_CBUFFER_BUFFERFLAGS,
+                CBUFFER_SIZE(pComponentPrivate->nMaxBufferCount) * sizeof(VIDDEC_CBUFFER_BUFFERFLAGS), pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel0]);
+            pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->nBufferPrivateCnt = 0;
+            pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->nBufferPrivateCnt = 0;
+            eError = VIDDEC_Port_ReserveBuffers(pComponentPrivate, VIDDEC_INPUT_PORT, MAX_PRIVATE_IN_BUFFERS);
+            if (eError != OMX_ErrorNone) {
+                goto EXIT;
             }
-
-            for (iCount = 0; iCount < MAX_PRIVATE_BUFFERS; iCount++) {
-                OMX_MALLOC_STRUCT(pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate[iCount], VIDDEC_BUFFER_PRIVATE,pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel0]);
-                pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate[iCount]->pBufferHdr = NULL;
+            eError = VIDDEC_Port_ReserveBuffers(pComponentPrivate, VIDDEC_OUTPUT_PORT, MAX_PRIVATE_OUT_BUFFERS);
+            if (eError != OMX_ErrorNone) {
+                goto EXIT;
             }
 
             /* Set pInPortFormat defaults */
@@ -958,14 +1118,7 @@ OMX_ERRORTYPE VIDDEC_Load_Defaults (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
             pComponentPrivate->eMBErrorReport.nPortIndex  = VIDDEC_OUTPUT_PORT;
             pComponentPrivate->eMBErrorReport.bEnabled    = OMX_FALSE;
             /*MBError Reporting code       */
-            /* Set eMBErrorMapType defaults */
-            for (iCount = 0; iCount < MAX_PRIVATE_BUFFERS; iCount++) {
-                OMX_CONF_INIT_STRUCT(&pComponentPrivate->eMBErrorMapType[iCount], OMX_CONFIG_MACROBLOCKERRORMAPTYPE_TI , pComponentPrivate->dbg);
-                pComponentPrivate->eMBErrorMapType[iCount].nPortIndex  = VIDDEC_OUTPUT_PORT;
-                pComponentPrivate->eMBErrorMapType[iCount].nErrMapSize = (VIDDEC_DEFAULT_WIDTH * VIDDEC_DEFAULT_HEIGHT) / 256;
-            }
-            pComponentPrivate->cMBErrorIndexIn = 0;
-            pComponentPrivate->cMBErrorIndexOut = 0;
+            pComponentPrivate->pMBErrorMapLast = NULL;
 
 #endif
 
@@ -1060,6 +1213,29 @@ OMX_ERRORTYPE VIDDEC_Load_Defaults (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
 #endif
             pComponentPrivate->eRMProxyState                    = VidDec_RMPROXY_State_Unload;
             pComponentPrivate->ProcessMode                      = VIDDEC_DEFAULT_PROCESSMODE;
+            pComponentPrivate->nReorderDepth                    = VIDDEC_REORDER_DEPTH_AUTO;
+            OMX_CONF_INIT_STRUCT(&pComponentPrivate->sAdaptivePlayback, VIDDEC_PARAM_ADAPTIVEPLAYBACKTYPE, pComponentPrivate->dbg);
+            pComponentPrivate->sAdaptivePlayback.nPortIndex     = VIDDEC_OUTPUT_PORT;
+            pComponentPrivate->sAdaptivePlayback.bEnable        = OMX_FALSE;
+            OMX_CONF_INIT_STRUCT(&pComponentPrivate->sOutputCrop, OMX_CONFIG_RECTTYPE, pComponentPrivate->dbg);
+            pComponentPrivate->sOutputCrop.nPortIndex           = VIDDEC_OUTPUT_PORT;
+            pComponentPrivate->sOutputCrop.nWidth               = VIDDEC_DEFAULT_WIDTH;
+            pComponentPrivate->sOutputCrop.nHeight              = VIDDEC_DEFAULT_HEIGHT;
+            OMX_CONF_INIT_STRUCT(&pComponentPrivate->sDecodeDeadline, VIDDEC_CONFIG_DECODEDEADLINETYPE, pComponentPrivate->dbg);
+            pComponentPrivate->sDecodeDeadline.nPortIndex       = VIDDEC_INPUT_PORT;
+            pComponentPrivate->sDecodeDeadline.bEnable          = OMX_FALSE;
+            pComponentPrivate->nDeadlineAnchor                  = 0;
+            OMX_CONF_INIT_STRUCT(&pComponentPrivate->sThumbnail, VIDDEC_PARAM_THUMBNAILTYPE, pComponentPrivate->dbg);
+            pComponentPrivate->sThumbnail.nPortIndex            = VIDDEC_OUTPUT_PORT;
+            pComponentPrivate->sThumbnail.bEnable               = OMX_FALSE;
+            pComponentPrivate->eThumbnailState                  = VIDDEC_Thumbnail_Seeking;
+            pComponentPrivate->bSeekPending                     = OMX_FALSE;
+            OMX_CONF_INIT_STRUCT(&pComponentPrivate->sNalCoalescing, VIDDEC_PARAM_NALCOALESCINGTYPE, pComponentPrivate->dbg);
+            pComponentPrivate->sNalCoalescing.nPortIndex        = VIDDEC_INPUT_PORT;
+            pComponentPrivate->sNalCoalescing.bEnable           = OMX_FALSE;
+            pComponentPrivate->pCoalesceBuffer                  = NULL;
+            pComponentPrivate->sTelemetry.bEnable               = OMX_FALSE;
+            pComponentPrivate->bCoalesceHasSlice                = OMX_FALSE;
             pComponentPrivate->bParserEnabled                   = OMX_TRUE;
 
             VIDDEC_CircBuf_Init(pComponentPrivate, VIDDEC_CBUFFER_TIMESTAMP, VIDDEC_INPUT_PORT);
@@ -1068,7 +1244,7 @@ OMX_ERRORTYPE VIDDEC_Load_Defaults (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
             VIDDEC_PTHREAD_SEMAPHORE_INIT(pComponentPrivate->sInSemaphore);
             VIDDEC_PTHREAD_SEMAPHORE_INIT(pComponentPrivate->sOutSemaphore);
 #endif
-            for (iCount = 0; iCount < CBUFFER_SIZE; iCount++) {
+            for (iCount = 0; iCount < CBUFFER_SIZE(pComponentPrivate->nMaxBufferCount); iCount++) {
                 pComponentPrivate->aBufferFlags[iCount].nTimeStamp = 0;
                 pComponentPrivate->aBufferFlags[iCount].nFlags = 0;
                 pComponentPrivate->aBufferFlags[iCount].pMarkData = NULL;
@@ -1168,6 +1344,7 @@ OMX_ERRORTYPE VIDDEC_Load_Defaults (VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
             pComponentPrivate->eFirstBuffer.nFilledLen          = 0;
             pComponentPrivate->bDynamicConfigurationInProgress  = OMX_FALSE;
             pComponentPrivate->nInternalConfigBufferFilledAVC = 0;
+            pComponentPrivate->sAVCParser.nConfigStartCodes = 0;
             pComponentPrivate->eMBErrorReport.bEnabled            = OMX_FALSE;
             pComponentPrivate->firstBufferEos                    = OMX_FALSE;
         break;
@@ -1407,9 +1584,8 @@ EXIT:
 
 /*----------------------------------------------------------------------------*/
 /**
-  * VIDDEC_Start_ComponentThread() starts the component thread and all the pipes
-  * to achieve communication between dsp and application for commands and buffer
-  * interchanging
+  * VIDDEC_Start_ComponentThread() starts the component thread and the rings
+  * that carry commands and buffers from the application and the dsp to it
   **/
 /*----------------------------------------------------------------------------*/
 OMX_ERRORTYPE VIDDEC_Start_ComponentThread(OMX_HANDLETYPE hComponent)
@@ -1421,47 +1597,25 @@ OMX_ERRORTYPE VIDDEC_Start_ComponentThread(OMX_HANDLETYPE hComponent)
     pComponentPrivate->bIsStopping =    0;
 
     OMX_PRINT1(pComponentPrivate->dbg, "+++ENTERING\n");
-    /* create the pipe used to maintain free input buffers*/
-    eError = pipe(pComponentPrivate->free_inpBuf_Q);
-    if (eError) {
+    /* the buffer counts may still change after this point, so the buffer
+       rings are sized for the most buffers a port accepts */
+    if (!OMX_TI_RingInit(&pComponentPrivate->free_inpBuf_Q, VIDDEC_BUFFER_RING_SIZE(pComponentPrivate->nMaxBufferCount)) ||
+        !OMX_TI_RingInit(&pComponentPrivate->free_outBuf_Q, VIDDEC_BUFFER_RING_SIZE(pComponentPrivate->nMaxBufferCount)) ||
+        !OMX_TI_RingInit(&pComponentPrivate->filled_inpBuf_Q, VIDDEC_BUFFER_RING_SIZE(pComponentPrivate->nMaxBufferCount)) ||
+        !OMX_TI_RingInit(&pComponentPrivate->filled_outBuf_Q, VIDDEC_BUFFER_RING_SIZE(pComponentPrivate->nMaxBufferCount)) ||
+        !OMX_TI_RingInit(&pComponentPrivate->cmdQ, VIDDEC_COMMAND_RING_SIZE)) {
         eError = OMX_ErrorInsufficientResources;
         goto EXIT;
     }
 
-    /* create the pipe used to maintain free input buffers*/
-    eError = pipe(pComponentPrivate->free_outBuf_Q);
-    if (eError) {
-        eError = OMX_ErrorInsufficientResources;
-        goto EXIT;
-    }
-
-    /* create the pipe used to maintain input buffers*/
-    eError = pipe(pComponentPrivate->filled_inpBuf_Q);
-    if (eError) {
-        eError = OMX_ErrorInsufficientResources;
-        goto EXIT;
-    }
-
-    /* create the pipe used to maintain dsp output/encoded buffers*/
-    eError = pipe(pComponentPrivate->filled_outBuf_Q);
-    if (eError) {
-        eError = OMX_ErrorInsufficientResources;
-        goto EXIT;
-    }
-
-    /* create the pipe used to send commands to the thread */
-    eError = pipe(pComponentPrivate->cmdPipe);
-    if (eError) {
-        eError = OMX_ErrorInsufficientResources;
-        goto EXIT;
-    }
-
-    /* create the pipe used to send commands to the thread */
-    eError = pipe(pComponentPrivate->cmdDataPipe);
-    if (eError) {
+    /* one eventfd wakes the thread for all the rings */
+    pComponentPrivate->bWakePending = 0;
+    pComponentPrivate->nWakeFd = eventfd(0, 0);
+    if (pComponentPrivate->nWakeFd < 0) {
         eError = OMX_ErrorInsufficientResources;
         goto EXIT;
     }
+    fcntl(pComponentPrivate->nWakeFd, F_SETFL, O_NONBLOCK);
 
     /* Create the Component Thread */
     eError = pthread_create(&(pComponentPrivate->ComponentThread),
@@ -1490,7 +1644,7 @@ EXIT:
 /* ========================================================================== */
 /**
 * @Stop_ComponentThread() This function is called by the component during
-* de-init to close component thread, Command pipe & data pipes.
+* de-init to close component thread, the command & buffer rings.
 *
 * @param pComponent  handle for this instance of the component
 *
@@ -1544,19 +1698,14 @@ OMX_ERRORTYPE VIDDEC_Stop_ComponentThread(OMX_HANDLETYPE pComponent)
                                                "Error while closing Component Thread\n");
     }
 
-    /* close the data pipe handles */
-    err = close(pComponentPrivate->free_inpBuf_Q[VIDDEC_PIPE_READ]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing data pipe\n");
-    }
+    /* the thread is gone, nothing uses the rings any more */
+    OMX_TI_RingDeinit(&pComponentPrivate->free_inpBuf_Q);
+    OMX_TI_RingDeinit(&pComponentPrivate->free_outBuf_Q);
+    OMX_TI_RingDeinit(&pComponentPrivate->filled_inpBuf_Q);
+    OMX_TI_RingDeinit(&pComponentPrivate->filled_outBuf_Q);
+    OMX_TI_RingDeinit(&pComponentPrivate->cmdQ);
 
-    err = close(pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_READ]);
+    err = close(pComponentPrivate->nWakeFd);
     if (0 != err) {
         eError = OMX_ErrorHardware;
         pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
@@ -1564,122 +1713,156 @@ OMX_ERRORTYPE VIDDEC_Stop_ComponentThread(OMX_HANDLETYPE pComponent)
                                                OMX_EventError,
                                                eError,
                                                OMX_TI_ErrorMajor,
-                                               "Error while closing data pipe\n");
+                                               "Error while closing wake fd\n");
     }
+    OMX_PRINT1(pComponentPrivate->dbg, "---EXITING(0x%x)\n",eError);
+    return eError;
+}
 
-    err = close(pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_READ]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing data pipe\n");
-    }
+/* ========================================================================== */
+/**
+  * VIDDEC_Ring_Wake() rings the eventfd of the component thread, unless a
+  * wake is already pending that the thread has not consumed yet.
+  **/
+/* ========================================================================== */
+static void VIDDEC_Ring_Wake(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate)
+{
+    uint64_t nOne = 1;
 
-    err = close(pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_READ]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing data pipe\n");
+    if (__sync_lock_test_and_set(&pComponentPrivate->bWakePending, 1) == 0) {
+        write(pComponentPrivate->nWakeFd, &nOne, sizeof(nOne));
     }
+}
 
-    err = close(pComponentPrivate->free_inpBuf_Q[VIDDEC_PIPE_WRITE]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing data pipe\n");
-    }
+/* ========================================================================== */
+/**
+  * VIDDEC_Ring_PutBuffer() queues a buffer header for the component thread
+  * and wakes it. Returns 0, or -1 if the ring is full.
+  **/
+/* ========================================================================== */
+int VIDDEC_Ring_PutBuffer(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                          OMX_TI_RINGTYPE* pRing,
+                          OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    OMX_TI_RINGENTRYTYPE sEntry;
 
-    err = close(pComponentPrivate->free_outBuf_Q[VIDDEC_PIPE_WRITE]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing data pipe\n");
+    sEntry.pData = pBuffHead;
+    sEntry.nParam1 = 0;
+    sEntry.nParam2 = 0;
+    if (!OMX_TI_RingPut(pRing, &sEntry)) {
+        return -1;
     }
+    VIDDEC_Ring_Wake(pComponentPrivate);
+    return 0;
+}
 
-    err = close(pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_WRITE]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing data pipe\n");
-    }
+/* ========================================================================== */
+/**
+  * VIDDEC_Ring_GetBuffer() takes the oldest buffer header off a ring.
+  * Component thread only. Returns 0, or -1 if the ring is empty.
+  **/
+/* ========================================================================== */
+int VIDDEC_Ring_GetBuffer(OMX_TI_RINGTYPE* pRing, OMX_BUFFERHEADERTYPE** ppBuffHead)
+{
+    OMX_TI_RINGENTRYTYPE sEntry;
 
-    err = close(pComponentPrivate->filled_outBuf_Q[VIDDEC_PIPE_WRITE]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing data pipe\n");
+    if (!OMX_TI_RingGet(pRing, &sEntry)) {
+        return -1;
     }
+    *ppBuffHead = (OMX_BUFFERHEADERTYPE*)sEntry.pData;
+    return 0;
+}
 
-    /* Close the command pipe handles */
-    err = close(pComponentPrivate->cmdPipe[VIDDEC_PIPE_READ]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing cmd pipe\n");
-    }
+/* ========================================================================== */
+/**
+  * VIDDEC_Ring_PutCommand() queues a command with its parameter and data as
+  * one entry, so the thread never sees a command without its arguments.
+  * Returns 0, or -1 if the ring is full.
+  **/
+/* ========================================================================== */
+int VIDDEC_Ring_PutCommand(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                           OMX_COMMANDTYPE eCmd,
+                           OMX_U32 nParam1,
+                           OMX_PTR pCmdData)
+{
+    OMX_TI_RINGENTRYTYPE sEntry;
 
-    err = close(pComponentPrivate->cmdPipe[VIDDEC_PIPE_WRITE]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing cmd pipe\n");
+    sEntry.pData = pCmdData;
+    sEntry.nParam1 = (OMX_U32)eCmd;
+    sEntry.nParam2 = nParam1;
+    if (!OMX_TI_RingPut(&pComponentPrivate->cmdQ, &sEntry)) {
+        return -1;
     }
+    VIDDEC_Ring_Wake(pComponentPrivate);
+    return 0;
+}
 
-    /* Close the command data pipe handles */
-    err = close (pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_READ]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing cmd pipe\n");
-    }
+/* ========================================================================== */
+/**
+  * VIDDEC_Ring_GetCommand() takes the oldest command off the command ring.
+  * Component thread only. OMX_FALSE if there is none.
+  **/
+/* ========================================================================== */
+OMX_BOOL VIDDEC_Ring_GetCommand(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                OMX_COMMANDTYPE* peCmd,
+                                OMX_U32* pnParam1,
+                                OMX_PTR* ppCmdData)
+{
+    OMX_TI_RINGENTRYTYPE sEntry;
 
-    err = close (pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_WRITE]);
-    if (0 != err) {
-        eError = OMX_ErrorHardware;
-        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                               pComponentPrivate->pHandle->pApplicationPrivate,
-                                               OMX_EventError,
-                                               eError,
-                                               OMX_TI_ErrorMajor,
-                                               "Error while closing cmd pipe\n");
+    if (!OMX_TI_RingGet(&pComponentPrivate->cmdQ, &sEntry)) {
+        return OMX_FALSE;
     }
-    OMX_PRINT1(pComponentPrivate->dbg, "---EXITING(0x%x)\n",eError);
-    return eError;
+    *peCmd = (OMX_COMMANDTYPE)sEntry.nParam1;
+    *pnParam1 = sEntry.nParam2;
+    *ppCmdData = sEntry.pData;
+    return OMX_TRUE;
+}
+
+/* ========================================================================== */
+/**
+  * VIDDEC_Ring_Wait() blocks the component thread until a producer rings the
+  * eventfd, for at most nTimeoutUs microseconds (forever if negative).
+  * The pending flag is cleared before the caller drains the rings, so an
+  * entry put after that point always brings a new wake.
+  *
+  * @retval 1 woken, 0 timed out, -1 select failed
+  **/
+/* ========================================================================== */
+int VIDDEC_Ring_Wait(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_S32 nTimeoutUs)
+{
+    fd_set rfds;
+#ifdef UNDER_CE
+    struct timeval tv;
+#else
+    sigset_t set;
+    struct timespec tv;
+#endif
+    uint64_t nCount;
+    int status;
+
+    FD_ZERO(&rfds);
+    FD_SET(pComponentPrivate->nWakeFd, &rfds);
+#ifdef UNDER_CE
+    tv.tv_sec = nTimeoutUs / 1000000;
+    tv.tv_usec = nTimeoutUs % 1000000;
+    status = select(pComponentPrivate->nWakeFd + 1, &rfds, NULL, NULL,
+                    (nTimeoutUs >= 0) ? &tv : NULL);
+#else
+    tv.tv_sec = nTimeoutUs / 1000000;
+    tv.tv_nsec = (nTimeoutUs % 1000000) * 1000;
+    sigemptyset(&set);
+    sigaddset(&set, SIGALRM);
+    status = pselect(pComponentPrivate->nWakeFd + 1, &rfds, NULL, NULL,
+                     (nTimeoutUs >= 0) ? &tv : NULL, &set);
+#endif
+    if (status <= 0) {
+        return (status == 0 || errno == EINTR) ? 0 : -1;
+    }
+    read(pComponentPrivate->nWakeFd, &nCount, sizeof(nCount));
+    __sync_lock_release(&pComponentPrivate->bWakePending);
+    __sync_synchronize();
+    return 1;
 }
 
 /* ========================================================================== */
@@ -1865,8 +2048,17 @@ EXIT:
 
 OMX_ERRORTYPE VIDDEC_EmptyBufferDone(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OMX_BUFFERHEADERTYPE* pBufferHeader)
 {
+    VIDDEC_BUFFER_PRIVATE* pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBufferHeader->pInputPortPrivate;
+
     //ALOGI("VIDDEC_EmptyBufferDone: header %p buffer %p", pBufferHeader, pBufferHeader->pBuffer);
-    ((VIDDEC_BUFFER_PRIVATE* )pBufferHeader->pInputPortPrivate)->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
+    pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
+    /* hand the buffer back as the client gave it, without the config data
+       VIDDEC_CopyBuffer put in front of it */
+    if (pBufferPrivate->nPrepended != 0) {
+        pBufferHeader->pBuffer += pBufferPrivate->nPrepended;
+        pBufferHeader->nAllocLen -= pBufferPrivate->nPrepended;
+        pBufferPrivate->nPrepended = 0;
+    }
 
     // No buffer flag EOS event needs to be sent for INPUT port
 
@@ -1891,6 +2083,7 @@ OMX_ERRORTYPE VIDDEC_FillBufferDone(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
 {
     //ALOGI("VIDDEC_FillBufferDone: header %p buffer %p", pBufferHeader, pBufferHeader->pBuffer);
     ((VIDDEC_BUFFER_PRIVATE* )pBufferHeader->pOutputPortPrivate)->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
+    VIDDEC_Telemetry_Output(pComponentPrivate, pBufferHeader);
 
     // OpenMAX-IL standard specifies that a component generates the OMX_EventBufferFlag event when an OUTPUT port
     // emits a buffer with the OMX_BUFFERFLAG_EOS flag set in the nFlags field
@@ -2251,6 +2444,10 @@ OMX_ERRORTYPE VIDDEC_HandleCommandFlush(VIDDEC_COMPONENT_PRIVATE *pComponentPriv
         }
         VIDDEC_CircBuf_Flush(pComponentPrivate, VIDDEC_CBUFFER_TIMESTAMP, VIDDEC_INPUT_PORT);
         OMX_VidDec_Return(pComponentPrivate);
+        VIDDEC_Coalesce_Release(pComponentPrivate);
+        VIDDEC_Telemetry_Flush(pComponentPrivate);
+        /* after a seek the next key frame gives another thumbnail */
+        pComponentPrivate->eThumbnailState = VIDDEC_Thumbnail_Seeking;
         if(bPass) {
             VIDDEC_PTHREAD_MUTEX_LOCK(pComponentPrivate->inputFlushCompletionMutex);
             pComponentPrivate->bIsInputFlushPending = OMX_TRUE;
@@ -2745,6 +2942,7 @@ OMX_ERRORTYPE VIDDEC_HandleCommand (OMX_HANDLETYPE phandle, OMX_U32 nParam1)
                 OMX_PRSTATE1(pComponentPrivate->dbg, "bIsStopping 0x%lx\n",pComponentPrivate->bIsStopping);
                 OMX_PRSTATE1(pComponentPrivate->dbg, "eExecuteToIdle 0x%x\n",pComponentPrivate->eExecuteToIdle);
                 OMX_VidDec_Return(pComponentPrivate);
+                VIDDEC_Coalesce_Release(pComponentPrivate);
 
 #ifdef __PERF_INSTRUMENTATION__
                 PERF_Boundary(pComponentPrivate->pPERFcomp,
@@ -3651,7 +3849,7 @@ OMX_ERRORTYPE VIDDEC_HandleCommand (OMX_HANDLETYPE phandle, OMX_U32 nParam1)
                     }
 #endif
                 }
-                for (iCount = 0; iCount < MAX_PRIVATE_BUFFERS; iCount++) {
+                for (iCount = 0; iCount < pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->nBufferPrivateCnt; iCount++) {
                     if(pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate[iCount]->bAllocByComponent == OMX_TRUE){
                         if(pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate[iCount]->pBufferHdr != NULL) {
                             OMX_BUFFERHEADERTYPE* pBuffHead = NULL;
@@ -3661,7 +3859,7 @@ OMX_ERRORTYPE VIDDEC_HandleCommand (OMX_HANDLETYPE phandle, OMX_U32 nParam1)
                     }
                 }
 
-                for (iCount = 0; iCount < MAX_PRIVATE_BUFFERS; iCount++) {
+                for (iCount = 0; iCount < pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->nBufferPrivateCnt; iCount++) {
                     if(pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate[iCount]->bAllocByComponent == OMX_TRUE){
                         if(pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate[iCount]->pBufferHdr != NULL) {
                             OMX_BUFFERHEADERTYPE* pBuffHead = NULL;
@@ -3841,11 +4039,11 @@ OMX_ERRORTYPE VIDDEC_HandleFreeOutputBufferFromApp(VIDDEC_COMPONENT_PRIVATE *pCo
     OMX_PRBUFFER1(pComponentPrivate->dbg, "pComponentPrivate 0x%p\n", pComponentPrivate);
     size_out_buf = (OMX_U32)pComponentPrivate->pOutPortDef->nBufferSize;
     pLcmlHandle = (LCML_DSP_INTERFACE*)(pComponentPrivate->pLCML);
-    ret = read(pComponentPrivate->free_outBuf_Q[0], &pBuffHead, sizeof(pBuffHead));
+    ret = VIDDEC_Ring_GetBuffer(&pComponentPrivate->free_outBuf_Q, &pBuffHead);
 
 
     if (ret == -1) {
-        OMX_PRCOMM4(pComponentPrivate->dbg, "Error while reading from the pipe\n");
+        OMX_PRCOMM4(pComponentPrivate->dbg, "Error while reading from the ring\n");
         eError = OMX_ErrorHardware;
         goto EXIT;
     }
@@ -3895,7 +4093,8 @@ OMX_ERRORTYPE VIDDEC_HandleFreeOutputBufferFromApp(VIDDEC_COMPONENT_PRIVATE *pCo
 
             OMX_PRDSP1(pComponentPrivate->dbg, "LCML_QueueBuffer(OUTPUT)\n");
             eError = LCML_QueueBuffer(((LCML_DSP_INTERFACE*)pLcmlHandle)->pCodecinterfacehandle,
-                                      EMMCodecOutputBufferMapBufLen,
+                                      (pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->bProprietaryTunnel ?
+                                        EMMCodecOutputBufferMapReuse : EMMCodecOutputBufferMapBufLen),
                                       pBuffHead->pBuffer,
                                       pBuffHead->nAllocLen,
                                       pBuffHead->nFilledLen,
@@ -3922,73 +4121,76 @@ EXIT:
     return eError;
 }
 
-#ifdef VIDDEC_ACTIVATEPARSER
-OMX_S32 GET_NUM_BIT_REQ(OMX_U32 num)
+/*  ==========================================================================*/
+/*  func    VIDDEC_NALULength                                                 */
+/*                                                                            */
+/*  desc    Value of the nLengthSize (1, 2 or 4) byte NAL unit length prefix  */
+/*          at pData.                                                         */
+/*  ==========================================================================*/
+static OMX_U32 VIDDEC_NALULength(const OMX_U8 *pData, OMX_U32 nLengthSize, OMX_BOOL bBigEndian)
 {
-    OMX_S32 i;
-    for ( i = 31; i >= 0; i--)
-    {
-        if (num & (0x1 << i) ) break;
+    if (nLengthSize == 4) {
+        if (bBigEndian) {
+            return (OMX_U32)pData[0] << 24 | (OMX_U32)pData[1] << 16 | (OMX_U32)pData[2] << 8 | pData[3];
+        }
+        return (OMX_U32)pData[3] << 24 | (OMX_U32)pData[2] << 16 | (OMX_U32)pData[1] << 8 | pData[0];
+    }
+    if (nLengthSize == 2) {
+        if (bBigEndian) {
+            return (OMX_U32)pData[0] << 8 | pData[1];
+        }
+        return (OMX_U32)pData[1] << 8 | pData[0];
     }
-    return (i+1);
+    return pData[0];
+}
+
+/*  ==========================================================================*/
+/*  func    VIDDEC_IndexNALUnits                                              */
+/*                                                                            */
+/*  desc    Packs an AVC frame of NAL units carrying a H264BitStreamFormat    */
+/*          byte length prefix the way the DSP expects, filling the NAL size  */
+/*          table of the buffer's DSP input parameters (see                   */
+/*          OMX_TI_NalPackLengthPrefixed). A length running past nFilledLen,  */
+/*          or more NAL units than the table holds, is OMX_ErrorBadParameter. */
+/*  ==========================================================================*/
+static OMX_ERRORTYPE VIDDEC_IndexNALUnits(VIDDEC_COMPONENT_PRIVATE *pComponentPrivate,
+                                          OMX_BUFFERHEADERTYPE *pBuffHead,
+                                          H264VDEC_UALGInputParam *pParam)
+{
+    OMX_U32 nFilledLen = pBuffHead->nFilledLen;
+    OMX_U32 nCount = 0;
+
+    if (!OMX_TI_NalPackLengthPrefixed(pBuffHead->pBuffer, &nFilledLen,
+                                      pComponentPrivate->H264BitStreamFormat,
+                                      pComponentPrivate->bIsNALBigEndian,
+                                      pParam->pNALUSizeArray, H264VDEC_SN_MAX_NALUNITS,
+                                      &nCount)) {
+        pParam->ulNumOfNALU = 0;
+        return OMX_ErrorBadParameter;
+    }
+    pParam->ulNumOfNALU = nCount;
+    pBuffHead->nFilledLen = nFilledLen;
+    return OMX_ErrorNone;
 }
-#endif
 
 #ifdef VIDDEC_ACTIVATEPARSER
 /*  ==========================================================================*/
 /*  func    VIDDEC_ParseVideo_MPEG2                                        */
 /*                                                                            */
-/*  desc                                                                      */
+/*  desc    Frame size from the first sequence header.                        */
 /*  ==========================================================================*/
 OMX_ERRORTYPE VIDDEC_ParseVideo_MPEG2( OMX_S32* nWidth, OMX_S32* nHeight, OMX_BUFFERHEADERTYPE *pBuffHead)
 {
     OMX_ERRORTYPE eError = OMX_ErrorUndefined;
-    OMX_U32    nTempValue = 0;
-    /*OMX_U8*    pTempValue = 0;*/
-    /*OMX_U8*    pTempSize = 0;*/
-    /*OMX_U32    nProfile = 0;*/
-    /*OMX_U32    nLevel = 0;*/
-    OMX_U32    nBitPosition = 0;
-    OMX_U8*    pHeaderStream = (OMX_U8*)pBuffHead->pBuffer;
-    OMX_BOOL   nStartFlag = OMX_FALSE;
-    OMX_U32    nInBytePosition = 0;
-    OMX_U32    nTotalInBytes = 0;
-    OMX_U32    nNalUnitType = 0;
-
-    nTotalInBytes = pBuffHead->nFilledLen;
-
-    do{
-        for (; (!nStartFlag) && (nInBytePosition < nTotalInBytes - 3); ) {
-           if (VIDDEC_GetBits(&nBitPosition, 24, pHeaderStream, OMX_FALSE) != 0x000001) {
-                nBitPosition += 8;
-                nInBytePosition++;
-           }
-           else {
-               nStartFlag = OMX_TRUE;
-               nBitPosition += 24;
-               nInBytePosition += 3;
-           }
-        }
-        if (!nStartFlag) {
-            eError = OMX_ErrorStreamCorrupt;
-            goto EXIT;
-        }
-        nNalUnitType = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
-        nInBytePosition++;
-        if (nNalUnitType != 0xB3) {
-            nStartFlag = OMX_FALSE;
-        }
-    }while (nNalUnitType != 0xB3);
+    OMX_U32 nSeqWidth = 0;
+    OMX_U32 nSeqHeight = 0;
 
-    if (nNalUnitType == 0xB3) {
-        nTempValue = VIDDEC_GetBits(&nBitPosition, 12, pHeaderStream, OMX_TRUE);
-        (*nWidth) = (nTempValue);
-        nTempValue = VIDDEC_GetBits(&nBitPosition, 12, pHeaderStream, OMX_TRUE);
-        (*nHeight) = (nTempValue);
-        eError = OMX_ErrorNone;
+    eError = OMX_TI_Mpeg2ParseSeqHeader((const OMX_U8*)pBuffHead->pBuffer, pBuffHead->nFilledLen,
+                                        &nSeqWidth, &nSeqHeight);
+    if (eError == OMX_ErrorNone) {
+        (*nWidth) = nSeqWidth;
+        (*nHeight) = nSeqHeight;
     }
-
-EXIT:
     return eError;
 }
 #endif
@@ -3997,98 +4199,54 @@ EXIT:
 /*  ==========================================================================*/
 /*  func    VIDDEC_ParseVideo_WMV9_VC1                                        */
 /*                                                                            */
-/*  desc                                                                      */
+/*  desc    Maximum coded size from the first advanced profile sequence      */
+/*          header (or entry point).                                          */
 /*  ==========================================================================*/
 OMX_ERRORTYPE VIDDEC_ParseVideo_WMV9_VC1( OMX_S32* nWidth, OMX_S32* nHeight, OMX_BUFFERHEADERTYPE *pBuffHead)
 {
     OMX_ERRORTYPE eError = OMX_ErrorUndefined;
-    OMX_U32    nTempValue = 0;
-    /*OMX_U8*    pTempValue = 0;*/
-    /*OMX_U8*    pTempSize = 0;*/
-    OMX_U32    nProfile = 0;
-    OMX_U32    nLevel = 0;
-    OMX_U32    nBitPosition = 0;
-    OMX_U8*    pHeaderStream = (OMX_U8*)pBuffHead->pBuffer;
-    OMX_BOOL   nStartFlag = OMX_FALSE;
-    OMX_U32    nInBytePosition = 0;
-    OMX_U32    nTotalInBytes = 0;
-    OMX_U32    nNalUnitType = 0;
+    OMX_U32 nSeqWidth = 0;
+    OMX_U32 nSeqHeight = 0;
 
-    nTotalInBytes = pBuffHead->nFilledLen;
-
-    do{
-        for (; (!nStartFlag) && (nInBytePosition < nTotalInBytes - 3); ) {
-           if (VIDDEC_GetBits(&nBitPosition, 24, pHeaderStream, OMX_FALSE) != 0x000001) {
-                nBitPosition += 8;
-                nInBytePosition++;
-           }
-           else {
-               nStartFlag = OMX_TRUE;
-               nBitPosition += 24;
-               nInBytePosition += 3;
-           }
-        }
-        if (!nStartFlag) {
-            eError = OMX_ErrorStreamCorrupt;
-            goto EXIT;
-        }
-        nNalUnitType = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
-        nInBytePosition++;
-        if (nNalUnitType != 0x0f && nNalUnitType != 0x0e) {
-            nStartFlag = OMX_FALSE;
-        }
-    }while (nNalUnitType != 0x0f && nNalUnitType != 0x0e);
-
-    if (nNalUnitType == 0x0f || nNalUnitType == 0x0e) {
-        nProfile = VIDDEC_GetBits(&nBitPosition, 2, pHeaderStream, OMX_TRUE);
-        nLevel = VIDDEC_GetBits(&nBitPosition, 3, pHeaderStream, OMX_TRUE);
-        nTempValue = VIDDEC_GetBits(&nBitPosition, 11, pHeaderStream, OMX_TRUE);
-        nTempValue = VIDDEC_GetBits(&nBitPosition, 12, pHeaderStream, OMX_TRUE);
-        (*nWidth) = (nTempValue * 2) + 2;
-        nTempValue = VIDDEC_GetBits(&nBitPosition, 12, pHeaderStream, OMX_TRUE);
-        (*nHeight) = (nTempValue * 2) + 2;
-        eError = OMX_ErrorNone;
-    }
-
-EXIT:
-    return eError;
-}
-#endif
+    eError = OMX_TI_Vc1ParseSeqHeader((const OMX_U8*)pBuffHead->pBuffer, pBuffHead->nFilledLen,
+                                      &nSeqWidth, &nSeqHeight);
+    if (eError == OMX_ErrorNone) {
+        (*nWidth) = nSeqWidth;
+        (*nHeight) = nSeqHeight;
+    }
+    return eError;
+}
+#endif
 
 #ifdef VIDDEC_ACTIVATEPARSER
 /*  ==========================================================================*/
 /*  func    VIDDEC_ParseVideo_WMV9_RCV                                        */
 /*                                                                            */
-/*  desc                                                                      */
+/*  desc    Frame size from the RCV file header, stored little endian.        */
 /*  ==========================================================================*/
 OMX_ERRORTYPE VIDDEC_ParseVideo_WMV9_RCV( OMX_S32* nWidth, OMX_S32* nHeight, OMX_BUFFERHEADERTYPE *pBuffHead)
 {
     OMX_ERRORTYPE eError = OMX_ErrorUndefined;
+    OMX_TI_BITREADERTYPE sBits;
     OMX_U32    nTempValue = 0;
-    OMX_U8*    pTempValue = 0;
-    /*OMX_U8*    pTempSize = 0;*/
-    OMX_U32    Profile = 0;
-    /*OMX_U32    i = 0;*/
-    OMX_U32    nBitPosition = 0;
-    OMX_U8*    pHeaderStream = (OMX_U8*)pBuffHead->pBuffer;
 
     if (pBuffHead->nFilledLen >= 20) {
-        nTempValue = VIDDEC_GetBits(&nBitPosition, 32, pHeaderStream, OMX_TRUE);
-        nTempValue = VIDDEC_GetBits(&nBitPosition, 32, pHeaderStream, OMX_TRUE);
-        Profile = VIDDEC_GetBits(&nBitPosition, 4, pHeaderStream, OMX_TRUE);
-        nTempValue = VIDDEC_GetBits(&nBitPosition, 28, pHeaderStream, OMX_TRUE);
-
-        pTempValue = (OMX_U8*)&nTempValue;
-        pTempValue[0] = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
-        pTempValue[1] = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
-        pTempValue[2] = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
-        pTempValue[3] = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
+        OMX_TI_BitsInit(&sBits, (const OMX_U8*)pBuffHead->pBuffer, pBuffHead->nFilledLen);
+        /* number of frames and extension size, then the 4 byte struct C */
+        OMX_TI_BitsSkip(&sBits, 32);
+        OMX_TI_BitsSkip(&sBits, 32);
+        OMX_TI_BitsSkip(&sBits, 32);
+
+        nTempValue = OMX_TI_BitsRead(&sBits, 8);
+        nTempValue |= OMX_TI_BitsRead(&sBits, 8) << 8;
+        nTempValue |= OMX_TI_BitsRead(&sBits, 8) << 16;
+        nTempValue |= OMX_TI_BitsRead(&sBits, 8) << 24;
         (*nHeight) = nTempValue;
 
-        pTempValue[0] = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
-        pTempValue[1] = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
-        pTempValue[2] = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
-        pTempValue[3] = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);
+        nTempValue = OMX_TI_BitsRead(&sBits, 8);
+        nTempValue |= OMX_TI_BitsRead(&sBits, 8) << 8;
+        nTempValue |= OMX_TI_BitsRead(&sBits, 8) << 16;
+        nTempValue |= OMX_TI_BitsRead(&sBits, 8) << 24;
         (*nWidth) = nTempValue;
         eError = OMX_ErrorNone;
     }
@@ -4104,423 +4262,21 @@ OMX_ERRORTYPE VIDDEC_ParseVideo_WMV9_RCV( OMX_S32* nWidth, OMX_S32* nHeight, OMX
 
 #ifdef VIDDEC_ACTIVATEPARSER
 /*  ==========================================================================*/
-/*  func    VIDDEC_ParseVideo_MPEG4                                             */
+/*  func    VIDDEC_ParseVideo_MPEG4                                           */
 /*                                                                            */
-/*  desc                                                                      */
+/*  desc    Frame size from the VOL header, or from the picture header of an  */
+/*          H.263 stream; OMX_TI_M4vParseHeader is shared with the config     */
+/*          parser.                                                           */
 /*  ==========================================================================*/
 OMX_ERRORTYPE VIDDEC_ParseVideo_MPEG4( OMX_S32* nWidth, OMX_S32* nHeight, OMX_BUFFERHEADERTYPE *pBuffHead)
 {
     OMX_ERRORTYPE eError = OMX_ErrorUndefined;
-    OMX_U32    nSartCode = 0;
-    OMX_U32    nBitPosition = 0;
-    OMX_BOOL   bHeaderParseCompleted = OMX_FALSE;
-    OMX_BOOL   bFillHeaderInfo = OMX_FALSE;
-    OMX_U8* pHeaderStream = (OMX_U8*)pBuffHead->pBuffer;
-
-    /*OMX_U32 nTotalInBytes = pBuffHead->nFilledLen;*/
-    VIDDEC_MPEG4_ParserParam MPEG4_Param;
-    VIDDEC_MPEG4UncompressedVideoFormat iOutputFormat = {0};
-    VIDDEC_MPEG4_ParserParam* sMPEG4_Param = &MPEG4_Param;
-    VIDDEC_VideoPictureHeader sPictHeaderDummy;
-    VIDDEC_MPEG4VisualVOLHeader sVolHeaderDummy;
-    VIDDEC_VideoPictureHeader* pPictHeaderPtr = &sPictHeaderDummy;
-    VIDDEC_MPEG4VisualVOLHeader* sVolHeaderPtr = &sVolHeaderDummy;
-
-    pPictHeaderPtr->cnOptional = (OMX_U8*)malloc( sizeof(VIDDEC_MPEG4VisualVOLHeader));
-    while (!bHeaderParseCompleted)
-    {
-        nSartCode = VIDDEC_GetBits(&nBitPosition, 32, pHeaderStream, OMX_TRUE);
-        if (nSartCode == 0x1B0)
-        {
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 4);
-            pPictHeaderPtr->nProfile = VIDDEC_GetBits(&nBitPosition, 4, pHeaderStream, OMX_TRUE);
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 4);
-            pPictHeaderPtr->nLevel = VIDDEC_GetBits(&nBitPosition, 4, pHeaderStream, OMX_TRUE);
-        }
-        else if (nSartCode == 0x1B5)
-        {
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nIsVisualObjectIdentifier = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-            if (sMPEG4_Param->nIsVisualObjectIdentifier)
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 7);
-                (void)VIDDEC_GetBits(&nBitPosition, 7, pHeaderStream, OMX_TRUE); /* DISCARD THIS INFO (7 bits)*/
-            }
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 4);
-            sMPEG4_Param->nVisualObjectType = VIDDEC_GetBits(&nBitPosition, 4, pHeaderStream, OMX_TRUE);
-            if (sMPEG4_Param->nVisualObjectType== 1|| sMPEG4_Param->nVisualObjectType== 2)
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                sMPEG4_Param->nVideoSignalType = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-                if (sMPEG4_Param->nVideoSignalType)
-                {
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 3);
-                    sMPEG4_Param->nVideoFormat = VIDDEC_GetBits(&nBitPosition, 3, pHeaderStream, OMX_TRUE);
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                    sMPEG4_Param->nVideoRange = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                    sMPEG4_Param->nColorDescription = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-                    if (sMPEG4_Param->nColorDescription)
-                    {
-                        /*Discard this info*/
-                        OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 24);
-                        (void)VIDDEC_GetBits(&nBitPosition, 24, pHeaderStream, OMX_TRUE);
-                    }
-                }
-            }
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->NBitZero = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-            while ((nBitPosition%8)!= 0) {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);/*discard align bits*/
-            }
-        }
-        else if ((nSartCode >= 0x100)&&(nSartCode <= 0x11F))
-        {
-            /*Do nothing*/
-            /*    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 8);
-                  (void)VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);*/
-        }
-        else if (nSartCode == 0x1B3) /*GOV*/
-        {
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 20);
-            (void)VIDDEC_GetBits(&nBitPosition, 20, pHeaderStream, OMX_TRUE);
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->NBitZero = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-            while ((nBitPosition%8)!= 0){
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);/*discard align bits*/
-            }
-        }
-        else if (nSartCode == 0x1B2) /*user data*/
-        {
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 24);
-            while (VIDDEC_GetBits(&nBitPosition, 24, pHeaderStream, OMX_TRUE)!= 0x1)
-                nBitPosition-=16;        /*discard only 8 bits and try againg until*/
-                                        /*the next start code is found*/
-            nBitPosition -=24;            /* prepare to read the entire start code*/
-        /*    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->NBitZero = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-            PRINT("sMPEG4_Param->NBitZero = %d", sMPEG4_Param->NBitZero);
-            while ((nBitPosition%8)!= 0) {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);*//*discard align bits*/
-            /*}*/
-        }
-        else if ((nSartCode >= 0x120)&&(nSartCode <= 0x12F))
-        {
-            sVolHeaderPtr->nVideoObjectLayerId = nSartCode&0x0000000f;
-            sVolHeaderPtr->bShortVideoHeader = 0;
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            pPictHeaderPtr->bIsRandomAccessible = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);    /*1 bit*/
-            sVolHeaderPtr->bRandomAccessibleVOL = pPictHeaderPtr->bIsRandomAccessible;
-            if (pPictHeaderPtr->bIsRandomAccessible)
-            {
-                /* it seems this never happens*/
-            }
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 8);
-            sMPEG4_Param->nVideoObjectTypeIndication = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);    /* 8 bits*/
-            sVolHeaderPtr->nVideoObjectTypeIndication = sMPEG4_Param->nVideoObjectTypeIndication;
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nIsVisualObjectLayerIdentifier = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);/*1 bit*/
-            sVolHeaderPtr->nVideoObjectLayerId = sMPEG4_Param->nIsVisualObjectLayerIdentifier;
-            sMPEG4_Param->nLayerVerId = 0;
-            if (sMPEG4_Param->nIsVisualObjectLayerIdentifier)
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 4);
-                sMPEG4_Param->nLayerVerId = VIDDEC_GetBits(&nBitPosition, 4, pHeaderStream, OMX_TRUE);                        /*4 bits*/
-                sVolHeaderPtr->nVideoObjectLayerVerId = sMPEG4_Param->nLayerVerId;
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 3);
-                sMPEG4_Param->nLayerPriority = VIDDEC_GetBits(&nBitPosition, 3, pHeaderStream, OMX_TRUE);            /*3 bits*/
-                sVolHeaderPtr->nVideoObjectLayerPriority = sMPEG4_Param->nLayerPriority;
-            }
-
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 4);
-            sMPEG4_Param->nAspectRadio = VIDDEC_GetBits(&nBitPosition, 4, pHeaderStream, OMX_TRUE);                    /*4 bits*/
-            if (sMPEG4_Param->nAspectRadio == 0xf)
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 8);
-                sMPEG4_Param->nParWidth = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);                    /*8 bits*/
-                sVolHeaderPtr->nAspectRatioNum = sMPEG4_Param->nParWidth;
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 8);
-                sMPEG4_Param->nParHeight = VIDDEC_GetBits(&nBitPosition, 8, pHeaderStream, OMX_TRUE);                /*8 bits*/
-                sVolHeaderPtr->nAspectRatioDenom = sMPEG4_Param->nParHeight;
-            }
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nControlParameters = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);            /*1 bit*/
-            if ( sMPEG4_Param->nControlParameters )
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 2);
-                sMPEG4_Param->nChromaFormat = VIDDEC_GetBits(&nBitPosition, 2, pHeaderStream, OMX_TRUE);                /*2 bits*/
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                sMPEG4_Param->nLowDelay = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                    /*1 bit*/
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                sMPEG4_Param->nVbvParameters = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);            /*1 bit*/
-                if (sMPEG4_Param->nVbvParameters)
-                {
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 15);
-                    sMPEG4_Param->nBitRate = VIDDEC_GetBits(&nBitPosition, 15, pHeaderStream, OMX_TRUE)<<15;                /*15 bit*/
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                    (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                        /*1 bit*/
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 15);
-                    sMPEG4_Param->nBitRate |= VIDDEC_GetBits(&nBitPosition, 15, pHeaderStream, OMX_TRUE);                    /*15 bit*/
-                    sVolHeaderPtr->sVbvParams.nBitRate = sMPEG4_Param->nBitRate;
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                    (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 15);
-                    sMPEG4_Param->nFirstHalfVbvBufferSize = VIDDEC_GetBits(&nBitPosition, 15, pHeaderStream, OMX_TRUE);
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                    (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 3);
-                    sMPEG4_Param->nLatterHalfVbvBufferSize = VIDDEC_GetBits(&nBitPosition, 3, pHeaderStream, OMX_TRUE);
-                    sVolHeaderPtr->sVbvParams.nVbvBufferSize =
-                        (((sMPEG4_Param->nFirstHalfVbvBufferSize) << 3) + sMPEG4_Param->nLatterHalfVbvBufferSize) * 2048;
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 11);
-                    sMPEG4_Param->nFirstHalfVbvOccupancy = VIDDEC_GetBits(&nBitPosition, 11, pHeaderStream, OMX_TRUE);
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                    (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 15);
-                    sMPEG4_Param->nLatterHalfVbvOccupancy = VIDDEC_GetBits(&nBitPosition, 15, pHeaderStream, OMX_TRUE);
-                    sVolHeaderPtr->sVbvParams.nVbvOccupancy =
-                        (((sMPEG4_Param->nFirstHalfVbvOccupancy) << 15) + sMPEG4_Param->nLatterHalfVbvOccupancy) * 2048;
-                    OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                    (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-
-                    /*OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 48);
-                    (void)VIDDEC_GetBits(&nBitPosition, 48, pHeaderStream, OMX_TRUE);*/
-                }
-                else
-                {
-                    sMPEG4_Param->nBitRate = 0;
-                }
-            }
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 2);
-            sMPEG4_Param->nLayerShape = VIDDEC_GetBits(&nBitPosition, 2, pHeaderStream, OMX_TRUE);                    /*2 bits*/
-            /*skip one marker_bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                                /*1 bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 16);
-            sMPEG4_Param->nTimeIncrementResolution = VIDDEC_GetBits(&nBitPosition, 16, pHeaderStream, OMX_TRUE);        /*16 bits*/
-            sVolHeaderPtr->nVOPTimeIncrementResolution = sMPEG4_Param->nTimeIncrementResolution;
-            /*skip one market bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                                /*1 bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nFnXedVopRate = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                    /*1 bit*/
-            sVolHeaderPtr->bnFnXedVopRate = sMPEG4_Param->nFnXedVopRate;
-            if (sMPEG4_Param->nFnXedVopRate)
-            {
-                sMPEG4_Param->nNum_bits = GET_NUM_BIT_REQ (sMPEG4_Param->nTimeIncrementResolution);
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, sMPEG4_Param->nNum_bits);
-                sVolHeaderPtr->nFnXedVOPTimeIncrement = VIDDEC_GetBits (&nBitPosition, sMPEG4_Param->nNum_bits, pHeaderStream, OMX_TRUE);
-            }
-            /*skip one market bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                                /*1 bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 13);
-            (*nWidth) = VIDDEC_GetBits(&nBitPosition, 13, pHeaderStream, OMX_TRUE);                        /*13 bits*/
-            /*skip one market bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                                /*1 bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 13);
-            (*nHeight) = VIDDEC_GetBits(&nBitPosition, 13, pHeaderStream, OMX_TRUE);                        /*13 bits*/
-
-            /*skip one market bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                                /*1 bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nInterlaced = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                    /*1 bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nObmc = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                            /*1 bit*/
-            if (sMPEG4_Param->nLayerVerId)
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                sMPEG4_Param->NSpriteNotSupported = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);        /*1 bit*/
-                if (sMPEG4_Param->NSpriteNotSupported)
-                {
-                }
-            }
-            else
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 2);
-                sMPEG4_Param->NSpriteNotSupported = VIDDEC_GetBits(&nBitPosition, 2, pHeaderStream, OMX_TRUE);        /*2 bits*/
-                if (sMPEG4_Param->NSpriteNotSupported)
-                {
-                }
-            }
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nNot8Bit = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                        /*1 bits*/
-            sMPEG4_Param->nQuantPrecision = 5;
-            sMPEG4_Param->nBitsPerPnXel = 8;
-            if (sMPEG4_Param->nNot8Bit)
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 4);
-                sMPEG4_Param->nQuantPrecision = VIDDEC_GetBits(&nBitPosition,4, pHeaderStream, OMX_TRUE);                    /* 4 bits*/
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 4);
-            sMPEG4_Param->nBitsPerPnXel = VIDDEC_GetBits(&nBitPosition,4, pHeaderStream, OMX_TRUE);                    /* 4 bits*/
-            }
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nIsInverseQuantMethodFirst = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);    /*1 bits*/
-            if (sMPEG4_Param->nLayerVerId !=1)
-            {
-                /*does not support quater sample*/
-                /*kip one market bit*/
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                            /*1 bit*/
-            }
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nComplexityEstimationDisable = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);    /*1 bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nIsResyncMarkerDisabled = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);        /*1 bit*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nIsDataPartitioned = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);            /*1 bit*/
-            sVolHeaderPtr->bDataPartitioning = sMPEG4_Param->nIsDataPartitioned;
-            if (sMPEG4_Param->nIsDataPartitioned)
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-                sMPEG4_Param->nRvlc = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                        /*1 bit*/
-                sVolHeaderPtr->bReversibleVLC = sMPEG4_Param->nRvlc;
-                if (sMPEG4_Param->nRvlc)
-                {
-                }
-            }
-            if (sMPEG4_Param->nLayerVerId !=1)
-            {
-                OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 2);
-                (void)VIDDEC_GetBits(&nBitPosition, 2, pHeaderStream, OMX_TRUE);                            /*2 bit*/
-            }
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 1);
-            sMPEG4_Param->nScalability = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);                    /*1 bit*/
-            /*pPictHeaderPtr->sSizeInMemory.nWidth              = (*nWidth);
-            pPictHeaderPtr->sSizeInMemory.nHeight             = (*nHeight);
-            pPictHeaderPtr->sDisplayedRect                    = TRect(TSize((*nWidth),(*nHeight)));*/
-            if (iOutputFormat.iYuvFormat.iPattern == 0x00000001)
-                pPictHeaderPtr->nPostDecoderBufferSize    = (*nHeight) * (*nWidth) * 3 / 2;    /*YUV 420 Planar*/
-            else if (iOutputFormat.iYuvFormat.iPattern == 0x00000008)
-                pPictHeaderPtr->nPostDecoderBufferSize    = (*nHeight) * (*nWidth) * 2;    /*YUV 422 Interleaved*/
-            pPictHeaderPtr->nOptions |= 0x00000008;
-            if(bFillHeaderInfo)
-            {
-                ;
-            }
-            bHeaderParseCompleted = OMX_TRUE;
-            eError = OMX_ErrorNone;
-        }
-        else if ( (nSartCode&0xfffffc00) == 0x00008000 )
-        {
-            sVolHeaderPtr->bShortVideoHeader = 1;
-            /* discard 3 bits for split_screen_indicator, document_camera_indicator*/
-            /* and full_picture_freeze_release*/
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 3);
-            (void)VIDDEC_GetBits(&nBitPosition, 3, pHeaderStream, OMX_TRUE);
-            OMX_PARSER_CHECKLIMIT(nTotalInBytes, nBitPosition, 3);
-            sMPEG4_Param->nSourceFormat = VIDDEC_GetBits(&nBitPosition, 3, pHeaderStream, OMX_TRUE);
-            if (sMPEG4_Param->nSourceFormat == 0x1)
-            {
-                (*nWidth) = 128;
-                (*nHeight) = 96;
-            }
-            else if (sMPEG4_Param->nSourceFormat == 0x2)
-            {
-                (*nWidth) = 176;
-                (*nHeight) = 144;
-            }
-            else if (sMPEG4_Param->nSourceFormat == 0x3)
-            {
-                (*nWidth) = 352;
-                (*nHeight) = 288;
-            }
-            else if (sMPEG4_Param->nSourceFormat == 0x4)
-            {
-                (*nWidth) = 704;
-                (*nHeight) = 576;
-            }
-            else if (sMPEG4_Param->nSourceFormat == 0x5)
-            {
-                (*nWidth) = 1408;
-                (*nHeight) = 1152;
-            }
-            else if (sMPEG4_Param->nSourceFormat == 0x7)
-            {
-                sMPEG4_Param->nUFEP = VIDDEC_GetBits(&nBitPosition, 3, pHeaderStream, OMX_TRUE);
-                if(sMPEG4_Param->nUFEP == 1) {
-                    sMPEG4_Param->nSourceFormat = VIDDEC_GetBits(&nBitPosition, 3, pHeaderStream, OMX_TRUE);
-                    if (sMPEG4_Param->nSourceFormat == 0x1)
-                    {
-                        (*nWidth) = 128;
-                        (*nHeight) = 96;
-                    }
-                    else if (sMPEG4_Param->nSourceFormat == 0x2)
-                    {
-                        (*nWidth) = 176;
-                        (*nHeight) = 144;
-                    }
-                    else if (sMPEG4_Param->nSourceFormat == 0x3)
-                    {
-                        (*nWidth) = 352;
-                        (*nHeight) = 288;
-                    }
-                    else if (sMPEG4_Param->nSourceFormat == 0x4)
-                    {
-
-                        (*nWidth) = 704;
-                        (*nHeight) = 576;
-                    }
-                    else if (sMPEG4_Param->nSourceFormat == 0x5)
-                    {
-                        (*nWidth) = 1408;
-                        (*nHeight) = 1152;
-                    }
-                    else if (sMPEG4_Param->nSourceFormat == 0x6)
-                    {
-                        (void)VIDDEC_GetBits(&nBitPosition, 24, pHeaderStream, OMX_TRUE);
-                        sMPEG4_Param->nCPM = VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-                        if(sMPEG4_Param->nCPM)
-                            (void)VIDDEC_GetBits(&nBitPosition, 2, pHeaderStream, OMX_TRUE);
-
-                        (void)VIDDEC_GetBits(&nBitPosition, 4, pHeaderStream, OMX_TRUE);
+    OMX_TI_M4VHEADERTYPE sHeader;
 
-                        sMPEG4_Param->nPWI = VIDDEC_GetBits(&nBitPosition, 9, pHeaderStream, OMX_TRUE);
-                        (*nWidth) = (sMPEG4_Param->nPWI + 1)*4;
-
-                        (void)VIDDEC_GetBits(&nBitPosition, 1, pHeaderStream, OMX_TRUE);
-
-                        sMPEG4_Param->nPHI = VIDDEC_GetBits(&nBitPosition, 9, pHeaderStream, OMX_TRUE);
-                        (*nHeight) = sMPEG4_Param->nPHI*4;
-
-                    }
-                    else if (sMPEG4_Param->nSourceFormat == 0x7)
-                    {
-                        sMPEG4_Param->nSourceFormat = VIDDEC_GetBits(&nBitPosition, 3, pHeaderStream, OMX_TRUE);
-                        (*nWidth) = 1408;
-                        (*nHeight) = 1152;
-                    }
-                    else
-                    {
-                        eError = OMX_ErrorUnsupportedSetting;
-                        goto EXIT;
-                    }
-                }
-            }
-            else
-            {
-                eError = OMX_ErrorUnsupportedSetting;
-                goto EXIT;
-            }
-            bHeaderParseCompleted = OMX_TRUE;
-            eError = OMX_ErrorNone;
-        }
-        else
-        {
-            eError = OMX_ErrorUnsupportedSetting;
-            goto EXIT;
-        }
-    }
-EXIT:
-    if(pPictHeaderPtr->cnOptional != NULL)
-    {
-            free( pPictHeaderPtr->cnOptional);
-            pPictHeaderPtr->cnOptional = NULL;
+    eError = OMX_TI_M4vParseHeader((const OMX_U8*)pBuffHead->pBuffer, pBuffHead->nFilledLen, &sHeader);
+    if (eError == OMX_ErrorNone) {
+        (*nWidth) = sHeader.nWidth;
+        (*nHeight) = sHeader.nHeight;
     }
     return eError;
 }
@@ -4530,28 +4286,14 @@ EXIT:
 /*  ==========================================================================*/
 /*  func    VIDDEC_ScanConfigBufferAVC                                            */
 /*                                                                            */
-/*  desc    Use to scan buffer for certain patter. Used to know if ConfigBuffers are together                             */
+/*  desc    Counts the start codes in the buffer. Used to know if ConfigBuffers are together                             */
 /*  ==========================================================================*/
-static OMX_U32 VIDDEC_ScanConfigBufferAVC(OMX_BUFFERHEADERTYPE* pBuffHead,  OMX_U32 pattern){
-    OMX_U32 nBitPosition = 0;
-    OMX_U32 nInBytePosition = 0;
-    OMX_U32 nPatternCounter = 0;
-    OMX_U32 nTotalInBytes = pBuffHead->nFilledLen;
-    OMX_U8* nBitStream = (OMX_U8*)pBuffHead->pBuffer;
-    
-    while (nInBytePosition < nTotalInBytes - 3){
-         if (VIDDEC_GetBits(&nBitPosition, 24, nBitStream, OMX_FALSE) != pattern) {
-              nBitPosition += 8;
-              nInBytePosition++;
-         }
-         else {
-             /*Pattern found; add count*/
-             nPatternCounter++;
-             nBitPosition += 24;
-             nInBytePosition += 3;
-         }
-    }
-    return nPatternCounter;
+static OMX_U32 VIDDEC_ScanConfigBufferAVC(OMX_BUFFERHEADERTYPE* pBuffHead){
+    if (pBuffHead->nFilledLen < 4) {
+        return 0;
+    }
+    /* a start code ending on the last byte is not counted */
+    return OMX_TI_NalCountStartCodes((OMX_U8*)pBuffHead->pBuffer, pBuffHead->nFilledLen - 1);
 }
 
 /*  ==========================================================================*/
@@ -4565,45 +4307,35 @@ OMX_ERRORTYPE VIDDEC_ParseVideo_H264(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate
                                      OMX_S32* nCropHeight, OMX_U32 nType)
 {
     OMX_ERRORTYPE eError = OMX_ErrorBadParameter;
-    OMX_S32 i = 0;
     VIDDEC_AVC_ParserParam* sParserParam = NULL;
     /*OMX_S32 nRetVal = 0;*/
     OMX_BOOL nStartFlag = OMX_FALSE;
-    OMX_U32 nBitPosition = 0;
-    OMX_U32 nRbspPosition = 0;
+    OMX_TI_BITREADERTYPE sBits;
     OMX_U32 nTotalInBytes = 0;
     OMX_U32 nInBytePosition = 0;
     OMX_U32 nInPositionTemp = 0;
     OMX_U32 nNumOfBytesInRbsp = 0;
     OMX_S32 nNumBytesInNALunit = 0;
+    OMX_U32 nStartOffset = 0;
     OMX_U8* nBitStream = 0;
     OMX_U32 nNalUnitType = 0;
-    OMX_U8* nRbspByte = NULL;
+    const OMX_U8* pRbsp = NULL;
+    OMX_U32 nNalBytes = 0;
+    VIDDEC_AVC_PARSERCTX* pParser = &pComponentPrivate->sAVCParser;
+    OMX_TI_AVCSPSTYPE* pInfo = &pComponentPrivate->sAVCStreamInfo;
 
     OMX_U8 *pDataBuf;
 
-    /* counter used for fragmentation of Config Buffer Code */
-   static OMX_U32 nConfigBufferCounter;
-
     nTotalInBytes = pBuffHead->nFilledLen;
     nBitStream = (OMX_U8*)pBuffHead->pBuffer;/* + (OMX_U8*)pBuffHead->nOffset;*/
-    nRbspByte = (OMX_U8*)malloc(nTotalInBytes);
-    if (!nRbspByte) {
-        eError =  OMX_ErrorInsufficientResources;
-        goto EXIT;
-    }
-    memset(nRbspByte, 0x0, nTotalInBytes);
-    sParserParam = (VIDDEC_AVC_ParserParam *)malloc(sizeof(VIDDEC_AVC_ParserParam));
-    if (!sParserParam) {
-        eError =  OMX_ErrorInsufficientResources;
-        goto EXIT;
-    }
+    sParserParam = &pParser->sParam;
+    memset(sParserParam, 0, sizeof(VIDDEC_AVC_ParserParam));
 
     if (nType == 0) {
         /* Start of Handle fragmentation of Config Buffer  Code*/
         /*Scan for 2 "0x000001", requiered on buffer to parser properly*/
-        nConfigBufferCounter += VIDDEC_ScanConfigBufferAVC(pBuffHead, 0x000001);
-        if(nConfigBufferCounter < 2){ /*If less of 2 we need to store the data internally to later assembly the complete ConfigBuffer*/
+        pParser->nConfigStartCodes += VIDDEC_ScanConfigBufferAVC(pBuffHead);
+        if(pParser->nConfigStartCodes < 2){ /*If less of 2 we need to store the data internally to later assembly the complete ConfigBuffer*/
             /*Set flag to False, the Config Buffer is not complete */
             OMX_PRINT2(pComponentPrivate->dbg, "Setting bConfigBufferCompleteAVC = OMX_FALSE");
             pComponentPrivate->bConfigBufferCompleteAVC = OMX_FALSE;
@@ -4638,103 +4370,72 @@ OMX_ERRORTYPE VIDDEC_ParseVideo_H264(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate
         else{  /* We have all the requiered data*/
              OMX_PRINT2(pComponentPrivate->dbg, "Setting bConfigBufferCompleteAVC = OMX_TRUE");
              pComponentPrivate->bConfigBufferCompleteAVC = OMX_TRUE;
+             pParser->nConfigStartCodes = 0;
              /* If we have already Config data of previous buffer, we assembly the final ConfigBuffer*/
              if(pComponentPrivate->pInternalConfigBufferAVC != NULL){
-                  /*Check if memcpy is safe*/
-                 if(pComponentPrivate->pInPortDef->nBufferSize >= 
-                     pComponentPrivate->nInternalConfigBufferFilledAVC + pBuffHead->nFilledLen){
-                     /*The current data of the Buffer has to be placed at the end of buffer*/
-                     if(memcpy((OMX_U8*)(pBuffHead->pBuffer + pComponentPrivate->nInternalConfigBufferFilledAVC),
-                         pBuffHead->pBuffer,
-                         pBuffHead->nFilledLen) == NULL){ 
-                           eError = OMX_ErrorInsufficientResources;    
-                           goto EXIT;
-                    }
-                     /*The data internally stored has to be put at the begining of the buffer*/
-                     if(memcpy(pBuffHead->pBuffer,
-                         pComponentPrivate->pInternalConfigBufferAVC,
-                         pComponentPrivate->nInternalConfigBufferFilledAVC) == NULL){ 
-                           eError = OMX_ErrorInsufficientResources;
-                           goto EXIT;
-                     }
-                }
-                else{
+                 /*The data internally stored has to be put at the begining of the buffer,
+                   in front of the current data, which also updates its filled length*/
+                 if(!OMX_TI_NalPrependConfig(pBuffHead->pBuffer, &pBuffHead->nFilledLen,
+                                             pComponentPrivate->pInPortDef->nBufferSize,
+                                             pComponentPrivate->pInternalConfigBufferAVC,
+                                             pComponentPrivate->nInternalConfigBufferFilledAVC)){
                     eError = OMX_ErrorInsufficientResources;
                     goto EXIT;
                  }
 
-                 /*Update filled length of current buffer */
-                 pBuffHead->nFilledLen = pComponentPrivate->nInternalConfigBufferFilledAVC + pBuffHead->nFilledLen;
                  /*Free Internal Buffer used to temporarly hold the data*/
                  if (pComponentPrivate->pInternalConfigBufferAVC != NULL)
                      free(pComponentPrivate->pInternalConfigBufferAVC);
                  /* Reset Internal Variables*/
                  pComponentPrivate->pInternalConfigBufferAVC = NULL;
                  pComponentPrivate->nInternalConfigBufferFilledAVC = 0;
-                 nConfigBufferCounter = 0;
                  /* Update Buffer Variables before parsing */
                  nTotalInBytes = pBuffHead->nFilledLen;
-                 if ( nRbspByte != NULL )
-                     free(nRbspByte);
-                 nRbspByte = (OMX_U8*)malloc(nTotalInBytes);
-                 if(nRbspByte == NULL){
-                     eError = OMX_ErrorInsufficientResources;
-                     goto EXIT;
-                 }
-                 memset(nRbspByte, 0x0, nTotalInBytes);
                  /*Buffer ready to be parse =) */
             }
         }
          /* End of Handle fragmentation Config Buffer Code*/
 
+        if (nTotalInBytes < 4) {
+            eError = OMX_ErrorStreamCorrupt;
+            goto EXIT;
+        }
         do{
-            for (; (!nStartFlag) && (nInBytePosition < nTotalInBytes - 3); )
-            {
-               if (VIDDEC_GetBits(&nBitPosition, 24, nBitStream, OMX_FALSE) != 0x000001)
-               {
-                    nBitPosition += 8;
-                    nInBytePosition++;
-               }
-               else
-               {
-                   /*Start Code found*/
-                   nStartFlag = OMX_TRUE;
-                   nBitPosition += 24;
-                   nInBytePosition += 3;
-               }
+            /* start codes ending on the last byte are not looked at */
+            if (nInBytePosition < nTotalInBytes - 3) {
+                nStartOffset = OMX_TI_NalFindStartCode(nBitStream + nInBytePosition,
+                                                       nTotalInBytes - 1 - nInBytePosition);
+                if (nStartOffset < nTotalInBytes - 1 - nInBytePosition) {
+                    /*Start Code found*/
+                    nInBytePosition += nStartOffset + 3;
+                }
+                else {
+                    nInBytePosition = nTotalInBytes - 3;
+                }
             }
             nStartFlag = OMX_FALSE;
             /* offset to NumBytesInNALunit*/
             nNumBytesInNALunit = nInBytePosition;
-            sParserParam->nBitPosTemp = nBitPosition;
-              for (;(!nStartFlag)&&(nNumBytesInNALunit < nTotalInBytes-3); )
-            {
-                if (VIDDEC_GetBits(&sParserParam->nBitPosTemp, 24, nBitStream, OMX_FALSE) != 0x000001)
-                /*find start code*/
-                {
-                    sParserParam->nBitPosTemp += 8;
-                    nNumBytesInNALunit++;
-                }
-                else
-                {
-                   /*Start Code found*/
+            if (nInBytePosition < nTotalInBytes - 3) {
+                nStartOffset = OMX_TI_NalFindStartCode(nBitStream + nInBytePosition,
+                                                       nTotalInBytes - 1 - nInBytePosition);
+                if (nStartOffset < nTotalInBytes - 1 - nInBytePosition) {
+                    /*Start Code found*/
                     nStartFlag = OMX_TRUE;
-                    sParserParam->nBitPosTemp += 24;
-                    nNumBytesInNALunit += 3;
+                    nNumBytesInNALunit += nStartOffset + 3;
                 }
             }
+            sParserParam->nBitPosTemp = nNumBytesInNALunit * 8;
 
             if (!nStartFlag)
             {
                 eError = OMX_ErrorStreamCorrupt;
                 goto EXIT;
             }
-            /* forbidden_zero_bit */
-            sParserParam->nForbiddenZeroBit = VIDDEC_GetBits(&nBitPosition, 1, nBitStream, OMX_TRUE);
-            /* nal_ref_idc */
-            sParserParam->nNalRefIdc = VIDDEC_GetBits(&nBitPosition, 2, nBitStream, OMX_TRUE);
-            /* nal_unit_type */
-            nNalUnitType = VIDDEC_GetBits(&nBitPosition, 5, nBitStream, OMX_TRUE);
+            /* forbidden_zero_bit u(1), nal_ref_idc u(2), nal_unit_type u(5) */
+            sParserParam->nForbiddenZeroBit = nBitStream[nInBytePosition] >> 7;
+            sParserParam->nNalRefIdc = (nBitStream[nInBytePosition] >> 5) & 0x3;
+            nNalUnitType = nBitStream[nInBytePosition] & 0x1f;
             nInBytePosition++;
 
             /* This code is to ensure we will get parameter info */
@@ -4750,243 +4451,148 @@ OMX_ERRORTYPE VIDDEC_ParseVideo_H264(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate
          do {
         /* iOMXComponentUsesNALStartCodes is set to OMX_FALSE on opencore */
 #ifndef ANDROID
-            if (pComponentPrivate->H264BitStreamFormat == 1) {
-                if (pComponentPrivate->bIsNALBigEndian) {
-                    nNumBytesInNALunit = (OMX_U32)pDataBuf[nInBytePosition];
-                }
-                else {
-                    nNumBytesInNALunit = (OMX_U32)pDataBuf[nInBytePosition];
-                }
-            }
-            else if (pComponentPrivate->H264BitStreamFormat == 2) {
-                if (pComponentPrivate>bIsNALBigEndian) {
-                    nNumBytesInNALunit = (OMX_U32)pDataBuf[nInBytePosition] << 8 | pDataBuf[nInBytePosition+1];
-                }
-                else {
-                    nNumBytesInNALunit = (OMX_U32)pDataBuf[nInBytePosition] << 0 | pDataBuf[nInBytePosition+1] << 8 ;
-                }
-            }
-            else if (pComponentPrivate->H264BitStreamFormat == 4){
-                if (pComponentPrivate->bIsNALBigEndian) {
-                    nNumBytesInNALunit = (OMX_U32)pDataBuf[nInBytePosition]<<24 | pDataBuf[nInBytePosition+1] << 16 | pDataBuf[nInBytePosition+2] << 8 | pDataBuf[nInBytePosition+3];
-                }
-                else {
-                    nNumBytesInNALunit = (OMX_U32)pDataBuf[nInBytePosition]<<0 | pDataBuf[nInBytePosition+1] << 8 | pDataBuf[nInBytePosition+2] << 16 | pDataBuf[nInBytePosition+3]<<24;
-                }
-            }
-            else {
+            if ((pComponentPrivate->H264BitStreamFormat != 1 &&
+                 pComponentPrivate->H264BitStreamFormat != 2 &&
+                 pComponentPrivate->H264BitStreamFormat != 4) ||
+                nInBytePosition + pComponentPrivate->H264BitStreamFormat > nTotalInBytes) {
                 eError = OMX_ErrorBadParameter;
                 goto EXIT;
             }
+            nNumBytesInNALunit = VIDDEC_NALULength(pDataBuf + nInBytePosition,
+                                                   pComponentPrivate->H264BitStreamFormat,
+                                                   pComponentPrivate->bIsNALBigEndian);
 #endif
-            nBitPosition = (nInPositionTemp + nType) * 8;
             nInBytePosition = nInPositionTemp + nType;
             nInPositionTemp += nNumBytesInNALunit + nType;
-            if (nInBytePosition > nTotalInBytes) {
+            if (nInBytePosition >= nTotalInBytes) {
                 eError = OMX_ErrorBadParameter;
                 goto EXIT;
             }
-            /* forbidden_zero_bit */
-            sParserParam->nForbiddenZeroBit = VIDDEC_GetBits(&nBitPosition, 1, nBitStream, OMX_TRUE);
-            /* nal_ref_idc */
-            sParserParam->nNalRefIdc = VIDDEC_GetBits(&nBitPosition, 2, nBitStream, OMX_TRUE);
-            /* nal_unit_type */
-            nNalUnitType = VIDDEC_GetBits(&nBitPosition, 5, nBitStream, OMX_TRUE);
+            /* forbidden_zero_bit u(1), nal_ref_idc u(2), nal_unit_type u(5) */
+            sParserParam->nForbiddenZeroBit = nBitStream[nInBytePosition] >> 7;
+            sParserParam->nNalRefIdc = (nBitStream[nInBytePosition] >> 5) & 0x3;
+            nNalUnitType = nBitStream[nInBytePosition] & 0x1f;
             nInBytePosition++;
             /* This code is to ensure we will get parameter info */
             if (nNalUnitType != 7) {
-                /*nBitPosition += (nNumBytesInNALunit - 1) * 8;
-                nInBytePosition += (nNumBytesInNALunit - 1);*/
-                nBitPosition = (nInPositionTemp) * 8;
                 nInBytePosition = (nInPositionTemp);
-
             }
         } while (nNalUnitType != 7);
         nNumBytesInNALunit += 8 + nInBytePosition;/*sum to keep the code flow*/
-                                /*the buffer must had enough space to enter this number*/
+        if (nNumBytesInNALunit - 3 > (OMX_S32)nTotalInBytes) {
+            nNumBytesInNALunit = nTotalInBytes + 3;
+        }
     }
-    for (i=0; nInBytePosition < nNumBytesInNALunit - 3; )
+    if ((OMX_S32)nInBytePosition < nNumBytesInNALunit - 3)
     {
-
-        if (((nInBytePosition + 2) < nNumBytesInNALunit - 3)&&
-            (VIDDEC_GetBits(&nBitPosition, 24, nBitStream, OMX_FALSE) == 0x000003))
-        {
-            OMX_PRINT2(pComponentPrivate->dbg, "discard emulation prev byte\n");
-            nRbspByte[i++] = nBitStream[nInBytePosition++];
-            nRbspByte[i++] = nBitStream[nInBytePosition++];
-            nNumOfBytesInRbsp += 2;
-            /* discard emulation prev byte */
-            nInBytePosition++;
-            nBitPosition += 24;
+        /* The SPS is parsed in place unless it has emulation prevention
+           bytes; then its leading bytes are unescaped into the scratch
+           area, which holds more than the fields that are read */
+        nNalBytes = nNumBytesInNALunit - 3 - nInBytePosition;
+        if (OMX_TI_NalFindEmulationPrevention(nBitStream + nInBytePosition, nNalBytes) == nNalBytes) {
+            pRbsp = nBitStream + nInBytePosition;
+            nNumOfBytesInRbsp = nNalBytes;
         }
-        else
-        {
-            nRbspByte[i++] = nBitStream[nInBytePosition++];
-            nNumOfBytesInRbsp++;
-            nBitPosition += 8;
+        else {
+            if (nNalBytes > VIDDEC_AVC_SCRATCH_SIZE) {
+                nNalBytes = VIDDEC_AVC_SCRATCH_SIZE;
+            }
+            pRbsp = pParser->aScratch;
+            nNumOfBytesInRbsp = OMX_TI_NalRemoveEmulationPrevention(pParser->aScratch,
+                                                                    nBitStream + nInBytePosition,
+                                                                    nNalBytes);
         }
+        nInBytePosition = nNumBytesInNALunit - 3;
     }
 
 
     /*Parse RBSP sequence*/
     /*///////////////////*/
-    /*  profile_idc u(8) */
-    sParserParam->nProfileIdc = VIDDEC_GetBits(&nRbspPosition, 8, nRbspByte, OMX_TRUE);
-    /* constraint_set0_flag u(1)*/
-    sParserParam->nConstraintSet0Flag = VIDDEC_GetBits(&nRbspPosition, 1, nRbspByte, OMX_TRUE);
-    /* constraint_set1_flag u(1)*/
-    sParserParam->nConstraintSet1Flag = VIDDEC_GetBits(&nRbspPosition, 1, nRbspByte, OMX_TRUE);
-    /* constraint_set2_flag u(1)*/
-    sParserParam->nConstraintSet2Flag = VIDDEC_GetBits(&nRbspPosition, 1, nRbspByte, OMX_TRUE);
-    /* reserved_zero_5bits u(5)*/
-    sParserParam->nReservedZero5bits = VIDDEC_GetBits(&nRbspPosition, 5, nRbspByte, OMX_TRUE);
-    /* level_idc*/
-    sParserParam->nLevelIdc = VIDDEC_GetBits(&nRbspPosition, 8, nRbspByte, OMX_TRUE);
-    sParserParam->nSeqParameterSetId = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-    sParserParam->nLog2MaxFrameNumMinus4 = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-    sParserParam->nPicOrderCntType = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-
-    if ( sParserParam->nPicOrderCntType == 0 )
-    {
-        sParserParam->nLog2MaxPicOrderCntLsbMinus4 = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-    }
-    else if( sParserParam->nPicOrderCntType == 1 )
-    {
-        /* delta_pic_order_always_zero_flag*/
-        VIDDEC_GetBits(&nRbspPosition, 1, nRbspByte, OMX_TRUE);
-        sParserParam->nOffsetForNonRefPic = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-        if (sParserParam->nOffsetForNonRefPic > 1)
-              sParserParam->nOffsetForNonRefPic = sParserParam->nOffsetForNonRefPic & 0x1 ?
-                                                sParserParam->nOffsetForNonRefPic >> 1 :
-                                              -(sParserParam->nOffsetForNonRefPic >> 1);
-        sParserParam->nOffsetForTopToBottomField = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-        sParserParam->nNumRefFramesInPicOrderCntCycle = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-        for(i = 0; i < sParserParam->nNumRefFramesInPicOrderCntCycle; i++ )
-            VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte); /*offset_for_ref_frame[i]*/
-    }
-
-    sParserParam->nNumRefFrames = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-    sParserParam->nGapsInFrameNumValueAllowedFlag = VIDDEC_GetBits(&nRbspPosition, 1, nRbspByte, OMX_TRUE);
-    sParserParam->nPicWidthInMbsMinus1 = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-    (*nWidth) = (sParserParam->nPicWidthInMbsMinus1 + 1) * 16;
-    sParserParam->nPicHeightInMapUnitsMinus1 = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-    (*nHeight) = (sParserParam->nPicHeightInMapUnitsMinus1 + 1) * 16;
-    /* Checking for cropping in picture saze */
-    /* getting frame_mbs_only_flag */
-    sParserParam->nFrameMbsOnlyFlag = VIDDEC_GetBits(&nRbspPosition, 1, nRbspByte, OMX_TRUE);
-    if (!sParserParam->nFrameMbsOnlyFlag)
-    {
-        sParserParam->nMBAdaptiveFrameFieldFlag = VIDDEC_GetBits(&nRbspPosition, 1, nRbspByte, OMX_TRUE);
+    OMX_TI_BitsInit(&sBits, pRbsp, nNumOfBytesInRbsp);
+    eError = OMX_TI_AvcParseSps(&sBits, pInfo);
+    if (eError != OMX_ErrorNone) {
+        goto EXIT;
     }
-    /*getting direct_8x8_inference_flag and frame_cropping_flag*/
-    sParserParam->nDirect8x8InferenceFlag = VIDDEC_GetBits(&nRbspPosition, 1, nRbspByte, OMX_TRUE);
-    sParserParam->nFrameCroppingFlag = VIDDEC_GetBits(&nRbspPosition, 1, nRbspByte, OMX_TRUE);
-    /*getting the crop values if exist*/
-    if (sParserParam->nFrameCroppingFlag)
-    {
-        sParserParam->nFrameCropLeftOffset = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-        sParserParam->nFrameCropRightOffset = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-        sParserParam->nFrameCropTopOffset = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-        sParserParam->nFrameCropBottomOffset = VIDDEC_UVLC_dec(&nRbspPosition, nRbspByte);
-        /* Update framesize taking into account the cropping values */
-        (*nCropWidth) = (2 * sParserParam->nFrameCropLeftOffset + 2 * sParserParam->nFrameCropRightOffset);
-        (*nCropHeight) = (2 * sParserParam->nFrameCropTopOffset + 2 * sParserParam->nFrameCropBottomOffset);
+    /* frame size in whole macroblocks, field coded map units are
+       macroblock pairs; the crop offsets in luma samples */
+    (*nWidth) = pInfo->nWidthMbs * 16;
+    (*nHeight) = pInfo->nHeightMapUnits * (2 - pInfo->bFrameMbsOnly) * 16;
+    if (pInfo->bFrameCropping) {
+        (*nCropWidth) = pInfo->nCropUnitX * (pInfo->nCropLeftOffset + pInfo->nCropRightOffset);
+        (*nCropHeight) = pInfo->nCropUnitY * (pInfo->nCropTopOffset + pInfo->nCropBottomOffset);
     }
+    OMX_PRINT1(pComponentPrivate->dbg, "AVC level %lu num_ref_frames %lu DPB %lu frames\n",
+               pInfo->nLevelIdc, pInfo->nNumRefFrames, pInfo->nDpbFrames);
     eError = OMX_ErrorNone;
 
 EXIT:
-    if (nRbspByte)
-        free( nRbspByte);
-    if (sParserParam)
-        free( sParserParam);
     return eError;
 }
 #endif
 
 #ifdef VIDDEC_ACTIVATEPARSER
-/*  =========================================================================*/
-/*  func    GetBits                                                          */
-/*                                                                           */
-/*  desc    Gets aBits number of bits from position aPosition of one buffer  */
-/*            and returns the value in a TUint value.                        */
-/*  =========================================================================*/
-OMX_U32 VIDDEC_GetBits(OMX_U32* nPosition, OMX_U8 nBits, OMX_U8* pBuffer, OMX_BOOL bIcreasePosition)
-{
-    OMX_U32 nOutput;
-    OMX_U32 nNumBitsRead = 0;
-    OMX_U32 nBytePosition = 0;
-    OMX_U8  nBitPosition =  0;
-    nBytePosition = *nPosition / 8;
-    nBitPosition =  *nPosition % 8;
-
-    if (bIcreasePosition)
-        *nPosition += nBits;
-    nOutput = ((OMX_U32)pBuffer[nBytePosition] << (24+nBitPosition) );
-    nNumBitsRead = nNumBitsRead + (8 - nBitPosition);
-    if (nNumBitsRead < nBits)
-    {
-        nOutput = nOutput | ( pBuffer[nBytePosition + 1] << (16+nBitPosition));
-        nNumBitsRead = nNumBitsRead + 8;
-    }
-    if (nNumBitsRead < nBits)
-    {
-        nOutput = nOutput | ( pBuffer[nBytePosition + 2] << (8+nBitPosition));
-        nNumBitsRead = nNumBitsRead + 8;
-    }
-    if (nNumBitsRead < nBits)
-    {
-        nOutput = nOutput | ( pBuffer[nBytePosition + 3] << (nBitPosition));
-        nNumBitsRead = nNumBitsRead + 8;
-    }
-    nOutput = nOutput >> (32 - nBits) ;
-    return nOutput;
-}
-
-
-OMX_S32 VIDDEC_UVLC_dec(OMX_U32 *nPosition, OMX_U8* pBuffer)
+/* ========================================================================== */
+/**
+  *  VIDDEC_AdaptiveResize() applies a new stream resolution of an adaptive
+  *  playback session without a port reconfiguration. The node was created
+  *  and the output buffers allocated and counted for the maximum
+  *  resolution, so only the layout of the frames inside the buffers
+  *  changes: nStride and
+  *  nSliceHeight follow the decoded frame, the crop its visible part. The
+  *  client is told through OMX_EventPortSettingsChanged with
+  *  OMX_IndexConfigCommonOutputCrop.
+  *
+  * @retval OMX_TRUE   the new resolution fits and was applied
+  *         OMX_FALSE  the ports have to be reconfigured
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_AdaptiveResize(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                      OMX_S32 nFrameWidth, OMX_S32 nFrameHeight,
+                                      OMX_S32 nVisibleWidth, OMX_S32 nVisibleHeight,
+                                      OMX_U32 nOutAllocLen)
 {
-
-    OMX_U32 nBytePosition = (*nPosition) / 8;
-    OMX_U8 cBitPosition =  (*nPosition) % 8;
-    OMX_U32 nLen = 1;
-    OMX_U32 nCtrBit = 0;
-    OMX_U32 nVal = 1;
-    OMX_S32 nInfoBit=0;
-
-    nCtrBit = pBuffer[nBytePosition] & (0x1 << (7-cBitPosition));
-    while (nCtrBit==0)
-    {
-        nLen++;
-        cBitPosition++;
-        (*nPosition)++;
-        if (!(cBitPosition%8))
-        {
-            cBitPosition=0;
-            nBytePosition++;
-        }
-        nCtrBit = pBuffer[nBytePosition] & (0x1<<(7-cBitPosition));
-    }
-    for(nInfoBit=0; (nInfoBit<(nLen-1)); nInfoBit++)
-    {
-        cBitPosition++;
-        (*nPosition)++;
-
-        if (!(cBitPosition%8))
-        {
-            cBitPosition=0;
-            nBytePosition++;
-        }
-        nVal=(nVal << 1);
-        if(pBuffer[nBytePosition] & (0x01 << (7 - cBitPosition)))
-            nVal |= 1;
+    VIDDEC_PARAM_ADAPTIVEPLAYBACKTYPE* pAdaptive = &pComponentPrivate->sAdaptivePlayback;
+    OMX_PARAM_PORTDEFINITIONTYPE* pOutPortDef = pComponentPrivate->pOutPortDef;
+    OMX_CONFIG_RECTTYPE* pCrop = &pComponentPrivate->sOutputCrop;
+    OMX_S32 nStride = nFrameWidth;
+
+    if (nFrameWidth < 16 || nFrameHeight < 16 ||
+        (OMX_U32)nFrameWidth > pAdaptive->nMaxFrameWidth ||
+        (OMX_U32)nFrameHeight > pAdaptive->nMaxFrameHeight) {
+        return OMX_FALSE;
+    }
+    /* MPEG-2 writes the frames at the display width handed to the node */
+    if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG2 &&
+        pComponentPrivate->nDisplayWidth > (OMX_U32)nStride) {
+        nStride = pComponentPrivate->nDisplayWidth;
+    }
+    if ((OMX_U32)nStride * nFrameHeight *
+        ((pComponentPrivate->pOutPortFormat->eColorFormat == VIDDEC_COLORFORMAT420) ? VIDDEC_FACTORFORMAT420 : VIDDEC_FACTORFORMAT422) > nOutAllocLen) {
+        return OMX_FALSE;
+    }
+
+    if (pOutPortDef->format.video.nStride != nStride ||
+        pOutPortDef->format.video.nSliceHeight != (OMX_U32)nFrameHeight ||
+        pCrop->nWidth != (OMX_U32)nVisibleWidth ||
+        pCrop->nHeight != (OMX_U32)nVisibleHeight) {
+        pOutPortDef->format.video.nStride = nStride;
+        pOutPortDef->format.video.nSliceHeight = nFrameHeight;
+        pCrop->nLeft = 0;
+        pCrop->nTop = 0;
+        pCrop->nWidth = nVisibleWidth;
+        pCrop->nHeight = nVisibleHeight;
+        OMX_PRINT1(pComponentPrivate->dbg, "Adaptive resolution %ldx%ld, frame %ldx%ld\n",
+                   nVisibleWidth, nVisibleHeight, nStride, nFrameHeight);
+        pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                               pComponentPrivate->pHandle->pApplicationPrivate,
+                                               OMX_EventPortSettingsChanged,
+                                               VIDDEC_OUTPUT_PORT,
+                                               OMX_IndexConfigCommonOutputCrop,
+                                               NULL);
     }
-    (*nPosition)++;
-    nVal -= 1;
-    return nVal;
+    return OMX_TRUE;
 }
-#endif
 
-#ifdef VIDDEC_ACTIVATEPARSER
 /* ========================================================================== */
 /**
   *  Parse the input buffer to get the correct width and height
@@ -5005,6 +4611,7 @@ OMX_ERRORTYPE VIDDEC_ParseHeader(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OM
     OMX_S32 nCroppedHeight = 0;
 
     OMX_U32 nOutMinBufferSize = 0;
+    OMX_U32 nOutBufferCount = 0;
     OMX_BOOL bInPortSettingsChanged = OMX_FALSE;
     OMX_BOOL bOutPortSettingsChanged = OMX_FALSE;
     OMX_U32 nOutPortActualAllocLen = 0;
@@ -5030,6 +4637,19 @@ OMX_ERRORTYPE VIDDEC_ParseHeader(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OM
         if( pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
             eError = VIDDEC_ParseVideo_H264( pComponentPrivate, pBuffHead, &nWidth, &nHeight,
                 &nCropWidth, &nCropHeight, pComponentPrivate->H264BitStreamFormat);
+            if (eError == OMX_ErrorNone) {
+                /* the DPB the stream needs plus the buffers the display
+                   holds. nDpbFrames comes from max_dec_frame_buffering,
+                   num_ref_frames or the level limit, in that order */
+                nOutBufferCount = pComponentPrivate->sAVCStreamInfo.nDpbFrames + VIDDEC_AVC_DISPLAY_BUFFERS;
+                if (nOutBufferCount > pComponentPrivate->nMaxBufferCount) {
+                    nOutBufferCount = pComponentPrivate->nMaxBufferCount;
+                }
+                /* a thumbnail is a single IDR picture, one buffer holds it */
+                if (pComponentPrivate->sThumbnail.bEnable) {
+                    nOutBufferCount = 0;
+                }
+            }
 
             /* Start Code to handle fragmentation of ConfigBuffer for AVC*/
             if(pComponentPrivate->bConfigBufferCompleteAVC == OMX_FALSE &&
@@ -5083,6 +4703,40 @@ OMX_ERRORTYPE VIDDEC_ParseHeader(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OM
             }
         }
 
+        if (pComponentPrivate->sAdaptivePlayback.bEnable) {
+            /* same frame layout the port definition gets below */
+            OMX_S32 nFrameWidth = nPadWidth;
+            OMX_S32 nFrameHeight = nPadHeight;
+            OMX_S32 nVisibleWidth = nWidth;
+            OMX_S32 nVisibleHeight = nHeight;
+
+            if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
+                nFrameWidth = nVisibleWidth = nPadWidth - nCropWidth;
+                nFrameHeight = nVisibleHeight = nPadHeight - nCropHeight;
+            }
+            else if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG4 ||
+                     pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingH263) {
+                nFrameWidth = nWidth;
+                nFrameHeight = nHeight;
+            }
+            if (VIDDEC_AdaptiveResize(pComponentPrivate, nFrameWidth, nFrameHeight,
+                                      nVisibleWidth, nVisibleHeight,
+                                      nOutPortActualAllocLen)) {
+                eError = OMX_ErrorNone;
+                goto EXIT;
+            }
+            /* does not fit: the ports are reconfigured for this stream,
+               which becomes the maximum of the session */
+            if (nPadWidth >= 16 && nPadHeight >= 16 && nWidth < 1500 && nHeight < 1500) {
+                pComponentPrivate->sAdaptivePlayback.nMaxFrameWidth = nPadWidth;
+                pComponentPrivate->sAdaptivePlayback.nMaxFrameHeight = nPadHeight;
+                pComponentPrivate->pOutPortDef->format.video.nStride = VIDDEC_OUTPUT_PORT_STRIDE;
+                pComponentPrivate->pOutPortDef->format.video.nSliceHeight = VIDDEC_OUTPUT_PORT_SLICEHEIGHT;
+                pComponentPrivate->sOutputCrop.nWidth = nVisibleWidth;
+                pComponentPrivate->sOutputCrop.nHeight = nVisibleHeight;
+            }
+        }
+
         /*TODO: Get minimum INPUT buffer size & verify if the actual size is enough*/
         /*Verify correct values in the initial setup*/
 
@@ -5154,6 +4808,27 @@ OMX_ERRORTYPE VIDDEC_ParseHeader(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OM
                 bOutPortSettingsChanged = OMX_TRUE;
                 OMX_PRINT1(pComponentPrivate->dbg, "Resolution: AVC new: %dx%d \n", nCroppedWidth, nCroppedHeight);
             }
+            /* The stream's need sets both counts, Actual goes down as well
+               as up. A client that raised Actual through SetParameter keeps
+               it until the stream's need changes */
+            if (nOutBufferCount != 0) {
+                if (nOutBufferCount != pComponentPrivate->nAVCOutBufferCount ||
+                    pComponentPrivate->pOutPortDef->nBufferCountActual < nOutBufferCount) {
+                    if (pComponentPrivate->pOutPortDef->nBufferCountActual != nOutBufferCount) {
+                        if (pComponentPrivate->pOutPortDef->nBufferCountActual < nOutBufferCount) {
+                            eError = VIDDEC_Port_ReserveBuffers(pComponentPrivate, VIDDEC_OUTPUT_PORT, nOutBufferCount);
+                            if (eError != OMX_ErrorNone) {
+                                goto EXIT;
+                            }
+                        }
+                        pComponentPrivate->pOutPortDef->nBufferCountActual = nOutBufferCount;
+                        bOutPortSettingsChanged = OMX_TRUE;
+                        OMX_PRINT1(pComponentPrivate->dbg, "AVC output buffers: %lu\n", nOutBufferCount);
+                    }
+                    pComponentPrivate->nAVCOutBufferCount = nOutBufferCount;
+                }
+                pComponentPrivate->pOutPortDef->nBufferCountMin = nOutBufferCount;
+            }
         }
 
         /*Get minimum OUTPUT buffer size, 
@@ -5192,59 +4867,1096 @@ OMX_ERRORTYPE VIDDEC_ParseHeader(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate, OM
                 VIDDEC_PTHREAD_MUTEX_LOCK(pComponentPrivate->sDynConfigMutex);
 #endif
 
-                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                    pComponentPrivate->pHandle->pApplicationPrivate,
-                                                    OMX_EventPortSettingsChanged,
-                                                    VIDDEC_INPUT_PORT,
-                                                    0,
-                                                    NULL);
-                VIDDEC_WAIT_CODE();
-                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                    pComponentPrivate->pHandle->pApplicationPrivate,
-                                                    OMX_EventPortSettingsChanged,
-                                                    VIDDEC_OUTPUT_PORT,
-                                                    0,
-                                                    NULL);
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                    pComponentPrivate->pHandle->pApplicationPrivate,
+                                                    OMX_EventPortSettingsChanged,
+                                                    VIDDEC_INPUT_PORT,
+                                                    0,
+                                                    NULL);
+                VIDDEC_WAIT_CODE();
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                    pComponentPrivate->pHandle->pApplicationPrivate,
+                                                    OMX_EventPortSettingsChanged,
+                                                    VIDDEC_OUTPUT_PORT,
+                                                    0,
+                                                    NULL);
+
+#ifdef ANDROID
+                VIDDEC_PTHREAD_MUTEX_WAIT(pComponentPrivate->sDynConfigMutex);
+#endif
+                eError = OMX_ErrorBadParameter;
+                goto EXIT;
+            }
+            else {
+                OMX_PRBUFFER2(pComponentPrivate->dbg, "sending OMX_EventPortSettingsChanged SINGLE port\n");
+                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
+                                                pComponentPrivate->pHandle->pApplicationPrivate,
+                                                OMX_EventPortSettingsChanged,
+                                                bOutPortSettingsChanged ? VIDDEC_OUTPUT_PORT : VIDDEC_INPUT_PORT,
+                                                0,
+                                                NULL);
+                eError = OMX_ErrorBadParameter;
+                goto EXIT;
+            }
+        }
+        else {
+            eError = OMX_ErrorNone;
+        }
+EXIT:
+    if (pComponentPrivate)
+        OMX_PRINT1(pComponentPrivate->dbg, "OUT\n");
+    return eError;
+}
+#endif
+
+static OMX_TICKS VIDDEC_MonotonicTime(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return (OMX_TICKS)sNow.tv_sec * 1000000 + sNow.tv_nsec / 1000;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_SetDecodeDeadline() takes the renderer's clock from the client.
+  *  Called on the client's thread, the component thread reads the clock
+  *  under mutexDecodeDeadline.
+  **/
+/* ========================================================================== */
+void VIDDEC_SetDecodeDeadline(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                              const VIDDEC_CONFIG_DECODEDEADLINETYPE* pDeadline)
+{
+    VIDDEC_CONFIG_DECODEDEADLINETYPE* pOwn = &pComponentPrivate->sDecodeDeadline;
+
+    pthread_mutex_lock(&pComponentPrivate->mutexDecodeDeadline);
+    if (pDeadline->bEnable && !pOwn->bEnable) {
+        pOwn->nFramesSkipped = 0;
+        pOwn->nFramesLate = 0;
+        pOwn->nFramesOnTime = 0;
+    }
+    pOwn->nMediaTime = pDeadline->nMediaTime;
+    pOwn->nLateBy = pDeadline->nLateBy;
+    pComponentPrivate->nDeadlineAnchor = VIDDEC_MonotonicTime();
+    pOwn->bEnable = pDeadline->bEnable;
+    pthread_mutex_unlock(&pComponentPrivate->mutexDecodeDeadline);
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_GetDecodeDeadline() returns the clock last set and the counters.
+  **/
+/* ========================================================================== */
+void VIDDEC_GetDecodeDeadline(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                              VIDDEC_CONFIG_DECODEDEADLINETYPE* pDeadline)
+{
+    VIDDEC_CONFIG_DECODEDEADLINETYPE* pOwn = &pComponentPrivate->sDecodeDeadline;
+
+    pthread_mutex_lock(&pComponentPrivate->mutexDecodeDeadline);
+    pDeadline->bEnable = pOwn->bEnable;
+    pDeadline->nMediaTime = pOwn->nMediaTime;
+    pDeadline->nLateBy = pOwn->nLateBy;
+    pDeadline->nFramesSkipped = pOwn->nFramesSkipped;
+    pDeadline->nFramesLate = pOwn->nFramesLate;
+    pDeadline->nFramesOnTime = pOwn->nFramesOnTime;
+    pthread_mutex_unlock(&pComponentPrivate->mutexDecodeDeadline);
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_SetDecodeTelemetry() turns the decode telemetry on or off; on
+  *  clears the samples. Called on the client's thread.
+  **/
+/* ========================================================================== */
+void VIDDEC_SetDecodeTelemetry(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                               const VIDDEC_CONFIG_DECODETELEMETRYTYPE* pTelemetry)
+{
+    VIDDEC_TELEMETRY* pOwn = &pComponentPrivate->sTelemetry;
+
+    pthread_mutex_lock(&pComponentPrivate->mutexTelemetry);
+    if (pTelemetry->bEnable && !pOwn->bEnable) {
+        memset(pOwn->nSamples, 0, sizeof(pOwn->nSamples));
+        memset(pOwn->aFrames, 0, sizeof(pOwn->aFrames));
+        pOwn->nNextFrame = 0;
+    }
+    pOwn->bEnable = pTelemetry->bEnable;
+    pthread_mutex_unlock(&pComponentPrivate->mutexTelemetry);
+}
+
+static int VIDDEC_Telemetry_Compare(const void* pA, const void* pB)
+{
+    OMX_U32 nA = *(const OMX_U32*)pA;
+    OMX_U32 nB = *(const OMX_U32*)pB;
+
+    return (nA > nB) - (nA < nB);
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_GetDecodeTelemetry() works out the percentiles of every stage
+  *  from a copy of its samples, nearest rank, and the output rate.
+  **/
+/* ========================================================================== */
+void VIDDEC_GetDecodeTelemetry(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                               VIDDEC_CONFIG_DECODETELEMETRYTYPE* pTelemetry)
+{
+    VIDDEC_TELEMETRY* pOwn = &pComponentPrivate->sTelemetry;
+    OMX_U32 aSorted[VIDDEC_TELEMETRY_WINDOW];
+    OMX_TICKS nFirst = 0;
+    OMX_TICKS nLast = 0;
+    OMX_U32 nOutputs = 0;
+    OMX_U32 nStage;
+
+    pTelemetry->nFramesPerSecondQ16 = 0;
+    for (nStage = 0; nStage < VIDDEC_TelemetryStageMax; nStage++) {
+        VIDDEC_TELEMETRY_STAGETYPE* pStage = &pTelemetry->sStage[nStage];
+        OMX_U32 nCount;
+
+        pthread_mutex_lock(&pComponentPrivate->mutexTelemetry);
+        pTelemetry->bEnable = pOwn->bEnable;
+        nCount = pOwn->nSamples[nStage];
+        if (nStage == VIDDEC_TelemetryTotal) {
+            pTelemetry->nFramesOut = nCount;
+            if (nCount > 1) {
+                /* the oldest sample left in the ring, and the newest */
+                nFirst = pOwn->aOutputTime[(nCount > VIDDEC_TELEMETRY_WINDOW) ? nCount % VIDDEC_TELEMETRY_WINDOW : 0];
+                nLast = pOwn->aOutputTime[(nCount - 1) % VIDDEC_TELEMETRY_WINDOW];
+            }
+        }
+        if (nCount > VIDDEC_TELEMETRY_WINDOW) {
+            nCount = VIDDEC_TELEMETRY_WINDOW;
+        }
+        memcpy(aSorted, pOwn->aSamples[nStage], nCount * sizeof(OMX_U32));
+        pthread_mutex_unlock(&pComponentPrivate->mutexTelemetry);
+
+        pStage->nSamples = nCount;
+        if (nCount == 0) {
+            pStage->nP50 = pStage->nP90 = pStage->nP99 = pStage->nMax = 0;
+            continue;
+        }
+        qsort(aSorted, nCount, sizeof(OMX_U32), VIDDEC_Telemetry_Compare);
+        pStage->nP50 = aSorted[(50 * nCount + 99) / 100 - 1];
+        pStage->nP90 = aSorted[(90 * nCount + 99) / 100 - 1];
+        pStage->nP99 = aSorted[(99 * nCount + 99) / 100 - 1];
+        pStage->nMax = aSorted[nCount - 1];
+        if (nStage == VIDDEC_TelemetryTotal) {
+            nOutputs = nCount;
+        }
+    }
+    if (nOutputs > 1 && nLast > nFirst) {
+        pTelemetry->nFramesPerSecondQ16 =
+            (OMX_U32)((((OMX_U64)(nOutputs - 1) * 1000000) << 16) / (OMX_U64)(nLast - nFirst));
+    }
+}
+
+/* Records nUs in eStage; nNow is the output time for VIDDEC_TelemetryTotal. */
+static void VIDDEC_Telemetry_Add(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                 VIDDEC_TELEMETRY_STAGE eStage, OMX_TICKS nTimeStamp,
+                                 OMX_TICKS nUs, OMX_TICKS nNow)
+{
+    VIDDEC_TELEMETRY* pOwn = &pComponentPrivate->sTelemetry;
+    OMX_U32 nSample = (nUs < 0) ? 0 : (nUs > 0xFFFFFFFF) ? 0xFFFFFFFF : (OMX_U32)nUs;
+    OMX_U32 nIndex;
+
+    pthread_mutex_lock(&pComponentPrivate->mutexTelemetry);
+    nIndex = pOwn->nSamples[eStage]++ % VIDDEC_TELEMETRY_WINDOW;
+    pOwn->aSamples[eStage][nIndex] = nSample;
+    if (eStage == VIDDEC_TelemetryTotal) {
+        pOwn->aOutputTime[nIndex] = nNow;
+    }
+    pthread_mutex_unlock(&pComponentPrivate->mutexTelemetry);
+#ifdef __PERF_INSTRUMENTATION__
+    PERF_Log(pComponentPrivate->pPERFcomp, VIDDEC_TELEMETRY_PERF_TAG | eStage,
+             nSample, (OMX_U32)nTimeStamp);
+#else
+    (void)nTimeStamp;
+#endif
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Telemetry_Received() stamps an input buffer on EmptyThisBuffer.
+  **/
+/* ========================================================================== */
+void VIDDEC_Telemetry_Received(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                               OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    VIDDEC_BUFFER_PRIVATE* pBufferPrivate = (VIDDEC_BUFFER_PRIVATE*)pBuffHead->pInputPortPrivate;
+
+    pBufferPrivate->nEmptyTime = pComponentPrivate->sTelemetry.bEnable ? VIDDEC_MonotonicTime() : 0;
+    pBufferPrivate->nSubmitTime = 0;
+}
+
+/* Times the LCML submission of an input buffer stamped nEmptyTime on
+   EmptyThisBuffer and nSubmitTime before LCML_QueueBuffer, once the call
+   returned. The buffer may be back from the DSP by then, so nothing is
+   read from it. */
+static void VIDDEC_Telemetry_Submitted(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                       OMX_TICKS nTimeStamp, OMX_TICKS nEmptyTime,
+                                       OMX_TICKS nSubmitTime)
+{
+    VIDDEC_Telemetry_Add(pComponentPrivate, VIDDEC_TelemetryAppQueue, nTimeStamp,
+                         nSubmitTime - nEmptyTime, 0);
+    VIDDEC_Telemetry_Add(pComponentPrivate, VIDDEC_TelemetryLcmlQueue, nTimeStamp,
+                         VIDDEC_MonotonicTime() - nSubmitTime, 0);
+}
+
+/* Times the DSP on an input buffer it returned, and keeps the frame for
+   VIDDEC_Telemetry_Output(). Several buffers of one timestamp (stream
+   mode) make one frame that starts at the first of them. */
+static void VIDDEC_Telemetry_InputDone(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                       OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    VIDDEC_BUFFER_PRIVATE* pBufferPrivate = (VIDDEC_BUFFER_PRIVATE*)pBuffHead->pInputPortPrivate;
+    VIDDEC_TELEMETRY* pOwn = &pComponentPrivate->sTelemetry;
+    OMX_TICKS nNow;
+    OMX_U32 nFree = VIDDEC_TELEMETRY_PENDING;
+    OMX_U32 i;
+
+    if (pBufferPrivate->nSubmitTime == 0 || !pOwn->bEnable) {
+        return;
+    }
+    nNow = VIDDEC_MonotonicTime();
+    VIDDEC_Telemetry_Add(pComponentPrivate, VIDDEC_TelemetryDsp, pBuffHead->nTimeStamp,
+                         nNow - pBufferPrivate->nSubmitTime, 0);
+
+    pthread_mutex_lock(&pComponentPrivate->mutexTelemetry);
+    for (i = 0; i < VIDDEC_TELEMETRY_PENDING; i++) {
+        if (pOwn->aFrames[i].nDspDoneTime == 0) {
+            if (nFree == VIDDEC_TELEMETRY_PENDING) {
+                nFree = i;
+            }
+        }
+        else if (pOwn->aFrames[i].nTimeStamp == pBuffHead->nTimeStamp) {
+            break;
+        }
+    }
+    if (i == VIDDEC_TELEMETRY_PENDING) {
+        /* a frame whose output never came goes when all slots are taken */
+        if (nFree == VIDDEC_TELEMETRY_PENDING) {
+            nFree = pOwn->nNextFrame;
+            pOwn->nNextFrame = (pOwn->nNextFrame + 1) % VIDDEC_TELEMETRY_PENDING;
+        }
+        i = nFree;
+        pOwn->aFrames[i].nTimeStamp = pBuffHead->nTimeStamp;
+        pOwn->aFrames[i].nEmptyTime = pBufferPrivate->nEmptyTime;
+    }
+    pOwn->aFrames[i].nDspDoneTime = nNow;
+    pthread_mutex_unlock(&pComponentPrivate->mutexTelemetry);
+
+    pBufferPrivate->nEmptyTime = 0;
+    pBufferPrivate->nSubmitTime = 0;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Telemetry_Output() closes the frame of a decoded output buffer
+  *  on FillBufferDone.
+  **/
+/* ========================================================================== */
+void VIDDEC_Telemetry_Output(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                             OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    VIDDEC_TELEMETRY* pOwn = &pComponentPrivate->sTelemetry;
+    VIDDEC_TELEMETRY_FRAME sFrame;
+    OMX_TICKS nNow;
+    OMX_U32 i;
+
+    if (!pOwn->bEnable || pBuffHead->nFilledLen == 0) {
+        return;
+    }
+    nNow = VIDDEC_MonotonicTime();
+    pthread_mutex_lock(&pComponentPrivate->mutexTelemetry);
+    for (i = 0; i < VIDDEC_TELEMETRY_PENDING; i++) {
+        if (pOwn->aFrames[i].nDspDoneTime != 0 &&
+            pOwn->aFrames[i].nTimeStamp == pBuffHead->nTimeStamp) {
+            break;
+        }
+    }
+    if (i == VIDDEC_TELEMETRY_PENDING) {
+        pthread_mutex_unlock(&pComponentPrivate->mutexTelemetry);
+        return;
+    }
+    sFrame = pOwn->aFrames[i];
+    pOwn->aFrames[i].nDspDoneTime = 0;
+    pthread_mutex_unlock(&pComponentPrivate->mutexTelemetry);
+
+    VIDDEC_Telemetry_Add(pComponentPrivate, VIDDEC_TelemetryOutputWait, sFrame.nTimeStamp,
+                         nNow - sFrame.nDspDoneTime, 0);
+    VIDDEC_Telemetry_Add(pComponentPrivate, VIDDEC_TelemetryTotal, sFrame.nTimeStamp,
+                         nNow - sFrame.nEmptyTime, nNow);
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Telemetry_Flush() forgets the frames waiting for their output,
+  *  on an input flush.
+  **/
+/* ========================================================================== */
+void VIDDEC_Telemetry_Flush(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate)
+{
+    pthread_mutex_lock(&pComponentPrivate->mutexTelemetry);
+    memset(pComponentPrivate->sTelemetry.aFrames, 0, sizeof(pComponentPrivate->sTelemetry.aFrames));
+    pthread_mutex_unlock(&pComponentPrivate->mutexTelemetry);
+}
+
+#ifdef KHRONOS_1_1
+/* ========================================================================== */
+/**
+  *  VIDDEC_SetMBErrorMap() points the error map view of an output buffer at
+  *  the map the DSP left in its UALG output params, nMapMax bytes at most,
+  *  and summarizes it.
+  **/
+/* ========================================================================== */
+static void VIDDEC_SetMBErrorMap(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                 VIDDEC_BUFFER_PRIVATE* pBufferPrivate,
+                                 const OMX_U8* pErrMap, OMX_U32 nMapMax)
+{
+    VIDDEC_MBERRORMAP* pMap = &pBufferPrivate->sMBErrorMap;
+    OMX_U32 nWidth = pComponentPrivate->pOutPortDef->format.video.nFrameWidth;
+    OMX_U32 nHeight = pComponentPrivate->pOutPortDef->format.video.nFrameHeight;
+    OMX_U32 nWidthMBs;
+    OMX_U32 nHeightMBs;
+
+    /* with adaptive playback the port keeps the maximum, the stream is
+       the size of the crop */
+    if (pComponentPrivate->sAdaptivePlayback.bEnable) {
+        nWidth = pComponentPrivate->sOutputCrop.nWidth;
+        nHeight = pComponentPrivate->sOutputCrop.nHeight;
+    }
+    nWidthMBs = (nWidth + 15) >> 4;
+    nHeightMBs = (nHeight + 15) >> 4;
+    if (nWidthMBs == 0 || nWidthMBs > nMapMax) {
+        pMap->pErrMap = NULL;
+        return;
+    }
+    /* the socket node reports up to nMapMax macroblocks */
+    if (nWidthMBs * nHeightMBs > nMapMax) {
+        nHeightMBs = nMapMax / nWidthMBs;
+    }
+    pMap->pErrMap = pErrMap;
+    pMap->nWidthMBs = nWidthMBs;
+    pMap->nHeightMBs = nHeightMBs;
+    OMX_TI_MBErrorSummarize(pErrMap, nWidthMBs, nHeightMBs, &pMap->sSummary);
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_FindMBErrorMap() returns the error map view of pBuffHead, NULL
+  *  unless it is an output buffer of this component that carries a map and
+  *  is not back with the component or the DSP.
+  **/
+/* ========================================================================== */
+const VIDDEC_MBERRORMAP* VIDDEC_FindMBErrorMap(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                               OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    VIDDEC_PORT_TYPE* pCompPort = pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT];
+    OMX_U32 i;
+
+    if (pBuffHead == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < pCompPort->nBufferPrivateCnt; i++) {
+        VIDDEC_BUFFER_PRIVATE* pBufferPrivate = pCompPort->pBufferPrivate[i];
+
+        if (pBufferPrivate != NULL && pBufferPrivate->pBufferHdr == pBuffHead) {
+            if (pBufferPrivate->sMBErrorMap.pErrMap == NULL ||
+                pBufferPrivate->eBufferOwner == VIDDEC_BUFFER_WITH_COMPONENT ||
+                pBufferPrivate->eBufferOwner == VIDDEC_BUFFER_WITH_DSP) {
+                return NULL;
+            }
+            return &pBufferPrivate->sMBErrorMap;
+        }
+    }
+    return NULL;
+}
+#endif
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_IsDisposableFrame() tells whether no other frame is predicted
+  *  from the frame in pBuffHead: an AVC picture with nal_ref_idc 0 or an
+  *  MPEG-4 B-VOP. Anything it cannot tell is kept.
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_IsDisposableFrame(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                         OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    const OMX_U8* pData = pBuffHead->pBuffer + pBuffHead->nOffset;
+    OMX_U32 nSize = pBuffHead->nFilledLen;
+
+    if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
+        OMX_TI_NALITERTYPE sIter;
+        const OMX_U8* pNal = NULL;
+        OMX_U32 nNalSize = 0;
+        OMX_U32 nType = 0;
+
+        OMX_TI_NalIterInit(&sIter, pData, nSize, pComponentPrivate->H264BitStreamFormat,
+                           pComponentPrivate->bIsNALBigEndian);
+        while (OMX_TI_NalIterNext(&sIter, &pNal, &nNalSize, &nType)) {
+            /* all the slices of a picture share nal_ref_idc */
+            if (nType == 1) {
+                return ((pNal[0] & 0x60) == 0) ? OMX_TRUE : OMX_FALSE;
+            }
+            if (nType == 5) {
+                return OMX_FALSE;
+            }
+        }
+    }
+    else if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG4) {
+        OMX_U32 nPos = 0;
+
+        /* vop_coding_type is in the two bits after the VOP start code */
+        while (nPos + 4 < nSize) {
+            nPos += OMX_TI_NalFindStartCode(pData + nPos, nSize - nPos);
+            if (nPos + 4 >= nSize) {
+                break;
+            }
+            if (pData[nPos + 3] == 0xB6) {
+                return ((pData[nPos + 4] >> 6) == 2) ? OMX_TRUE : OMX_FALSE;
+            }
+            nPos += 3;
+        }
+    }
+    return OMX_FALSE;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_SkipLateFrame() decides whether a frame mode input buffer is
+  *  returned without being decoded because it would be shown too late,
+  *  and counts the outcome.
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_SkipLateFrame(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                     OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    VIDDEC_CONFIG_DECODEDEADLINETYPE* pDeadline = &pComponentPrivate->sDecodeDeadline;
+    OMX_TICKS nClock = 0;
+    OMX_BOOL bSkip = OMX_FALSE;
+
+    /* only whole frames that carry nothing else the decoder must see */
+    if (pComponentPrivate->ProcessMode != 0 ||
+        pBuffHead->nFilledLen == 0 ||
+        (pBuffHead->nFlags & (OMX_BUFFERFLAG_EOS | OMX_BUFFERFLAG_CODECCONFIG)) ||
+        pBuffHead->hMarkTargetComponent != NULL ||
+        pComponentPrivate->eFirstBuffer.bSaveFirstBuffer ||
+        pComponentPrivate->bDynamicConfigurationInProgress) {
+        return OMX_FALSE;
+    }
+
+    /* the counters are reset and read under the same lock */
+    pthread_mutex_lock(&pComponentPrivate->mutexDecodeDeadline);
+    nClock = pDeadline->nMediaTime + pDeadline->nLateBy +
+             (VIDDEC_MonotonicTime() - pComponentPrivate->nDeadlineAnchor);
+    if (pBuffHead->nTimeStamp >= nClock + VIDDEC_DECODE_DEADLINE_MARGIN) {
+        pDeadline->nFramesOnTime++;
+    }
+    else if (!VIDDEC_IsDisposableFrame(pComponentPrivate, pBuffHead)) {
+        pDeadline->nFramesLate++;
+    }
+    else {
+        pDeadline->nFramesSkipped++;
+        bSkip = OMX_TRUE;
+    }
+    pthread_mutex_unlock(&pComponentPrivate->mutexDecodeDeadline);
+
+    if (bSkip) {
+        OMX_PRBUFFER1(pComponentPrivate->dbg, "Skipping frame %lld, clock %lld\n",
+                      pBuffHead->nTimeStamp, nClock);
+    }
+    return bSkip;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_IsKeyFrame() tells whether the frame in pData[0..nSize) decodes
+  *  on its own: an AVC IDR picture, an MPEG-4 I-VOP, an H.263 or MPEG-2
+  *  intra picture. WMV frames are all taken as key frames.
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_IsKeyFrame(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                  const OMX_U8* pData, OMX_U32 nSize)
+{
+    OMX_VIDEO_CODINGTYPE eCoding = pComponentPrivate->pInPortDef->format.video.eCompressionFormat;
+    OMX_U32 nPos = 0;
+
+    if (nSize == 0) {
+        return OMX_FALSE;
+    }
+    if (eCoding == OMX_VIDEO_CodingAVC) {
+        OMX_TI_NALITERTYPE sIter;
+        const OMX_U8* pNal = NULL;
+        OMX_U32 nNalSize = 0;
+        OMX_U32 nType = 0;
+
+        OMX_TI_NalIterInit(&sIter, pData, nSize, pComponentPrivate->H264BitStreamFormat,
+                           pComponentPrivate->bIsNALBigEndian);
+        while (OMX_TI_NalIterNext(&sIter, &pNal, &nNalSize, &nType)) {
+            if (nType == 5) {
+                return OMX_TRUE;
+            }
+        }
+        return OMX_FALSE;
+    }
+    if (eCoding == OMX_VIDEO_CodingMPEG4 || eCoding == OMX_VIDEO_CodingMPEG2) {
+        while (nPos + 5 < nSize) {
+            nPos += OMX_TI_NalFindStartCode(pData + nPos, nSize - nPos);
+            if (nPos + 5 >= nSize) {
+                break;
+            }
+            /* vop_coding_type 0 is an I-VOP */
+            if (eCoding == OMX_VIDEO_CodingMPEG4 && pData[nPos + 3] == 0xB6) {
+                return ((pData[nPos + 4] >> 6) == 0) ? OMX_TRUE : OMX_FALSE;
+            }
+            /* temporal_reference(10) then picture_coding_type(3), 1 is I */
+            if (eCoding == OMX_VIDEO_CodingMPEG2 && pData[nPos + 3] == 0x00) {
+                return (((pData[nPos + 5] >> 3) & 0x7) == 1) ? OMX_TRUE : OMX_FALSE;
+            }
+            nPos += 3;
+        }
+        return OMX_FALSE;
+    }
+    if (eCoding == OMX_VIDEO_CodingH263) {
+        OMX_TI_BITREADERTYPE sBits;
+        OMX_U32 nPictureType = 0;
+
+        OMX_TI_BitsInit(&sBits, pData, nSize);
+        if (OMX_TI_BitsRead(&sBits, 22) != 0x20) {
+            return OMX_FALSE;
+        }
+        /* TR and PTYPE bits 1 to 5, then the source format */
+        OMX_TI_BitsSkip(&sBits, 8 + 5);
+        if (OMX_TI_BitsRead(&sBits, 3) != 7) {
+            nPictureType = OMX_TI_BitsRead(&sBits, 1);
+        }
+        else {
+            /* PLUSPTYPE: UFEP, OPPTYPE when UFEP is 1, MPPTYPE picture type */
+            if (OMX_TI_BitsRead(&sBits, 3) == 1) {
+                OMX_TI_BitsSkip(&sBits, 18);
+            }
+            nPictureType = OMX_TI_BitsRead(&sBits, 3);
+        }
+        return (nPictureType == 0 && !OMX_TI_BitsOverrun(&sBits)) ? OMX_TRUE : OMX_FALSE;
+    }
+    return OMX_TRUE;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_IsRandomAccessPoint() tells whether decoding can start at the
+  *  frame in pData[0..nSize): a key frame, or for AVC a picture after a
+  *  recovery point SEI message.
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_IsRandomAccessPoint(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                           const OMX_U8* pData, OMX_U32 nSize)
+{
+    if (nSize != 0 &&
+        pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
+        OMX_TI_NALITERTYPE sIter;
+        const OMX_U8* pNal = NULL;
+        OMX_U32 nNalSize = 0;
+        OMX_U32 nType = 0;
+
+        OMX_TI_NalIterInit(&sIter, pData, nSize, pComponentPrivate->H264BitStreamFormat,
+                           pComponentPrivate->bIsNALBigEndian);
+        while (OMX_TI_NalIterNext(&sIter, &pNal, &nNalSize, &nType)) {
+            if (nType == 5) {
+                return OMX_TRUE;
+            }
+            if (nType == 6 && OMX_TI_AvcSeiHasRecoveryPoint(pNal, nNalSize)) {
+                return OMX_TRUE;
+            }
+        }
+        return OMX_FALSE;
+    }
+    return VIDDEC_IsKeyFrame(pComponentPrivate, pData, nSize);
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Seek_SkipInput() drops the input of a pending seek up to the
+  *  first random access point and clears bSeekPending there. Returns
+  *  OMX_TRUE for a buffer to hand back undecoded.
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_Seek_SkipInput(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                      OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    if (pBuffHead->nFlags & OMX_BUFFERFLAG_CODECCONFIG) {
+        return OMX_FALSE;
+    }
+    /* the saved first buffer goes in front of this one */
+    if (!(pBuffHead->nFlags & OMX_BUFFERFLAG_EOS) &&
+        !VIDDEC_IsRandomAccessPoint(pComponentPrivate, pBuffHead->pBuffer + pBuffHead->nOffset,
+                                    pBuffHead->nFilledLen) &&
+        !(pComponentPrivate->eFirstBuffer.bSaveFirstBuffer &&
+          VIDDEC_IsRandomAccessPoint(pComponentPrivate, pComponentPrivate->eFirstBuffer.pFirstBufferSaved,
+                                     pComponentPrivate->eFirstBuffer.nFilledLen))) {
+        OMX_PRBUFFER1(pComponentPrivate->dbg, "Seek: dropping %p, %lld before a random access point\n",
+                      pBuffHead, pBuffHead->nTimeStamp);
+        return OMX_TRUE;
+    }
+    OMX_PRBUFFER2(pComponentPrivate->dbg, "Seek: resuming at %lld\n", pBuffHead->nTimeStamp);
+    pComponentPrivate->bSeekPending = OMX_FALSE;
+    return OMX_FALSE;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Thumbnail_SkipInput() filters the input of a thumbnail session:
+  *  nothing before the first key frame, the key frame untouched, nothing
+  *  after it; VIDDEC_HandleDataBuf_Input() ends the stream right behind the
+  *  key frame. Returns OMX_TRUE for a buffer to hand back undecoded.
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_Thumbnail_SkipInput(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                           OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    if (pComponentPrivate->ProcessMode != 0 ||
+        (pBuffHead->nFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
+        return OMX_FALSE;
+    }
+    switch (pComponentPrivate->eThumbnailState) {
+        case VIDDEC_Thumbnail_Seeking:
+        case VIDDEC_Thumbnail_EosPending:
+            /* still pending when the key frame went back to the client
+               undecoded, during a port reconfiguration: look again */
+            if (pBuffHead->nFlags & OMX_BUFFERFLAG_EOS) {
+                pComponentPrivate->eThumbnailState = VIDDEC_Thumbnail_Done;
+                return OMX_FALSE;
+            }
+            /* the saved first buffer goes in front of this one */
+            if (!VIDDEC_IsKeyFrame(pComponentPrivate, pBuffHead->pBuffer + pBuffHead->nOffset,
+                                   pBuffHead->nFilledLen) &&
+                !(pComponentPrivate->eFirstBuffer.bSaveFirstBuffer &&
+                  VIDDEC_IsKeyFrame(pComponentPrivate, pComponentPrivate->eFirstBuffer.pFirstBufferSaved,
+                                    pComponentPrivate->eFirstBuffer.nFilledLen))) {
+                OMX_PRBUFFER1(pComponentPrivate->dbg, "Thumbnail: no key frame in %p\n", pBuffHead);
+                return OMX_TRUE;
+            }
+            pComponentPrivate->eThumbnailState = VIDDEC_Thumbnail_EosPending;
+            return OMX_FALSE;
+        default:
+            return OMX_TRUE;
+    }
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Thumbnail_Layout() tells where the picture is in the output
+  *  frames: rows of the port's nStride (the frame width when it is not
+  *  set) and planes of its nSliceHeight. With adaptive playback the port
+  *  keeps the maximum size and the stream is the crop.
+  **/
+/* ========================================================================== */
+static void VIDDEC_Thumbnail_Layout(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                    OMX_TI_FRAMELAYOUTTYPE* pLayout)
+{
+    OMX_VIDEO_PORTDEFINITIONTYPE* pVideo = &pComponentPrivate->pOutPortDef->format.video;
+
+    pLayout->nStride = pVideo->nStride > 0 ? (OMX_U32)pVideo->nStride : pVideo->nFrameWidth;
+    pLayout->nSliceHeight = pVideo->nSliceHeight != 0 ? pVideo->nSliceHeight : pVideo->nFrameHeight;
+    pLayout->nLeft = 0;
+    pLayout->nTop = 0;
+    pLayout->nWidth = pVideo->nFrameWidth;
+    pLayout->nHeight = pVideo->nFrameHeight;
+    if (pComponentPrivate->sAdaptivePlayback.bEnable) {
+        pLayout->nLeft = pComponentPrivate->sOutputCrop.nLeft;
+        pLayout->nTop = pComponentPrivate->sOutputCrop.nTop;
+        pLayout->nWidth = pComponentPrivate->sOutputCrop.nWidth;
+        pLayout->nHeight = pComponentPrivate->sOutputCrop.nHeight;
+    }
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Thumbnail_Scale() shrinks the decoded frame in pBuffHead by
+  *  sThumbnail.nScaleShift in place and sets nFilledLen to the result.
+  **/
+/* ========================================================================== */
+static void VIDDEC_Thumbnail_Scale(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                   OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    OMX_TI_FRAMELAYOUTTYPE sLayout;
+    OMX_U32 nShift = pComponentPrivate->sThumbnail.nScaleShift;
+    OMX_U8* pFrame = pBuffHead->pBuffer + pBuffHead->nOffset;
+    OMX_U32 nDstWidth = 0;
+    OMX_U32 nDstHeight = 0;
+    OMX_U32 nFilledLen = 0;
+
+    VIDDEC_Thumbnail_Layout(pComponentPrivate, &sLayout);
+    if (pComponentPrivate->pOutPortFormat->eColorFormat == VIDDEC_COLORFORMAT420) {
+        nFilledLen = OMX_TI_DownscaleYuv420(pFrame, &sLayout, nShift, &nDstWidth, &nDstHeight);
+    }
+    else {
+        nFilledLen = OMX_TI_DownscaleCbYCrY(pFrame, &sLayout, nShift, &nDstWidth, &nDstHeight);
+    }
+    if (nFilledLen != 0) {
+        pBuffHead->nFilledLen = nFilledLen;
+    }
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Coalesce_CanCarry() tells whether an input buffer can be held or
+  *  copied into the one held by the NAL coalescing: AVC byte stream in
+  *  stream mode with data and no flag, mark or pending state of its own
+  *  the decoder has to see on a buffer by itself.
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_Coalesce_CanCarry(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                         OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat != OMX_VIDEO_CodingAVC ||
+        pComponentPrivate->ProcessMode != 1 ||
+        pComponentPrivate->H264BitStreamFormat != 0 ||
+        pComponentPrivate->pInPortDef->nBufferCountActual < 2 ||
+        pBuffHead->nFilledLen == 0 ||
+        (pBuffHead->nFlags & ~OMX_BUFFERFLAG_ENDOFFRAME) ||
+        pBuffHead->hMarkTargetComponent != NULL ||
+        pComponentPrivate->nInCmdMarkBufIndex != pComponentPrivate->nOutCmdMarkBufIndex ||
+        pComponentPrivate->bFirstHeader == OMX_FALSE ||
+        pComponentPrivate->eFirstBuffer.bSaveFirstBuffer ||
+        pComponentPrivate->bSeekPending ||
+        pComponentPrivate->bDynamicConfigurationInProgress) {
+        return OMX_FALSE;
+    }
+    return OMX_TRUE;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Coalesce_StartsAccessUnit() tells whether the NAL units in
+  *  pBuffHead open a new access unit when they follow a slice (H.264
+  *  7.4.1.2.3): an access unit delimiter, SEI, SPS, PPS or NAL unit type
+  *  14 to 18 first, or a slice with first_mb_in_slice 0. The DSP parses
+  *  the stream itself in stream mode, so a boundary missed here only
+  *  costs a submission, it does not change what is decoded. Sets
+  *  *pbHasSlice when pBuffHead holds a slice.
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_Coalesce_StartsAccessUnit(OMX_BUFFERHEADERTYPE* pBuffHead,
+                                                 OMX_BOOL* pbHasSlice)
+{
+    OMX_TI_NALITERTYPE sIter;
+    const OMX_U8* pNal = NULL;
+    OMX_U32 nNalSize = 0;
+    OMX_U32 nType = 0;
+    OMX_BOOL bStarts = OMX_FALSE;
+
+    *pbHasSlice = OMX_FALSE;
+    OMX_TI_NalIterInit(&sIter, pBuffHead->pBuffer + pBuffHead->nOffset, pBuffHead->nFilledLen,
+                       0, OMX_FALSE);
+    if (!OMX_TI_NalIterNext(&sIter, &pNal, &nNalSize, &nType)) {
+        return OMX_FALSE;
+    }
+    if (nType == 1 || nType == 2 || nType == 5) {
+        OMX_TI_BITREADERTYPE sBits;
+
+        /* ue(v) 0 is a single 1 bit, no emulation prevention byte in front */
+        OMX_TI_BitsInit(&sBits, pNal + 1, nNalSize - 1);
+        bStarts = (OMX_TI_BitsUe(&sBits) == 0 && !OMX_TI_BitsOverrun(&sBits)) ? OMX_TRUE : OMX_FALSE;
+        *pbHasSlice = OMX_TRUE;
+        return bStarts;
+    }
+    bStarts = ((nType >= 6 && nType <= 9) || (nType >= 14 && nType <= 18)) ? OMX_TRUE : OMX_FALSE;
+    while (OMX_TI_NalIterNext(&sIter, &pNal, &nNalSize, &nType)) {
+        if (nType >= 1 && nType <= 5) {
+            *pbHasSlice = OMX_TRUE;
+            break;
+        }
+    }
+    return bStarts;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Coalesce_Append() copies the NAL units of pBuffHead behind the
+  *  data of the buffer held by the NAL coalescing and returns pBuffHead to
+  *  the client. OMX_FALSE, with nothing done, when pBuffHead belongs to
+  *  the next access unit or does not fit.
+  **/
+/* ========================================================================== */
+static OMX_BOOL VIDDEC_Coalesce_Append(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
+                                       OMX_BUFFERHEADERTYPE* pBuffHead,
+                                       OMX_BOOL bStartsAccessUnit,
+                                       OMX_BOOL bHasSlice)
+{
+    OMX_BUFFERHEADERTYPE* pCarrier = pComponentPrivate->pCoalesceBuffer;
+    VIDDEC_BUFFER_PRIVATE* pBufferPrivate = NULL;
+
+    if (pBuffHead->nTimeStamp != pCarrier->nTimeStamp ||
+        (bStartsAccessUnit && pComponentPrivate->bCoalesceHasSlice) ||
+        pBuffHead->nFilledLen > pCarrier->nAllocLen - pCarrier->nOffset - pCarrier->nFilledLen) {
+        return OMX_FALSE;
+    }
+    memcpy(pCarrier->pBuffer + pCarrier->nOffset + pCarrier->nFilledLen,
+           pBuffHead->pBuffer + pBuffHead->nOffset, pBuffHead->nFilledLen);
+    pCarrier->nFilledLen += pBuffHead->nFilledLen;
+    pCarrier->nFlags |= pBuffHead->nFlags;
+    if (bHasSlice) {
+        pComponentPrivate->bCoalesceHasSlice = OMX_TRUE;
+    }
+    pComponentPrivate->sNalCoalescing.nBuffersCoalesced++;
+
+    pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate;
+    pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
+#ifdef __PERF_INSTRUMENTATION__
+    PERF_SendingFrame(pComponentPrivate->pPERFcomp,
+                      pBuffHead->pBuffer,
+                      pBuffHead->nFilledLen,
+                      PERF_ModuleHLMM);
+#endif
+    VIDDEC_EmptyBufferDone(pComponentPrivate, pBuffHead);
+    return OMX_TRUE;
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_Coalesce_Release() hands the buffer held by the NAL coalescing
+  *  back to the client undecoded, on an input flush or the stop to Idle.
+  **/
+/* ========================================================================== */
+void VIDDEC_Coalesce_Release(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate)
+{
+    OMX_BUFFERHEADERTYPE* pBuffHead = pComponentPrivate->pCoalesceBuffer;
+    VIDDEC_BUFFER_PRIVATE* pBufferPrivate = NULL;
+
+    if (pBuffHead == NULL) {
+        return;
+    }
+    pComponentPrivate->pCoalesceBuffer = NULL;
+    pComponentPrivate->bCoalesceHasSlice = OMX_FALSE;
+    pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate;
+    pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
+    pBuffHead->nFilledLen = 0;
+#ifdef __PERF_INSTRUMENTATION__
+    PERF_SendingFrame(pComponentPrivate->pPERFcomp,
+                      pBuffHead->pBuffer,
+                      pBuffHead->nFilledLen,
+                      PERF_ModuleHLMM);
+#endif
+    VIDDEC_EmptyBufferDone(pComponentPrivate, pBuffHead);
+}
+
+/* ========================================================================== */
+/**
+  *  VIDDEC_SendEndOfInput() queues the end of the input to the DSP. With
+  *  the first buffer still saved it goes out with pBuffHead, the client's
+  *  end of stream buffer; otherwise an empty pTempBuffHead carries it and
+  *  pBuffHead, which may be NULL for an end of stream the component makes
+  *  up itself, is not touched.
+  **/
+/* ========================================================================== */
+static OMX_ERRORTYPE VIDDEC_SendEndOfInput(VIDDEC_COMPONENT_PRIVATE *pComponentPrivate,
+                                           OMX_BUFFERHEADERTYPE* pBuffHead)
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    VIDDEC_BUFFER_PRIVATE* pBufferPrivate = NULL;
+    LCML_DSP_INTERFACE* pLcmlHandle = (LCML_DSP_INTERFACE*)pComponentPrivate->pLCML;
+    OMX_U32 size_dsp;
+
+    OMX_PRBUFFER1(pComponentPrivate->dbg, "Sending EOS Empty pBuffHead %p\n", pBuffHead);
+    if(pComponentPrivate->eFirstBuffer.bSaveFirstBuffer == OMX_FALSE){
+        OMX_MEMFREE_STRUCT_DSPALIGN(pComponentPrivate->pUalgParams,OMX_PTR);
+    }
+
+    if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
+        if(pComponentPrivate->pUalgParams == NULL){
+            OMX_U8* pTemp = NULL;
+            OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
+                    H264VDEC_UALGInputParam,
+                    sizeof(H264VDEC_UALGInputParam) + VIDDEC_PADDING_FULL,
+                    pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
+            pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
+            pTemp += VIDDEC_PADDING_HALF;
+            pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
+        }
+        size_dsp = sizeof(H264VDEC_UALGInputParam);
+        ((H264VDEC_UALGInputParam *)pComponentPrivate->pUalgParams)->lBuffCount = -1;
+        OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
+            ((H264VDEC_UALGInputParam *)pComponentPrivate->pUalgParams)->lBuffCount);
+    }
+    else if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingWMV) {
+        if(pComponentPrivate->pUalgParams == NULL){
+            OMX_U8* pTemp = NULL;
+            OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
+                    WMV9DEC_UALGInputParam,
+                    sizeof(WMV9DEC_UALGInputParam) + VIDDEC_PADDING_FULL,
+                    pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
+            pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
+            pTemp += VIDDEC_PADDING_HALF;
+            pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
+        }
+        size_dsp = sizeof(WMV9DEC_UALGInputParam);
+        ((WMV9DEC_UALGInputParam*)pComponentPrivate->pUalgParams)->lBuffCount = -1;
+        OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
+            ((WMV9DEC_UALGInputParam*)pComponentPrivate->pUalgParams)->lBuffCount);
+    }
+    else if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG4 ||
+             pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingH263) {
+        if(pComponentPrivate->pUalgParams == NULL){
+            OMX_U8* pTemp = NULL;
+            OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
+                    MP4VD_GPP_SN_UALGInputParams,
+                    sizeof(MP4VD_GPP_SN_UALGInputParams) + VIDDEC_PADDING_FULL,
+                    pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
+            pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
+            pTemp += VIDDEC_PADDING_HALF;
+            pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
+        }
+        size_dsp = sizeof(MP4VD_GPP_SN_UALGInputParams);
+        ((MP4VD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->nBuffCount = -1;
+        ((MP4VD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->uRingIOBlocksize = 0;
+        /* If EOS is sent, set nPerformMode to 0 (this handle thumbnail case)*/
+        ((MP4VD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->nPerformMode = 0;
+        OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
+            ((MP4VD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->nBuffCount);
+    }
+    else if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG2) {
+        if(pComponentPrivate->pUalgParams == NULL){
+            OMX_U8* pTemp = NULL;
+            OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
+                    MP2VDEC_UALGInputParam,
+                    sizeof(MP2VDEC_UALGInputParam) + VIDDEC_PADDING_FULL,
+                    pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
+            pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
+            pTemp += VIDDEC_PADDING_HALF;
+            pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
+        }
+        size_dsp = sizeof(MP2VDEC_UALGInputParam);
+        ((MP2VDEC_UALGInputParam*)pComponentPrivate->pUalgParams)->lBuffCount = -1;
+        OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
+            ((MP2VDEC_UALGInputParam*)pComponentPrivate->pUalgParams)->lBuffCount);
+    }
+#ifdef VIDDEC_SPARK_CODE
+    else if (VIDDEC_SPARKCHECK) {
+        if(pComponentPrivate->pUalgParams == NULL){
+            OMX_U8* pTemp = NULL;
+            OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
+                    SPARKVD_GPP_SN_UALGInputParams,
+                    sizeof(SPARKVD_GPP_SN_UALGInputParams) + VIDDEC_PADDING_FULL,
+                    pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
+            pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
+            pTemp += VIDDEC_PADDING_HALF;
+            pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
+        }
+        size_dsp = sizeof(SPARKVD_GPP_SN_UALGInputParams);
+        ((SPARKVD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->lBuffCount = -1;
+        ((SPARKVD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->nIsSparkInput = 1;
+        OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
+            ((SPARKVD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->lBuffCount);
+    }
+#endif
+    else {
+        eError = OMX_ErrorUnsupportedSetting;
+        goto EXIT;
+    }
+
+#ifdef __PERF_INSTRUMENTATION__
+    PERF_SendingFrame(pComponentPrivate->pPERFcomp,
+                      NULL, 0,
+                      PERF_ModuleCommonLayer);
+#endif
+    if(pComponentPrivate->eLCMLState != VidDec_LCML_State_Unload &&
+        pComponentPrivate->eLCMLState != VidDec_LCML_State_Destroy &&
+        pComponentPrivate->pLCML != NULL){
+        pComponentPrivate->pTempBuffHead.nFlags = 0;
+        //pComponentPrivate->pTempBuffHead.nFlags |= OMX_BUFFERFLAG_EOS;
+        pComponentPrivate->pTempBuffHead.nFilledLen = 0;
+        pComponentPrivate->pTempBuffHead.pBuffer = NULL;
+        
+#ifdef __PERF_INSTRUMENTATION__
+        PERF_SendingFrame(pComponentPrivate->pPERFcomp,
+                          pBuffHead ? pBuffHead->pBuffer : NULL,
+                          pBuffHead ? pBuffHead->nFilledLen : 0,
+                          PERF_ModuleHLMM);
+#endif
+
+        if(pComponentPrivate->bDynamicConfigurationInProgress){
+            if (pBuffHead != NULL) {
+                pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate;
+                pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
+                OMX_PRBUFFER1(pComponentPrivate->dbg, "eBufferOwner 0x%x\n", pBufferPrivate->eBufferOwner);
+                OMX_PRBUFFER2(pComponentPrivate->dbg, "Sending buffer back to client pBuffer=%p\n", pBuffHead->pBuffer);
+                VIDDEC_EmptyBufferDone(pComponentPrivate, pBuffHead);
+            }
+            goto EXIT;
+        }
 
-#ifdef ANDROID
-                VIDDEC_PTHREAD_MUTEX_WAIT(pComponentPrivate->sDynConfigMutex);
-#endif
-                eError = OMX_ErrorBadParameter;
-                goto EXIT;
+        OMX_PRDSP2(pComponentPrivate->dbg, "LCML_QueueBuffer(INPUT)\n");
+
+        /* Verify if first buffer as been stored. 
+         * Handle case were only one frame is decoded */
+        if(pBuffHead != NULL && pComponentPrivate->eFirstBuffer.bSaveFirstBuffer){
+            pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate;
+            if (pBuffHead->nFlags & OMX_BUFFERFLAG_EOS){
+                pComponentPrivate->firstBufferEos = OMX_TRUE;
             }
-            else {
-                OMX_PRBUFFER2(pComponentPrivate->dbg, "sending OMX_EventPortSettingsChanged SINGLE port\n");
-                pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
-                                                pComponentPrivate->pHandle->pApplicationPrivate,
-                                                OMX_EventPortSettingsChanged,
-                                                bOutPortSettingsChanged ? VIDDEC_OUTPUT_PORT : VIDDEC_INPUT_PORT,
-                                                0,
-                                                NULL);
-                eError = OMX_ErrorBadParameter;
+            eError = VIDDEC_CopyBuffer(pComponentPrivate, pBuffHead);
+            if (eError != OMX_ErrorNone) {
+                OMX_PRDSP4(pComponentPrivate->dbg, "VIDDEC_HandleDataBuf_FromApp: VIDDEC_CopyBuffer()= 0x%x\n", eError);
+                if (eError == OMX_ErrorInsufficientResources) {
+                    goto EXIT;
+                }
+            }
+            pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_DSP;
+            eError = LCML_QueueBuffer(((LCML_DSP_INTERFACE*)
+                                        pLcmlHandle)->pCodecinterfacehandle,
+                                        ((pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingWMV) ? EMMCodecInputBufferMapBufLen : EMMCodecInputBuffer),
+                                        &pBuffHead->pBuffer[pBuffHead->nOffset],/*WMV_VC1_CHANGES*/
+                                        pBuffHead->nAllocLen,
+                                        pBuffHead->nFilledLen,
+                                        (OMX_U8 *)pComponentPrivate->pUalgParams,
+                                        size_dsp,
+                                        (OMX_U8 *)pBuffHead);
+            if (eError != OMX_ErrorNone){
+                OMX_PRDSP4(pComponentPrivate->dbg, "LCML_QueueBuffer EOS (0x%x)\n",eError);
+                eError = OMX_ErrorHardware;
                 goto EXIT;
             }
         }
-        else {
-            eError = OMX_ErrorNone;
+        else{
+            eError = LCML_QueueBuffer(pLcmlHandle->pCodecinterfacehandle,
+                                          ((pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingWMV) ? EMMCodecInputBufferMapBufLen : EMMCodecInputBuffer),
+                                          NULL,
+                                          0,
+                                          0,
+                                          (OMX_U8 *)pComponentPrivate->pUalgParams,
+                                          size_dsp,
+                                          (OMX_PTR)&pComponentPrivate->pTempBuffHead);
+        }
+        if (eError != OMX_ErrorNone){
+            OMX_PRDSP4(pComponentPrivate->dbg, "LCML_QueueBuffer 1 (0x%x)\n",eError);
+            eError = OMX_ErrorHardware;
+            goto EXIT;
         }
+    }
+    else {
+        eError = OMX_ErrorHardware;
+        goto EXIT;
+    }
+
 EXIT:
-    if (pComponentPrivate)
-        OMX_PRINT1(pComponentPrivate->dbg, "OUT\n");
     return eError;
 }
-#endif
 
 /* ========================================================================== */
 /**
-  *  Handle Data Buff function from application
+  *  VIDDEC_HandleDataBuf_Input() sends one input buffer to the DSP, or back
+  *  to the client when it is not to be decoded.
   **/
 /* ========================================================================== */
-
-OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentPrivate)
+static OMX_ERRORTYPE VIDDEC_HandleDataBuf_Input(VIDDEC_COMPONENT_PRIVATE *pComponentPrivate,
+                                                OMX_BUFFERHEADERTYPE* pBuffHead)
 {
     OMX_ERRORTYPE eError = OMX_ErrorNone;
-    OMX_BUFFERHEADERTYPE* pBuffHead = NULL;
     VIDDEC_BUFFER_PRIVATE* pBufferPrivate = NULL;
+    OMX_TICKS nEmptyTime = 0;
+    OMX_TICKS nSubmitTime = 0;
+    OMX_TICKS nTimeStamp = 0;
     OMX_U32 inpBufSize;
     int ret = 0;
     OMX_U32 size_dsp;
@@ -5262,16 +5974,6 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
     OMX_PRBUFFER1(pComponentPrivate->dbg, "pComponentPrivate 0x%p iEndofInputSent 0x%x\n", pComponentPrivate, pComponentPrivate->iEndofInputSent);
     inpBufSize = pComponentPrivate->pInPortDef->nBufferSize;
     pLcmlHandle = (LCML_DSP_INTERFACE*)pComponentPrivate->pLCML;
-    ret = read(pComponentPrivate->filled_inpBuf_Q[0], &(pBuffHead), sizeof(pBuffHead));
-    if (ret == -1) {
-        OMX_PRCOMM4(pComponentPrivate->dbg, "Error while reading from the pipe\n");
-        eError = OMX_ErrorHardware;
-        goto EXIT;
-    }
-    eError = DecrementCount (&(pComponentPrivate->nCountInputBFromApp), &(pComponentPrivate->mutexInputBFromApp));
-    if (eError != OMX_ErrorNone) {
-        return eError;
-    }
     if( pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingWMV &&
             pComponentPrivate->ProcessMode == 0 && 
             pBuffHead->nFilledLen != 0) {
@@ -5542,6 +6244,16 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
         }
     }
 #ifdef VIDDEC_ACTIVATEPARSER
+    /* In adaptive playback every new codec config goes through the header
+       parser again; a resolution that fits is applied in place */
+    if (pComponentPrivate->sAdaptivePlayback.bEnable &&
+            pComponentPrivate->pInPortDef->format.video.eCompressionFormat != OMX_VIDEO_CodingWMV &&
+            pComponentPrivate->bParserEnabled &&
+            pComponentPrivate->bFirstHeader == OMX_TRUE &&
+            (pBuffHead->nFlags & OMX_BUFFERFLAG_CODECCONFIG) &&
+            pBuffHead->nFilledLen != 0) {
+        pComponentPrivate->bFirstHeader = OMX_FALSE;
+    }
     if((((pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) ||
             pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG4 ||
             pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG2 ||
@@ -5611,6 +6323,23 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
     }
 #endif
 
+    if ((pComponentPrivate->bSeekPending &&
+         VIDDEC_Seek_SkipInput(pComponentPrivate, pBuffHead)) ||
+        (pComponentPrivate->sThumbnail.bEnable &&
+         VIDDEC_Thumbnail_SkipInput(pComponentPrivate, pBuffHead)) ||
+        (pComponentPrivate->sDecodeDeadline.bEnable &&
+         VIDDEC_SkipLateFrame(pComponentPrivate, pBuffHead))) {
+        pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate;
+        pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
+#ifdef __PERF_INSTRUMENTATION__
+        PERF_SendingFrame(pComponentPrivate->pPERFcomp,
+                          pBuffHead->pBuffer,
+                          pBuffHead->nFilledLen,
+                          PERF_ModuleHLMM);
+#endif
+        VIDDEC_EmptyBufferDone(pComponentPrivate, pBuffHead);
+        goto EXIT;
+    }
 
     if (pComponentPrivate->nInCmdMarkBufIndex != pComponentPrivate->nOutCmdMarkBufIndex) {
         pComponentPrivate->arrMarkBufIndex[pComponentPrivate->nInMarkBufIndex].hMarkTargetComponent = pComponentPrivate->arrCmdMarkBufIndex[pComponentPrivate->nOutCmdMarkBufIndex].hMarkTargetComponent;
@@ -5644,59 +6373,11 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
                 /*     we need to pack the data buffer as: NAL1 NAL2 NAL3..*/
                 /*     and put the length info to the parameter array*/
                     if (pComponentPrivate->H264BitStreamFormat) {
-                        OMX_U32 nal_len, i;
-                        OMX_U8 *pDataBuf;
-                        OMX_U32 length_pos = 0;
-                        OMX_U32 data_pos = 0;
-                        OMX_U32 buf_len;
-                        H264VDEC_UALGInputParam *pParam;
-
-                        buf_len = pBuffHead->nFilledLen;
-                        pDataBuf = pBuffHead->pBuffer;
-                        pParam = (H264VDEC_UALGInputParam *)pUalgInpParams;
-                        pParam->ulNumOfNALU = 0;
-                        while (pBuffHead->nFilledLen > length_pos+pComponentPrivate->H264BitStreamFormat) {
-                            if (pComponentPrivate->H264BitStreamFormat == 1)
-                                if (pComponentPrivate->bIsNALBigEndian) {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos];
-                                }
-                                else {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos];
-                                }
-                            else if (pComponentPrivate->H264BitStreamFormat == 2)
-                                if (pComponentPrivate->bIsNALBigEndian) {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos] << 8 | pDataBuf[length_pos+1];
-                                }
-                                else {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos] << 0 | pDataBuf[length_pos+1] << 8 ;
-                                }
-                            else if (pComponentPrivate->H264BitStreamFormat == 4){
-                                if (pComponentPrivate->bIsNALBigEndian) {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos]<<24 | pDataBuf[length_pos+1] << 16 | pDataBuf[length_pos+2] << 8 | pDataBuf[length_pos+3];
-                                }
-                                else {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos]<<0 | pDataBuf[length_pos+1] << 8 | pDataBuf[length_pos+2] << 16 | pDataBuf[length_pos+3]<<24;
-                                }
-                            }
-                            else {
-                                eError = OMX_ErrorBadParameter;
-                                goto EXIT;
-                            }
-                            length_pos += pComponentPrivate->H264BitStreamFormat;
-                            if (nal_len > buf_len - length_pos) {
-                                eError = OMX_ErrorBadParameter;
-                                goto EXIT;
-                            }
-                            /* move the memory*/
-                            for (i=0; i<nal_len; i++)
-                                pDataBuf[data_pos+i] = pDataBuf[length_pos+i];
-                            data_pos += nal_len;
-                            length_pos += nal_len;
-                            /* save the size*/
-                            pParam->pNALUSizeArray[pParam->ulNumOfNALU++] = nal_len;
+                        eError = VIDDEC_IndexNALUnits(pComponentPrivate, pBuffHead,
+                                                      (H264VDEC_UALGInputParam *)pUalgInpParams);
+                        if (eError != OMX_ErrorNone) {
+                            goto EXIT;
                         }
-                        /* update with the new data size*/
-                        pBuffHead->nFilledLen = data_pos;
                     }
                 }
                 size_dsp = sizeof(H264VDEC_UALGInputParam);
@@ -5823,9 +6504,9 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
             if (eError != OMX_ErrorNone) {
                 return eError;
             }
-            ret = write(pComponentPrivate->free_inpBuf_Q[1], &pBuffHead, sizeof(pBuffHead));
+            ret = VIDDEC_Ring_PutBuffer(pComponentPrivate, &pComponentPrivate->free_inpBuf_Q, pBuffHead);
             if(ret == -1){
-                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input pipe %x (%d)\n", OMX_ErrorInsufficientResources,ret);
+                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input ring %x (%d)\n", OMX_ErrorInsufficientResources,ret);
                 pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_DSP;
                 DecrementCount (&(pComponentPrivate->nCountInputBFromDsp), &(pComponentPrivate->mutexInputBFromDSP));
                 pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
@@ -5833,187 +6514,13 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
                                                        OMX_EventError,
                                                        OMX_ErrorInsufficientResources,
                                                        OMX_TI_ErrorSevere,
-                                                       "Error writing to the output pipe");
+                                                       "Error writing to the output ring");
             }
         }
 
         if(pComponentPrivate->iEndofInputSent == 0){
-            //pComponentPrivate->iEndofInputSent = 1;
-            OMX_PRBUFFER1(pComponentPrivate->dbg, "Sending EOS Empty eBufferOwner 0x%x\n", pBufferPrivate->eBufferOwner);
-            if(pComponentPrivate->eFirstBuffer.bSaveFirstBuffer == OMX_FALSE){
-                OMX_MEMFREE_STRUCT_DSPALIGN(pComponentPrivate->pUalgParams,OMX_PTR);
-            }
-
-            if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
-                if(pComponentPrivate->pUalgParams == NULL){
-                    OMX_U8* pTemp = NULL;
-                    OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
-                            H264VDEC_UALGInputParam,
-                            sizeof(H264VDEC_UALGInputParam) + VIDDEC_PADDING_FULL,
-                            pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
-                    pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
-                    pTemp += VIDDEC_PADDING_HALF;
-                    pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
-                }
-                size_dsp = sizeof(H264VDEC_UALGInputParam);
-                ((H264VDEC_UALGInputParam *)pComponentPrivate->pUalgParams)->lBuffCount = -1;
-                OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
-                    ((H264VDEC_UALGInputParam *)pComponentPrivate->pUalgParams)->lBuffCount);
-            }
-            else if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingWMV) {
-                if(pComponentPrivate->pUalgParams == NULL){
-                    OMX_U8* pTemp = NULL;
-                    OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
-                            WMV9DEC_UALGInputParam,
-                            sizeof(WMV9DEC_UALGInputParam) + VIDDEC_PADDING_FULL,
-                            pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
-                    pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
-                    pTemp += VIDDEC_PADDING_HALF;
-                    pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
-                }
-                size_dsp = sizeof(WMV9DEC_UALGInputParam);
-                ((WMV9DEC_UALGInputParam*)pComponentPrivate->pUalgParams)->lBuffCount = -1;
-                OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
-                    ((WMV9DEC_UALGInputParam*)pComponentPrivate->pUalgParams)->lBuffCount);
-            }
-            else if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG4 ||
-                     pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingH263) {
-                if(pComponentPrivate->pUalgParams == NULL){
-                    OMX_U8* pTemp = NULL;
-                    OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
-                            MP4VD_GPP_SN_UALGInputParams,
-                            sizeof(MP4VD_GPP_SN_UALGInputParams) + VIDDEC_PADDING_FULL,
-                            pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
-                    pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
-                    pTemp += VIDDEC_PADDING_HALF;
-                    pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
-                }
-                size_dsp = sizeof(MP4VD_GPP_SN_UALGInputParams);
-                ((MP4VD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->nBuffCount = -1;
-                ((MP4VD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->uRingIOBlocksize = 0;
-                /* If EOS is sent, set nPerformMode to 0 (this handle thumbnail case)*/
-                ((MP4VD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->nPerformMode = 0;
-                OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
-                    ((MP4VD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->nBuffCount);
-            }
-            else if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG2) {
-                if(pComponentPrivate->pUalgParams == NULL){
-                    OMX_U8* pTemp = NULL;
-                    OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
-                            MP2VDEC_UALGInputParam,
-                            sizeof(MP2VDEC_UALGInputParam) + VIDDEC_PADDING_FULL,
-                            pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
-                    pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
-                    pTemp += VIDDEC_PADDING_HALF;
-                    pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
-                }
-                size_dsp = sizeof(MP2VDEC_UALGInputParam);
-                ((MP2VDEC_UALGInputParam*)pComponentPrivate->pUalgParams)->lBuffCount = -1;
-                OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
-                    ((MP2VDEC_UALGInputParam*)pComponentPrivate->pUalgParams)->lBuffCount);
-            }
-#ifdef VIDDEC_SPARK_CODE
-            else if (VIDDEC_SPARKCHECK) {
-                if(pComponentPrivate->pUalgParams == NULL){
-                    OMX_U8* pTemp = NULL;
-                    OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->pUalgParams,
-                            SPARKVD_GPP_SN_UALGInputParams,
-                            sizeof(SPARKVD_GPP_SN_UALGInputParams) + VIDDEC_PADDING_FULL,
-                            pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
-                    pTemp = (OMX_U8*)(pComponentPrivate->pUalgParams);
-                    pTemp += VIDDEC_PADDING_HALF;
-                    pComponentPrivate->pUalgParams = (OMX_PTR*)pTemp;
-                }
-                size_dsp = sizeof(SPARKVD_GPP_SN_UALGInputParams);
-                ((SPARKVD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->lBuffCount = -1;
-                ((SPARKVD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->nIsSparkInput = 1;
-                OMX_PRBUFFER1(pComponentPrivate->dbg, "lBuffCount 0x%lx\n",
-                    ((SPARKVD_GPP_SN_UALGInputParams*)pComponentPrivate->pUalgParams)->lBuffCount);
-            }
-#endif
-            else {
-                eError = OMX_ErrorUnsupportedSetting;
-                goto EXIT;
-            }
-
-#ifdef __PERF_INSTRUMENTATION__
-            PERF_SendingFrame(pComponentPrivate->pPERFcomp,
-                              NULL, 0,
-                              PERF_ModuleCommonLayer);
-#endif
-            if(pComponentPrivate->eLCMLState != VidDec_LCML_State_Unload &&
-                pComponentPrivate->eLCMLState != VidDec_LCML_State_Destroy &&
-                pComponentPrivate->pLCML != NULL){
-                pComponentPrivate->pTempBuffHead.nFlags = 0;
-                //pComponentPrivate->pTempBuffHead.nFlags |= OMX_BUFFERFLAG_EOS;
-                pComponentPrivate->pTempBuffHead.nFilledLen = 0;
-                pComponentPrivate->pTempBuffHead.pBuffer = NULL;
-                
-#ifdef __PERF_INSTRUMENTATION__
-                PERF_SendingFrame(pComponentPrivate->pPERFcomp,
-                                  pBuffHead->pBuffer,
-                                  pBuffHead->nFilledLen,
-                                  PERF_ModuleHLMM);
-#endif
-
-                if(pComponentPrivate->bDynamicConfigurationInProgress){
-                    pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate;
-                    pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
-                    OMX_PRBUFFER1(pComponentPrivate->dbg, "eBufferOwner 0x%x\n", pBufferPrivate->eBufferOwner);
-                    OMX_PRBUFFER2(pComponentPrivate->dbg, "Sending buffer back to client pBuffer=%p\n", pBuffHead->pBuffer);
-                    VIDDEC_EmptyBufferDone(pComponentPrivate, pBuffHead);
-                    goto EXIT;
-                }
-
-                OMX_PRDSP2(pComponentPrivate->dbg, "LCML_QueueBuffer(INPUT)\n");
-
-                /* Verify if first buffer as been stored. 
-                 * Handle case were only one frame is decoded */
-                if(pComponentPrivate->eFirstBuffer.bSaveFirstBuffer){
-                    if (pBuffHead->nFlags & OMX_BUFFERFLAG_EOS){
-                        pComponentPrivate->firstBufferEos = OMX_TRUE;
-                    }
-                    eError = VIDDEC_CopyBuffer(pComponentPrivate, pBuffHead);
-                    if (eError != OMX_ErrorNone) {
-                        OMX_PRDSP4(pComponentPrivate->dbg, "VIDDEC_HandleDataBuf_FromApp: VIDDEC_CopyBuffer()= 0x%x\n", eError);
-                        if (eError == OMX_ErrorInsufficientResources) {
-                            goto EXIT;
-                        }
-                    }
-                    pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_DSP;
-                    eError = LCML_QueueBuffer(((LCML_DSP_INTERFACE*)
-                                                pLcmlHandle)->pCodecinterfacehandle,
-                                                ((pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingWMV) ? EMMCodecInputBufferMapBufLen : EMMCodecInputBuffer),
-                                                &pBuffHead->pBuffer[pBuffHead->nOffset],/*WMV_VC1_CHANGES*/
-                                                pBuffHead->nAllocLen,
-                                                pBuffHead->nFilledLen,
-                                                (OMX_U8 *)pComponentPrivate->pUalgParams,
-                                                size_dsp,
-                                                (OMX_U8 *)pBuffHead);
-                    if (eError != OMX_ErrorNone){
-                        OMX_PRDSP4(pComponentPrivate->dbg, "LCML_QueueBuffer EOS (0x%x)\n",eError);
-                        eError = OMX_ErrorHardware;
-                        goto EXIT;
-                    }
-                }
-                else{
-                    eError = LCML_QueueBuffer(pLcmlHandle->pCodecinterfacehandle,
-                                                  ((pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingWMV) ? EMMCodecInputBufferMapBufLen : EMMCodecInputBuffer),
-                                                  NULL,
-                                                  0,
-                                                  0,
-                                                  (OMX_U8 *)pComponentPrivate->pUalgParams,
-                                                  size_dsp,
-                                                  (OMX_PTR)&pComponentPrivate->pTempBuffHead);
-                }
-                if (eError != OMX_ErrorNone){
-                    OMX_PRDSP4(pComponentPrivate->dbg, "LCML_QueueBuffer 1 (0x%x)\n",eError);
-                    eError = OMX_ErrorHardware;
-                    goto EXIT;
-                }
-            }
-            else {
-                eError = OMX_ErrorHardware;
+            eError = VIDDEC_SendEndOfInput(pComponentPrivate, pBuffHead);
+            if (eError != OMX_ErrorNone) {
                 goto EXIT;
             }
         }
@@ -6026,61 +6533,15 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
                 if ((pBuffHead->nFlags & OMX_BUFFERFLAG_EOS) == 0) {
                     ((H264VDEC_UALGInputParam *)pUalgInpParams)->lBuffCount = ++pComponentPrivate->frameCounter;
                     if (pComponentPrivate->H264BitStreamFormat) {
-                        H264VDEC_UALGInputParam *pParam;
 #ifndef ANDROID
-                        OMX_U32 nal_len, i;
-                        OMX_U8 *pDataBuf;
-                        OMX_U32 length_pos = 0;
-                        OMX_U32 data_pos = 0;
-                        OMX_U32 buf_len;
-
-                        buf_len = pBuffHead->nFilledLen;
-                        pDataBuf = pBuffHead->pBuffer;
-                        pParam = (H264VDEC_UALGInputParam *)pUalgInpParams;
-                        pParam->ulNumOfNALU = 0;
-                        while (pBuffHead->nFilledLen > length_pos+pComponentPrivate->H264BitStreamFormat) {
-                            if (pComponentPrivate->H264BitStreamFormat == 1)
-                                if (pComponentPrivate->bIsNALBigEndian) {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos];
-                                }
-                                else {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos];
-                                }
-                            else if (pComponentPrivate->H264BitStreamFormat == 2)
-                                if (pComponentPrivate->bIsNALBigEndian) {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos] << 8 | pDataBuf[length_pos+1];
-                                }
-                                else {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos] << 0 | pDataBuf[length_pos+1] << 8 ;
-                                }
-                            else if (pComponentPrivate->H264BitStreamFormat == 4){
-                                if (pComponentPrivate->bIsNALBigEndian) {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos]<<24 | pDataBuf[length_pos+1] << 16 | pDataBuf[length_pos+2] << 8 | pDataBuf[length_pos+3];
-                                }
-                                else {
-                                    nal_len = (OMX_U32)pDataBuf[length_pos]<<0 | pDataBuf[length_pos+1] << 8 | pDataBuf[length_pos+2] << 16 | pDataBuf[length_pos+3]<<24;
-                                }
-                            }
-                            else {
-                                eError = OMX_ErrorBadParameter;
-                                goto EXIT;
-                            }
-                            length_pos += pComponentPrivate->H264BitStreamFormat;
-                            if (nal_len > buf_len - length_pos) {
-                                eError = OMX_ErrorBadParameter;
-                                goto EXIT;
-                            }
-                            /* move the memory*/
-                            for (i=0; i<nal_len; i++)
-                                pDataBuf[data_pos+i] = pDataBuf[length_pos+i];
-                            data_pos += nal_len;
-                            length_pos += nal_len;
-                            /* save the size*/
-                            pParam->pNALUSizeArray[pParam->ulNumOfNALU++] = nal_len;
+                        eError = VIDDEC_IndexNALUnits(pComponentPrivate, pBuffHead,
+                                                      (H264VDEC_UALGInputParam *)pUalgInpParams);
+                        if (eError != OMX_ErrorNone) {
+                            goto EXIT;
                         }
-                        /* update with the new data size*/
-                        pBuffHead->nFilledLen = data_pos;
 #else
+                        H264VDEC_UALGInputParam *pParam;
+
                         pParam = (H264VDEC_UALGInputParam *)pUalgInpParams;
                         pParam->ulNumOfNALU = 0;
 
@@ -6374,6 +6835,12 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
 #endif
 
                 OMX_PRDSP2(pComponentPrivate->dbg, "LCML_QueueBuffer(INPUT), nFilledLen=0x%x nFlags=0x%x", pBuffHead->nFilledLen, pBuffHead->nFlags);
+                nEmptyTime = pBufferPrivate->nEmptyTime;
+                nTimeStamp = pBuffHead->nTimeStamp;
+                if (nEmptyTime != 0) {
+                    pBufferPrivate->nSubmitTime = VIDDEC_MonotonicTime();
+                    nSubmitTime = pBufferPrivate->nSubmitTime;
+                }
                 pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_DSP;
                 eError = LCML_QueueBuffer(((LCML_DSP_INTERFACE*)
                                             pLcmlHandle)->pCodecinterfacehandle,
@@ -6389,6 +6856,18 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
                     eError = OMX_ErrorHardware;
                     goto EXIT;
                 }
+                if (nEmptyTime != 0) {
+                    VIDDEC_Telemetry_Submitted(pComponentPrivate, nTimeStamp, nEmptyTime, nSubmitTime);
+                }
+                /* a thumbnail needs nothing past its key frame, the end of
+                   stream follows it without waiting for more client input */
+                if (pComponentPrivate->eThumbnailState == VIDDEC_Thumbnail_EosPending) {
+                    pComponentPrivate->eThumbnailState = VIDDEC_Thumbnail_Done;
+                    eError = VIDDEC_SendEndOfInput(pComponentPrivate, NULL);
+                    if (eError != OMX_ErrorNone) {
+                        goto EXIT;
+                    }
+                }
             }
             else {
                 eError = OMX_ErrorHardware;
@@ -6403,9 +6882,9 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
             if (eError != OMX_ErrorNone) {
                 return eError;
             }
-            ret = write(pComponentPrivate->free_inpBuf_Q[1], &pBuffHead, sizeof(pBuffHead));
+            ret = VIDDEC_Ring_PutBuffer(pComponentPrivate, &pComponentPrivate->free_inpBuf_Q, pBuffHead);
             if(ret == -1){
-                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input pipe %x (%d)\n", OMX_ErrorInsufficientResources,ret);
+                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input ring %x (%d)\n", OMX_ErrorInsufficientResources,ret);
                 pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_DSP;
                 DecrementCount (&(pComponentPrivate->nCountInputBFromDsp), &(pComponentPrivate->mutexInputBFromDSP));
                 pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
@@ -6413,7 +6892,7 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentP
                                                        OMX_EventError,
                                                        OMX_ErrorInsufficientResources,
                                                        OMX_TI_ErrorSevere,
-                                                       "Error writing to the output pipe");
+                                                       "Error writing to the output ring");
             }
         }
     }
@@ -6422,6 +6901,68 @@ EXIT:
     return eError;
 }
 
+/* ========================================================================== */
+/**
+  *  Handle Data Buff function from application
+  **/
+/* ========================================================================== */
+
+OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromApp(VIDDEC_COMPONENT_PRIVATE *pComponentPrivate)
+{
+    OMX_ERRORTYPE eError = OMX_ErrorNone;
+    OMX_BUFFERHEADERTYPE* pBuffHead = NULL;
+    OMX_BUFFERHEADERTYPE* pCarrier = NULL;
+    OMX_BOOL bCanCarry = OMX_FALSE;
+    OMX_BOOL bStartsAccessUnit = OMX_FALSE;
+    OMX_BOOL bHasSlice = OMX_FALSE;
+    int ret = 0;
+
+    ret = VIDDEC_Ring_GetBuffer(&pComponentPrivate->filled_inpBuf_Q, &pBuffHead);
+    if (ret == -1) {
+        OMX_PRCOMM4(pComponentPrivate->dbg, "Error while reading from the ring\n");
+        return OMX_ErrorHardware;
+    }
+    eError = DecrementCount (&(pComponentPrivate->nCountInputBFromApp), &(pComponentPrivate->mutexInputBFromApp));
+    if (eError != OMX_ErrorNone) {
+        return eError;
+    }
+    if (!pComponentPrivate->sNalCoalescing.bEnable) {
+        return VIDDEC_HandleDataBuf_Input(pComponentPrivate, pBuffHead);
+    }
+
+    bCanCarry = VIDDEC_Coalesce_CanCarry(pComponentPrivate, pBuffHead);
+    if (bCanCarry) {
+        bStartsAccessUnit = VIDDEC_Coalesce_StartsAccessUnit(pBuffHead, &bHasSlice);
+    }
+    pCarrier = pComponentPrivate->pCoalesceBuffer;
+    if (pCarrier != NULL) {
+        if (bCanCarry &&
+            VIDDEC_Coalesce_Append(pComponentPrivate, pBuffHead, bStartsAccessUnit, bHasSlice)) {
+            if (!(pCarrier->nFlags & OMX_BUFFERFLAG_ENDOFFRAME)) {
+                return OMX_ErrorNone;
+            }
+            /* the access unit is complete */
+            bCanCarry = OMX_FALSE;
+            pBuffHead = NULL;
+        }
+        OMX_PRBUFFER1(pComponentPrivate->dbg, "Coalesced access unit %p, nFilledLen %lu\n",
+                      pCarrier, pCarrier->nFilledLen);
+        pComponentPrivate->pCoalesceBuffer = NULL;
+        pComponentPrivate->bCoalesceHasSlice = OMX_FALSE;
+        eError = VIDDEC_HandleDataBuf_Input(pComponentPrivate, pCarrier);
+        if (eError != OMX_ErrorNone || pBuffHead == NULL) {
+            return eError;
+        }
+    }
+    if (bCanCarry && !(pBuffHead->nFlags & OMX_BUFFERFLAG_ENDOFFRAME)) {
+        ((VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate)->eBufferOwner = VIDDEC_BUFFER_WITH_COMPONENT;
+        pComponentPrivate->pCoalesceBuffer = pBuffHead;
+        pComponentPrivate->bCoalesceHasSlice = bHasSlice;
+        return OMX_ErrorNone;
+    }
+    return VIDDEC_HandleDataBuf_Input(pComponentPrivate, pBuffHead);
+}
+
 /* ========================================================================== */
 /**
   *  Handle Data Buff function from DSP
@@ -6438,9 +6979,9 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromDsp(VIDDEC_COMPONENT_PRIVATE *pComponentP
 
     OMX_PRBUFFER1(pComponentPrivate->dbg, "+++ENTERING\n");
     OMX_PRBUFFER1(pComponentPrivate->dbg, "pComponentPrivate 0x%p\n", (int*)pComponentPrivate);
-    ret = read(pComponentPrivate->filled_outBuf_Q[0], &pBuffHead, sizeof(pBuffHead));
+    ret = VIDDEC_Ring_GetBuffer(&pComponentPrivate->filled_outBuf_Q, &pBuffHead);
     if (ret == -1) {
-        OMX_PRDSP4(pComponentPrivate->dbg, "Error while reading from dsp out pipe\n");
+        OMX_PRDSP4(pComponentPrivate->dbg, "Error while reading from dsp out ring\n");
         eError = OMX_ErrorHardware;
         goto EXIT;
     }
@@ -6618,41 +7159,31 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromDsp(VIDDEC_COMPONENT_PRIVATE *pComponentP
             }
         }
 #ifdef KHRONOS_1_1
-        if (pComponentPrivate->eMBErrorReport.bEnabled) {/* && pBuffHead->nFilledLen != 0*/
-            OMX_U8* ErrMapFrom = NULL;
-            OMX_U8* ErrMapTo = NULL;
-            /*OMX_U32 nlooping = 0;*/
-            OMX_U32 nErrMapSize = 0;
+        /* the map stays in the buffer's UALG output params, clients read
+           it from there through VIDDEC_FindMBErrorMap */
+        pBufferPrivate->sMBErrorMap.pErrMap = NULL;
+        if (pComponentPrivate->eMBErrorReport.bEnabled) {
             if (pComponentPrivate->MPEG4Codec_IsTI &&
                 (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG4 ||
                  pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingH263)) {
-                MP4VD_GPP_SN_UALGOutputParams* pUalgOutParams = NULL;
-                pUalgOutParams = (MP4VD_GPP_SN_UALGOutputParams *)pBufferPrivate->pUalgParam;
-                ErrMapFrom = pUalgOutParams->usMbErrorBuf;
-                /*todo add code to use ualg_array*/
-                nErrMapSize = pComponentPrivate->pOutPortDef->format.video.nFrameWidth *
-                              pComponentPrivate->pOutPortDef->format.video.nFrameHeight / 256;
-                ErrMapTo = pComponentPrivate->eMBErrorMapType[pComponentPrivate->cMBErrorIndexIn].ErrMap;
-                pComponentPrivate->eMBErrorMapType[pComponentPrivate->cMBErrorIndexIn].nErrMapSize = nErrMapSize;
-                memcpy(ErrMapTo, ErrMapFrom, nErrMapSize);
-                pComponentPrivate->cMBErrorIndexIn++;
-                pComponentPrivate->cMBErrorIndexIn %= pComponentPrivate->pOutPortDef->nBufferCountActual;
+                MP4VD_GPP_SN_UALGOutputParams* pUalgOutParams = (MP4VD_GPP_SN_UALGOutputParams *)pBufferPrivate->pUalgParam;
+                VIDDEC_SetMBErrorMap(pComponentPrivate, pBufferPrivate,
+                                     pUalgOutParams->usMbErrorBuf, sizeof(pUalgOutParams->usMbErrorBuf));
             }
-            if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
-                H264VDEC_UALGOutputParam* pUalgOutParams = NULL;
-                pUalgOutParams = (H264VDEC_UALGOutputParam *)pBufferPrivate->pUalgParam;
-                ErrMapFrom = pUalgOutParams->pMBErrStatOutBuf;
-                /*todo add code to use ualg_array*/
-                nErrMapSize = pComponentPrivate->pOutPortDef->format.video.nFrameWidth *
-                              pComponentPrivate->pOutPortDef->format.video.nFrameHeight / 256;
-                ErrMapTo = pComponentPrivate->eMBErrorMapType[pComponentPrivate->cMBErrorIndexIn].ErrMap;
-                pComponentPrivate->eMBErrorMapType[pComponentPrivate->cMBErrorIndexIn].nErrMapSize = nErrMapSize;
-                memcpy(ErrMapTo, ErrMapFrom, nErrMapSize);
-                pComponentPrivate->cMBErrorIndexIn++;
-                pComponentPrivate->cMBErrorIndexIn %= pComponentPrivate->pOutPortDef->nBufferCountActual;
+            else if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
+                H264VDEC_UALGOutputParam* pUalgOutParams = (H264VDEC_UALGOutputParam *)pBufferPrivate->pUalgParam;
+                VIDDEC_SetMBErrorMap(pComponentPrivate, pBufferPrivate,
+                                     pUalgOutParams->pMBErrStatOutBuf, sizeof(pUalgOutParams->pMBErrStatOutBuf));
+            }
+            if (pBufferPrivate->sMBErrorMap.pErrMap != NULL) {
+                pComponentPrivate->pMBErrorMapLast = pBuffHead;
             }
         }
 #endif
+        if (pComponentPrivate->sThumbnail.bEnable && pComponentPrivate->sThumbnail.nScaleShift != 0 &&
+            pBuffHead->nFilledLen != 0) {
+            VIDDEC_Thumbnail_Scale(pComponentPrivate, pBuffHead);
+        }
         if (pComponentPrivate->pCompPort[1]->hTunnelComponent != NULL) {
             if(pComponentPrivate->bFirstBuffer) {
                 OMX_PRBUFFER2(pComponentPrivate->dbg, "**** Setting OMX_BUFFERFLAG_STARTTIME\n");
@@ -6677,9 +7208,9 @@ OMX_ERRORTYPE VIDDEC_HandleDataBuf_FromDsp(VIDDEC_COMPONENT_PRIVATE *pComponentP
                     eError = OMX_EmptyThisBuffer(pComponentPrivate->pCompPort[1]->hTunnelComponent, pBuffHead);
                 }
                 else {
-                    ret = write(pComponentPrivate->free_outBuf_Q[1],&pBuffHead,sizeof(pBuffHead));
+                    ret = VIDDEC_Ring_PutBuffer(pComponentPrivate, &pComponentPrivate->free_outBuf_Q, pBuffHead);
                     if (ret == -1) {
-                        OMX_PRDSP4(pComponentPrivate->dbg, "Error while writing to out pipe to client\n");
+                        OMX_PRDSP4(pComponentPrivate->dbg, "Error while writing to out ring to client\n");
                         eError = OMX_ErrorHardware;
                         return eError;
                     }
@@ -6736,7 +7267,7 @@ OMX_ERRORTYPE VIDDEC_HandleFreeDataBuf( VIDDEC_COMPONENT_PRIVATE *pComponentPriv
 
     OMX_PRBUFFER1(pComponentPrivate->dbg, "+++ENTERING\n");
     OMX_PRBUFFER1(pComponentPrivate->dbg, "pComponentPrivate 0x%p\n", (int*)pComponentPrivate);
-    ret = read(pComponentPrivate->free_inpBuf_Q[0], &pBuffHead, sizeof(pBuffHead));
+    ret = VIDDEC_Ring_GetBuffer(&pComponentPrivate->free_inpBuf_Q, &pBuffHead);
     if (ret == -1) {
         OMX_PRCOMM4(pComponentPrivate->dbg, "Error while reading from the free Q\n");
         eError = OMX_ErrorHardware;
@@ -8018,17 +8549,17 @@ OMX_ERRORTYPE VIDDEC_LCML_Callback (TUsnCodecEvent event,void * argsCb [10])
                                                PERF_ModuleCommonLayer);
 #endif
 
-                            nRetVal = write(pComponentPrivate->filled_outBuf_Q[1],&pBuffHead,sizeof(pBuffHead));
+                            nRetVal = VIDDEC_Ring_PutBuffer(pComponentPrivate, &pComponentPrivate->filled_outBuf_Q, pBuffHead);
                             if(nRetVal == -1){
                                 DecrementCount (&(pComponentPrivate->nCountOutputBFromDsp), &(pComponentPrivate->mutexOutputBFromDSP));
                                 pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_DSP;
-                                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input pipe %x (%ld)\n", OMX_ErrorInsufficientResources,nRetVal);
+                                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input ring %x (%ld)\n", OMX_ErrorInsufficientResources,nRetVal);
                                 pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
                                                                        pComponentPrivate->pHandle->pApplicationPrivate,
                                                                        OMX_EventError,
                                                                        OMX_ErrorInsufficientResources,
                                                                        OMX_TI_ErrorSevere,
-                                                                       "Error writing to the output pipe");
+                                                                       "Error writing to the output ring");
                             }
                         }
                     }
@@ -8066,6 +8597,7 @@ OMX_ERRORTYPE VIDDEC_LCML_Callback (TUsnCodecEvent event,void * argsCb [10])
                             pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate;
                             pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_COMPONENT;
                             OMX_PRBUFFER1(pComponentPrivate->dbg, "eBufferOwner 0x%x\n", pBufferPrivate->eBufferOwner);
+                            VIDDEC_Telemetry_InputDone(pComponentPrivate, pBuffHead);
     #ifdef __PERF_INSTRUMENTATION__
                             PERF_ReceivedFrame(pComponentPrivate->pPERFcomp,
                                                PREF(pBuffHead,pBuffer),
@@ -8085,9 +8617,9 @@ OMX_ERRORTYPE VIDDEC_LCML_Callback (TUsnCodecEvent event,void * argsCb [10])
                                 pBuffHead->nOffset = VIDDEC_WMV_BUFFER_OFFSET;
 #endif
                             }
-                            nRetVal = write(pComponentPrivate->free_inpBuf_Q[1], &pBuffHead, sizeof(pBuffHead));
+                            nRetVal = VIDDEC_Ring_PutBuffer(pComponentPrivate, &pComponentPrivate->free_inpBuf_Q, pBuffHead);
                             if(nRetVal == -1){
-                                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input pipe %x (%lu)\n", OMX_ErrorInsufficientResources,nRetVal);
+                                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input ring %x (%lu)\n", OMX_ErrorInsufficientResources,nRetVal);
                                 DecrementCount (&(pComponentPrivate->nCountInputBFromDsp), &(pComponentPrivate->mutexInputBFromDSP));
                                 pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_DSP;
                                 pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
@@ -8095,7 +8627,7 @@ OMX_ERRORTYPE VIDDEC_LCML_Callback (TUsnCodecEvent event,void * argsCb [10])
                                                                        OMX_EventError,
                                                                        OMX_ErrorInsufficientResources,
                                                                        OMX_TI_ErrorSevere,
-                                                                       "Error writing to the output pipe");
+                                                                       "Error writing to the output ring");
                             }
                         }
                     }
@@ -8180,17 +8712,17 @@ OMX_ERRORTYPE VIDDEC_LCML_Callback (TUsnCodecEvent event,void * argsCb [10])
                                                PERF_ModuleCommonLayer);
 #endif
 
-                            nRetVal = write(pComponentPrivate->filled_outBuf_Q[1],&pBuffHead,sizeof(pBuffHead));
+                            nRetVal = VIDDEC_Ring_PutBuffer(pComponentPrivate, &pComponentPrivate->filled_outBuf_Q, pBuffHead);
                             if(nRetVal == -1){
                                 DecrementCount (&(pComponentPrivate->nCountOutputBFromDsp), &(pComponentPrivate->mutexOutputBFromDSP));
                                 pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_DSP;
-                                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input pipe %x (%lu)\n", OMX_ErrorInsufficientResources,nRetVal);
+                                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input ring %x (%lu)\n", OMX_ErrorInsufficientResources,nRetVal);
                                 pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
                                                                        pComponentPrivate->pHandle->pApplicationPrivate,
                                                                        OMX_EventError,
                                                                        OMX_ErrorInsufficientResources,
                                                                        OMX_TI_ErrorSevere,
-                                                                       "Error writing to the output pipe");
+                                                                       "Error writing to the output ring");
                             }
                         }
                     }
@@ -8246,9 +8778,9 @@ OMX_ERRORTYPE VIDDEC_LCML_Callback (TUsnCodecEvent event,void * argsCb [10])
                                 pBuffHead->nOffset = VIDDEC_WMV_BUFFER_OFFSET;
 #endif
                             }
-                            nRetVal = write(pComponentPrivate->free_inpBuf_Q[1], &pBuffHead, sizeof(pBuffHead));
+                            nRetVal = VIDDEC_Ring_PutBuffer(pComponentPrivate, &pComponentPrivate->free_inpBuf_Q, pBuffHead);
                             if(nRetVal == -1){
-                                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input pipe %x (%lu)\n", OMX_ErrorInsufficientResources,nRetVal);
+                                OMX_PRCOMM4(pComponentPrivate->dbg, "writing to the input ring %x (%lu)\n", OMX_ErrorInsufficientResources,nRetVal);
                                 DecrementCount (&(pComponentPrivate->nCountInputBFromDsp), &(pComponentPrivate->mutexInputBFromDSP));
                                 pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_DSP;
                                 pComponentPrivate->cbInfo.EventHandler(pComponentPrivate->pHandle,
@@ -8256,7 +8788,7 @@ OMX_ERRORTYPE VIDDEC_LCML_Callback (TUsnCodecEvent event,void * argsCb [10])
                                                                        OMX_EventError,
                                                                        OMX_ErrorInsufficientResources,
                                                                        OMX_TI_ErrorSevere,
-                                                                       "Error writing to the output pipe");
+                                                                       "Error writing to the output ring");
                             }
                         }
                     }
@@ -8380,6 +8912,10 @@ OMX_ERRORTYPE VIDDEC_SaveBuffer(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
 {
     OMX_ERRORTYPE eError = OMX_ErrorNone;
     OMX_PRINT1(pComponentPrivate->dbg, "IN\n");
+    if (pComponentPrivate->eFirstBuffer.pFirstBufferSaved != NULL) {
+        free(pComponentPrivate->eFirstBuffer.pFirstBufferSaved);
+        pComponentPrivate->eFirstBuffer.pFirstBufferSaved = NULL;
+    }
     pComponentPrivate->eFirstBuffer.bSaveFirstBuffer = OMX_TRUE;
 
     OMX_MALLOC_STRUCT_SIZED(pComponentPrivate->eFirstBuffer.pFirstBufferSaved, OMX_U8, pBuffHead->nFilledLen, NULL);
@@ -8396,8 +8932,14 @@ EXIT:
 
 /* ========================================================================== */
 /**
-  *  VIDDEC_CopyBuffer() function will insert an the begining of pBuffer the buffer stored using VIDDEC_SaveBuffer() 
-  *     and update nFilledLen of the buffer header
+  *  VIDDEC_CopyBuffer() function will insert at the begining of pBuffer the buffer stored using VIDDEC_SaveBuffer()
+  *     and update nFilledLen of the buffer header.
+  *     Buffers allocated by the component (except WMV) take it in the headroom in front of pBuffer: pBuffer
+  *     (and nAllocLen) are moved back over the saved data until VIDDEC_EmptyBufferDone, and the frame is not
+  *     copied. Only saved data of a multiple of VIDDEC_ALIGNMENT bytes is placed there, so that pBuffer stays
+  *     aligned, and not on a proprietary tunnel port, whose buffers must keep the address they are mapped at.
+  *     Other buffers get the frame moved up within nAllocLen. If neither fits, the frame is sent as is and
+  *     the saved data is kept for the next buffer.
   *
   * @param 
   *     pComponentPrivate            Component private structure
@@ -8405,50 +8947,44 @@ EXIT:
   *
   * @retval OMX_ErrorNone              Success, ready to roll
   *         OMX_ErrorUndefined       No buffer to be copy.
-  *         OMX_ErrorInsufficientResources   Not enough memory to save buffer
  **/
 /* ========================================================================== */
 
 OMX_ERRORTYPE VIDDEC_CopyBuffer(VIDDEC_COMPONENT_PRIVATE* pComponentPrivate,
                                      OMX_BUFFERHEADERTYPE* pBuffHead)
 {
-    OMX_PRINT1(pComponentPrivate->dbg, "IN\n");
     OMX_ERRORTYPE eError = OMX_ErrorNone;
+    VIDDEC_BUFFER_PRIVATE* pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate;
+    OMX_U32 nSavedLen = (OMX_U32)pComponentPrivate->eFirstBuffer.nFilledLen;
+
+    OMX_PRINT1(pComponentPrivate->dbg, "IN\n");
     if (pComponentPrivate->eFirstBuffer.bSaveFirstBuffer == OMX_FALSE) {
         eError = OMX_ErrorUndefined;
         goto EXIT;
     }
     OMX_PRINT1(pComponentPrivate->dbg, "pBuffer=%p\n", pBuffHead->pBuffer);
-    OMX_PTR pTemp = NULL;
-    pComponentPrivate->eFirstBuffer.bSaveFirstBuffer = OMX_FALSE;
 
-    /* only if NAL-bitstream format in frame mode */
-    if (
-        ((pComponentPrivate->ProcessMode == 0 && pComponentPrivate->H264BitStreamFormat > 0)
-     || (pBuffHead->nFilledLen > pComponentPrivate->eFirstBuffer.nFilledLen))
-     && (pBuffHead->nAllocLen >= pComponentPrivate->eFirstBuffer.nFilledLen + pBuffHead->nFilledLen)
-       ) {
-        OMX_MALLOC_STRUCT_SIZED(pTemp, OMX_U8, pBuffHead->nFilledLen, NULL);
-        memcpy(pTemp, pBuffHead->pBuffer, pBuffHead->nFilledLen); /*copy somewere actual buffer*/
-        memcpy(pBuffHead->pBuffer, pComponentPrivate->eFirstBuffer.pFirstBufferSaved, pComponentPrivate->eFirstBuffer.nFilledLen); /*copy first buffer to the beganing of pBuffer.*/
-        memcpy((OMX_U8 *)pBuffHead->pBuffer+pComponentPrivate->eFirstBuffer.nFilledLen, pTemp, pBuffHead->nFilledLen); /* copy back actual buffer after first buffer*/
-        pBuffHead->nFilledLen += pComponentPrivate->eFirstBuffer.nFilledLen; /*Add first buffer size*/
-
-        free(pTemp);
-        free(pComponentPrivate->eFirstBuffer.pFirstBufferSaved);
-        pComponentPrivate->eFirstBuffer.pFirstBufferSaved = NULL;
+    /* WMV buffers keep the VC-1 pointer/offset handling, which resets pBuffer itself */
+    if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat != OMX_VIDEO_CodingWMV &&
+        !pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->bProprietaryTunnel &&
+        (nSavedLen & (VIDDEC_ALIGNMENT - 1)) == 0 &&
+        pBufferPrivate->nHeadroom - pBufferPrivate->nPrepended >= nSavedLen) {
+        pBuffHead->pBuffer -= nSavedLen;
+        pBuffHead->nAllocLen += nSavedLen;
+        pBufferPrivate->nPrepended += nSavedLen;
+        memcpy(pBuffHead->pBuffer, pComponentPrivate->eFirstBuffer.pFirstBufferSaved, nSavedLen);
+        pBuffHead->nFilledLen += nSavedLen;
+    }
+    else if (!OMX_TI_NalPrependConfig(pBuffHead->pBuffer, &pBuffHead->nFilledLen, pBuffHead->nAllocLen,
+                                      pComponentPrivate->eFirstBuffer.pFirstBufferSaved, nSavedLen)) {
+        OMX_ERROR4(pComponentPrivate->dbg, "No room for %lu bytes of config data in buffer %p, kept for the next one\n",
+                   nSavedLen, pBuffHead);
+        goto EXIT;
     }
-        /*The first buffer has more information than the second, so the first buffer will be send to codec*/
-        /*We are loosing the second fame. TODO: Fix this*/
-        else if (pBuffHead->nAllocLen >= pComponentPrivate->eFirstBuffer.nFilledLen){
-            /*copy first buffer data to the actual buffer*/
-            memcpy(pBuffHead->pBuffer, pComponentPrivate->eFirstBuffer.pFirstBufferSaved, pComponentPrivate->eFirstBuffer.nFilledLen); /*copy first buffer*/
-            pBuffHead->nFilledLen = pComponentPrivate->eFirstBuffer.nFilledLen; /*Update buffer size*/
-            free(pComponentPrivate->eFirstBuffer.pFirstBufferSaved);
-            pComponentPrivate->eFirstBuffer.pFirstBufferSaved = NULL;
-        } else {
-            ALOGE("Not enough memory in the buffer to concatenate the 2 frames, loosing first frame\n");
-        }
+
+    pComponentPrivate->eFirstBuffer.bSaveFirstBuffer = OMX_FALSE;
+    free(pComponentPrivate->eFirstBuffer.pFirstBufferSaved);
+    pComponentPrivate->eFirstBuffer.pFirstBufferSaved = NULL;
 EXIT:
     OMX_PRINT1(pComponentPrivate->dbg, "OUT\n");
     return eError;
@@ -75,6 +75,7 @@
 #include "OMX_VideoDec_DSP.h"
 #include "OMX_VideoDec_Thread.h"
 #include "OMX_VidDec_CustomCmd.h"
+#include "OMX_TI_NalScan.h"
 
 /* For PPM fps measurements */
 static int mDebugFps = 0;
@@ -111,6 +112,14 @@ VIDDEC_CUSTOM_PARAM sVideoDecCustomParams[] =                                {{V
                                                                              {VIDDEC_CUSTOMPARAM_WMVFILETYPE, VideoDecodeCustomParamWMVFileType},
                                                                              {VIDDEC_CUSTOMPARAM_PARSERENABLED, VideoDecodeCustomParamParserEnabled},
                                                                              {VIDDEC_CUSTOMCONFIG_DEBUG, VideoDecodeCustomConfigDebug},
+                                                                             {VIDDEC_CUSTOMPARAM_REORDERDEPTH, VideoDecodeCustomParamReorderDepth},
+                                                                             {VIDDEC_CUSTOMPARAM_ADAPTIVEPLAYBACK, VideoDecodeCustomParamAdaptivePlayback},
+                                                                             {VIDDEC_CUSTOMCONFIG_DECODEDEADLINE, VideoDecodeCustomConfigDecodeDeadline},
+                                                                             {VIDDEC_CUSTOMPARAM_THUMBNAIL, VideoDecodeCustomParamThumbnail},
+                                                                             {VIDDEC_CUSTOMCONFIG_SEEKPENDING, VideoDecodeCustomConfigSeekPending},
+                                                                             {VIDDEC_CUSTOMCONFIG_MBERRORMAP, VideoDecodeCustomConfigMBErrorMap},
+                                                                             {VIDDEC_CUSTOMPARAM_NALCOALESCING, VideoDecodeCustomParamNalCoalescing},
+                                                                             {VIDDEC_CUSTOMCONFIG_DECODETELEMETRY, VideoDecodeCustomConfigDecodeTelemetry},
 #ifdef VIDDEC_SPARK_CODE
                                                                              {VIDDEC_CUSTOMPARAM_ISNALBIGENDIAN, VideoDecodeCustomParamIsNALBigEndian},
                                                                              {VIDDEC_CUSTOMPARAM_ISSPARKINPUT, VideoDecodeCustomParamIsSparkInput}};
@@ -340,6 +349,14 @@ OMX_ERRORTYPE OMX_ComponentInit (OMX_HANDLETYPE hComponent)
         eError = OMX_ErrorUndefined;
         return eError;
     }
+    if (pthread_mutex_init(&(pComponentPrivate->mutexDecodeDeadline), NULL) != 0) {
+        eError = OMX_ErrorUndefined;
+        return eError;
+    }
+    if (pthread_mutex_init(&(pComponentPrivate->mutexTelemetry), NULL) != 0) {
+        eError = OMX_ErrorUndefined;
+        return eError;
+    }
     VIDDEC_PTHREAD_MUTEX_INIT(pComponentPrivate->outputFlushCompletionMutex);
     pComponentPrivate->bIsOutputFlushPending = OMX_FALSE;
     VIDDEC_PTHREAD_MUTEX_INIT(pComponentPrivate->inputFlushCompletionMutex);
@@ -642,14 +659,7 @@ static OMX_ERRORTYPE VIDDEC_SendCommand (OMX_HANDLETYPE hComponent,
             }
             pComponentPrivate->eIdleToLoad = nParam1;
             pComponentPrivate->eExecuteToIdle = nParam1;
-            nRet = write(pComponentPrivate->cmdPipe[VIDDEC_PIPE_WRITE], &Cmd, sizeof(Cmd));
-            if (nRet == -1) {
-                if(RemoveStateTransition(pComponentPrivate, OMX_FALSE) != OMX_ErrorNone) {
-                   return OMX_ErrorUndefined;
-                }
-                return OMX_ErrorUndefined;
-            }
-            nRet = write(pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_WRITE], &nParam1, sizeof(nParam1));
+            nRet = VIDDEC_Ring_PutCommand(pComponentPrivate, Cmd, nParam1, NULL);
             if (nRet == -1) {
                 if(RemoveStateTransition(pComponentPrivate, OMX_FALSE) != OMX_ErrorNone) {
                    return OMX_ErrorUndefined;
@@ -679,12 +689,7 @@ static OMX_ERRORTYPE VIDDEC_SendCommand (OMX_HANDLETYPE hComponent,
                 eError = OMX_ErrorBadParameter;
                 goto EXIT;
             }
-            nRet = write(pComponentPrivate->cmdPipe[VIDDEC_PIPE_WRITE], &Cmd, sizeof(Cmd));
-            if (nRet == -1) {
-                eError = OMX_ErrorUndefined;
-                goto EXIT;
-            }
-            nRet = write(pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_WRITE], &nParam1, sizeof(nParam1));
+            nRet = VIDDEC_Ring_PutCommand(pComponentPrivate, Cmd, nParam1, NULL);
             if (nRet == -1) {
                 eError = OMX_ErrorUndefined;
                 goto EXIT;
@@ -714,12 +719,7 @@ static OMX_ERRORTYPE VIDDEC_SendCommand (OMX_HANDLETYPE hComponent,
                 pComponentPrivate->pOutPortDef->bEnabled = OMX_TRUE;
                 OMX_PRBUFFER2(pComponentPrivate->dbg, "Enabling VIDDEC_INPUT_PORT 0x%x\n",pComponentPrivate->pInPortDef->bEnabled);
             }
-            nRet = write(pComponentPrivate->cmdPipe[VIDDEC_PIPE_WRITE], &Cmd, sizeof(Cmd));
-            if (nRet == -1) {
-                eError = OMX_ErrorUndefined;
-                goto EXIT;
-            }
-            nRet = write(pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_WRITE], &nParam1, sizeof(nParam1));
+            nRet = VIDDEC_Ring_PutCommand(pComponentPrivate, Cmd, nParam1, NULL);
             if (nRet == -1) {
                 eError = OMX_ErrorUndefined;
                 goto EXIT;
@@ -730,12 +730,7 @@ static OMX_ERRORTYPE VIDDEC_SendCommand (OMX_HANDLETYPE hComponent,
                 eError = OMX_ErrorBadPortIndex;
                 goto EXIT;
             }
-            nRet = write(pComponentPrivate->cmdPipe[VIDDEC_PIPE_WRITE], &Cmd, sizeof(Cmd));
-            if (nRet == -1) {
-                eError = OMX_ErrorUndefined;
-                goto EXIT;
-            }
-            nRet = write(pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_WRITE], &nParam1, sizeof(nParam1));
+            nRet = VIDDEC_Ring_PutCommand(pComponentPrivate, Cmd, nParam1, NULL);
             if (nRet == -1) {
                 eError = OMX_ErrorUndefined;
                 goto EXIT;
@@ -746,17 +741,7 @@ static OMX_ERRORTYPE VIDDEC_SendCommand (OMX_HANDLETYPE hComponent,
                 eError = OMX_ErrorBadPortIndex;
                 goto EXIT;
             }
-            nRet = write(pComponentPrivate->cmdPipe[VIDDEC_PIPE_WRITE], &Cmd, sizeof(Cmd));
-            if (nRet == -1) {
-                eError = OMX_ErrorUndefined;
-                goto EXIT;
-            }
-            nRet = write(pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_WRITE], &nParam1, sizeof(nParam1));
-            if (nRet == -1) {
-                eError = OMX_ErrorUndefined;
-                goto EXIT;
-            }
-            nRet = write(pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_WRITE], &pCmdData, sizeof(pCmdData));
+            nRet = VIDDEC_Ring_PutCommand(pComponentPrivate, Cmd, nParam1, pCmdData);
             if (nRet == -1) {
                 eError = OMX_ErrorUndefined;
                 goto EXIT;
@@ -1112,6 +1097,46 @@ static OMX_ERRORTYPE VIDDEC_GetParameter (OMX_IN OMX_HANDLETYPE hComponent,
         case VideoDecodeCustomParamIsNALBigEndian:
             *((OMX_BOOL *)ComponentParameterStructure) = pComponentPrivate->bIsNALBigEndian;
 
+            break;
+        case VideoDecodeCustomParamReorderDepth:
+            *((OMX_U32 *)ComponentParameterStructure) = pComponentPrivate->nReorderDepth;
+            break;
+        case VideoDecodeCustomParamAdaptivePlayback:
+            if (((VIDDEC_PARAM_ADAPTIVEPLAYBACKTYPE *)ComponentParameterStructure)->nPortIndex != VIDDEC_OUTPUT_PORT) {
+                eError = OMX_ErrorBadPortIndex;
+                break;
+            }
+            memcpy(ComponentParameterStructure, &pComponentPrivate->sAdaptivePlayback, sizeof(VIDDEC_PARAM_ADAPTIVEPLAYBACKTYPE));
+            break;
+        case VideoDecodeCustomParamThumbnail:
+        {
+            VIDDEC_PARAM_THUMBNAILTYPE* pThumbnail = (VIDDEC_PARAM_THUMBNAILTYPE*)ComponentParameterStructure;
+            OMX_U32 nShift = pComponentPrivate->sThumbnail.nScaleShift;
+
+            if (pThumbnail->nPortIndex != VIDDEC_OUTPUT_PORT) {
+                eError = OMX_ErrorBadPortIndex;
+                break;
+            }
+            memcpy(pThumbnail, &pComponentPrivate->sThumbnail, sizeof(VIDDEC_PARAM_THUMBNAILTYPE));
+            pThumbnail->nOutputWidth = pComponentPrivate->pOutPortDef->format.video.nFrameWidth;
+            pThumbnail->nOutputHeight = pComponentPrivate->pOutPortDef->format.video.nFrameHeight;
+            /* the port keeps the maximum size, the stream is the crop */
+            if (pComponentPrivate->sAdaptivePlayback.bEnable) {
+                pThumbnail->nOutputWidth = pComponentPrivate->sOutputCrop.nWidth;
+                pThumbnail->nOutputHeight = pComponentPrivate->sOutputCrop.nHeight;
+            }
+            if (nShift != 0) {
+                pThumbnail->nOutputWidth = (pThumbnail->nOutputWidth >> nShift) & ~1;
+                pThumbnail->nOutputHeight = (pThumbnail->nOutputHeight >> nShift) & ~1;
+            }
+            break;
+        }
+        case VideoDecodeCustomParamNalCoalescing:
+            if (((VIDDEC_PARAM_NALCOALESCINGTYPE *)ComponentParameterStructure)->nPortIndex != VIDDEC_INPUT_PORT) {
+                eError = OMX_ErrorBadPortIndex;
+                break;
+            }
+            memcpy(ComponentParameterStructure, &pComponentPrivate->sNalCoalescing, sizeof(VIDDEC_PARAM_NALCOALESCINGTYPE));
             break;
 #ifdef VIDDEC_SPARK_CODE
         case VideoDecodeCustomParamIsSparkInput:
@@ -1336,6 +1361,10 @@ static OMX_ERRORTYPE VIDDEC_SetParameter (OMX_HANDLETYPE hComp,
                 if (pComponentParam->nPortIndex == pComponentPrivate->pInPortDef->nPortIndex) {
                     OMX_PARAM_PORTDEFINITIONTYPE *pPortDefParam = (OMX_PARAM_PORTDEFINITIONTYPE *)pComponentParam;
                     OMX_PARAM_PORTDEFINITIONTYPE *pPortDef = pComponentPrivate->pInPortDef;
+                    eError = VIDDEC_Port_ReserveBuffers(pComponentPrivate, VIDDEC_INPUT_PORT, pPortDefParam->nBufferCountActual);
+                    if (eError != OMX_ErrorNone) {
+                        break;
+                    }
                     memcpy(pPortDef, pPortDefParam, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
                     if ( pPortDef->nBufferSize == 0 )
                     {
@@ -1348,6 +1377,10 @@ static OMX_ERRORTYPE VIDDEC_SetParameter (OMX_HANDLETYPE hComp,
                 else if (pComponentParam->nPortIndex == pComponentPrivate->pOutPortDef->nPortIndex) {
                     OMX_PARAM_PORTDEFINITIONTYPE *pPortDefParam = (OMX_PARAM_PORTDEFINITIONTYPE *)pComponentParam;
                     OMX_PARAM_PORTDEFINITIONTYPE *pPortDef = pComponentPrivate->pOutPortDef;
+                    eError = VIDDEC_Port_ReserveBuffers(pComponentPrivate, VIDDEC_OUTPUT_PORT, pPortDefParam->nBufferCountActual);
+                    if (eError != OMX_ErrorNone) {
+                        break;
+                    }
                     memcpy(pPortDef, pPortDefParam, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
                     pPortDef->nBufferSize = pPortDef->format.video.nFrameWidth *
                                             pPortDef->format.video.nFrameHeight *
@@ -1512,6 +1545,112 @@ static OMX_ERRORTYPE VIDDEC_SetParameter (OMX_HANDLETYPE hComp,
         case VideoDecodeCustomParamIsNALBigEndian:
             pComponentPrivate->bIsNALBigEndian = (OMX_BOOL)(*((OMX_BOOL *)pCompParam));
             break;
+        case VideoDecodeCustomParamReorderDepth:
+            pComponentPrivate->nReorderDepth = (OMX_U32)(*((OMX_U32 *)pCompParam));
+            break;
+        case VideoDecodeCustomParamAdaptivePlayback:
+        {
+            VIDDEC_PARAM_ADAPTIVEPLAYBACKTYPE* pAdaptive = (VIDDEC_PARAM_ADAPTIVEPLAYBACKTYPE*)pCompParam;
+            OMX_PARAM_PORTDEFINITIONTYPE* pOutPortDef = pComponentPrivate->pOutPortDef;
+            OMX_U32 nMaxWidth = 0;
+            OMX_U32 nMaxHeight = 0;
+
+            if (pAdaptive->nPortIndex != VIDDEC_OUTPUT_PORT) {
+                eError = OMX_ErrorBadPortIndex;
+                break;
+            }
+            pComponentPrivate->sAdaptivePlayback.bEnable = pAdaptive->bEnable;
+            if (!pAdaptive->bEnable) {
+                break;
+            }
+            /* same bounds the header parser accepts */
+            if (pAdaptive->nMaxFrameWidth < 16 || pAdaptive->nMaxFrameWidth >= 1500 ||
+                pAdaptive->nMaxFrameHeight < 16 || pAdaptive->nMaxFrameHeight >= 1500) {
+                pComponentPrivate->sAdaptivePlayback.bEnable = OMX_FALSE;
+                eError = OMX_ErrorBadParameter;
+                break;
+            }
+            nMaxWidth = (pAdaptive->nMaxFrameWidth + 15) & ~15;
+            nMaxHeight = (pAdaptive->nMaxFrameHeight + 15) & ~15;
+            pComponentPrivate->sAdaptivePlayback.nMaxFrameWidth = nMaxWidth;
+            pComponentPrivate->sAdaptivePlayback.nMaxFrameHeight = nMaxHeight;
+            /* the node is created and the output buffers sized for the
+               maximum, later streams only move the stride and the crop */
+            pComponentPrivate->pInPortDef->format.video.nFrameWidth = nMaxWidth;
+            pComponentPrivate->pInPortDef->format.video.nFrameHeight = nMaxHeight;
+            pOutPortDef->format.video.nFrameWidth = nMaxWidth;
+            pOutPortDef->format.video.nFrameHeight = nMaxHeight;
+            pOutPortDef->format.video.nStride = nMaxWidth;
+            pOutPortDef->format.video.nSliceHeight = nMaxHeight;
+            pOutPortDef->nBufferSize = nMaxWidth * nMaxHeight *
+                ((pComponentPrivate->pOutPortFormat->eColorFormat == VIDDEC_COLORFORMAT420) ? VIDDEC_FACTORFORMAT420 : VIDDEC_FACTORFORMAT422);
+            pComponentPrivate->sOutputCrop.nLeft = 0;
+            pComponentPrivate->sOutputCrop.nTop = 0;
+            pComponentPrivate->sOutputCrop.nWidth = nMaxWidth;
+            pComponentPrivate->sOutputCrop.nHeight = nMaxHeight;
+            /* the count too is fixed here, for the DPB the configured level
+               allows at the maximum size, so that no later stream asks for
+               more buffers. Without a level the spec's upper bound is used */
+            if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
+                OMX_U32 nLevelIdc = VIDDEC_AVC_LevelIdc(pComponentPrivate->pH264->eLevel);
+                OMX_U32 nCount = OMX_TI_AvcMaxDpbFrames(nLevelIdc, nMaxWidth / 16, nMaxHeight / 16);
+
+                if (nCount == 0) {
+                    /* unknown level, or a maximum size the level does not allow */
+                    nCount = nLevelIdc ? 1 : OMX_TI_AVC_MAX_DPB_FRAMES;
+                }
+                nCount += VIDDEC_AVC_DISPLAY_BUFFERS;
+
+                if (nCount > pComponentPrivate->nMaxBufferCount) {
+                    nCount = pComponentPrivate->nMaxBufferCount;
+                }
+                if (pOutPortDef->nBufferCountActual < nCount) {
+                    eError = VIDDEC_Port_ReserveBuffers(pComponentPrivate, VIDDEC_OUTPUT_PORT, nCount);
+                    if (eError != OMX_ErrorNone) {
+                        break;
+                    }
+                    pOutPortDef->nBufferCountActual = nCount;
+                }
+                pOutPortDef->nBufferCountMin = nCount;
+            }
+            break;
+        }
+        case VideoDecodeCustomParamThumbnail:
+        {
+            VIDDEC_PARAM_THUMBNAILTYPE* pThumbnail = (VIDDEC_PARAM_THUMBNAILTYPE*)pCompParam;
+
+            if (pThumbnail->nPortIndex != VIDDEC_OUTPUT_PORT) {
+                eError = OMX_ErrorBadPortIndex;
+                break;
+            }
+            if (pThumbnail->nScaleShift > VIDDEC_THUMBNAIL_MAX_SCALE_SHIFT) {
+                eError = OMX_ErrorBadParameter;
+                break;
+            }
+            if (pThumbnail->bEnable && !pComponentPrivate->sThumbnail.bEnable) {
+                /* one frame comes out, one buffer is enough */
+                pComponentPrivate->nThumbnailSavedCountMin = pComponentPrivate->pOutPortDef->nBufferCountMin;
+                pComponentPrivate->nThumbnailSavedCountActual = pComponentPrivate->pOutPortDef->nBufferCountActual;
+                pComponentPrivate->pOutPortDef->nBufferCountMin = VIDDEC_BUFFERMINCOUNT;
+                pComponentPrivate->pOutPortDef->nBufferCountActual = VIDDEC_BUFFERMINCOUNT;
+            }
+            else if (!pThumbnail->bEnable && pComponentPrivate->sThumbnail.bEnable) {
+                pComponentPrivate->pOutPortDef->nBufferCountMin = pComponentPrivate->nThumbnailSavedCountMin;
+                pComponentPrivate->pOutPortDef->nBufferCountActual = pComponentPrivate->nThumbnailSavedCountActual;
+            }
+            pComponentPrivate->sThumbnail.bEnable = pThumbnail->bEnable;
+            pComponentPrivate->sThumbnail.nScaleShift = pThumbnail->nScaleShift;
+            pComponentPrivate->eThumbnailState = VIDDEC_Thumbnail_Seeking;
+            break;
+        }
+        case VideoDecodeCustomParamNalCoalescing:
+            if (((VIDDEC_PARAM_NALCOALESCINGTYPE *)pCompParam)->nPortIndex != VIDDEC_INPUT_PORT) {
+                eError = OMX_ErrorBadPortIndex;
+                break;
+            }
+            pComponentPrivate->sNalCoalescing.bEnable = ((VIDDEC_PARAM_NALCOALESCINGTYPE *)pCompParam)->bEnable;
+            pComponentPrivate->sNalCoalescing.nBuffersCoalesced = 0;
+            break;
 #ifdef VIDDEC_SPARK_CODE
         case VideoDecodeCustomParamIsSparkInput:
             pComponentPrivate->bIsSparkInput = (OMX_BOOL)(*((OMX_BOOL *)pCompParam));
@@ -1719,6 +1858,85 @@ static OMX_ERRORTYPE VIDDEC_GetConfig (OMX_HANDLETYPE hComp,
             case VideoDecodeCustomConfigDebug:/**< reference: struct OMX_TI_Debug */
                 OMX_DBG_GETCONFIG(pComponentPrivate->dbg, ComponentConfigStructure);
                 break;
+            case VideoDecodeCustomConfigDecodeDeadline:/**< reference: VIDDEC_CONFIG_DECODEDEADLINETYPE */
+                if (((VIDDEC_CONFIG_DECODEDEADLINETYPE*)ComponentConfigStructure)->nPortIndex != VIDDEC_INPUT_PORT) {
+                    eError = OMX_ErrorBadPortIndex;
+                    break;
+                }
+                VIDDEC_GetDecodeDeadline(pComponentPrivate, (VIDDEC_CONFIG_DECODEDEADLINETYPE*)ComponentConfigStructure);
+                break;
+            case VideoDecodeCustomConfigDecodeTelemetry:/**< reference: VIDDEC_CONFIG_DECODETELEMETRYTYPE */
+                if (((VIDDEC_CONFIG_DECODETELEMETRYTYPE*)ComponentConfigStructure)->nPortIndex != VIDDEC_INPUT_PORT) {
+                    eError = OMX_ErrorBadPortIndex;
+                    break;
+                }
+                VIDDEC_GetDecodeTelemetry(pComponentPrivate, (VIDDEC_CONFIG_DECODETELEMETRYTYPE*)ComponentConfigStructure);
+                break;
+            case VideoDecodeCustomConfigSeekPending:/**< reference: OMX_CONFIG_BOOLEANTYPE */
+                ((OMX_CONFIG_BOOLEANTYPE*)ComponentConfigStructure)->bEnabled = pComponentPrivate->bSeekPending;
+                break;
+#ifdef KHRONOS_1_1
+            case VideoDecodeCustomConfigMBErrorMap:/**< reference: VIDDEC_CONFIG_MBERRORMAPTYPE */
+            {
+                VIDDEC_CONFIG_MBERRORMAPTYPE* pMapTo = (VIDDEC_CONFIG_MBERRORMAPTYPE*)ComponentConfigStructure;
+                const VIDDEC_MBERRORMAP* pMap = NULL;
+
+                if (pMapTo->nPortIndex != VIDDEC_OUTPUT_PORT) {
+                    eError = OMX_ErrorBadPortIndex;
+                    break;
+                }
+                if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat != OMX_VIDEO_CodingMPEG4 &&
+                    pComponentPrivate->pInPortDef->format.video.eCompressionFormat != OMX_VIDEO_CodingH263 &&
+                    pComponentPrivate->pInPortDef->format.video.eCompressionFormat != OMX_VIDEO_CodingAVC) {
+                    eError = OMX_ErrorUnsupportedIndex;
+                    break;
+                }
+                pMap = VIDDEC_FindMBErrorMap(pComponentPrivate, pMapTo->pBufferHeader);
+                if (pMap == NULL) {
+                    pMapTo->pErrMap = NULL;
+                    pMapTo->nErrMapSize = 0;
+                    pMapTo->nWidthMBs = 0;
+                    pMapTo->nHeightMBs = 0;
+                    pMapTo->nErroredMBs = 0;
+                    pMapTo->nLeft = 0;
+                    pMapTo->nTop = 0;
+                    pMapTo->nWidth = 0;
+                    pMapTo->nHeight = 0;
+                    break;
+                }
+                pMapTo->pErrMap = pMap->pErrMap;
+                pMapTo->nErrMapSize = pMap->nWidthMBs * pMap->nHeightMBs;
+                pMapTo->nWidthMBs = pMap->nWidthMBs;
+                pMapTo->nHeightMBs = pMap->nHeightMBs;
+                pMapTo->nErroredMBs = pMap->sSummary.nErroredMBs;
+                pMapTo->nLeft = pMap->sSummary.nLeft;
+                pMapTo->nTop = pMap->sSummary.nTop;
+                pMapTo->nWidth = pMap->sSummary.nRight - pMap->sSummary.nLeft;
+                pMapTo->nHeight = pMap->sSummary.nBottom - pMap->sSummary.nTop;
+                break;
+            }
+#endif
+            case OMX_IndexConfigCommonOutputCrop:     /**< reference: OMX_CONFIG_RECTTYPE */
+            {
+                OMX_CONFIG_RECTTYPE* pCrop = (OMX_CONFIG_RECTTYPE*)ComponentConfigStructure;
+                if (pCrop->nPortIndex != VIDDEC_OUTPUT_PORT) {
+                    eError = OMX_ErrorBadPortIndex;
+                    break;
+                }
+                if (pComponentPrivate->sAdaptivePlayback.bEnable) {
+                    pCrop->nLeft = pComponentPrivate->sOutputCrop.nLeft;
+                    pCrop->nTop = pComponentPrivate->sOutputCrop.nTop;
+                    pCrop->nWidth = pComponentPrivate->sOutputCrop.nWidth;
+                    pCrop->nHeight = pComponentPrivate->sOutputCrop.nHeight;
+                }
+                else {
+                    pCrop->nLeft = 0;
+                    pCrop->nTop = 0;
+                    pCrop->nWidth = pComponentPrivate->pOutPortDef->format.video.nFrameWidth;
+                    pCrop->nHeight = pComponentPrivate->pOutPortDef->format.video.nFrameHeight;
+                }
+                break;
+            }
 #ifdef KHRONOS_1_1
             case OMX_IndexConfigVideoMBErrorReporting:/**< reference: OMX_CONFIG_MBERRORREPORTINGTYPE */
             {
@@ -1739,15 +1957,19 @@ static OMX_ERRORTYPE VIDDEC_GetConfig (OMX_HANDLETYPE hComp,
                 if (pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingMPEG4 ||
                     pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingH263 ||
                     pComponentPrivate->pInPortDef->format.video.eCompressionFormat == OMX_VIDEO_CodingAVC) {
-                    OMX_CONFIG_MACROBLOCKERRORMAPTYPE_TI* pMBErrorMapTypeFrom = &pComponentPrivate->eMBErrorMapType[pComponentPrivate->cMBErrorIndexOut];
+                    /* copied once, from the frame most recently delivered while
+                       the client still holds it; nErrMapSize 0 otherwise */
+                    const VIDDEC_MBERRORMAP* pMap = VIDDEC_FindMBErrorMap(pComponentPrivate, pComponentPrivate->pMBErrorMapLast);
                     OMX_CONFIG_MACROBLOCKERRORMAPTYPE_TI* pMBErrorMapTypeTo = ComponentConfigStructure;
-                    OMX_U8* ErrMapFrom = pMBErrorMapTypeFrom->ErrMap;
-                    OMX_U8* ErrMapTo = pMBErrorMapTypeTo->ErrMap;
                     /*OMX_CONF_CHK_VERSION( pRole, OMX_CONFIG_MBERRORREPORTINGTYPE, eError, pComponentPrivate->dbg);*/
-                    pMBErrorMapTypeTo->nErrMapSize = pMBErrorMapTypeFrom->nErrMapSize;
-                    memcpy(ErrMapTo, ErrMapFrom, pMBErrorMapTypeFrom->nErrMapSize);
-                    pComponentPrivate->cMBErrorIndexOut++;
-                    pComponentPrivate->cMBErrorIndexOut %= pComponentPrivate->pOutPortDef->nBufferCountActual;
+                    pMBErrorMapTypeTo->nErrMapSize = 0;
+                    if (pMap != NULL) {
+                        pMBErrorMapTypeTo->nErrMapSize = pMap->nWidthMBs * pMap->nHeightMBs;
+                        if (pMBErrorMapTypeTo->nErrMapSize > sizeof(pMBErrorMapTypeTo->ErrMap)) {
+                            pMBErrorMapTypeTo->nErrMapSize = sizeof(pMBErrorMapTypeTo->ErrMap);
+                        }
+                        memcpy(pMBErrorMapTypeTo->ErrMap, pMap->pErrMap, pMBErrorMapTypeTo->nErrMapSize);
+                    }
                 }
                 else {
                     eError = OMX_ErrorUnsupportedIndex;
@@ -1918,7 +2140,6 @@ static OMX_ERRORTYPE VIDDEC_GetConfig (OMX_HANDLETYPE hComp,
             case OMX_IndexConfigCommonMirror:         /**< reference: OMX_CONFIG_MIRRORTYPE */
             case OMX_IndexConfigCommonOutputPosition: /**< reference: OMX_CONFIG_POINTTYPE */
             case OMX_IndexConfigCommonInputCrop:      /**< reference: OMX_CONFIG_RECTTYPE */
-            case OMX_IndexConfigCommonOutputCrop:     /**< reference: OMX_CONFIG_RECTTYPE */
             case OMX_IndexConfigCommonDigitalZoom:    /**< reference: OMX_SCALEFACTORTYPE */
             case OMX_IndexConfigCommonOpticalZoom:    /**< reference: OMX_SCALEFACTORTYPE*/
             case OMX_IndexConfigCommonWhiteBalance:   /**< reference: OMX_CONFIG_WHITEBALCONTROLTYPE */
@@ -2042,6 +2263,23 @@ static OMX_ERRORTYPE VIDDEC_SetConfig (OMX_HANDLETYPE hComp,
             case VideoDecodeCustomConfigDebug:/**< reference: struct OMX_TI_Debug */
                 OMX_DBG_SETCONFIG(pComponentPrivate->dbg, ComponentConfigStructure);
                 break;
+            case VideoDecodeCustomConfigDecodeDeadline:/**< reference: VIDDEC_CONFIG_DECODEDEADLINETYPE */
+                if (((VIDDEC_CONFIG_DECODEDEADLINETYPE*)ComponentConfigStructure)->nPortIndex != VIDDEC_INPUT_PORT) {
+                    eError = OMX_ErrorBadPortIndex;
+                    break;
+                }
+                VIDDEC_SetDecodeDeadline(pComponentPrivate, (VIDDEC_CONFIG_DECODEDEADLINETYPE*)ComponentConfigStructure);
+                break;
+            case VideoDecodeCustomConfigDecodeTelemetry:/**< reference: VIDDEC_CONFIG_DECODETELEMETRYTYPE */
+                if (((VIDDEC_CONFIG_DECODETELEMETRYTYPE*)ComponentConfigStructure)->nPortIndex != VIDDEC_INPUT_PORT) {
+                    eError = OMX_ErrorBadPortIndex;
+                    break;
+                }
+                VIDDEC_SetDecodeTelemetry(pComponentPrivate, (VIDDEC_CONFIG_DECODETELEMETRYTYPE*)ComponentConfigStructure);
+                break;
+            case VideoDecodeCustomConfigSeekPending:/**< reference: OMX_CONFIG_BOOLEANTYPE */
+                pComponentPrivate->bSeekPending = ((OMX_CONFIG_BOOLEANTYPE*)ComponentConfigStructure)->bEnabled;
+                break;
 #ifdef KHRONOS_1_1
             case OMX_IndexConfigVideoMBErrorReporting:/**< reference: OMX_CONFIG_MBERRORREPORTINGTYPE */
             {
@@ -2096,6 +2334,7 @@ static OMX_ERRORTYPE VIDDEC_SetConfig (OMX_HANDLETYPE hComp,
             case OMX_IndexConfigVideoAVCIntraPeriod:
             case OMX_IndexConfigVideoNalSize:
             case OMX_IndexConfigVideoMacroBlockErrorMap:
+            case VideoDecodeCustomConfigMBErrorMap:
             case OMX_IndexConfigCommonExposureValue:
             case OMX_IndexConfigCommonOutputSize:
             case OMX_IndexParamCommonExtraQuantData:
@@ -2418,6 +2657,7 @@ static OMX_ERRORTYPE VIDDEC_EmptyThisBuffer (OMX_HANDLETYPE pComponent,
     pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pInputPortPrivate;
     ret = pBufferPrivate->eBufferOwner;
     pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_COMPONENT;
+    VIDDEC_Telemetry_Received(pComponentPrivate, pBuffHead);
     eError = IncrementCount (&(pComponentPrivate->nCountInputBFromApp), &(pComponentPrivate->mutexInputBFromApp));
     if (eError != OMX_ErrorNone) {
         return eError;
@@ -2426,11 +2666,11 @@ static OMX_ERRORTYPE VIDDEC_EmptyThisBuffer (OMX_HANDLETYPE pComponent,
     OMX_PRBUFFER1(pComponentPrivate->dbg, "Writing pBuffer 0x%p OldeBufferOwner %ld nAllocLen %lu nFilledLen %lu eBufferOwner %d\n",
         pBuffHead, ret,pBuffHead->nAllocLen,pBuffHead->nFilledLen,pBufferPrivate->eBufferOwner);
 
-    ret = write (pComponentPrivate->filled_inpBuf_Q[VIDDEC_PIPE_WRITE], &(pBuffHead), sizeof(pBuffHead));
+    ret = VIDDEC_Ring_PutBuffer(pComponentPrivate, &pComponentPrivate->filled_inpBuf_Q, pBuffHead);
     if (ret == -1) {
         /*like function returns error buffer still with Client IL*/
         pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
-        OMX_PRCOMM4(pComponentPrivate->dbg, "Error in Writing to the Data pipe\n");
+        OMX_PRCOMM4(pComponentPrivate->dbg, "Error in Writing to the Data ring\n");
         DecrementCount (&(pComponentPrivate->nCountInputBFromApp), &(pComponentPrivate->mutexInputBFromApp));
         eError = OMX_ErrorHardware;
         goto EXIT;
@@ -2515,6 +2755,10 @@ static OMX_ERRORTYPE VIDDEC_FillThisBuffer (OMX_HANDLETYPE pComponent,
     pBufferPrivate = (VIDDEC_BUFFER_PRIVATE* )pBuffHead->pOutputPortPrivate;
     ret = pBufferPrivate->eBufferOwner;
     pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_COMPONENT;
+#ifdef KHRONOS_1_1
+    /* the error map view ends with the frame it came with */
+    pBufferPrivate->sMBErrorMap.pErrMap = NULL;
+#endif
     eError = IncrementCount (&(pComponentPrivate->nCountOutputBFromApp), &(pComponentPrivate->mutexOutputBFromApp));
     if (eError != OMX_ErrorNone) {
         return eError;
@@ -2523,11 +2767,11 @@ static OMX_ERRORTYPE VIDDEC_FillThisBuffer (OMX_HANDLETYPE pComponent,
     pBuffHead->nFlags = 0;
     OMX_PRBUFFER1(pComponentPrivate->dbg, "Writing pBuffer 0x%p OldeBufferOwner %d eBufferOwner %d nFilledLen %lu\n",
         pBuffHead, ret,pBufferPrivate->eBufferOwner,pBuffHead->nFilledLen);
-    ret = write (pComponentPrivate->free_outBuf_Q[1], &(pBuffHead), sizeof (pBuffHead));
+    ret = VIDDEC_Ring_PutBuffer(pComponentPrivate, &pComponentPrivate->free_outBuf_Q, pBuffHead);
     if (ret == -1) {
         /*like function returns error buffer still with Client IL*/
         pBufferPrivate->eBufferOwner = VIDDEC_BUFFER_WITH_CLIENT;
-        OMX_PRCOMM4(pComponentPrivate->dbg, "Error in Writing to the Data pipe\n");
+        OMX_PRCOMM4(pComponentPrivate->dbg, "Error in Writing to the Data ring\n");
         DecrementCount (&(pComponentPrivate->nCountOutputBFromApp), &(pComponentPrivate->mutexOutputBFromApp));
         eError = OMX_ErrorHardware;
         goto EXIT;
@@ -2594,16 +2838,11 @@ static OMX_ERRORTYPE VIDDEC_ComponentDeInit(OMX_HANDLETYPE hComponent)
             pComponentPrivate->eLCMLState = VidDec_LCML_State_Unload;
         }
     }
-    eError = write(pComponentPrivate->cmdPipe[VIDDEC_PIPE_WRITE], &Cmd, sizeof(Cmd));
+    eError = VIDDEC_Ring_PutCommand(pComponentPrivate, Cmd, nParam1, NULL);
     if (eError == -1) {
         eError = OMX_ErrorUndefined;
         goto EXIT;
     }
-    eError = write(pComponentPrivate->cmdDataPipe[VIDDEC_PIPE_WRITE], &nParam1, sizeof(nParam1));
-    if (eError == -1) {
-       eError = OMX_ErrorUndefined;
-       goto EXIT;
-    }
 
     eError = VIDDEC_Stop_ComponentThread(pHandle);
     if (eError != OMX_ErrorNone) {
@@ -2612,7 +2851,7 @@ static OMX_ERRORTYPE VIDDEC_ComponentDeInit(OMX_HANDLETYPE hComponent)
 
     if (pComponentPrivate->pInternalConfigBufferAVC != NULL)
       free(pComponentPrivate->pInternalConfigBufferAVC);
-    for (iCount = 0; iCount < MAX_PRIVATE_BUFFERS; iCount++) {
+    for (iCount = 0; iCount < pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->nBufferPrivateCnt; iCount++) {
         if(pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate[iCount]->pBufferHdr != NULL) {
             OMX_BUFFERHEADERTYPE* pBuffHead = NULL;
             pBuffHead = pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate[iCount]->pBufferHdr;
@@ -2627,7 +2866,7 @@ static OMX_ERRORTYPE VIDDEC_ComponentDeInit(OMX_HANDLETYPE hComponent)
         }
     }
 
-    for (iCount = 0; iCount < MAX_PRIVATE_BUFFERS; iCount++) {
+    for (iCount = 0; iCount < pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->nBufferPrivateCnt; iCount++) {
         if(pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate[iCount]->pBufferHdr != NULL) {
             OMX_BUFFERHEADERTYPE* pBuffHead = NULL;
             pBuffHead = pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate[iCount]->pBufferHdr;
@@ -2722,7 +2961,7 @@ static OMX_ERRORTYPE VIDDEC_ComponentDeInit(OMX_HANDLETYPE hComponent)
     }
 #endif
 
-    buffcount = MAX_PRIVATE_BUFFERS;
+    buffcount = pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->nBufferPrivateCnt;
     for (i = 0; i < buffcount; i++) {
         if(pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate[i]) {
             OMX_PRBUFFER1(pComponentPrivate->dbg, "BufferPrivate cleared 0x%p\n",
@@ -2731,8 +2970,9 @@ static OMX_ERRORTYPE VIDDEC_ComponentDeInit(OMX_HANDLETYPE hComponent)
             pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate[i] = NULL;
         }
     }
+    OMX_FREE_VIDDEC(pComponentPrivate->pCompPort[VIDDEC_INPUT_PORT]->pBufferPrivate);
 
-    buffcount = MAX_PRIVATE_BUFFERS;
+    buffcount = pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->nBufferPrivateCnt;
     for (i = 0; i < buffcount; i++) {
         if(pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate[i]) {
             OMX_PRBUFFER1(pComponentPrivate->dbg, "BufferPrivate cleared 0x%p\n",
@@ -2741,6 +2981,8 @@ static OMX_ERRORTYPE VIDDEC_ComponentDeInit(OMX_HANDLETYPE hComponent)
             pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate[i] = NULL;
         }
     }
+    OMX_FREE_VIDDEC(pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]->pBufferPrivate);
+    OMX_FREE_VIDDEC(pComponentPrivate->aBufferFlags);
     if(pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]) {
         free(pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT]);
         pComponentPrivate->pCompPort[VIDDEC_OUTPUT_PORT] = NULL;
@@ -2850,6 +3092,8 @@ static OMX_ERRORTYPE VIDDEC_ComponentDeInit(OMX_HANDLETYPE hComponent)
     pthread_mutex_destroy(&(pComponentPrivate->mutexOutputBFromApp));
     pthread_mutex_destroy(&(pComponentPrivate->mutexInputBFromDSP));
     pthread_mutex_destroy(&(pComponentPrivate->mutexOutputBFromDSP));
+    pthread_mutex_destroy(&(pComponentPrivate->mutexDecodeDeadline));
+    pthread_mutex_destroy(&(pComponentPrivate->mutexTelemetry));
 
     pthread_mutex_destroy(&pComponentPrivate->mutexStateChangeRequest);
     pthread_cond_destroy(&pComponentPrivate->StateChangeCondition);
@@ -2945,6 +3189,11 @@ static OMX_ERRORTYPE VIDDEC_UseBuffer(OMX_IN OMX_HANDLETYPE hComponent,
         eError = OMX_ErrorBadParameter;
         goto EXIT;
     }
+    if (pBufferCnt >= pCompPort->nBufferPrivateCnt) {
+        OMX_PRBUFFER4(pComponentPrivate->dbg, "Error: more buffers than nBufferCountActual\n");
+        eError = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
 
     OMX_MALLOC_STRUCT(pCompPort->pBufferPrivate[pBufferCnt]->pBufferHdr, OMX_BUFFERHEADERTYPE,pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
     if (!pCompPort->pBufferPrivate[pBufferCnt]->pBufferHdr) {
@@ -3004,6 +3253,8 @@ static OMX_ERRORTYPE VIDDEC_UseBuffer(OMX_IN OMX_HANDLETYPE hComponent,
         (*ppBufferHdr)->pOutputPortPrivate = pComponentPrivate->pCompPort[nPortIndex]->pBufferPrivate[pBufferCnt];
     }
     pComponentPrivate->pCompPort[nPortIndex]->pBufferPrivate[pBufferCnt]->bAllocByComponent = OMX_FALSE;
+    pComponentPrivate->pCompPort[nPortIndex]->pBufferPrivate[pBufferCnt]->nHeadroom = 0;
+    pComponentPrivate->pCompPort[nPortIndex]->pBufferPrivate[pBufferCnt]->nPrepended = 0;
 
     if (pCompPort->hTunnelComponent != NULL) {
         pComponentPrivate->pCompPort[nPortIndex]->pBufferPrivate[pBufferCnt]->eBufferOwner = VIDDEC_BUFFER_WITH_TUNNELEDCOMP;
@@ -3375,6 +3626,11 @@ static OMX_ERRORTYPE VIDDEC_AllocateBuffer (OMX_IN OMX_HANDLETYPE hComponent,
         eError = OMX_ErrorBadPortIndex;
         goto EXIT;
     }
+    if (pBufferCnt >= pCompPort->nBufferPrivateCnt) {
+        OMX_PRBUFFER4(pComponentPrivate->dbg, "Error: more buffers than nBufferCountActual\n");
+        eError = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
 
     OMX_MALLOC_STRUCT(pCompPort->pBufferPrivate[pBufferCnt]->pBufferHdr, OMX_BUFFERHEADERTYPE,pComponentPrivate->nMemUsage[VIDDDEC_Enum_MemLevel1]);
     if (!pCompPort->pBufferPrivate[pBufferCnt]->pBufferHdr) {
@@ -3405,7 +3661,9 @@ static OMX_ERRORTYPE VIDDEC_AllocateBuffer (OMX_IN OMX_HANDLETYPE hComponent,
     }
     /* Align and add padding for data buffer */
     pCompPort->pBufferPrivate[pBufferCnt]->pOriginalBuffer = (*pBuffHead)->pBuffer;
-    (*pBuffHead)->pBuffer += VIDDEC_PADDING_HALF;
+    pCompPort->pBufferPrivate[pBufferCnt]->nHeadroom = (nPortIndex == VIDDEC_INPUT_PORT) ? VIDDEC_CONFIG_HEADROOM : 0;
+    pCompPort->pBufferPrivate[pBufferCnt]->nPrepended = 0;
+    (*pBuffHead)->pBuffer += VIDDEC_PADDING_HALF + pCompPort->pBufferPrivate[pBufferCnt]->nHeadroom;
     OMX_ALIGN_BUFFER((*pBuffHead)->pBuffer, VIDDEC_ALIGNMENT);
 #ifdef VIDDEC_WMVPOINTERFIXED
     pCompPort->pBufferPrivate[pBufferCnt]->pTempBuffer = (*pBuffHead)->pBuffer;
@@ -3701,6 +3959,7 @@ static OMX_ERRORTYPE VIDDEC_ComponentTunnelRequest (OMX_IN OMX_HANDLETYPE hCompo
         pPort->hTunnelComponent = NULL;
         pPort->nTunnelPort = 0;
         pPort->eSupplierSetting = OMX_BufferSupplyUnspecified;
+        pPort->bProprietaryTunnel = OMX_FALSE;
     }
     else {
         if (pPortDef->eDir != OMX_DirInput && pPortDef->eDir != OMX_DirOutput) {
@@ -3716,6 +3975,8 @@ static OMX_ERRORTYPE VIDDEC_ComponentTunnelRequest (OMX_IN OMX_HANDLETYPE hCompo
 #endif
         pPort->hTunnelComponent = hTunneledComp;
         pPort->nTunnelPort = nTunneledPort;
+        /* TI to TI tunnel, keep the DSP mappings of the tunnel buffers */
+        pPort->bProprietaryTunnel = (pTunnelSetup->nTunnelFlags & OMX_TI_PORTTUNNELFLAG_PROPRIETARY) ? OMX_TRUE : OMX_FALSE;
 
         if (pPortDef->eDir == OMX_DirOutput) {
             pTunnelSetup->eSupplier = pPort->eSupplierSetting;
@@ -70,6 +70,7 @@
     #include <pthread.h>
 #endif
 #include "OMX_TI_Common.h"
+#include "OMX_TI_Core.h"
 #include <utils/Log.h>
 
 /* this is the max of VIDENC_MAX_NUM_OF_IN_BUFFERS and VIDENC_MAX_NUM_OF_OUT_BUFFERS */
@@ -467,6 +468,7 @@ typedef enum VIDENC_CUSTOM_INDEX
     /*only for H264*/
     VideoEncodeCustomParamIndexEncodingPreset,
     VideoEncodeCustomParamIndexNALFormat,
+    VideoEncodeCustomParamIndexRepeatParamSets,
     /* debug config */
     VideoEncodeCustomConfigIndexDebug
 } VIDENC_CUSTOM_INDEX;
@@ -486,6 +488,22 @@ typedef enum VIDENC_AVC_NAL_FORMAT
     VIDENC_AVC_NAL_FRAME        /*One frame per buffer, one or more NAL units inside the buffer*/
 }VIDENC_AVC_NAL_FORMAT;
 
+/* Largest SPS / PPS NAL unit kept by the parameter set cache */
+#define VIDENC_MAX_SPS_SIZE 128
+#define VIDENC_MAX_PPS_SIZE 64
+
+/* Current SPS and PPS of the AVC stream, without start codes. The codec
+   config buffer (and with bRepeatParamSets the copy ahead of every IDR)
+   is written from here. */
+typedef struct VIDENC_AVC_PARAMSET_CACHE
+{
+    OMX_U8  aSps[VIDENC_MAX_SPS_SIZE];
+    OMX_U32 nSpsLen;
+    OMX_U8  aPps[VIDENC_MAX_PPS_SIZE];
+    OMX_U32 nPpsLen;
+    OMX_BOOL bChanged;      /* differs from the last codec config sent */
+} VIDENC_AVC_PARAMSET_CACHE;
+
 typedef struct VIDENC_BUFFER_PRIVATE
 {
     OMX_PTR pMetaData;/*pointer to metadata structure, this structure is used when MPEG4 segment mode is enabled  */
@@ -510,6 +528,7 @@ typedef struct VIDEOENC_PORT_TYPE
     OMX_U32 nTunnelPort;
     OMX_HANDLETYPE hTunnelComponent;
     OMX_BUFFERSUPPLIERTYPE eSupplierSetting;
+    OMX_BOOL bProprietaryTunnel;
     OMX_PARAM_PORTDEFINITIONTYPE* pPortDef;
     OMX_VIDEO_PARAM_PORTFORMATTYPE* pPortFormat;
 
@@ -614,8 +633,8 @@ typedef struct VIDENC_COMPONENT_PRIVATE
     OMX_U32 nMIRRate;
     OMX_U8  ucUnrestrictedMV;
     OMX_BOOL bSentFirstSpsPps;
-    unsigned char *sps;
-    OMX_U32  spsLen;
+    OMX_BOOL bRepeatParamSets;
+    VIDENC_AVC_PARAMSET_CACHE sParamSets;
 
     OMX_U32 nInBufferSize;
     OMX_U32 nOutBufferSize;
@@ -1328,12 +1328,6 @@ OMX_ERRORTYPE OMX_VIDENC_HandleCommandStateSetIdle(VIDENC_COMPONENT_PRIVATE* pCo
                    pComponentPrivate->pLCML = NULL;
                 }
 
-                if (pComponentPrivate->sps) {
-                    free(pComponentPrivate->sps);
-                    pComponentPrivate->sps = NULL;
-                    pComponentPrivate->spsLen = 0;
-                }
-
                 pComponentPrivate->bCodecStarted = OMX_FALSE;
                 pComponentPrivate->bCodecLoaded = OMX_FALSE;
             }
@@ -2614,7 +2608,8 @@ OMX_ERRORTYPE OMX_VIDENC_Process_FilledInBuf(VIDENC_COMPONENT_PRIVATE* pComponen
         OMX_PRBUFFER1(pComponentPrivate->dbg, " %p\n", (void*)pBufHead);
         pBufferPrivate->eBufferOwner = VIDENC_BUFFER_WITH_DSP;
         eError = LCML_QueueBuffer(pLcmlHandle->pCodecinterfacehandle,
-                                  EMMCodecInputBuffer,
+                                  (pComponentPrivate->pCompPort[VIDENC_INPUT_PORT]->bProprietaryTunnel ?
+                                    EMMCodecInputBufferMapReuse : EMMCodecInputBuffer),
                                   pBufHead->pBuffer,
                                   pBufHead->nAllocLen,
                                   pBufHead->nFilledLen,
@@ -2761,7 +2756,8 @@ OMX_ERRORTYPE OMX_VIDENC_Queue_Mpeg4_Buffer(VIDENC_COMPONENT_PRIVATE* pComponent
         OMX_PRBUFFER1(pComponentPrivate->dbg, " %p\n", (void*)pBufHead);
         pBufferPrivate->eBufferOwner = VIDENC_BUFFER_WITH_DSP;
         eError = LCML_QueueBuffer(pLcmlHandle->pCodecinterfacehandle,
-                                  EMMCodecInputBuffer,
+                                  (pComponentPrivate->pCompPort[VIDENC_INPUT_PORT]->bProprietaryTunnel ?
+                                    EMMCodecInputBufferMapReuse : EMMCodecInputBuffer),
                                   pBufHead->pBuffer,
                                   pBufHead->nAllocLen,
                                   pBufHead->nFilledLen,
@@ -2779,6 +2775,88 @@ OMX_CONF_CMD_BAIL:
 }
 
 
+/*---------------------------------------------------------------------------------------*/
+/**
+  * OMX_VIDENC_CacheParamSet()
+  *
+  * Keeps the SPS or PPS NAL unit held in pBufHead in the parameter set cache. The
+  * copy is only made when it differs from the one already cached. One that does not
+  * fit empties its slot, so that a stale copy is never written out with the new other.
+  *
+  * @retval OMX_ErrorNone                  success
+  *         OMX_ErrorUndefined             the NAL unit is empty or too large to cache
+  **/
+/*---------------------------------------------------------------------------------------*/
+
+static OMX_ERRORTYPE OMX_VIDENC_CacheParamSet(VIDENC_COMPONENT_PRIVATE* pComponentPrivate,
+                                              OMX_BUFFERHEADERTYPE* pBufHead,
+                                              OMX_S32 nalType)
+{
+    VIDENC_AVC_PARAMSET_CACHE* pCache = &pComponentPrivate->sParamSets;
+    OMX_U8* pStore = pCache->aSps;
+    OMX_U32* pLen = &pCache->nSpsLen;
+    OMX_U32 nMax = VIDENC_MAX_SPS_SIZE;
+
+    if (nalType == PPS_CODE_PREFIX)
+    {
+        pStore = pCache->aPps;
+        pLen = &pCache->nPpsLen;
+        nMax = VIDENC_MAX_PPS_SIZE;
+    }
+    if (pBufHead->nFilledLen == 0 || pBufHead->nFilledLen > nMax)
+    {
+        OMX_PRBUFFER4(pComponentPrivate->dbg, "Parameter set NAL %ld of %lu bytes not cached\n",
+                      nalType, pBufHead->nFilledLen);
+        *pLen = 0;
+        return OMX_ErrorUndefined;
+    }
+    if (*pLen != pBufHead->nFilledLen || memcmp(pStore, pBufHead->pBuffer, *pLen) != 0)
+    {
+        memcpy(pStore, pBufHead->pBuffer, pBufHead->nFilledLen);
+        *pLen = pBufHead->nFilledLen;
+        pCache->bChanged = OMX_TRUE;
+    }
+    return OMX_ErrorNone;
+}
+
+/*---------------------------------------------------------------------------------------*/
+/**
+  * OMX_VIDENC_WriteParamSets()
+  *
+  * Fills pBufHead with the cached SPS and PPS, each behind a start code, replacing
+  * what the buffer held.
+  *
+  * @retval OMX_ErrorNone                  success
+  *         OMX_ErrorUndefined             no SPS/PPS pair cached, or it does not fit
+  **/
+/*---------------------------------------------------------------------------------------*/
+
+static OMX_ERRORTYPE OMX_VIDENC_WriteParamSets(VIDENC_COMPONENT_PRIVATE* pComponentPrivate,
+                                               OMX_BUFFERHEADERTYPE* pBufHead)
+{
+    static const OMX_U8 aStartCode[4] = {0x00, 0x00, 0x00, 0x01};
+    VIDENC_AVC_PARAMSET_CACHE* pCache = &pComponentPrivate->sParamSets;
+    OMX_U8* pOut = pBufHead->pBuffer;
+
+    if (pCache->nSpsLen == 0 || pCache->nPpsLen == 0 ||
+        2 * sizeof(aStartCode) + pCache->nSpsLen + pCache->nPpsLen > pBufHead->nAllocLen)
+    {
+        OMX_PRBUFFER4(pComponentPrivate->dbg, "Cannot write SPS (%lu) and PPS (%lu) in %lu bytes\n",
+                      pCache->nSpsLen, pCache->nPpsLen, pBufHead->nAllocLen);
+        return OMX_ErrorUndefined;
+    }
+    memcpy(pOut, aStartCode, sizeof(aStartCode));
+    pOut += sizeof(aStartCode);
+    memcpy(pOut, pCache->aSps, pCache->nSpsLen);
+    pOut += pCache->nSpsLen;
+    memcpy(pOut, aStartCode, sizeof(aStartCode));
+    pOut += sizeof(aStartCode);
+    memcpy(pOut, pCache->aPps, pCache->nPpsLen);
+    pOut += pCache->nPpsLen;
+    pBufHead->nFilledLen = (OMX_U32)(pOut - pBufHead->pBuffer);
+    return OMX_ErrorNone;
+}
+
 /*---------------------------------------------------------------------------------------*/
 /**
   * OMX_VIDENC_Process_FilledOutBuf()
@@ -2843,40 +2921,39 @@ OMX_ERRORTYPE OMX_VIDENC_Process_FilledOutBuf(VIDENC_COMPONENT_PRIVATE* pCompone
             {
                 /* IDR Frame */
                 OMX_S32 nalType = pBufHead->pBuffer[0] & 0x1F;
-                if (nalType == SPS_CODE_PREFIX || nalType == PPS_CODE_PREFIX) {
-                    /* Need to drop subsequent SPS or PPS NAL unit since opencore does not
-                     * correctly handle storage */
-                    if (!pComponentPrivate->bSentFirstSpsPps) {
-                        if (nalType == SPS_CODE_PREFIX) {
-                            // Save SPS and send it along with PPS later in a single buffer
-                            // Workaround to send a 0-length buffer first.
-                            // Ideally, we should not send a buffer at all.
-                            pComponentPrivate->sps = malloc(4 + pBufHead->nFilledLen);
-                            pComponentPrivate->spsLen = 4 + pBufHead->nFilledLen;
-                            memcpy(pComponentPrivate->sps, "\x00\x00\x00\x01", 4);
-                            memcpy(pComponentPrivate->sps + 4, pBufHead->pBuffer, pBufHead->nFilledLen);
-                            pBufHead->nFilledLen = 0;
+                /* Only the NAL slice mode has a buffer per NAL unit; in the other
+                 * modes the parameter sets stay in the frame as the codec wrote them */
+                if (pComponentPrivate->AVCNALFormat == VIDENC_AVC_NAL_SLICE &&
+                    (nalType == SPS_CODE_PREFIX || nalType == PPS_CODE_PREFIX)) {
+                    /* The codec sends the SPS and then the PPS, each in its own buffer,
+                     * ahead of every IDR frame. Both go to the cache and the pair is
+                     * written from there into the PPS buffer: as codec config the first
+                     * time and whenever it changed, otherwise only with bRepeatParamSets
+                     * since opencore does not correctly handle storage of repeated ones.
+                     * The SPS buffer goes back empty; ideally it would not be sent at all.
+                     * A NAL unit the cache cannot take, or a pair that cannot be written,
+                     * goes out as it is. */
+                    if (OMX_VIDENC_CacheParamSet(pComponentPrivate, pBufHead, nalType) != OMX_ErrorNone) {
+                        if (!pComponentPrivate->bSentFirstSpsPps) {
+                            pBufHead->nFlags |= OMX_BUFFERFLAG_CODECCONFIG;
                         }
-
-                        /* we can assume here that PPS always comes second */
-                        if (nalType == PPS_CODE_PREFIX) {
+                    }
+                    /* we can assume here that PPS always comes second */
+                    else if (nalType == SPS_CODE_PREFIX) {
+                        pBufHead->nFilledLen = 0;
+                    }
+                    else if (!pComponentPrivate->bSentFirstSpsPps ||
+                             pComponentPrivate->sParamSets.bChanged) {
+                        if (OMX_VIDENC_WriteParamSets(pComponentPrivate, pBufHead) == OMX_ErrorNone) {
                             pComponentPrivate->bSentFirstSpsPps = OMX_TRUE;
-                            if (pComponentPrivate->sps == NULL ||
-                                pComponentPrivate->spsLen == 0) {
-                                OMX_CONF_SET_ERROR_BAIL(eError, OMX_ErrorUndefined);
-                            }
-                            memmove(pBufHead->pBuffer + pComponentPrivate->spsLen + 4,
-                                    pBufHead->pBuffer, pBufHead->nFilledLen);
-                            memmove(pBufHead->pBuffer,
-                                    pComponentPrivate->sps, pComponentPrivate->spsLen);
-                            memcpy(pBufHead->pBuffer + pComponentPrivate->spsLen, "\x00\x00\x00\x01", 4);
-                            pBufHead->nFilledLen += pComponentPrivate->spsLen + 4;
-                            pBufHead->nFlags |= OMX_BUFFERFLAG_CODECCONFIG;
-                            free(pComponentPrivate->sps);
-                            pComponentPrivate->sps = NULL;
-                            pComponentPrivate->spsLen = 0;
+                            pComponentPrivate->sParamSets.bChanged = OMX_FALSE;
                         }
-                    } else {
+                        pBufHead->nFlags |= OMX_BUFFERFLAG_CODECCONFIG;
+                    }
+                    else if (pComponentPrivate->bRepeatParamSets) {
+                        (void)OMX_VIDENC_WriteParamSets(pComponentPrivate, pBufHead);
+                    }
+                    else {
                         pBufHead->nFilledLen = 0;
                     }
                 }
@@ -3268,6 +3345,9 @@ OMX_ERRORTYPE OMX_VIDENC_InitDSP_H264Enc(VIDENC_COMPONENT_PRIVATE* pComponentPri
     pComponentPrivate->nTargetFrameRate       = pCreatePhaseArgs->ulFrameRate;
     pComponentPrivate->nPrevTargetFrameRate   = 0;
     pComponentPrivate->bSentFirstSpsPps       = OMX_FALSE;
+    pComponentPrivate->sParamSets.nSpsLen     = 0;
+    pComponentPrivate->sParamSets.nPpsLen     = 0;
+    pComponentPrivate->sParamSets.bChanged    = OMX_FALSE;
 
     if (pPortDefIn->format.video.eColorFormat == OMX_COLOR_FormatYUV420Planar)
     {
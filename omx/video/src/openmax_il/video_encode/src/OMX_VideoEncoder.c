@@ -384,8 +384,7 @@ OMX_ERRORTYPE OMX_ComponentInit (OMX_HANDLETYPE hComponent)
     pComponentPrivate->bUnresponsiveDsp     = OMX_FALSE;
     pComponentPrivate->bCodecLoaded         = OMX_FALSE;
     pComponentPrivate->cComponentName       = "OMX.TI.Video.encoder";
-    pComponentPrivate->sps = NULL;
-    pComponentPrivate->spsLen = 0;
+    pComponentPrivate->bRepeatParamSets     = OMX_FALSE;
 
 #ifdef __KHRONOS_CONF__
     pComponentPrivate->bPassingIdleToLoaded = OMX_FALSE;
@@ -1779,6 +1778,9 @@ static OMX_ERRORTYPE GetParameter (OMX_IN OMX_HANDLETYPE hComponent,
        case VideoEncodeCustomParamIndexNALFormat:
            (*((unsigned int*)ComponentParameterStructure)) = (unsigned int)pComponentPrivate->AVCNALFormat;
            break;
+       case VideoEncodeCustomParamIndexRepeatParamSets:
+           (*((OMX_BOOL*)ComponentParameterStructure)) = pComponentPrivate->bRepeatParamSets;
+           break;
        case PV_OMX_COMPONENT_CAPABILITY_TYPE_INDEX:
             pTmp = memcpy(ComponentParameterStructure,
             pComponentPrivate->pCapabilityFlags,
@@ -2205,8 +2207,25 @@ static OMX_ERRORTYPE SetParameter (OMX_IN OMX_HANDLETYPE hComponent,
             pComponentPrivate->ucUnrestrictedMV = (OMX_U8)(*((OMX_U8*)pCompParam));
             break;
        case VideoEncodeCustomParamIndexNALFormat:
+              /* repeated parameter sets are only written in the NAL slice mode */
+              if (pComponentPrivate->bRepeatParamSets &&
+                  (VIDENC_AVC_NAL_FORMAT)(*((unsigned int*)pCompParam)) != VIDENC_AVC_NAL_SLICE) {
+                  eError = OMX_ErrorUnsupportedSetting;
+                  break;
+              }
               pComponentPrivate->AVCNALFormat = (VIDENC_AVC_NAL_FORMAT)(*((unsigned int*)pCompParam));
        break;
+       /* SPS and PPS ahead of every IDR frame, not only in the codec config.
+          Only the NAL slice mode gets them as buffers of their own, which are
+          filled from the cache; the other modes would need the frame moved */
+       case VideoEncodeCustomParamIndexRepeatParamSets:
+              if ((OMX_BOOL)(*((OMX_BOOL*)pCompParam)) &&
+                  pComponentPrivate->AVCNALFormat != VIDENC_AVC_NAL_SLICE) {
+                  eError = OMX_ErrorUnsupportedSetting;
+                  break;
+              }
+              pComponentPrivate->bRepeatParamSets = (OMX_BOOL)(*((OMX_BOOL*)pCompParam));
+       break;
        //not supported yet
        case OMX_IndexConfigCommonRotate:
        break;
@@ -2650,6 +2669,7 @@ static OMX_ERRORTYPE ExtensionIndex(OMX_IN OMX_HANDLETYPE hComponent,
         {"OMX.TI.VideoEncode.Config.Intra4x4EnableIdc", VideoEncodeCustomConfigIndexIntra4x4EnableIdc},
         {"OMX.TI.VideoEncode.Config.EncodingPreset", VideoEncodeCustomParamIndexEncodingPreset},
         {"OMX.TI.VideoEncode.Config.NALFormat", VideoEncodeCustomParamIndexNALFormat},
+        {"OMX.TI.VideoEncode.Param.RepeatParamSets", VideoEncodeCustomParamIndexRepeatParamSets},
         {"OMX.TI.VideoEncode.Debug", VideoEncodeCustomConfigIndexDebug}
     };
     OMX_ERRORTYPE eError = OMX_ErrorNone;
@@ -3991,6 +4011,7 @@ OMX_ERRORTYPE ComponentTunnelRequest(OMX_IN  OMX_HANDLETYPE hComponent,
         pPort->hTunnelComponent = 0;
         pPort->nTunnelPort = 0;
         pPort->eSupplierSetting = OMX_BufferSupplyUnspecified;
+        pPort->bProprietaryTunnel = OMX_FALSE;
     }
     else
     {
@@ -4016,6 +4037,9 @@ OMX_ERRORTYPE ComponentTunnelRequest(OMX_IN  OMX_HANDLETYPE hComponent,
         }
         pPort->hTunnelComponent = hTunneledComp;
         pPort->nTunnelPort = nTunneledPort;
+        /* TI to TI tunnel, keep the DSP mappings of the tunnel buffers */
+        pPort->bProprietaryTunnel = (pTunnelSetup->nTunnelFlags & OMX_TI_PORTTUNNELFLAG_PROPRIETARY) ?
+                                    OMX_TRUE : OMX_FALSE;
 
         if (pPort->pPortDef->eDir == OMX_DirOutput)
         {